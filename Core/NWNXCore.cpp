@@ -14,13 +14,15 @@
 #include "API/CExoStringList.hpp"
 #include "API/CScriptCompiler.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <csignal>
-#include <regex>
 #include <dirent.h>
 #include <unistd.h>
 #include <cstdio>
 #include <sstream>
 #include <dlfcn.h>
+#include <unordered_map>
 
 using namespace NWNXLib;
 using namespace NWNXLib::API;
@@ -40,6 +42,8 @@ extern "C" void nwnx_signal_handler(int sig)
         default:       err = "Unknown error";            break;
     }
 
+    Log::FlushFromSignalHandler();
+
     std::fprintf(stdout, " NWNX Signal Handler:\n"
         "==============================================================\n"
         " NWNX %d.%d-%d (%s) has crashed. Fatal error: %s (%d).\n"
@@ -148,13 +152,24 @@ NWNXCore::~NWNXCore()
 
 void NWNXCore::CleanupPreload()
 {
-    const auto* preload = std::getenv("LD_PRELOAD");
-    const std::regex regex("(([^: ]+)?NWNX_[^: ]+)");
+    const std::string preload = std::getenv("LD_PRELOAD");
 
-    std::string newPreload = preload;
-    while (std::regex_search(newPreload, regex))
+    // Drop every entry containing NWNX_ followed by something, keeping the separators.
+    std::string newPreload;
+    size_t start = 0;
+    while (start <= preload.size())
     {
-        newPreload = std::regex_replace(newPreload, regex, "");
+        auto end = preload.find_first_of(": ", start);
+        if (end == std::string::npos)
+            end = preload.size();
+
+        const auto entry = std::string_view(preload).substr(start, end - start);
+        const auto nwnx = entry.find("NWNX_");
+        if (nwnx == std::string_view::npos || nwnx + 5 == entry.size())
+            newPreload += entry;
+        if (end < preload.size())
+            newPreload += preload[end];
+        start = end + 1;
     }
 
     setenv("LD_PRELOAD", newPreload.c_str(), true);
@@ -471,10 +486,10 @@ void NWNXCore::InitialSetupCommands()
         {
             if (auto *pList = Globals::ExoResMan()->GetResOfType(Constants::ResRefType::NSS, false))
             {
-                std::regex rgx("nwnx_[a-z]*");
+                auto rgx = Pattern::Compile("nwnx_[a-z]*");
                 for (int i = 0; i < pList->m_nCount; i++)
                 {
-                    if (std::regex_match(pList->m_pStrings[i]->CStr(), rgx))
+                    if (Pattern::Match(rgx, pList->m_pStrings[i]->CStr()))
                         nwnxHeaders += "#include \"" + std::string(pList->m_pStrings[i]->CStr()) + "\" ";
                 }
             }
@@ -543,6 +558,50 @@ void NWNXCore::InitialSetupCommands()
                  Log::GetPrintSource(), Log::GetColorOutput(), Log::GetForceColor());
     });
 
+    Commands::Register("hookstats", [](std::string&, std::string& args)
+    {
+        std::istringstream stream(args);
+        std::string action;
+        stream >> action;
+
+        if (action == "bench")
+        {
+            uint32_t depth = 8, calls = 1000000;
+            stream >> depth >> calls;
+            const auto results = Hooks::BenchmarkChain(depth, calls);
+            for (size_t i = 0; i < results.size(); i++)
+            {
+                LOG_INFO("Hook chain depth %u: %.1f ns per call, %.1f ns per hook", i, results[i],
+                         i ? (results[i] - results[0]) / i : 0.0);
+            }
+            return;
+        }
+
+        if (!Hooks::IsAccountingEnabled())
+        {
+            LOG_INFO("Hook accounting is disabled, set NWNX_CORE_HOOK_ACCOUNTING=y to enable it.");
+            return;
+        }
+
+        if (action == "reset")
+        {
+            Hooks::ResetAccounting();
+            LOG_INFO("Hook accounting reset.");
+            return;
+        }
+
+        auto accounting = Hooks::GetAccounting();
+        std::sort(accounting.begin(), accounting.end(), [](const auto& a, const auto& b) { return a.exclusiveNs > b.exclusiveNs; });
+        const size_t count = std::min<size_t>(accounting.size(), String::FromString<uint32_t>(action).value_or(20));
+        for (size_t i = 0; i < count && accounting[i].calls; i++)
+        {
+            const auto& hook = accounting[i];
+            LOG_INFO("%s in %s: %llu calls, %.3f ms inclusive, %.3f ms exclusive, %.1f us exclusive per call",
+                     hook.function, hook.plugin, hook.calls, hook.inclusiveNs / 1e6, hook.exclusiveNs / 1e6,
+                     hook.exclusiveNs / 1e3 / hook.calls);
+        }
+    });
+
 }
 
 
@@ -559,6 +618,7 @@ void NWNXCore::Shutdown()
         Plugin::UnloadAll();
         UnloadServices();
         Tasks::StopAsyncWorkers();
+        Log::StopAsyncWriter();
         g_core = nullptr;
         if (Config::Get<bool>("HARD_EXIT", false))
             exit(0);
@@ -582,6 +642,12 @@ void NWNXCore::CreateServerHandler(CAppManager* app)
     Log::SetColorOutput(Config::Get<bool>("LOG_COLOR", true));
     Log::SetForceColor(Config::Get<bool>("LOG_FORCE_COLOR", false));
     Log::SetLogFile(Config::Get<std::string>("LOG_FILE_PATH", ""));
+    Log::SetJsonOutput(Config::Get<bool>("LOG_JSON", false));
+    if (Config::Get<bool>("LOG_ASYNC", true))
+    {
+        Log::StartAsyncWriter(Config::Get<int>("LOG_QUEUE_SIZE", 8192),
+            Config::Get<std::string>("LOG_OVERFLOW", "block") == "drop" ? Log::OverflowPolicy::Drop : Log::OverflowPolicy::Block);
+    }
 
     if (auto locale = Config::Get<std::string>("LOCALE"))
     {
@@ -640,11 +706,48 @@ void NWNXCore::DestroyServerHandler(CAppManager* app)
     RestoreCrashHandlers();
 }
 
+// Pushes the hooks called since the last push, once a second.
+static void PushHookAccounting()
+{
+    static auto s_lastPush = std::chrono::steady_clock::now();
+    static std::unordered_map<std::string, Hooks::HookAccounting> s_pushed;
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now - s_lastPush < std::chrono::seconds(1))
+        return;
+    s_lastPush = now;
+
+    for (auto& hook : Hooks::GetAccounting())
+    {
+        auto& pushed = s_pushed[hook.function + "|" + hook.plugin];
+        // Counters drop below the pushed values after a reset.
+        if (hook.calls < pushed.calls)
+            pushed = {};
+        if (hook.calls != pushed.calls)
+        {
+            g_core->m_services->m_metrics->Push(
+                "HookAccounting",
+                {
+                    { "Count", std::to_string(hook.calls - pushed.calls) },
+                    { "InclusiveNs", std::to_string(hook.inclusiveNs - pushed.inclusiveNs) },
+                    { "ExclusiveNs", std::to_string(hook.exclusiveNs - pushed.exclusiveNs) }
+                },
+                {
+                    { "Function", hook.function },
+                    { "Plugin", hook.plugin }
+                });
+        }
+        pushed = std::move(hook);
+    }
+}
+
 int32_t NWNXCore::MainLoopInternalHandler(CServerExoAppInternal *pServerExoAppInternal)
 {
     g_core->m_services->m_metrics->Update();
     Tasks::ProcessMainThreadWork();
     Commands::RunScheduled();
+    if (Hooks::IsAccountingEnabled())
+        PushHookAccounting();
 
     return g_core->m_mainLoopInternalHook->CallOriginal<int32_t>(pServerExoAppInternal);
 }
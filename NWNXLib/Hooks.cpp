@@ -1,8 +1,19 @@
 #include "nwnx.hpp"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <deque>
+#include <dlfcn.h>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include "External/funchook/include/funchook.h"
 
@@ -10,11 +21,142 @@ using namespace NWNXLib;
 namespace NWNXLib::Hooks
 {
 
-FunctionHook::FunctionHook(void* originalFunction, void* newFunction, int32_t order)
-    : m_originalFunction(originalFunction), m_newFunction(newFunction), m_order(order)
+namespace {
+
+struct Accounting
+{
+    std::string function;
+    std::string plugin;
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> inclusiveNs{0};
+    std::atomic<uint64_t> exclusiveNs{0};
+    void *replacement;
+};
+
+}
+
+static std::mutex s_AccountingMutex;
+static std::map<std::pair<void*, void*>, Accounting*> s_AccountingByHook;
+// Never shrinks, a hook that is destroyed mid call still has its scope on the stack.
+static std::deque<Accounting> s_Accounting;
+// Set by the prehook right before funchook jumps to the accounting wrapper, which takes it on entry.
+static thread_local Accounting *t_PendingAccounting;
+static thread_local AccountingScope *t_CurrentScope;
+
+static uint64_t Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void AccountingPrehook(funchook_info_t *info)
+{
+    t_PendingAccounting = static_cast<Accounting*>(info->user_data);
+}
+
+AccountingScope::AccountingScope()
+    : m_accounting(t_PendingAccounting), m_parent(t_CurrentScope), m_start(Now()), m_childNs(0)
+{
+    t_PendingAccounting = nullptr;
+    t_CurrentScope = this;
+}
+
+AccountingScope::~AccountingScope()
+{
+    const auto ns = Now() - m_start;
+    if (auto *pAccounting = static_cast<Accounting*>(m_accounting))
+    {
+        pAccounting->calls.fetch_add(1, std::memory_order_relaxed);
+        pAccounting->inclusiveNs.fetch_add(ns, std::memory_order_relaxed);
+        pAccounting->exclusiveNs.fetch_add(ns - std::min(ns, m_childNs), std::memory_order_relaxed);
+    }
+    if (m_parent)
+        m_parent->m_childNs += ns;
+    t_CurrentScope = m_parent;
+}
+
+void* AccountingScope::GetReplacement() const
+{
+    // Only the prehook tells the wrapper which hook it was entered for, without it there is nothing to call.
+    ASSERT_MSG(m_accounting, "Accounted hook entered without its prehook.");
+    if (!m_accounting)
+        std::abort();
+    return static_cast<Accounting*>(m_accounting)->replacement;
+}
+
+static std::string SymbolName(void *address)
+{
+    Dl_info info;
+    if (dladdr(address, &info) && info.dli_sname)
+    {
+        int status;
+        std::unique_ptr<char, decltype(&std::free)> demangled(abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status), &std::free);
+        return status == 0 ? demangled.get() : info.dli_sname;
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%p", address);
+    return buffer;
+}
+
+static std::string ModuleName(void *address)
+{
+    Dl_info info;
+    if (!dladdr(address, &info) || !info.dli_fname)
+        return "?";
+    std::string name = info.dli_fname;
+    name = name.substr(name.find_last_of('/') + 1);
+    return name.substr(0, name.find('.'));
+}
+
+static Accounting* GetAccounting(void *originalFunction, void *newFunction)
+{
+    std::lock_guard<std::mutex> lock(s_AccountingMutex);
+    auto& pAccounting = s_AccountingByHook[{originalFunction, newFunction}];
+    if (!pAccounting)
+    {
+        pAccounting = &s_Accounting.emplace_back();
+        pAccounting->function = SymbolName(originalFunction);
+        pAccounting->plugin = ModuleName(newFunction);
+        pAccounting->replacement = newFunction;
+    }
+    return pAccounting;
+}
+
+bool IsAccountingEnabled()
+{
+    static const bool s_bEnabled = Config::Get<bool>("HOOK_ACCOUNTING", false, "NWNX_CORE");
+    return s_bEnabled;
+}
+
+std::vector<HookAccounting> GetAccounting()
+{
+    std::lock_guard<std::mutex> lock(s_AccountingMutex);
+    std::vector<HookAccounting> accounting;
+    accounting.reserve(s_Accounting.size());
+    for (const auto& entry : s_Accounting)
+    {
+        accounting.push_back({entry.function, entry.plugin, entry.calls.load(std::memory_order_relaxed),
+                              entry.inclusiveNs.load(std::memory_order_relaxed), entry.exclusiveNs.load(std::memory_order_relaxed)});
+    }
+    return accounting;
+}
+
+void ResetAccounting()
+{
+    std::lock_guard<std::mutex> lock(s_AccountingMutex);
+    for (auto& entry : s_Accounting)
+    {
+        entry.calls = 0;
+        entry.inclusiveNs = 0;
+        entry.exclusiveNs = 0;
+    }
+}
+
+FunctionHook::FunctionHook(void* originalFunction, void* newFunction, int32_t order, void* accountingWrapper)
+    : m_originalFunction(originalFunction), m_newFunction(newFunction), m_order(order), m_accountingWrapper(accountingWrapper)
 {
     m_trampoline = nullptr;
     m_funchook = nullptr;
+    m_accounting = accountingWrapper && IsAccountingEnabled() ? GetAccounting(originalFunction, newFunction) : nullptr;
 
     auto &funcHooks = s_hooks[originalFunction];
     if (order == Order::Final && !funcHooks.empty() && funcHooks[0]->m_order == Order::Final)
@@ -80,9 +222,70 @@ void FunctionHook::UpdateHookList(void* originalFunction, const std::vector<Func
         hookList[i]->m_trampoline = originalFunction;
         hookList[i]->m_funchook = funchook_create();
         ASSERT(hookList[i]->m_funchook);
-        ASSERT(!funchook_prepare(static_cast<funchook_t*>(hookList[i]->m_funchook), &hookList[i]->m_trampoline, hookList[i]->m_newFunction));
+        if (hookList[i]->m_accounting)
+        {
+            funchook_params_t params = {};
+            params.hook_func = hookList[i]->m_accountingWrapper;
+            params.prehook = &AccountingPrehook;
+            params.user_data = hookList[i]->m_accounting;
+            ASSERT(!funchook_prepare_with_params(static_cast<funchook_t*>(hookList[i]->m_funchook), &hookList[i]->m_trampoline, &params));
+        }
+        else
+        {
+            ASSERT(!funchook_prepare(static_cast<funchook_t*>(hookList[i]->m_funchook), &hookList[i]->m_trampoline, hookList[i]->m_newFunction));
+        }
         ASSERT(!funchook_install(static_cast<funchook_t*>(hookList[i]->m_funchook), 0));
     }
 }
 
+static constexpr size_t BENCHMARK_MAX_DEPTH = 16;
+static volatile int32_t s_BenchmarkSink;
+static std::array<Hook, BENCHMARK_MAX_DEPTH> s_BenchmarkHooks;
+
+__attribute__((noinline)) static int32_t BenchmarkTarget(int32_t value)
+{
+    s_BenchmarkSink = value;
+    return value + s_BenchmarkSink;
+}
+
+template <size_t Depth>
+static int32_t BenchmarkHook(int32_t value)
+{
+    return s_BenchmarkHooks[Depth]->CallOriginal<int32_t>(value);
+}
+
+using BenchmarkFunction = int32_t(*)(int32_t);
+
+template <size_t... Depths>
+static constexpr std::array<BenchmarkFunction, sizeof...(Depths)> BenchmarkHooks(std::index_sequence<Depths...>)
+{
+    return {{ &BenchmarkHook<Depths>... }};
+}
+
+std::vector<double> BenchmarkChain(uint32_t maxDepth, uint32_t calls)
+{
+    static constexpr auto hookFunctions = BenchmarkHooks(std::make_index_sequence<BENCHMARK_MAX_DEPTH>());
+    // Called through a volatile pointer so the calls can't be inlined past the hooks.
+    volatile BenchmarkFunction target = &BenchmarkTarget;
+
+    maxDepth = std::min<uint32_t>(maxDepth, BENCHMARK_MAX_DEPTH);
+    calls = std::max(calls, 1u);
+
+    std::vector<double> results;
+    for (uint32_t depth = 0; depth <= maxDepth; depth++)
+    {
+        if (depth > 0)
+            s_BenchmarkHooks[depth - 1] = HookFunction(&BenchmarkTarget, hookFunctions[depth - 1]);
+
+        const auto start = Now();
+        for (uint32_t i = 0; i < calls; i++)
+            target(i);
+        results.push_back((double)(Now() - start) / calls);
+    }
+
+    for (auto& hook : s_BenchmarkHooks)
+        hook.reset();
+    return results;
+}
+
 };
@@ -2,7 +2,18 @@
 #include "API/Globals.hpp"
 #include "API/CExoBase.hpp"
 
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
 #include <unordered_map>
 
 #include "External/rang/rang.hpp"
@@ -16,6 +27,7 @@ static bool s_PrintSource;
 static bool s_ColorOutput;
 static bool s_ForceColor;
 static std::string s_LogFile;
+static bool s_JsonOutput;
 
 void SetPrintTimestamp(bool value)
 {
@@ -72,77 +84,763 @@ void SetLogFile(const std::string& logfilepath)
     s_LogFile = logfilepath;
 }
 
-void InternalTrace(Channel::Enum channel, Channel::Enum allowedChannel, const char* message)
+void SetJsonOutput(bool value)
 {
-    if (channel > allowedChannel)
+    s_JsonOutput = value;
+}
+bool GetJsonOutput()
+{
+    return s_JsonOutput;
+}
+
+// A log message as handed from the logging thread to the writer. Messages that don't fit inline are
+// moved to the heap, which only happens for the occasional large dump.
+struct Record
+{
+    static constexpr size_t INLINE_MESSAGE_SIZE = 384;
+
+    std::time_t time;
+    Channel::Enum channel;
+    int32_t line;
+    uint32_t length;
+    char plugin[32];
+    char file[48];
+    char *heapMessage;
+    char inlineMessage[INLINE_MESSAGE_SIZE];
+
+    const char* Message() const { return heapMessage ? heapMessage : inlineMessage; }
+};
+
+template <size_t Size>
+static void CopyTruncated(char (&dest)[Size], const char* str)
+{
+    const size_t length = strnlen(str, Size - 1);
+    std::memcpy(dest, str, length);
+    dest[length] = '\0';
+}
+
+static Record MakeRecord(Channel::Enum channel, const char* plugin, const char* file, int line, const char* message, size_t length)
+{
+    Record record;
+    record.time = std::time(nullptr);
+    record.channel = channel;
+    record.line = line;
+    record.length = length;
+
+    // Get filename without the full path.
+    const char* filename = std::strrchr(file, '/');
+    CopyTruncated(record.plugin, plugin);
+    CopyTruncated(record.file, filename ? filename + 1 : file);
+
+    char *dest = record.inlineMessage;
+    if (length >= Record::INLINE_MESSAGE_SIZE)
+        dest = new char[length + 1];
+    record.heapMessage = dest == record.inlineMessage ? nullptr : dest;
+    std::memcpy(dest, message, length);
+    dest[length] = '\0';
+    return record;
+}
+
+static Record MakeRecord(Channel::Enum channel, const char* plugin, const char* file, int line, const std::string& message)
+{
+    return MakeRecord(channel, plugin, file, line, message.c_str(), message.size());
+}
+
+// Length of the well formed UTF-8 sequence at the start of str, or 0 if it is truncated, overlong, a
+// surrogate or past U+10FFFF.
+static size_t Utf8SequenceLength(const unsigned char* str, size_t length)
+{
+    static constexpr uint32_t MIN_CODEPOINT[] = { 0, 0, 0x80, 0x800, 0x10000 };
+
+    size_t size;
+    uint32_t codepoint;
+    if (str[0] < 0x80)
+        return 1;
+    else if ((str[0] & 0xE0) == 0xC0) { size = 2; codepoint = str[0] & 0x1F; }
+    else if ((str[0] & 0xF0) == 0xE0) { size = 3; codepoint = str[0] & 0x0F; }
+    else if ((str[0] & 0xF8) == 0xF0) { size = 4; codepoint = str[0] & 0x07; }
+    else
+        return 0;
+
+    if (size > length)
+        return 0;
+    for (size_t i = 1; i < size; i++)
     {
-        // No need to do anything. Our log level is lower.
-        return;
+        if ((str[i] & 0xC0) != 0x80)
+            return 0;
+        codepoint = (codepoint << 6) | (str[i] & 0x3F);
     }
+    if (codepoint < MIN_CODEPOINT[size] || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+        return 0;
+    return size;
+}
 
-    INSTR_MESSAGE(message, strlen(message));
+// Messages are whatever the game or a script handed us, not necessarily UTF-8. Bytes that don't form a
+// valid sequence are replaced so every line stays valid JSON.
+template <typename Output>
+static void AppendJsonString(Output& out, const char* str, size_t length)
+{
+    out.push_back('"');
+    for (size_t i = 0; i < length; i++)
+    {
+        const char c = str[i];
+        switch (c)
+        {
+            case '"':  out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\n': out.append("\\n");  break;
+            case '\r': out.append("\\r");  break;
+            case '\t': out.append("\\t");  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+                    out.append("\\u00");
+                    out.push_back(HEX_DIGITS[c >> 4]);
+                    out.push_back(HEX_DIGITS[c & 0xF]);
+                }
+                else if (static_cast<unsigned char>(c) < 0x80)
+                {
+                    out.push_back(c);
+                }
+                else if (auto size = Utf8SequenceLength(reinterpret_cast<const unsigned char*>(str + i), length - i))
+                {
+                    out.append(str + i, size);
+                    i += size - 1;
+                }
+                else
+                {
+                    out.append("\\ufffd");
+                }
+        }
+    }
+    out.push_back('"');
+}
+
+template <typename Output>
+static void AppendNumber(Output& out, int64_t value, int width = 0)
+{
+    char digits[20];
+    int count = 0;
+    uint64_t magnitude = value < 0 ? -static_cast<uint64_t>(value) : value;
+    do
+    {
+        digits[count++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude);
+
+    if (value < 0)
+        out.push_back('-');
+    for (int i = count; i < width; i++)
+        out.push_back('0');
+    while (count)
+        out.push_back(digits[--count]);
+}
 
-    switch (channel)
+struct Timestamp
+{
+    int year, month, day, hour, minute, second;
+};
+
+// Offset of local time from UTC as of the last record the writer formatted, so the crash handler can
+// convert times without localtime_r().
+static std::atomic<long> s_UtcOffset;
+
+static Timestamp LocalTimestamp(std::time_t time)
+{
+    tm timeinfo;
+    localtime_r(&time, &timeinfo);
+    s_UtcOffset.store(timeinfo.tm_gmtoff, std::memory_order_relaxed);
+    return { 1900 + timeinfo.tm_year, 1 + timeinfo.tm_mon, timeinfo.tm_mday, timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec };
+}
+
+// LocalTimestamp() from plain arithmetic (H. Hinnant's civil_from_days), safe to call in a signal handler.
+static Timestamp SignalSafeTimestamp(std::time_t time)
+{
+    int64_t seconds = time + s_UtcOffset.load(std::memory_order_relaxed);
+    int64_t days = seconds / 86400;
+    seconds %= 86400;
+    if (seconds < 0)
     {
-        case Channel::SEV_DEBUG:   std::cout << rang::fg::cyan << rang::style::dim;  break;
-        case Channel::SEV_INFO:    std::cout << rang::fg::gray;                      break;
-        case Channel::SEV_NOTICE:  /*default*/                                       break;
-        case Channel::SEV_WARNING: std::cout << rang::fg::yellow;                    break;
-        case Channel::SEV_ERROR:   std::cout << rang::fg::red;                       break;
-        case Channel::SEV_FATAL:   std::cout << rang::fg::red << rang::style::bold;  break;
+        seconds += 86400;
+        days--;
     }
-    std::cout << message << rang::style::reset << rang::fg::reset  << std::endl;
 
-    // Also write to a file if configured
-    WriteToLogFile(message);
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const int64_t dayOfEra = days - era * 146097;
+    const int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const int64_t monthIndex = (5 * dayOfYear + 2) / 153;
 
-    if (channel == Channel::SEV_FATAL)
+    Timestamp timestamp;
+    timestamp.day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    timestamp.month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    timestamp.year = yearOfEra + era * 400 + (timestamp.month <= 2);
+    timestamp.hour = seconds / 3600;
+    timestamp.minute = seconds / 60 % 60;
+    timestamp.second = seconds % 60;
+    return timestamp;
+}
+
+// Formats a record without allocating beyond what the output does, or locking, so the writer thread and
+// the crash handler produce the same lines.
+template <typename Output>
+static void AppendRecord(Output& out, const Record& record, const Timestamp& time)
+{
+    static constexpr const char * SEVERITY_NAMES[] = { "", "", "F", "E", "W", "N", "I", "D" };
+
+    if (s_JsonOutput)
     {
-        ASSERT_FAIL();
-        std::abort();
+        out.append("{\"time\":\"");
+        AppendNumber(out, time.year, 4);
+        out.push_back('-');
+        AppendNumber(out, time.month, 2);
+        out.push_back('-');
+        AppendNumber(out, time.day, 2);
+        out.push_back('T');
+        AppendNumber(out, time.hour, 2);
+        out.push_back(':');
+        AppendNumber(out, time.minute, 2);
+        out.push_back(':');
+        AppendNumber(out, time.second, 2);
+        out.append("\",\"severity\":\"");
+        out.append(SEVERITY_NAMES[record.channel]);
+        out.append("\",\"plugin\":");
+        AppendJsonString(out, record.plugin, std::strlen(record.plugin));
+        out.append(",\"file\":");
+        AppendJsonString(out, record.file, std::strlen(record.file));
+        out.append(",\"line\":");
+        AppendNumber(out, record.line);
+        out.append(",\"message\":");
+        AppendJsonString(out, record.Message(), record.length);
+        out.push_back('}');
+        return;
     }
+
+    out.append(SEVERITY_NAMES[static_cast<size_t>(record.channel)]);
+    out.push_back(' ');
+    if (s_PrintTimestamp)
+    {
+        out.push_back('[');
+        if (s_PrintDate)
+        {
+            AppendNumber(out, time.year, 4);
+            out.push_back('-');
+            AppendNumber(out, time.month, 2);
+            out.push_back('-');
+            AppendNumber(out, time.day, 2);
+            out.push_back(' ');
+        }
+        AppendNumber(out, time.hour, 2);
+        out.push_back(':');
+        AppendNumber(out, time.minute, 2);
+        out.push_back(':');
+        AppendNumber(out, time.second, 2);
+        out.append("] ");
+    }
+    if (s_PrintPlugin)
+    {
+        out.push_back('[');
+        out.append(record.plugin);
+        out.append("] ");
+    }
+    if (s_PrintSource)
+    {
+        out.push_back('[');
+        out.append(record.file);
+        out.push_back(':');
+        AppendNumber(out, record.line);
+        out.append("] ");
+    }
+    out.append(record.Message(), record.length);
 }
 
-void WriteToLogFile(const char* message)
+static std::string FormatRecord(const Record& record)
+{
+    std::string out;
+    out.reserve(128 + record.length);
+    AppendRecord(out, record, LocalTimestamp(record.time));
+    return out;
+}
+
+static std::mutex s_LogFileLock;
+static FILE* s_LogFileHandle;
+// For the crash handler, which can't use stdio.
+static std::atomic<int> s_LogFileDescriptor{-1};
+
+static void WriteLineToLogFile(const char* message, bool flush)
 {
-    static FILE* logFile;
+    std::lock_guard<std::mutex> lock(s_LogFileLock);
 
-    if (!logFile && s_LogFile != "")
+    if (!s_LogFileHandle && s_LogFile != "")
     {
-        logFile = std::fopen(s_LogFile.c_str(), "a+");
-        if (logFile)
+        s_LogFileHandle = std::fopen(s_LogFile.c_str(), "a+");
+        if (s_LogFileHandle)
         {
-            std::fprintf(logFile,
+            s_LogFileDescriptor = fileno(s_LogFileHandle);
+            std::fprintf(s_LogFileHandle,
         "=====================================================================\n"
         "       NWNX secondary log file. This log file may be incomplete!     \n"
         " Please attach stdout output instead of this file to any bug reports.\n"
         "=====================================================================\n");
         }
     }
-    if (logFile)
+    if (s_LogFileHandle)
+    {
+        std::fprintf(s_LogFileHandle, "%s\n", message);
+        if (flush)
+            std::fflush(s_LogFileHandle);
+    }
+}
+
+static void FlushOutput()
+{
+    std::cout.flush();
+    std::lock_guard<std::mutex> lock(s_LogFileLock);
+    if (s_LogFileHandle)
+        std::fflush(s_LogFileHandle);
+}
+
+// Writes without flushing, the caller flushes once per batch.
+static void WriteRecord(const Record& record)
+{
+    auto line = FormatRecord(record);
+    if (record.heapMessage)
+        delete[] record.heapMessage;
+
+    if (!s_JsonOutput)
+    {
+        switch (record.channel)
+        {
+            case Channel::SEV_DEBUG:   std::cout << rang::fg::cyan << rang::style::dim;  break;
+            case Channel::SEV_INFO:    std::cout << rang::fg::gray;                      break;
+            case Channel::SEV_NOTICE:  /*default*/                                       break;
+            case Channel::SEV_WARNING: std::cout << rang::fg::yellow;                    break;
+            case Channel::SEV_ERROR:   std::cout << rang::fg::red;                       break;
+            case Channel::SEV_FATAL:   std::cout << rang::fg::red << rang::style::bold;  break;
+        }
+        std::cout << line << rang::style::reset << rang::fg::reset << '\n';
+    }
+    else
+    {
+        std::cout << line << '\n';
+    }
+
+    // Also write to a file if configured
+    WriteLineToLogFile(line.c_str(), false);
+}
+
+// Collects output in a fixed buffer and writes it straight to stdout and the log file, so the crash
+// handler can write records without allocating.
+struct SignalSafeWriter
+{
+    explicit SignalSafeWriter(int logFile) : m_LogFile(logFile) {}
+
+    void push_back(char c)
+    {
+        if (m_Size == sizeof(m_Buffer))
+            Flush();
+        m_Buffer[m_Size++] = c;
+    }
+    void append(const char* str, size_t length)
+    {
+        for (size_t i = 0; i < length; i++)
+            push_back(str[i]);
+    }
+    void append(const char* str)
+    {
+        append(str, std::strlen(str));
+    }
+
+    void Flush()
+    {
+        WriteAll(STDOUT_FILENO);
+        if (m_LogFile >= 0)
+            WriteAll(m_LogFile);
+        m_Size = 0;
+    }
+
+private:
+    void WriteAll(int fd)
+    {
+        for (size_t written = 0; written < m_Size;)
+        {
+            const auto result = ::write(fd, m_Buffer + written, m_Size - written);
+            if (result < 0 && errno == EINTR)
+                continue;
+            if (result <= 0)
+                return;
+            written += result;
+        }
+    }
+
+    const int m_LogFile;
+    size_t m_Size = 0;
+    char m_Buffer[1024];
+};
+
+// WriteRecord() without colors or stdio. The heap message is leaked, freeing it isn't safe here.
+static void WriteRecord(SignalSafeWriter& out, const Record& record)
+{
+    AppendRecord(out, record, SignalSafeTimestamp(record.time));
+    out.push_back('\n');
+}
+
+// Bounded multi-producer multi-consumer queue (D. Vyukov). Each cell's sequence number tells producers
+// and consumers whether the cell is free for the current lap, so neither side ever takes a lock.
+struct RecordQueue
+{
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        Record record;
+    };
+
+    explicit RecordQueue(size_t size) : m_Cells(new Cell[size]), m_Mask(size - 1)
+    {
+        for (size_t i = 0; i < size; i++)
+            m_Cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    bool TryPush(const Record& record)
+    {
+        Cell *cell;
+        size_t pos = m_EnqueuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &m_Cells[pos & m_Mask];
+            const auto diff = (intptr_t)cell->sequence.load(std::memory_order_acquire) - (intptr_t)pos;
+            if (diff == 0)
+            {
+                if (m_EnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = m_EnqueuePos.load(std::memory_order_relaxed);
+        }
+        cell->record = record;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPop(Record& record)
+    {
+        Cell *cell;
+        size_t pos = m_DequeuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &m_Cells[pos & m_Mask];
+            const auto diff = (intptr_t)cell->sequence.load(std::memory_order_acquire) - (intptr_t)(pos + 1);
+            if (diff == 0)
+            {
+                if (m_DequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = m_DequeuePos.load(std::memory_order_relaxed);
+        }
+        record = cell->record;
+        cell->sequence.store(pos + m_Mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Empty() const
+    {
+        return m_DequeuePos.load(std::memory_order_acquire) == m_EnqueuePos.load(std::memory_order_acquire);
+    }
+
+private:
+    std::unique_ptr<Cell[]> m_Cells;
+    const size_t m_Mask;
+    alignas(64) std::atomic<size_t> m_EnqueuePos{0};
+    alignas(64) std::atomic<size_t> m_DequeuePos{0};
+};
+
+static std::unique_ptr<RecordQueue> s_Queue;
+static std::atomic<bool> s_AsyncEnabled;
+static std::atomic<uint32_t> s_ActiveProducers;
+static size_t s_QueueSize;
+static OverflowPolicy s_OverflowPolicy;
+static bool s_WriterSuspended;
+static std::atomic<uint64_t> s_DroppedRecords;
+static std::timed_mutex s_WriterLock;
+static std::thread s_WriterThread;
+static std::atomic<bool> s_WriterStop;
+static std::atomic<bool> s_WriterIdle;
+static std::mutex s_WriterSignalLock;
+static std::condition_variable s_WriterSignal;
+
+// Turns the number of dropped messages into a warning, if there were any.
+static bool TakeDroppedRecord(Record& record)
+{
+    const auto dropped = s_DroppedRecords.exchange(0);
+    if (!dropped)
+        return false;
+
+    // Built by hand, the crash handler calls this too.
+    struct
+    {
+        void push_back(char c) { data[size++] = c; }
+        void append(const char* str) { while (*str) push_back(*str++); }
+        char data[96];
+        size_t size = 0;
+    } message;
+    AppendNumber(message, dropped);
+    message.append(" log messages were dropped because the log queue was full.");
+    record = MakeRecord(Channel::SEV_WARNING, "NWNXLib", __FILE__, __LINE__, message.data, message.size);
+    return true;
+}
+
+// Pops and writes everything queued. Returns the number of records written.
+static size_t DrainQueue()
+{
+    size_t written = 0;
+    Record record;
+    while (s_Queue->TryPop(record))
+    {
+        WriteRecord(record);
+        written++;
+    }
+
+    if (TakeDroppedRecord(record))
     {
-        std::fprintf(logFile, "%s\n", message);
-        std::fflush(logFile);
+        WriteRecord(record);
+        written++;
     }
+
+    if (written)
+        FlushOutput();
+    return written;
 }
 
-// Unfortunately this needs to be backed by an std::string rather than a const char* because the C++ standard library
-// doesn't provide a hashing function for a const char* and I'm too lazy to write or copy/paste one.
-// Small perf hit when logging.
-static std::unordered_map<std::string, Channel::Enum> s_LogLevelMap;
+static void WriterThread()
+{
+    while (!s_WriterStop)
+    {
+        {
+            std::lock_guard<std::timed_mutex> lock(s_WriterLock);
+            DrainQueue();
+        }
+
+        s_WriterIdle = true;
+        std::unique_lock<std::mutex> signalLock(s_WriterSignalLock);
+        s_WriterSignal.wait_for(signalLock, std::chrono::milliseconds(50),
+            []{ return s_WriterStop || !s_Queue->Empty(); });
+        s_WriterIdle = false;
+    }
+}
+
+void StartAsyncWriter(size_t queueSize, OverflowPolicy policy)
+{
+    if (s_AsyncEnabled)
+        return;
+
+    size_t size = 64;
+    while (size < queueSize)
+        size <<= 1;
+
+    // Threads logging synchronously may still be draining the old queue, so keep it if it's the right size.
+    if (!s_Queue || s_QueueSize != size)
+        s_Queue = std::make_unique<RecordQueue>(size);
+    s_QueueSize = size;
+    s_OverflowPolicy = policy;
+    s_WriterStop = false;
+    s_WriterThread = std::thread(WriterThread);
+    s_AsyncEnabled = true;
+
+    // Destroying a joinable std::thread terminates the process, so stop the writer before static destructors run
+    // if the server exits without shutting NWNX down.
+    static const bool s_StopAtExit = std::atexit(StopAsyncWriter) == 0;
+    (void)s_StopAtExit;
+}
+
+void StopAsyncWriter()
+{
+    if (!s_AsyncEnabled)
+        return;
+
+    s_AsyncEnabled = false;
+    // Producers that saw the writer running are about to push, wait for them so the final drain gets everything.
+    while (s_ActiveProducers)
+        std::this_thread::yield();
+
+    s_WriterStop = true;
+    s_WriterSignal.notify_one();
+    s_WriterThread.join();
+
+    std::lock_guard<std::timed_mutex> lock(s_WriterLock);
+    DrainQueue();
+}
+
+void SuspendAsyncWriter()
+{
+    s_WriterSuspended = s_AsyncEnabled;
+    StopAsyncWriter();
+}
+
+void ResumeAsyncWriter()
+{
+    if (!s_WriterSuspended)
+        return;
+
+    s_WriterSuspended = false;
+    StartAsyncWriter(s_QueueSize, s_OverflowPolicy);
+}
+
+void Flush()
+{
+    if (!s_Queue)
+        return;
+
+    // The writer thread may be the one that crashed while holding the lock, so don't wait on it forever.
+    const bool locked = s_WriterLock.try_lock_for(std::chrono::milliseconds(250));
+    DrainQueue();
+    if (locked)
+        s_WriterLock.unlock();
+}
+
+void FlushFromSignalHandler()
+{
+    if (!s_Queue)
+        return;
+
+    // Nothing but write(2) from here, no locks or stdio. The queue is lock free, so this can pop alongside a
+    // writer thread that is still running. Lines the writer already formatted but hadn't flushed stay in the
+    // stdio buffers, it flushes after every batch so that is at most one batch.
+    SignalSafeWriter out(s_LogFileDescriptor.load());
+    Record record;
+    while (s_Queue->TryPop(record))
+        WriteRecord(out, record);
+    if (TakeDroppedRecord(record))
+        WriteRecord(out, record);
+    out.Flush();
+}
+
+void InternalTrace(Channel::Enum channel, const char* plugin, const char* file, int line, const std::string& message)
+{
+    INSTR_MESSAGE(message.c_str(), message.size());
+
+    auto record = MakeRecord(channel, plugin, file, line, message);
+
+    if (channel != Channel::SEV_FATAL)
+    {
+        // Counted before checking s_AsyncEnabled so StopAsyncWriter() can wait for this push.
+        s_ActiveProducers++;
+        if (s_AsyncEnabled)
+        {
+            while (!s_Queue->TryPush(record))
+            {
+                if (s_OverflowPolicy == OverflowPolicy::Drop)
+                {
+                    if (record.heapMessage)
+                        delete[] record.heapMessage;
+                    s_DroppedRecords++;
+                    s_ActiveProducers--;
+                    return;
+                }
+                s_WriterSignal.notify_one();
+                std::this_thread::yield();
+            }
+
+            if (s_WriterIdle)
+                s_WriterSignal.notify_one();
+            s_ActiveProducers--;
+            return;
+        }
+        s_ActiveProducers--;
+    }
+
+    {
+        // Keep ordering with anything still queued.
+        Flush();
+        std::lock_guard<std::timed_mutex> lock(s_WriterLock);
+        WriteRecord(record);
+        FlushOutput();
+    }
+
+    if (channel == Channel::SEV_FATAL)
+    {
+        ASSERT_FAIL();
+        std::abort();
+    }
+}
+
+void WriteToLogFile(const char* message)
+{
+    WriteLineToLogFile(message, true);
+}
+
+// Log levels are checked on every log call, possibly from several threads. Each plugin name gets a fixed
+// slot the first time it is seen, which call sites cache, and the level itself lives in an atomic so
+// reading it takes no lock.
+static constexpr size_t MAX_LOG_SOURCES = 256;
+static std::atomic<uint8_t> s_LogLevels[MAX_LOG_SOURCES];
+static std::shared_mutex s_LogSourceLock;
+static std::unordered_map<std::string_view, uint32_t> s_LogSourceIds;
+static std::deque<std::string> s_LogSourceNames;
+static std::atomic<bool> s_LoggingDisabled;
+
+uint32_t GetLogSource(const char* plugin)
+{
+    // A forked child can't take the lock, the thread holding it wasn't copied.
+    if (s_LoggingDisabled)
+        return MAX_LOG_SOURCES;
+
+    {
+        std::shared_lock<std::shared_mutex> lock(s_LogSourceLock);
+        auto entry = s_LogSourceIds.find(plugin);
+        if (entry != std::end(s_LogSourceIds))
+            return entry->second;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(s_LogSourceLock);
+    auto entry = s_LogSourceIds.find(plugin);
+    if (entry != std::end(s_LogSourceIds))
+        return entry->second;
+
+    // Out of slots, the source keeps the default level.
+    if (s_LogSourceNames.size() >= MAX_LOG_SOURCES)
+        return MAX_LOG_SOURCES;
+
+    const uint32_t source = s_LogSourceNames.size();
+    s_LogLevels[source].store(Channel::SEV_NOTICE, std::memory_order_relaxed);
+    s_LogSourceIds.emplace(s_LogSourceNames.emplace_back(plugin), source);
+    return source;
+}
+
+Channel::Enum GetLogLevel(uint32_t source)
+{
+    if (source >= MAX_LOG_SOURCES)
+        return s_LoggingDisabled ? static_cast<Channel::Enum>(0) : Channel::SEV_NOTICE;
+    return static_cast<Channel::Enum>(s_LogLevels[source].load(std::memory_order_relaxed));
+}
 
 Channel::Enum GetLogLevel(const char* plugin)
 {
-    // TODO: Is this thread safe? I think so if we're just looking up but I don't know.
-    auto entry = s_LogLevelMap.find(plugin);
-    return entry == std::end(s_LogLevelMap) ? Channel::SEV_NOTICE : entry->second;
+    return GetLogLevel(GetLogSource(plugin));
 }
 
-void SetLogLevel(const char* plugin, Channel::Enum logLevel)
+void DisableLogging()
 {
-    s_LogLevelMap[plugin] = logLevel;
+    s_LoggingDisabled = true;
+    for (auto& level : s_LogLevels)
+        level.store(0, std::memory_order_relaxed);
 }
 
+void SetLogLevel(const char* plugin, Channel::Enum logLevel)
+{
+    if (s_LoggingDisabled)
+        return;
+
+    const auto source = GetLogSource(plugin);
+    if (source < MAX_LOG_SOURCES)
+        s_LogLevels[source].store(logLevel, std::memory_order_relaxed);
+}
 }
 
 #include "API/API/CExoString.hpp"
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "External/tinyformat/tinyformat.hpp"
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <sstream>
@@ -8,8 +9,11 @@
 
 namespace NWNXLib::Log {
 
+// Each call site looks its plugin's log source up once and keeps it in a function-local static.
 #define LOG_IMPL(sev, format, ...) \
-    ::NWNXLib::Log::Trace(::NWNXLib::Log::Channel::sev, PLUGIN_NAME, __FILE__, __LINE__, (format), ##__VA_ARGS__)
+    ::NWNXLib::Log::Trace(::NWNXLib::Log::Channel::sev, \
+        [] { static const uint32_t s_logSource = ::NWNXLib::Log::GetLogSource(PLUGIN_NAME); return s_logSource; }(), \
+        PLUGIN_NAME, __FILE__, __LINE__, (format), ##__VA_ARGS__)
 
 struct Channel
 {
@@ -49,10 +53,16 @@ struct Channel
 };
 
 template <typename ... Args>
-void Trace(Channel::Enum channel, const char* plugin, const char* file, int line, const char* format, Args&& ... args);
+void Trace(Channel::Enum channel, uint32_t source, const char* plugin, const char* file, int line, const char* format, Args&& ... args);
 
+// Returns the slot holding the plugin's log level, creating it on first use.
+uint32_t GetLogSource(const char* plugin);
+Channel::Enum GetLogLevel(uint32_t source);
 Channel::Enum GetLogLevel(const char* plugin);
 void SetLogLevel(const char* plugin, Channel::Enum logLevel);
+// Drops every message from now on, without taking any locks. For forked children, which only have a copy
+// of the locks the other threads held.
+void DisableLogging();
 void SetPrintTimestamp(bool value);
 bool GetPrintTimestamp();
 void SetPrintDate(bool value);
@@ -66,14 +76,36 @@ bool GetColorOutput();
 void SetForceColor(bool value);
 bool GetForceColor();
 void SetLogFile(const std::string& logfile = "");
+void SetJsonOutput(bool value);
+bool GetJsonOutput();
 
-void InternalTrace(Channel::Enum channel, Channel::Enum allowedChannel, const char* message);
+// What a producer does when the async log queue is full.
+enum class OverflowPolicy
+{
+    Block, // Wait for the writer thread to make room.
+    Drop,  // Discard the message and count it; the count is logged once the queue drains.
+};
+
+// Moves formatting and writing of log messages to a background thread. Until this is called, and after
+// StopAsyncWriter(), messages are written synchronously by the thread that logs them.
+void StartAsyncWriter(size_t queueSize, OverflowPolicy policy);
+void StopAsyncWriter();
+// Stops the writer thread and writes out the queue, so fork() doesn't copy its locks mid-use.
+// ResumeAsyncWriter() starts it again if it was running.
+void SuspendAsyncWriter();
+void ResumeAsyncWriter();
+// Writes out everything still queued on the calling thread.
+void Flush();
+// Like Flush(), but async-signal-safe: no allocations, locks or stdio, only write(2). For the crash handler.
+void FlushFromSignalHandler();
+
+void InternalTrace(Channel::Enum channel, const char* plugin, const char* file, int line, const std::string& message);
 void WriteToLogFile(const char* message);
 
 template <typename ... Args>
-void Trace(Channel::Enum channel, const char* plugin, const char* file, int line, const char* format, Args&& ... args)
+void Trace(Channel::Enum channel, uint32_t source, const char* plugin, const char* file, int line, const char* format, Args&& ... args)
 {
-    Channel::Enum allowedChannel = GetLogLevel(plugin);
+    Channel::Enum allowedChannel = GetLogLevel(source);
 
     if (channel > allowedChannel)
     {
@@ -81,52 +113,27 @@ void Trace(Channel::Enum channel, const char* plugin, const char* file, int line
         return;
     }
 
-    static constexpr const char * SEVERITY_NAMES[] = { "", "", "F", "E", "W", "N", "I", "D" };
-
-    std::ostringstream formatted_message;
+    // Only the message itself is formatted here, while the arguments are alive. Everything else about the
+    // line is left to the writer.
+    thread_local std::ostringstream formatted_message;
+    formatted_message.str("");
+    formatted_message.clear();
     tfm::format(formatted_message, format, std::forward<Args>(args)...);
+    const auto message = formatted_message.str();
 
-    MessageBus::Broadcast("NWNX_CORE_LOG_MESSAGE", {
-        std::to_string((int) channel),
-        plugin,
-        file,
-        std::to_string(line),
-        formatted_message.str()
-    });
-
-    // Get filename without the full path.
-    const char* filename = file;
-    const char* filenameTemp = filename;
-    while ((filenameTemp = std::strstr(filename, "/")))
-    {
-        filename = filenameTemp + 1;
-    }
-
-    std::ostringstream stream;
-    stream << SEVERITY_NAMES[static_cast<size_t>(channel)] << " ";
-    if (GetPrintTimestamp())
-    {
-        time_t now = std::time(nullptr);
-        tm* timeinfo = std::localtime(&now);
-
-        if (GetPrintDate())
-            tfm::format(stream, "[%04d-%02d-%02d %02d:%02d:%02d] ", 1900 + timeinfo->tm_year,  1 + timeinfo->tm_mon,
-                    timeinfo->tm_mday, timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec);
-        else
-            tfm::format(stream, "[%02d:%02d:%02d] ", timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec);
-    }
-    if (GetPrintPlugin())
+    static const std::string s_messageTag = "NWNX_CORE_LOG_MESSAGE";
+    if (MessageBus::HasSubscribers(s_messageTag))
     {
-        tfm::format(stream, "[%s] ", plugin);
+        MessageBus::Broadcast(s_messageTag, {
+            std::to_string((int) channel),
+            plugin,
+            file,
+            std::to_string(line),
+            message
+        });
     }
-    if (GetPrintSource())
-    {
-        tfm::format(stream, "[%s:%d] ", filename, line);
-    }
-
-    stream << formatted_message.str();
 
-    InternalTrace(channel, allowedChannel, stream.str().c_str());
+    InternalTrace(channel, plugin, file, line, message);
 }
 
 }
@@ -36,6 +36,12 @@ void Unsubscribe(const uint32_t id)
     throw std::runtime_error("Tried to unsubscribe with an ID that wasn't present.");
 }
 
+bool HasSubscribers(const std::string& tag)
+{
+    auto bucket = s_messageMap.find(tag);
+    return bucket != std::end(s_messageMap) && !bucket->second.empty();
+}
+
 void Broadcast(const std::string& tag, const Message& message)
 {
     auto bucket = s_messageMap.find(tag);
@@ -8,9 +8,12 @@
 #include "API/CNWSModule.hpp"
 #include "API/CNWSPlayerTURD.hpp"
 
-#include <regex>
+#include <cstring>
+#include <deque>
 #include <unordered_map>
 #include <sstream>
+#include <string_view>
+#include <variant>
 
 extern "C" void _ZN10CNWSObjectD1Ev(CNWSObject*);
 extern "C" void _ZN8CNWSAreaD1Ev(CNWSArea*);
@@ -19,52 +22,184 @@ using namespace NWNXLib;
 namespace NWNXLib::POS
 {
 static char GffFieldName[] = "NWNX_POS";
+static char GffBinaryFieldName[] = "NWNX_POS_BIN";
+static char GffBinarySizeFieldName[] = "NWNX_POS_BINSZ";
 
-class ObjectStorage
+// All POS keys are interned in a single pool shared by every object, so an object's table only holds
+// a key id and a lookup for a key no object has ever set is a single hash miss.
+class KeyPool
 {
-    // TODO maybe pack it up into a a single map?
 public:
-    using IntMap     = std::unordered_map<std::string, std::pair<int, bool>>;
-    using FloatMap   = std::unordered_map<std::string, std::pair<float, bool>>;
-    using StringMap  = std::unordered_map<std::string, std::pair<std::string, bool>>;
-    using PointerMap = std::unordered_map<std::string, std::pair<void*, CleanupFunc>>;
+    static constexpr uint32_t INVALID = ~0u;
 
-    IntMap& GetIntMap()
+    uint32_t Find(std::string_view name) const
+    {
+        auto it = m_Ids.find(name);
+        return it != m_Ids.end() ? it->second : INVALID;
+    }
+    uint32_t Acquire(std::string_view name)
     {
-        if (!m_IntMap)
-            m_IntMap = std::make_unique<IntMap>();
-        return *m_IntMap;
+        auto it = m_Ids.find(name);
+        if (it != m_Ids.end())
+        {
+            m_Keys[it->second].second++;
+            return it->second;
+        }
+
+        uint32_t id;
+        if (!m_Free.empty())
+        {
+            id = m_Free.back();
+            m_Free.pop_back();
+        }
+        else
+        {
+            id = m_Keys.size();
+            m_Keys.emplace_back();
+        }
+        m_Keys[id] = std::make_pair(std::string(name), 1u);
+        m_Ids.emplace(m_Keys[id].first, id);
+        return id;
     }
-    FloatMap& GetFloatMap()
+    void AddRef(uint32_t id)
     {
-        if (!m_FloatMap)
-            m_FloatMap = std::make_unique<FloatMap>();
-        return *m_FloatMap;
+        m_Keys[id].second++;
     }
-    StringMap& GetStringMap()
+    void Release(uint32_t id)
     {
-        if (!m_StringMap)
-            m_StringMap = std::make_unique<StringMap>();
-        return *m_StringMap;
+        if (--m_Keys[id].second == 0)
+        {
+            m_Ids.erase(m_Keys[id].first);
+            m_Keys[id].first.clear();
+            m_Free.push_back(id);
+        }
     }
-    PointerMap& GetPointerMap()
+    const std::string& Name(uint32_t id) const
     {
-        if (!m_PointerMap)
-            m_PointerMap = std::make_unique<PointerMap>();
-        return *m_PointerMap;
+        return m_Keys[id].first;
     }
 
+private:
+    // The map's views point into m_Keys, a deque so they stay put as keys are added.
+    std::unordered_map<std::string_view, uint32_t> m_Ids;
+    std::deque<std::pair<std::string, uint32_t>> m_Keys;
+    std::vector<uint32_t> m_Free;
+};
+static KeyPool s_KeyPool;
+
+// Extensions can be registered from static initializers in other translation units.
+static std::vector<ExtensionType>& ExtensionTypes()
+{
+    static std::vector<ExtensionType> s_ExtensionTypes;
+    return s_ExtensionTypes;
+}
+
+class ObjectStorage
+{
+public:
+    enum Type : uint8_t { Int = 0, Float = 1, String = 2, Pointer = 3 };
+    using PointerValue = std::pair<void*, CleanupFunc>;
+    using Value = std::variant<int32_t, float, std::string, PointerValue>;
+
+    struct Entry
+    {
+        uint32_t keyId = KeyPool::INVALID;
+        bool persist = false;
+        Value value;
+    };
+
     ObjectStorage(ObjectID owner) : m_oidOwner(owner), m_bCloned(false) {}
     ~ObjectStorage()
     {
-        if (m_PointerMap && !m_bCloned)
+        Clear(!m_bCloned);
+        ResetExtensions();
+    }
+
+    void *GetExtension(uint32_t extension, CGameObject *pOwner)
+    {
+        if (extension >= m_Extensions.size())
+            m_Extensions.resize(ExtensionTypes().size(), nullptr);
+
+        if (!m_Extensions[extension])
         {
-            for (auto it: *m_PointerMap)
-            {
-                auto ptr = it.second.first;
-                if (auto cleanup = it.second.second)
-                    cleanup(ptr);
-            }
+            const auto& type = ExtensionTypes()[extension];
+            m_Extensions[extension] = type.create();
+            if (type.init)
+                type.init(pOwner, m_Extensions[extension]);
+        }
+        return m_Extensions[extension];
+    }
+
+    void ResetExtension(uint32_t extension)
+    {
+        if (extension < m_Extensions.size() && m_Extensions[extension])
+        {
+            ExtensionTypes()[extension].destroy(m_Extensions[extension]);
+            m_Extensions[extension] = nullptr;
+        }
+    }
+
+    void ResetExtensions()
+    {
+        for (uint32_t extension = 0; extension < m_Extensions.size(); extension++)
+            ResetExtension(extension);
+    }
+
+    template <typename F>
+    void ForEachInt(F&& fn) const
+    {
+        for (const auto& entry : m_Slots)
+        {
+            if (entry.keyId == KeyPool::INVALID)
+                continue;
+            if (auto *pInt = std::get_if<int32_t>(&entry.value))
+                fn(s_KeyPool.Name(entry.keyId), *pInt);
+        }
+    }
+
+    template <typename T>
+    T* Find(uint32_t keyId)
+    {
+        auto *pEntry = FindEntry(keyId, TypeOf<T>());
+        return pEntry ? std::get_if<T>(&pEntry->value) : nullptr;
+    }
+
+    template <typename T>
+    void Set(std::string_view key, T&& value, bool persist)
+    {
+        using V = std::decay_t<T>;
+        const auto keyId = s_KeyPool.Acquire(key);
+        if (auto *pEntry = FindEntry(keyId, TypeOf<V>()))
+        {
+            s_KeyPool.Release(keyId);
+            pEntry->value = std::forward<T>(value);
+            pEntry->persist = persist;
+            return;
+        }
+        Insert(Entry{keyId, persist, Value(std::in_place_type<V>, std::forward<T>(value))});
+    }
+
+    // Removes every value stored under keyId regardless of its type, without cleanup.
+    void Remove(uint32_t keyId)
+    {
+        for (uint8_t type = Int; type <= Pointer; type++)
+        {
+            const auto slot = FindSlot(keyId, type);
+            if (slot != NOT_FOUND)
+                EraseSlot(slot);
+        }
+    }
+
+    template <typename Pred>
+    void RemoveIf(Pred&& pred)
+    {
+        for (size_t slot = 0; slot < m_Slots.size();)
+        {
+            auto& entry = m_Slots[slot];
+            if (entry.keyId != KeyPool::INVALID && pred(s_KeyPool.Name(entry.keyId)))
+                EraseSlot(slot); // Backward shift may move a new entry into this slot, so look at it again.
+            else
+                slot++;
         }
     }
 
@@ -75,97 +210,321 @@ public:
 
         other->m_bCloned = true;
 
-        if (other->m_IntMap)
-            m_IntMap = std::make_unique<IntMap>(*other->m_IntMap);
-        if (other->m_FloatMap)
-            m_FloatMap = std::make_unique<FloatMap>(*other->m_FloatMap);
-        if (other->m_StringMap)
-            m_StringMap = std::make_unique<StringMap>(*other->m_StringMap);
-        if (other->m_PointerMap)
-            m_PointerMap = std::make_unique<PointerMap>(*other->m_PointerMap);
+        Clear(false);
+        ResetExtensions();
+        m_Slots = other->m_Slots;
+        m_nCount = other->m_nCount;
+        for (const auto& entry : m_Slots)
+        {
+            if (entry.keyId != KeyPool::INVALID)
+                s_KeyPool.AddRef(entry.keyId);
+        }
     }
 
     std::string DumpToString()
     {
         std::stringstream ss;
         ss << "Object ID: " << std::hex << m_oidOwner << std::endl;
-        if (m_IntMap)
+        for (const auto& entry : m_Slots)
         {
-            for (auto it: *m_IntMap)
-                ss << it.first << " = " << std::dec << it.second.first << (it.second.second?" (persistant)":"") << std::endl;
+            if (entry.keyId == KeyPool::INVALID)
+                continue;
+
+            ss << s_KeyPool.Name(entry.keyId) << " = ";
+            std::visit([&](const auto& value)
+            {
+                using V = std::decay_t<decltype(value)>;
+                if constexpr (std::is_same_v<V, PointerValue>)
+                    ss << value.first;
+                else if constexpr (std::is_same_v<V, int32_t>)
+                    ss << std::dec << value;
+                else
+                    ss << value;
+            }, entry.value);
+            ss << (entry.persist?" (persistant)":"") << std::endl;
         }
-        if (m_FloatMap)
+        return ss.str();
+    }
+
+    // Binary format, all integers little endian:
+    //   "NXPS" u8:version u32:count { u8:type u32:keylen key (i32 | f32 | u32:len bytes) }*count
+    std::string Serialize(bool persistonly = true)
+    {
+        std::string out;
+        uint32_t count = 0;
+
+        auto Write = [&](const void *data, size_t size) { out.append(static_cast<const char*>(data), size); };
+        auto WriteU32 = [&](uint32_t value) { Write(&value, sizeof(value)); };
+
+        Write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+        out.push_back(BINARY_VERSION);
+        WriteU32(0);
+        for (const auto& entry : m_Slots)
         {
-            for (auto it: *m_FloatMap)
-                ss << it.first << " = " << it.second.first << (it.second.second?" (persistant)":"") << std::endl;
+            if (entry.keyId == KeyPool::INVALID || entry.value.index() == Pointer || (persistonly && !entry.persist))
+                continue;
+
+            const auto& key = s_KeyPool.Name(entry.keyId);
+            out.push_back(static_cast<char>(entry.value.index()));
+            WriteU32(key.size());
+            Write(key.data(), key.size());
+            if (auto *pInt = std::get_if<int32_t>(&entry.value))
+                Write(pInt, sizeof(*pInt));
+            else if (auto *pFloat = std::get_if<float>(&entry.value))
+                Write(pFloat, sizeof(*pFloat));
+            else if (auto *pString = std::get_if<std::string>(&entry.value))
+            {
+                WriteU32(pString->size());
+                Write(pString->data(), pString->size());
+            }
+            count++;
         }
-        if (m_StringMap)
+        std::memcpy(out.data() + sizeof(BINARY_MAGIC) + 1, &count, sizeof(count));
+
+        return count ? out : std::string();
+    }
+
+    // The text format read by versions before the binary one, still written so a downgrade keeps the data:
+    //   [INTMAP:count]<keylen>key = value;... [FLTMAP:count]... [STRMAP:count]<keylen>key = <len>value;...
+    std::string SerializeText(bool persistonly = true)
+    {
+        std::string out;
+        for (uint8_t type = Int; type <= String; type++)
         {
-            for (auto it: *m_StringMap)
-                ss << it.first << " = " << it.second.first << (it.second.second?" (persistant)":"") << std::endl;
+            static constexpr const char *SECTIONS[] = { "[INTMAP:", "[FLTMAP:", "[STRMAP:" };
+
+            uint32_t count = 0;
+            std::string section;
+            for (const auto& entry : m_Slots)
+            {
+                if (entry.keyId == KeyPool::INVALID || entry.value.index() != type || (persistonly && !entry.persist))
+                    continue;
+
+                const auto& key = s_KeyPool.Name(entry.keyId);
+                section.append("<").append(std::to_string(key.size())).append(">").append(key).append(" = ");
+                if (auto *pInt = std::get_if<int32_t>(&entry.value))
+                    section.append(std::to_string(*pInt));
+                else if (auto *pFloat = std::get_if<float>(&entry.value))
+                {
+                    // What the old writer's ostream produced.
+                    char buffer[32];
+                    std::snprintf(buffer, sizeof(buffer), "%g", *pFloat);
+                    section.append(buffer);
+                }
+                else if (auto *pString = std::get_if<std::string>(&entry.value))
+                    section.append("<").append(std::to_string(pString->size())).append(">").append(*pString);
+                section.push_back(';');
+                count++;
+            }
+            if (count)
+                out.append(SECTIONS[type]).append(std::to_string(count)).append("]").append(section);
         }
-        if (m_PointerMap)
+        return out;
+    }
+
+    void Deserialize(const char *serialized, size_t size, bool persist = true)
+    {
+        Clear(false);
+        ResetExtensions();
+
+        if (size >= sizeof(BINARY_MAGIC) && std::memcmp(serialized, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0)
+            DeserializeBinary(serialized, size, persist);
+        else
+            DeserializeText(serialized, persist);
+    }
+
+private:
+    static constexpr char BINARY_MAGIC[4] = {'N', 'X', 'P', 'S'};
+    static constexpr uint8_t BINARY_VERSION = 1;
+    static constexpr size_t NOT_FOUND = ~size_t(0);
+
+    template <typename T>
+    static constexpr uint8_t TypeOf()
+    {
+        if constexpr (std::is_same_v<T, int32_t>)     return Int;
+        else if constexpr (std::is_same_v<T, float>)  return Float;
+        else if constexpr (std::is_same_v<T, std::string>) return String;
+        else return Pointer;
+    }
+
+    // Key ids are small and sequential, so mix every bit into the low ones the mask keeps (MurmurHash3's
+    // 64 bit finalizer).
+    static size_t Hash(uint32_t keyId, uint8_t type)
+    {
+        uint64_t hash = (uint64_t(keyId) << 2) | type;
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    size_t FindSlot(uint32_t keyId, uint8_t type) const
+    {
+        if (m_Slots.empty() || keyId == KeyPool::INVALID)
+            return NOT_FOUND;
+
+        const size_t mask = m_Slots.size() - 1;
+        for (size_t slot = Hash(keyId, type) & mask;; slot = (slot + 1) & mask)
         {
-            for (auto it: *m_PointerMap)
-                ss << it.first << " = " << it.second.first << std::endl;
+            const auto& entry = m_Slots[slot];
+            if (entry.keyId == KeyPool::INVALID)
+                return NOT_FOUND;
+            if (entry.keyId == keyId && entry.value.index() == type)
+                return slot;
         }
-        return ss.str();
     }
 
-    std::string Serialize(bool persistonly = true)
+    Entry* FindEntry(uint32_t keyId, uint8_t type)
     {
-        std::stringstream ss;
-        if (m_IntMap)
+        const auto slot = FindSlot(keyId, type);
+        return slot != NOT_FOUND ? &m_Slots[slot] : nullptr;
+    }
+
+    void Insert(Entry&& entry)
+    {
+        if ((m_nCount + 1) * 4 > m_Slots.size() * 3)
+            Grow();
+
+        const size_t mask = m_Slots.size() - 1;
+        size_t slot = Hash(entry.keyId, entry.value.index()) & mask;
+        while (m_Slots[slot].keyId != KeyPool::INVALID)
+            slot = (slot + 1) & mask;
+        m_Slots[slot] = std::move(entry);
+        m_nCount++;
+    }
+
+    void Grow()
+    {
+        std::vector<Entry> old;
+        old.swap(m_Slots);
+        m_Slots.resize(old.empty() ? 8 : old.size() * 2);
+        m_nCount = 0;
+        for (auto& entry : old)
         {
-            int count = 0;
-            for (auto it: *m_IntMap)
-                count += (!persistonly || it.second.second) ? 1:0;
+            if (entry.keyId != KeyPool::INVALID)
+                Insert(std::move(entry));
+        }
+    }
 
-            if (count > 0)
+    // Linear probing with backward shift deletion, so the table never needs tombstones.
+    void EraseSlot(size_t slot)
+    {
+        s_KeyPool.Release(m_Slots[slot].keyId);
+
+        const size_t mask = m_Slots.size() - 1;
+        size_t hole = slot;
+        for (size_t next = (hole + 1) & mask; m_Slots[next].keyId != KeyPool::INVALID; next = (next + 1) & mask)
+        {
+            const size_t home = Hash(m_Slots[next].keyId, m_Slots[next].value.index()) & mask;
+            if (((next - home) & mask) >= ((next - hole) & mask))
             {
-                ss << "[INTMAP:" << count << "]";
-                for (auto it: *m_IntMap)
-                    if (!persistonly || it.second.second)
-                        ss << "<" << it.first.length() << ">" << it.first << " = " << std::dec << it.second.first << ";";
+                m_Slots[hole] = std::move(m_Slots[next]);
+                hole = next;
             }
         }
-        if (m_FloatMap)
+        m_Slots[hole] = Entry();
+        m_nCount--;
+    }
+
+    void Clear(bool bCleanup)
+    {
+        for (auto& entry : m_Slots)
+        {
+            if (entry.keyId == KeyPool::INVALID)
+                continue;
+
+            if (auto *pPointer = std::get_if<PointerValue>(&entry.value); bCleanup && pPointer && pPointer->second)
+                pPointer->second(pPointer->first);
+            s_KeyPool.Release(entry.keyId);
+        }
+        m_Slots.clear();
+        m_nCount = 0;
+    }
+
+    void DeserializeBinary(const char *serialized, size_t size, bool persist)
+    {
+        const char *s = serialized + sizeof(BINARY_MAGIC);
+        const char *end = serialized + size;
+
+        auto Read = [&](void *data, size_t len) -> bool
+        {
+            if (static_cast<size_t>(end - s) < len)
+                return false;
+            std::memcpy(data, s, len);
+            s += len;
+            return true;
+        };
+        auto ReadString = [&](std::string& str) -> bool
         {
-            int count = 0;
-            for (auto it: *m_FloatMap)
-                count += (!persistonly || it.second.second) ? 1:0;
+            uint32_t len;
+            if (!Read(&len, sizeof(len)) || static_cast<size_t>(end - s) < len)
+                return false;
+            str.assign(s, len);
+            s += len;
+            return true;
+        };
 
-            if (count > 0)
-            {
-                ss << "[FLTMAP:" << count << "]";
-                for (auto it: *m_FloatMap)
-                    if (!persistonly || it.second.second)
-                        ss << "<" << it.first.length() << ">" << it.first << " = " << it.second.first << ";";
-            }
+        uint8_t version;
+        uint32_t count;
+        if (!Read(&version, sizeof(version)) || !Read(&count, sizeof(count)))
+        {
+            LOG_ERROR("Serialized POS header truncated. Aborting.");
+            return;
         }
-        if (m_StringMap)
+        if (version != BINARY_VERSION)
         {
-            int count = 0;
-            for (auto it: *m_StringMap)
-                count += (!persistonly || it.second.second) ? 1:0;
+            LOG_ERROR("Serialized POS has unsupported version %u. Aborting.", version);
+            return;
+        }
 
-            if (count > 0)
+        std::string name;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            uint8_t type;
+            if (!Read(&type, sizeof(type)) || !ReadString(name))
             {
-                ss << "[STRMAP:" << count << "]";
-                for (auto it: *m_StringMap)
-                    if (!persistonly || it.second.second)
-                        ss << "<" << it.first.length() << ">" << it.first << " = " << "<" << it.second.first.length() << ">" << it.second.first << ";";
+                LOG_ERROR("Serialized POS truncated at entry %u of %u. Aborting.", i, count);
+                return;
+            }
+
+            bool bOk = false;
+            switch (type)
+            {
+                case Int:
+                {
+                    int32_t value;
+                    if ((bOk = Read(&value, sizeof(value))))
+                        Set(name, value, persist);
+                    break;
+                }
+                case Float:
+                {
+                    float value;
+                    if ((bOk = Read(&value, sizeof(value))))
+                        Set(name, value, persist);
+                    break;
+                }
+                case String:
+                {
+                    std::string value;
+                    if ((bOk = ReadString(value)))
+                        Set(name, std::move(value), persist);
+                    break;
+                }
+            }
+            if (!bOk)
+            {
+                LOG_ERROR("Serialized POS corrupted at entry %u ('%s') of %u. Aborting.", i, name, count);
+                return;
             }
         }
-        return ss.str();
     }
-    void Deserialize(const char *serialized, bool persist = true)
-    {
-        if (m_IntMap)     m_IntMap->clear();
-        if (m_FloatMap)   m_FloatMap->clear();
-        if (m_StringMap)  m_StringMap->clear();
-        if (m_PointerMap) m_PointerMap->clear();
 
+    // The text format written by earlier versions.
+    void DeserializeText(const char *serialized, bool persist)
+    {
     #define SSCANF_OR_ABORT(s, fmt, val) \
         do { int inc = 0; if (sscanf(s, fmt "%n", val, &inc) != 1)                                                        \
         {                                                                                                                 \
@@ -188,7 +547,7 @@ public:
 
                 int value;
                 SSCANF_OR_ABORT(s, " = %d;", &value);
-                GetIntMap()[name] = std::make_pair<>(value, persist);
+                Set(name, int32_t(value), persist);
             }
         }
 
@@ -204,7 +563,7 @@ public:
 
                 float value;
                 SSCANF_OR_ABORT(s, " = %f;", &value);
-                GetFloatMap()[name] = std::make_pair<>(value, persist);
+                Set(name, value, persist);
             }
         }
 
@@ -221,19 +580,19 @@ public:
                 SSCANF_OR_ABORT(s, " = <%d>", &len);
                 std::string value = std::string{s, (size_t)len};
                 s += len + 1; // ';' at the end.
-                GetStringMap().emplace(name, std::make_pair<>(std::move(value), persist));
+                if (!FindEntry(s_KeyPool.Find(name), String))
+                    Set(name, std::move(value), persist);
             }
         }
 
     #undef SSCANF_OR_ABORT
     }
 
-    ObjectID        m_oidOwner;
-    bool                        m_bCloned;
-    std::unique_ptr<IntMap>     m_IntMap;
-    std::unique_ptr<FloatMap>   m_FloatMap;
-    std::unique_ptr<StringMap>  m_StringMap;
-    std::unique_ptr<PointerMap> m_PointerMap;
+    ObjectID            m_oidOwner;
+    bool                m_bCloned;
+    std::vector<Entry>  m_Slots;
+    size_t              m_nCount = 0;
+    std::vector<void*>  m_Extensions;
 };
 
 static ObjectStorage* GetObjectStorage(CGameObject *pGameObject)
@@ -256,29 +615,54 @@ static void DestroyObjectStorage(CGameObject *pGameObject)
     }
 }
 
+// prefix!key, built on the caller's stack so lookups don't allocate unless the key is unusually long.
+class FullKey
+{
+public:
+    FullKey(const std::string& prefix, const std::string& key)
+    {
+        m_nSize = prefix.size() + 1 + key.size();
+        char *pBuffer = m_Inline;
+        if (m_nSize > sizeof(m_Inline))
+        {
+            m_Heap.resize(m_nSize);
+            pBuffer = m_Heap.data();
+        }
+        std::memcpy(pBuffer, prefix.data(), prefix.size());
+        pBuffer[prefix.size()] = '!';
+        std::memcpy(pBuffer + prefix.size() + 1, key.data(), key.size());
+    }
+
+    operator std::string_view() const
+    {
+        return { m_Heap.empty() ? m_Inline : m_Heap.data(), m_nSize };
+    }
+
+private:
+    char m_Inline[128];
+    std::string m_Heap;
+    size_t m_nSize;
+};
+
 void Set(CGameObject *pGameObject, const std::string& prefix, const std::string& key, int value, bool persist)
 {
-    auto fullkey = prefix + "!" + key;
     if (auto *pOS = GetObjectStorage(pGameObject))
-        pOS->GetIntMap()[fullkey] = std::make_pair<>(value, persist);
+        pOS->Set(FullKey(prefix, key), int32_t(value), persist);
 }
 void Set(CGameObject *pGameObject, const std::string& prefix, const std::string& key, float value, bool persist)
 {
-    auto fullkey = prefix + "!" + key;
     if (auto *pOS = GetObjectStorage(pGameObject))
-        pOS->GetFloatMap()[fullkey] = std::make_pair<>(value, persist);
+        pOS->Set(FullKey(prefix, key), value, persist);
 }
 void Set(CGameObject *pGameObject, const std::string& prefix, const std::string& key, std::string value, bool persist)
 {
-    auto fullkey = prefix + "!" + key;
     if (auto *pOS = GetObjectStorage(pGameObject))
-        pOS->GetStringMap()[fullkey] = std::make_pair<>(std::move(value), persist);
+        pOS->Set(FullKey(prefix, key), std::move(value), persist);
 }
 void Set(CGameObject *pGameObject, const std::string& prefix, const std::string& key, void *value, std::optional<CleanupFunc> cleanup)
 {
-    auto fullkey = prefix + "!" + key;
     if (auto *pOS = GetObjectStorage(pGameObject))
-        pOS->GetPointerMap()[fullkey] = std::make_pair<>(value, cleanup.value_or(nullptr));
+        pOS->Set(FullKey(prefix, key), ObjectStorage::PointerValue(value, cleanup.value_or(nullptr)), false);
 }
 
 
@@ -286,11 +670,8 @@ template <> std::optional<int> Get<int>(CGameObject *pGameObject, const std::str
 {
     if (auto *pOS = GetObjectStorage(pGameObject))
     {
-        auto fullkey = prefix + "!" + key;
-        auto map = pOS->GetIntMap();
-        auto it = map.find(fullkey);
-        if (it != map.end())
-            return std::make_optional<int>(it->second.first);
+        if (auto *pValue = pOS->Find<int32_t>(s_KeyPool.Find(FullKey(prefix, key))))
+            return std::make_optional<int>(*pValue);
     }
     return std::optional<int>();
 }
@@ -299,11 +680,8 @@ template <> std::optional<float> Get<float>(CGameObject *pGameObject, const std:
 {
     if (auto *pOS = GetObjectStorage(pGameObject))
     {
-        auto fullkey = prefix + "!" + key;
-        auto map = pOS->GetFloatMap();
-        auto it = map.find(fullkey);
-        if (it != map.end())
-            return std::make_optional<float>(it->second.first);
+        if (auto *pValue = pOS->Find<float>(s_KeyPool.Find(FullKey(prefix, key))))
+            return std::make_optional<float>(*pValue);
     }
     return std::optional<float>();
 }
@@ -312,11 +690,8 @@ template <> std::optional<std::string> Get<std::string>(CGameObject *pGameObject
 {
     if (auto *pOS = GetObjectStorage(pGameObject))
     {
-        auto fullkey = prefix + "!" + key;
-        auto map = pOS->GetStringMap();
-        auto it = map.find(fullkey);
-        if (it != map.end())
-            return std::make_optional<std::string>(it->second.first);
+        if (auto *pValue = pOS->Find<std::string>(s_KeyPool.Find(FullKey(prefix, key))))
+            return std::make_optional<std::string>(*pValue);
     }
     return std::optional<std::string>();
 }
@@ -325,11 +700,8 @@ template <> std::optional<void*> Get<void*>(CGameObject *pGameObject, const std:
 {
     if (auto *pOS = GetObjectStorage(pGameObject))
     {
-        auto fullkey = prefix + "!" + key;
-        auto map = pOS->GetPointerMap();
-        auto it = map.find(fullkey);
-        if (it != map.end())
-            return std::make_optional<void*>(it->second.first);
+        if (auto *pValue = pOS->Find<ObjectStorage::PointerValue>(s_KeyPool.Find(FullKey(prefix, key))))
+            return std::make_optional<void*>(pValue->first);
     }
     return std::optional<void*>();
 }
@@ -337,18 +709,7 @@ template <> std::optional<void*> Get<void*>(CGameObject *pGameObject, const std:
 void Remove(CGameObject *pGameObject, const std::string& prefix, const std::string& key)
 {
     if (auto *pOS = GetObjectStorage(pGameObject))
-    {
-        auto fullkey = prefix + "!" + key;
-        // Ugly, but GetXxxMap will create it if missing.
-        if (pOS->m_StringMap)
-            pOS->m_StringMap->erase(fullkey);
-        if (pOS->m_IntMap)
-            pOS->m_IntMap->erase(fullkey);
-        if (pOS->m_FloatMap)
-            pOS->m_FloatMap->erase(fullkey);
-        if (pOS->m_PointerMap)
-            pOS->m_PointerMap->erase(fullkey);
-    }
+        pOS->Remove(s_KeyPool.Find(FullKey(prefix, key)));
 }
 
 void RemoveRegex(CGameObject *pGameObject, const std::string& prefix, const std::string& regex)
@@ -356,31 +717,43 @@ void RemoveRegex(CGameObject *pGameObject, const std::string& prefix, const std:
     auto fullregex = "(?:" + prefix + "!)" + regex;
     if (auto *pOS = GetObjectStorage(pGameObject))
     {
-        std::regex rgx(fullregex);
+        auto rgx = Pattern::Compile(fullregex);
+        pOS->RemoveIf([&](const std::string& name) { return Pattern::Match(rgx, name); });
+    }
+}
 
-        auto Remove = [&](auto &map) -> void
+void ForEachInt(CGameObject *pGameObject, const std::string& prefix, const std::string& keyPrefix,
+                const std::function<void(const std::string& key, int32_t value)>& fn)
+{
+    if (auto *pOS = GetObjectStorage(pGameObject))
+    {
+        const auto fullPrefix = prefix + "!" + keyPrefix;
+        pOS->ForEachInt([&](const std::string& name, int32_t value)
         {
-            std::vector<std::string> erase;
+            if (name.compare(0, fullPrefix.size(), fullPrefix) == 0)
+                fn(name.substr(prefix.size() + 1), value);
+        });
+    }
+}
 
-            for (const auto& it: *map)
-            {
-                if (std::regex_match(it.first, rgx))
-                    erase.push_back(it.first);
-            }
+uint32_t RegisterExtension(ExtensionType type)
+{
+    ASSERT_OR_THROW(type.create && type.destroy);
+    auto& types = ExtensionTypes();
+    types.push_back(std::move(type));
+    return types.size() - 1;
+}
 
-            for (const auto& e: erase)
-                map->erase(e);
-        };
+void *GetExtension(CGameObject *pGameObject, uint32_t extension)
+{
+    auto *pOS = GetObjectStorage(pGameObject);
+    return pOS ? pOS->GetExtension(extension, pGameObject) : nullptr;
+}
 
-        if (pOS->m_StringMap)
-            Remove(pOS->m_StringMap);
-        if (pOS->m_IntMap)
-            Remove(pOS->m_IntMap);
-        if (pOS->m_FloatMap)
-            Remove(pOS->m_FloatMap);
-        if (pOS->m_PointerMap)
-            Remove(pOS->m_PointerMap);
-    }
+void ResetExtension(CGameObject *pGameObject, uint32_t extension)
+{
+    if (pGameObject && pGameObject->m_pNwnxData)
+        static_cast<ObjectStorage*>(pGameObject->m_pNwnxData)->ResetExtension(extension);
 }
 
 void InitializeHooks()
@@ -431,7 +804,15 @@ void InitializeHooks()
     static Hooks::Hook s_UUIDSaveToGffHook   = Hooks::HookFunction(&CNWSUUID::SaveToGff,
         +[](CNWSUUID* pThis, CResGFF* pRes, CResStruct* pStruct)
         {
-            pRes->WriteFieldCExoString(pStruct, GetObjectStorage(pThis->m_parent)->Serialize(), GffFieldName);
+            auto *pOS = GetObjectStorage(pThis->m_parent);
+            auto serialized = pOS->Serialize();
+            if (!serialized.empty())
+            {
+                pRes->WriteFieldDWORD(pStruct, serialized.size(), GffBinarySizeFieldName);
+                pRes->WriteFieldVOID(pStruct, serialized.data(), serialized.size(), GffBinaryFieldName);
+                // Loading prefers the binary field, older versions only know this one.
+                pRes->WriteFieldCExoString(pStruct, pOS->SerializeText(), GffFieldName);
+            }
             s_UUIDSaveToGffHook->CallOriginal<void>(pThis, pRes, pStruct);
         }, Hooks::Order::VeryEarly);
 
@@ -439,9 +820,20 @@ void InitializeHooks()
         +[](CNWSUUID* pThis, CResGFF* pRes, CResStruct* pStruct) -> bool
         {
             int32_t success;
-            auto str = pRes->ReadFieldCExoString(pStruct, GffFieldName, success);
+            auto size = pRes->ReadFieldDWORD(pStruct, GffBinarySizeFieldName, success);
             if (success)
-                GetObjectStorage(pThis->m_parent)->Deserialize(str.CStr());
+            {
+                std::string serialized(size, '\0');
+                pRes->ReadFieldVOID(pStruct, serialized.data(), size, GffBinaryFieldName, success);
+                if (success)
+                    GetObjectStorage(pThis->m_parent)->Deserialize(serialized.data(), serialized.size());
+            }
+            else
+            {
+                auto str = pRes->ReadFieldCExoString(pStruct, GffFieldName, success);
+                if (success)
+                    GetObjectStorage(pThis->m_parent)->Deserialize(str.CStr(), str.GetLength());
+            }
 
             return s_UUIDLoadFromGffHook->CallOriginal<bool>(pThis, pRes, pStruct);
         }, Hooks::Order::VeryEarly);
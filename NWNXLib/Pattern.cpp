@@ -0,0 +1,532 @@
+#include "nwnx.hpp"
+
+#include <bitset>
+#include <mutex>
+#include <unordered_map>
+
+namespace NWNXLib::Pattern
+{
+
+// Compiled to a Thompson NFA and run by simulating every state at once, so matching takes
+// O(input length * states) no matter what the pattern looks like.
+class Regex
+{
+public:
+    enum StateType : uint8_t { Char, Split, Bol, Eol, Accept };
+
+    struct State
+    {
+        StateType type;
+        uint32_t charClass; // Char: index into m_charClasses
+        int32_t out = -1;
+        int32_t out1 = -1;   // Split only
+    };
+
+    std::vector<State> m_states;
+    std::vector<std::bitset<256>> m_charClasses;
+    int32_t m_start = -1;
+
+    bool Run(std::string_view str, bool bSearch) const;
+
+private:
+    void AddState(std::vector<int32_t>& list, std::vector<int32_t>& stack, std::vector<uint32_t>& seen,
+                  uint32_t generation, int32_t start, size_t pos, size_t len) const;
+};
+
+namespace
+{
+
+struct Node
+{
+    enum Type { Empty, Char, Bol, Eol, Concat, Alt, Repeat } type = Empty;
+    std::bitset<256> charClass = {};
+    std::vector<Node> children = {};
+    int32_t min = 0;
+    int32_t max = 0; // -1 for unbounded
+};
+
+class Parser
+{
+public:
+    explicit Parser(std::string_view pattern) : m_pattern(pattern) {}
+
+    Node Parse()
+    {
+        auto node = ParseAlt();
+        if (m_pos != m_pattern.size())
+            throw std::runtime_error("unmatched ')'");
+        return node;
+    }
+
+private:
+    bool More() const { return m_pos < m_pattern.size(); }
+    char Peek() const { return m_pattern[m_pos]; }
+
+    Node ParseAlt()
+    {
+        Node alt{Node::Alt};
+        alt.children.push_back(ParseConcat());
+        while (More() && Peek() == '|')
+        {
+            m_pos++;
+            alt.children.push_back(ParseConcat());
+        }
+        return alt.children.size() == 1 ? std::move(alt.children[0]) : std::move(alt);
+    }
+
+    Node ParseConcat()
+    {
+        Node concat{Node::Concat};
+        while (More() && Peek() != '|' && Peek() != ')')
+            concat.children.push_back(ParseRepeat());
+        return concat;
+    }
+
+    Node ParseRepeat()
+    {
+        auto atom = ParseAtom();
+        while (More())
+        {
+            int32_t min, max;
+            const char c = Peek();
+            if (c == '*')      { min = 0; max = -1; m_pos++; }
+            else if (c == '+') { min = 1; max = -1; m_pos++; }
+            else if (c == '?') { min = 0; max = 1; m_pos++; }
+            else if (c == '{' && ParseBounds(min, max)) {}
+            else break;
+
+            // Lazy quantifiers only change which match is reported, which doesn't matter here.
+            if (More() && Peek() == '?')
+                m_pos++;
+
+            if (atom.type == Node::Bol || atom.type == Node::Eol)
+                throw std::runtime_error("nothing to repeat");
+
+            Node repeat{Node::Repeat};
+            repeat.min = min;
+            repeat.max = max;
+            repeat.children.push_back(std::move(atom));
+            atom = std::move(repeat);
+        }
+        return atom;
+    }
+
+    bool ParseBounds(int32_t& min, int32_t& max)
+    {
+        auto pos = m_pos + 1;
+        auto number = [&]() -> int32_t
+        {
+            int32_t n = -1;
+            while (pos < m_pattern.size() && std::isdigit((unsigned char)m_pattern[pos]))
+            {
+                n = (n < 0 ? 0 : n) * 10 + (m_pattern[pos++] - '0');
+                if (n > 1000)
+                    throw std::runtime_error("repetition count too large");
+            }
+            return n;
+        };
+
+        min = number();
+        if (min < 0)
+            return false; // Not a quantifier, '{' is a literal
+        max = min;
+        if (pos < m_pattern.size() && m_pattern[pos] == ',')
+        {
+            pos++;
+            max = number();
+        }
+        if (pos >= m_pattern.size() || m_pattern[pos] != '}')
+            return false;
+        if (max >= 0 && max < min)
+            throw std::runtime_error("invalid repetition bounds");
+
+        m_pos = pos + 1;
+        return true;
+    }
+
+    Node ParseAtom()
+    {
+        Node node{Node::Char};
+        const char c = m_pattern[m_pos++];
+        switch (c)
+        {
+            case '(':
+            {
+                if (More() && Peek() == '?')
+                {
+                    if (m_pos + 1 < m_pattern.size() && m_pattern[m_pos + 1] == ':')
+                        m_pos += 2;
+                    else
+                        throw std::runtime_error("lookaround and group flags are not supported");
+                }
+                auto group = ParseAlt();
+                if (!More() || Peek() != ')')
+                    throw std::runtime_error("missing ')'");
+                m_pos++;
+                return group;
+            }
+            case ')': throw std::runtime_error("unmatched ')'");
+            case '*': case '+': case '?': throw std::runtime_error("nothing to repeat");
+            case '^': node.type = Node::Bol; break;
+            case '$': node.type = Node::Eol; break;
+            case '.': node.charClass.set(); node.charClass.reset('\n'); break;
+            case '[': node.charClass = ParseClass(); break;
+            case '\\': node.charClass = ParseEscape(); break;
+            default: node.charClass.set((unsigned char)c);
+        }
+        return node;
+    }
+
+    static bool IsClassEscape(char c)
+    {
+        return c == 'd' || c == 'D' || c == 'w' || c == 'W' || c == 's' || c == 'S';
+    }
+
+    // A single escaped character.
+    char ParseEscapedChar()
+    {
+        if (!More())
+            throw std::runtime_error("trailing '\\'");
+
+        const char c = m_pattern[m_pos++];
+        switch (c)
+        {
+            case 'n': return '\n';
+            case 'r': return '\r';
+            case 't': return '\t';
+        }
+        if (std::isalnum((unsigned char)c))
+            throw std::runtime_error(std::string("unsupported escape '\\") + c + "'");
+        return c;
+    }
+
+    std::bitset<256> ParseEscape()
+    {
+        std::bitset<256> set;
+        if (!More() || !IsClassEscape(Peek()))
+        {
+            set.set((unsigned char)ParseEscapedChar());
+            return set;
+        }
+
+        const char c = m_pattern[m_pos++];
+        for (int i = 0; i < 256; i++)
+        {
+            bool bIn;
+            switch (std::tolower(c))
+            {
+                case 'd': bIn = std::isdigit(i); break;
+                case 'w': bIn = std::isalnum(i) || i == '_'; break;
+                default:  bIn = std::isspace(i); break;
+            }
+            if (bIn != !!std::isupper(c))
+                set.set(i);
+        }
+        return set;
+    }
+
+    std::bitset<256> ParseClass()
+    {
+        std::bitset<256> set;
+        const bool bNegate = More() && Peek() == '^';
+        if (bNegate)
+            m_pos++;
+
+        while (true)
+        {
+            if (!More())
+                throw std::runtime_error("missing ']'");
+
+            // As in ECMAScript, "[]" is an empty class rather than starting with a literal ']'.
+            unsigned char first = m_pattern[m_pos++];
+            if (first == ']')
+                break;
+            if (first == '\\')
+            {
+                if (More() && IsClassEscape(Peek()))
+                {
+                    set |= ParseEscape();
+                    continue;
+                }
+                first = ParseEscapedChar();
+            }
+
+            unsigned char last = first;
+            if (m_pos + 1 < m_pattern.size() && Peek() == '-' && m_pattern[m_pos + 1] != ']')
+            {
+                m_pos++;
+                last = m_pattern[m_pos++];
+                if (last == '\\')
+                    last = ParseEscapedChar();
+                if (last < first)
+                    throw std::runtime_error("invalid range in character class");
+            }
+            for (int i = first; i <= last; i++)
+                set.set(i);
+        }
+        return bNegate ? ~set : set;
+    }
+
+    std::string_view m_pattern;
+    size_t m_pos = 0;
+};
+
+class Compiler
+{
+public:
+    Compiler(Regex& regex, uint32_t maxStates) : m_regex(regex), m_maxStates(maxStates) {}
+
+    // Compiles node so it continues to next, returns its first state.
+    int32_t Compile(const Node& node, int32_t next)
+    {
+        switch (node.type)
+        {
+            case Node::Empty:
+                return next;
+            case Node::Char:
+            {
+                auto state = AddState(Regex::Char, next);
+                m_regex.m_states[state].charClass = AddCharClass(node.charClass);
+                return state;
+            }
+            case Node::Bol:
+                return AddState(Regex::Bol, next);
+            case Node::Eol:
+                return AddState(Regex::Eol, next);
+            case Node::Concat:
+                for (auto it = node.children.rbegin(); it != node.children.rend(); ++it)
+                    next = Compile(*it, next);
+                return next;
+            case Node::Alt:
+            {
+                int32_t start = Compile(node.children.back(), next);
+                for (auto it = node.children.rbegin() + 1; it != node.children.rend(); ++it)
+                    start = AddState(Regex::Split, Compile(*it, next), start);
+                return start;
+            }
+            case Node::Repeat:
+            {
+                const auto& child = node.children[0];
+                if (node.max < 0)
+                {
+                    // Loop: split -> child -> split, or leave.
+                    auto loop = AddState(Regex::Split, -1, next);
+                    m_regex.m_states[loop].out = Compile(child, loop);
+                    next = loop;
+                }
+                else
+                {
+                    for (int32_t i = node.min; i < node.max; i++)
+                        next = AddState(Regex::Split, Compile(child, next), next);
+                }
+                for (int32_t i = 0; i < node.min; i++)
+                    next = Compile(child, next);
+                return next;
+            }
+        }
+        return next;
+    }
+
+    int32_t AddState(Regex::StateType type, int32_t out, int32_t out1 = -1)
+    {
+        if (m_regex.m_states.size() >= m_maxStates)
+            throw std::runtime_error("pattern is too complex");
+        m_regex.m_states.push_back({type, 0, out, out1});
+        return m_regex.m_states.size() - 1;
+    }
+
+private:
+    uint32_t AddCharClass(const std::bitset<256>& charClass)
+    {
+        for (uint32_t i = 0; i < m_regex.m_charClasses.size(); i++)
+        {
+            if (m_regex.m_charClasses[i] == charClass)
+                return i;
+        }
+        m_regex.m_charClasses.push_back(charClass);
+        return m_regex.m_charClasses.size() - 1;
+    }
+
+    Regex& m_regex;
+    uint32_t m_maxStates;
+};
+
+}
+
+void Regex::AddState(std::vector<int32_t>& list, std::vector<int32_t>& stack, std::vector<uint32_t>& seen,
+                     uint32_t generation, int32_t start, size_t pos, size_t len) const
+{
+    // Follows the epsilon transitions, only Char and Accept states end up in the list.
+    stack.push_back(start);
+    while (!stack.empty())
+    {
+        auto state = stack.back();
+        stack.pop_back();
+        if (state < 0 || seen[state] == generation)
+            continue;
+
+        seen[state] = generation;
+        const auto& s = m_states[state];
+        switch (s.type)
+        {
+            case Split:
+                stack.push_back(s.out1);
+                stack.push_back(s.out);
+                break;
+            case Bol:
+                if (pos == 0)
+                    stack.push_back(s.out);
+                break;
+            case Eol:
+                if (pos == len)
+                    stack.push_back(s.out);
+                break;
+            default:
+                list.push_back(state);
+        }
+    }
+}
+
+bool Regex::Run(std::string_view str, bool bSearch) const
+{
+    // Reused between runs. The generation keeps counting across runs and patterns, so seen never needs
+    // clearing until it wraps.
+    thread_local std::vector<int32_t> current, next, stack;
+    thread_local std::vector<uint32_t> seen;
+    thread_local uint32_t generation = 0;
+
+    if (seen.size() < m_states.size())
+        seen.resize(m_states.size(), 0);
+    if (generation > UINT32_MAX - str.size() - 2)
+    {
+        std::fill(seen.begin(), seen.end(), 0);
+        generation = 0;
+    }
+    generation++;
+
+    current.clear();
+    stack.clear();
+    AddState(current, stack, seen, generation, m_start, 0, str.size());
+
+    for (size_t pos = 0; ; pos++)
+    {
+        for (auto state : current)
+        {
+            if (m_states[state].type == Accept && (bSearch || pos == str.size()))
+                return true;
+        }
+        if (pos == str.size())
+            return false;
+
+        generation++;
+        next.clear();
+        const auto c = (unsigned char)str[pos];
+        for (auto state : current)
+        {
+            const auto& s = m_states[state];
+            if (s.type == Char && m_charClasses[s.charClass].test(c))
+                AddState(next, stack, seen, generation, s.out, pos + 1, str.size());
+        }
+        if (bSearch)
+            AddState(next, stack, seen, generation, m_start, pos + 1, str.size());
+
+        std::swap(current, next);
+        // A search restarts at every position, so an empty list only ends a full match.
+        if (!bSearch && current.empty())
+            return false;
+    }
+}
+
+static uint32_t s_MaxLength = Config::Get<uint32_t>("PATTERN_MAX_LENGTH", 1024, "NWNX_CORE");
+static uint32_t s_MaxStates = Config::Get<uint32_t>("PATTERN_MAX_STATES", 4096, "NWNX_CORE");
+static constexpr size_t MAX_CACHED = 1024;
+
+static std::mutex s_CacheMutex;
+static std::unordered_map<std::string, RegexPtr> s_Cache;
+
+static RegexPtr CompileUncached(const std::string& pattern)
+{
+    if (pattern.size() > s_MaxLength)
+    {
+        LOG_ERROR("Pattern '%s' is longer than %u characters", pattern, s_MaxLength);
+        return nullptr;
+    }
+
+    try
+    {
+        auto regex = std::make_shared<Regex>();
+        Compiler compiler(*regex, s_MaxStates);
+        const auto accept = compiler.AddState(Regex::Accept, -1);
+        regex->m_start = compiler.Compile(Parser(pattern).Parse(), accept);
+        return regex;
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR("Invalid pattern '%s': %s", pattern, e.what());
+        return nullptr;
+    }
+}
+
+RegexPtr Compile(const std::string& pattern)
+{
+    std::lock_guard<std::mutex> lock(s_CacheMutex);
+    auto it = s_Cache.find(pattern);
+    if (it != s_Cache.end())
+        return it->second;
+
+    // Patterns are usually a handful of fixed strings, a full cache means someone builds them on the fly.
+    if (s_Cache.size() >= MAX_CACHED)
+        s_Cache.clear();
+
+    // Invalid patterns are cached too, so they're only reported once.
+    return s_Cache.emplace(pattern, CompileUncached(pattern)).first->second;
+}
+
+bool Match(const RegexPtr& regex, std::string_view str)
+{
+    return regex && regex->Run(str, false);
+}
+
+bool Search(const RegexPtr& regex, std::string_view str)
+{
+    return regex && regex->Run(str, true);
+}
+
+bool Glob(std::string_view glob, std::string_view str)
+{
+    // Greedy with a single backtrack point, linear in practice and never exponential.
+    size_t g = 0, s = 0, starG = std::string_view::npos, starS = 0;
+    while (s < str.size())
+    {
+        // '*' first, a literal '*' in str mustn't be taken as matching it.
+        if (g < glob.size() && glob[g] == '*')
+        {
+            starG = g++;
+            starS = s;
+        }
+        else if (g < glob.size() && (glob[g] == '?' || glob[g] == str[s]))
+        {
+            g++;
+            s++;
+        }
+        else if (starG != std::string_view::npos)
+        {
+            g = starG + 1;
+            s = ++starS;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    while (g < glob.size() && glob[g] == '*')
+        g++;
+    return g == glob.size();
+}
+
+bool Prefix(std::string_view prefix, std::string_view str)
+{
+    return str.compare(0, prefix.size(), prefix) == 0;
+}
+
+}
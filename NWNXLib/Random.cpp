@@ -0,0 +1,59 @@
+#include "nwnx.hpp"
+
+#include <memory>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+
+namespace NWNXLib::Random
+{
+
+static uint64_t SplitMix64(uint64_t& x)
+{
+    uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static uint64_t HashName(const std::string& name)
+{
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (unsigned char c : name)
+        hash = (hash ^ c) * 0x100000001B3ull;
+    return hash;
+}
+
+static uint64_t InitialSeed()
+{
+    if (auto seed = Config::Get<uint64_t>("RANDOM_SEED", "NWNX_CORE"))
+        return *seed;
+    return ((uint64_t)std::random_device{}() << 32) | std::random_device{}();
+}
+
+static const uint64_t s_Seed = InitialSeed();
+static std::mutex s_StreamsMutex;
+static std::unordered_map<std::string, std::unique_ptr<Stream>> s_Streams;
+
+static uint64_t StreamSeed(const std::string& name)
+{
+    uint64_t x = s_Seed ^ HashName(name);
+    return SplitMix64(x);
+}
+
+void Stream::Seed(uint64_t seed)
+{
+    for (auto& s : m_state)
+        s = SplitMix64(seed);
+}
+
+Stream& GetStream(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(s_StreamsMutex);
+    auto& pStream = s_Streams[name];
+    if (!pStream)
+        pStream = std::make_unique<Stream>(StreamSeed(name));
+    return *pStream;
+}
+
+}
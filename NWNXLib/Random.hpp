@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace NWNXLib::Random
+{
+    // A xoshiro256** random number stream. Streams aren't thread safe, a subsystem that draws from another
+    // thread should use a stream of its own.
+    class Stream
+    {
+    public:
+        explicit Stream(uint64_t seed = 0) { Seed(seed); }
+
+        void Seed(uint64_t seed);
+
+        uint64_t Next()
+        {
+            const uint64_t result = Rotl(m_state[1] * 5, 7) * 9;
+            const uint64_t t = m_state[1] << 17;
+            m_state[2] ^= m_state[0];
+            m_state[3] ^= m_state[1];
+            m_state[1] ^= m_state[2];
+            m_state[0] ^= m_state[3];
+            m_state[2] ^= t;
+            m_state[3] = Rotl(m_state[3], 45);
+            return result;
+        }
+
+        // Uniform in [0, range), 0 if range is 0.
+        uint32_t Range(uint32_t range)
+        {
+            // Lemire's multiply and shift with rejection, no modulo bias.
+            uint64_t product = (Next() >> 32) * range;
+            if ((uint32_t)product < range)
+            {
+                const uint32_t threshold = -range % range;
+                while ((uint32_t)product < threshold)
+                    product = (Next() >> 32) * range;
+            }
+            return product >> 32;
+        }
+
+        // Uniform in [min, max].
+        int32_t Between(int32_t min, int32_t max)
+        {
+            return min + (int32_t)Range((uint32_t)(max - min) + 1);
+        }
+
+    private:
+        static uint64_t Rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+        std::array<uint64_t, 4> m_state;
+    };
+
+    // Named per subsystem stream, seeded from NWNX_CORE_RANDOM_SEED (or a random seed if unset) and its name.
+    // References stay valid for the lifetime of the server.
+    Stream& GetStream(const std::string& name);
+}
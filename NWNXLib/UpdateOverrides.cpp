@@ -0,0 +1,221 @@
+#include "nwnx.hpp"
+
+#include "API/CNWSCreature.hpp"
+#include "API/CNWSMessage.hpp"
+#include "API/CNWSObject.hpp"
+#include "API/CNWSPlayer.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+extern "C" void _ZN10CNWSObjectD1Ev(CNWSObject*);
+extern "C" void _ZN12CNWSCreatureD1Ev(CNWSCreature*);
+
+namespace NWNXLib::UpdateOverrides
+{
+
+using namespace NWNXLib::API;
+
+struct OverrideType
+{
+    ApplyFunc apply;
+    CleanupFunc cleanup;
+};
+
+struct Override
+{
+    uint32_t type;
+    void *pData;
+};
+
+// Overrides of an object for one observer, sorted by type.
+using ObjectOverrides = std::vector<Override>;
+
+struct Observer
+{
+    ObjectID oidObserver;
+    std::unordered_map<ObjectID, ObjectOverrides> objects;
+};
+
+static std::vector<OverrideType> s_Types;
+// Only observers with at least one override, there's rarely more than a handful.
+static std::vector<Observer> s_Observers;
+// A PC being destroyed is logging out, it comes back with the same object id. Overrides targeting it stay, as
+// they did when they were kept in its POS and went with its TURD.
+static ObjectID s_oidLoggingOutPC = Constants::OBJECT_INVALID;
+
+static Observer* FindObserver(ObjectID oidObserver)
+{
+    for (auto& observer : s_Observers)
+    {
+        if (observer.oidObserver == oidObserver)
+            return &observer;
+    }
+    return nullptr;
+}
+
+static ObjectOverrides* FindObjectOverrides(ObjectID oidObserver, ObjectID oidObject)
+{
+    if (auto *pObserver = FindObserver(oidObserver))
+    {
+        auto it = pObserver->objects.find(oidObject);
+        if (it != pObserver->objects.end())
+            return &it->second;
+    }
+    return nullptr;
+}
+
+static void CleanupOverride(const Override& override)
+{
+    if (s_Types[override.type].cleanup)
+        s_Types[override.type].cleanup(override.pData);
+}
+
+static void RemoveEmptyObservers()
+{
+    s_Observers.erase(std::remove_if(s_Observers.begin(), s_Observers.end(),
+                                     [](const Observer& observer) { return observer.objects.empty(); }),
+                      s_Observers.end());
+}
+
+static void RemoveObject(ObjectID oidObject)
+{
+    bool bRemoved = false;
+    for (auto& observer : s_Observers)
+    {
+        auto it = observer.objects.find(oidObject);
+        if (it == observer.objects.end())
+            continue;
+
+        for (const auto& override : it->second)
+            CleanupOverride(override);
+        observer.objects.erase(it);
+        bRemoved = true;
+    }
+
+    if (bRemoved)
+        RemoveEmptyObservers();
+}
+
+static void InitializeHooks()
+{
+    static Hooks::Hook s_ComputeGameObjectUpdateForObjectHook = Hooks::HookFunction(&CNWSMessage::ComputeGameObjectUpdateForObject,
+        +[](CNWSMessage *pMessage, CNWSPlayer *pPlayer, CNWSObject *pPlayerGameObject, CGameObjectArray *pGameObjectArray, ObjectID oidObjectToUpdate) -> void
+        {
+            if (!s_Observers.empty())
+            {
+                if (auto *pOverrides = FindObjectOverrides(pPlayer->m_oidNWSObject, oidObjectToUpdate))
+                {
+                    if (auto *pObject = Utils::AsNWSObject(Utils::GetGameObject(oidObjectToUpdate)))
+                    {
+                        for (const auto& override : *pOverrides)
+                            s_Types[override.type].apply(pObject, override.pData, true);
+
+                        s_ComputeGameObjectUpdateForObjectHook->CallOriginal<void>(pMessage, pPlayer, pPlayerGameObject, pGameObjectArray, oidObjectToUpdate);
+
+                        for (auto it = pOverrides->rbegin(); it != pOverrides->rend(); ++it)
+                            s_Types[it->type].apply(pObject, it->pData, false);
+                        return;
+                    }
+                }
+            }
+            s_ComputeGameObjectUpdateForObjectHook->CallOriginal<void>(pMessage, pPlayer, pPlayerGameObject, pGameObjectArray, oidObjectToUpdate);
+        }, Hooks::Order::Early);
+
+    static Hooks::Hook s_ObjectDtorHook = Hooks::HookFunction(&_ZN10CNWSObjectD1Ev,
+        +[](CNWSObject *pThis) -> void
+        {
+            const auto oidSelf = pThis->m_idSelf;
+            s_ObjectDtorHook->CallOriginal<void>(pThis);
+            if (!s_Observers.empty() && oidSelf != s_oidLoggingOutPC)
+                RemoveObject(oidSelf);
+        }, Hooks::Order::Early);
+
+    // Runs around the object destructor above, while the creature is still whole.
+    static Hooks::Hook s_CreatureDtorHook = Hooks::HookFunction(&_ZN12CNWSCreatureD1Ev,
+        +[](CNWSCreature *pThis) -> void
+        {
+            if (pThis->m_bPlayerCharacter)
+                s_oidLoggingOutPC = pThis->m_idSelf;
+            s_CreatureDtorHook->CallOriginal<void>(pThis);
+            s_oidLoggingOutPC = Constants::OBJECT_INVALID;
+        }, Hooks::Order::Early);
+}
+
+uint32_t RegisterType(ApplyFunc apply, CleanupFunc cleanup)
+{
+    ASSERT_OR_THROW(apply);
+    s_Types.push_back({std::move(apply), std::move(cleanup)});
+    return s_Types.size() - 1;
+}
+
+void *Get(ObjectID oidObserver, ObjectID oidObject, uint32_t type)
+{
+    if (auto *pOverrides = FindObjectOverrides(oidObserver, oidObject))
+    {
+        for (const auto& override : *pOverrides)
+        {
+            if (override.type == type)
+                return override.pData;
+        }
+    }
+    return nullptr;
+}
+
+void Set(ObjectID oidObserver, ObjectID oidObject, uint32_t type, void *pData)
+{
+    ASSERT_OR_THROW(type < s_Types.size());
+    InitializeHooks();
+
+    auto *pObserver = FindObserver(oidObserver);
+    if (!pObserver)
+    {
+        s_Observers.push_back({oidObserver, {}});
+        pObserver = &s_Observers.back();
+    }
+
+    auto& overrides = pObserver->objects[oidObject];
+    auto it = std::lower_bound(overrides.begin(), overrides.end(), type,
+                               [](const Override& override, uint32_t type) { return override.type < type; });
+    if (it != overrides.end() && it->type == type)
+    {
+        if (it->pData != pData)
+            CleanupOverride(*it);
+        it->pData = pData;
+    }
+    else
+    {
+        overrides.insert(it, {type, pData});
+    }
+}
+
+void Remove(ObjectID oidObserver, ObjectID oidObject, uint32_t type)
+{
+    auto *pObserver = FindObserver(oidObserver);
+    if (!pObserver)
+        return;
+
+    auto object = pObserver->objects.find(oidObject);
+    if (object == pObserver->objects.end())
+        return;
+
+    auto& overrides = object->second;
+    for (auto it = overrides.begin(); it != overrides.end(); ++it)
+    {
+        if (it->type == type)
+        {
+            CleanupOverride(*it);
+            overrides.erase(it);
+            break;
+        }
+    }
+
+    if (overrides.empty())
+    {
+        pObserver->objects.erase(object);
+        if (pObserver->objects.empty())
+            RemoveEmptyObservers();
+    }
+}
+
+}
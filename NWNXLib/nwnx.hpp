@@ -6,6 +6,7 @@
 #include "API/Globals.hpp"
 
 #include <string>
+#include <string_view>
 #include <optional>
 #include <vector>
 #include <functional>
@@ -82,7 +83,7 @@ namespace Hooks
     class FunctionHook final
     {
     public:
-        FunctionHook(void* originalFunction, void* newFunction, int32_t order = Order::Default);
+        FunctionHook(void* originalFunction, void* newFunction, int32_t order = Order::Default, void* accountingWrapper = nullptr);
         ~FunctionHook();
 
         void *GetOriginal() { return m_trampoline; }
@@ -98,6 +99,8 @@ namespace Hooks
         int32_t     m_order;
         void*       m_funchook;
         void*       m_trampoline;
+        void*       m_accounting;
+        void*       m_accountingWrapper;
 
         static inline std::unordered_map<void*, std::vector<FunctionHook*>> s_hooks;
 
@@ -107,11 +110,59 @@ namespace Hooks
 
     using Hook = std::unique_ptr<FunctionHook>;
 
+    // Times one call of an accounted hook. The wrapper installed in place of the replacement opens a scope,
+    // which picks up the hook funchook's prehook was entered for, and calls the replacement from it.
+    class AccountingScope
+    {
+    public:
+        AccountingScope();
+        ~AccountingScope();
+        void* GetReplacement() const;
+
+    private:
+        void*            m_accounting;
+        AccountingScope* m_parent;
+        uint64_t         m_start;
+        uint64_t         m_childNs;
+    };
+
+    template <typename Ret, typename ... Params>
+    Ret AccountingWrapper(Params ... args)
+    {
+        AccountingScope scope;
+        return reinterpret_cast<Ret(*)(Params...)>(scope.GetReplacement())(std::forward<Params>(args) ...);
+    }
+
+    template <typename Ret, typename ... Params>
+    void* GetAccountingWrapper(Ret (*)(Params...)) { return (void*)&AccountingWrapper<Ret, Params...>; }
+    // Variadic and untyped replacements can't be wrapped and aren't accounted.
+    template <typename T>
+    void* GetAccountingWrapper(T) { return nullptr; }
+
     template <typename T1, typename T2>
     [[nodiscard]] Hook HookFunction(T1 original, T2 replacement, int32_t order = Order::Default)
     {
-        return std::make_unique<FunctionHook>((void*)original, (void *)replacement, order);
+        return std::make_unique<FunctionHook>((void*)original, (void *)replacement, order, GetAccountingWrapper(replacement));
     }
+
+    struct HookAccounting
+    {
+        std::string function;
+        std::string plugin;
+        uint64_t calls;
+        uint64_t inclusiveNs; // Time spent in the hook and everything it called.
+        uint64_t exclusiveNs; // Time spent in the hook minus the hooks further down the chain.
+    };
+
+    // Per hook call accounting, enabled with NWNX_CORE_HOOK_ACCOUNTING. Only hooks installed through
+    // HookFunction() while it is enabled are counted. The innermost hook's exclusive time includes the
+    // original function.
+    bool IsAccountingEnabled();
+    std::vector<HookAccounting> GetAccounting();
+    void ResetAccounting();
+
+    // Average cost of a call through a synthetic hook chain of 0 to maxDepth hooks, in nanoseconds.
+    std::vector<double> BenchmarkChain(uint32_t maxDepth, uint32_t calls);
 }
 
 namespace MessageBus
@@ -122,6 +173,7 @@ namespace MessageBus
     uint32_t Subscribe(const std::string& tag, const Handler& handler);
     void Unsubscribe(const uint32_t id);
     void Broadcast(const std::string& tag, const Message& message);
+    bool HasSubscribers(const std::string& tag);
 }
 
 namespace Platform
@@ -277,6 +329,89 @@ namespace POS
     // Removes without cleanup
     void Remove(CGameObject *pGameObject, const std::string& prefix, const std::string& key);
     void RemoveRegex(CGameObject *pGameObject, const std::string& prefix, const std::string& regex);
+
+    // Calls fn for every int value of the object whose key starts with keyPrefix.
+    void ForEachInt(CGameObject *pGameObject, const std::string& prefix, const std::string& keyPrefix,
+                    const std::function<void(const std::string& key, int32_t value)>& fn);
+
+    // Typed per object extensions for state read on hot paths. A plugin registers a struct once and gets
+    // direct access to an object's instance without building keys or hashing. An object's instance is
+    // created on first access and destroyed with the object. Extensions aren't saved themselves: the init
+    // function runs when an instance is created and again after the object's POS is loaded from a save or
+    // a TURD, so extensions mirroring persistent POS values can rebuild themselves from them.
+    using ExtensionInitFunc = std::function<void(CGameObject *pGameObject, void *pData)>;
+    struct ExtensionType
+    {
+        void *(*create)();
+        void (*destroy)(void *pData);
+        ExtensionInitFunc init;
+    };
+    uint32_t RegisterExtension(ExtensionType type);
+    // nullptr if pGameObject is nullptr.
+    void *GetExtension(CGameObject *pGameObject, uint32_t extension);
+    // Destroys the object's instance, the next access creates and initializes a new one.
+    void ResetExtension(CGameObject *pGameObject, uint32_t extension);
+
+    template <typename T>
+    class Extension
+    {
+    public:
+        explicit Extension(std::function<void(CGameObject*, T&)> init = nullptr)
+            : m_id(RegisterExtension({+[]() -> void* { return new T(); },
+                                      +[](void *pData) { delete static_cast<T*>(pData); },
+                                      init ? ExtensionInitFunc([init](CGameObject *pGameObject, void *pData) { init(pGameObject, *static_cast<T*>(pData)); })
+                                           : ExtensionInitFunc()}))
+        {
+        }
+
+        T *Get(CGameObject *pGameObject) const { return static_cast<T*>(GetExtension(pGameObject, m_id)); }
+        void Reset(CGameObject *pGameObject) const { ResetExtension(pGameObject, m_id); }
+
+    private:
+        uint32_t m_id;
+    };
+}
+
+namespace Pattern
+{
+    // Patterns compiled once and cached by their source text. Matching takes time linear in the length of
+    // the input, so a user supplied pattern can't hang the server. Supported are literals, '.', classes with
+    // ranges and negation, \d \w \s and their negations, escaped characters, '^', '$', groups, '|', '*', '+',
+    // '?' and {n,m} repetitions. Backreferences and lookaround aren't.
+    //
+    // Compile() logs an error and returns nullptr for invalid patterns, and for patterns longer than
+    // NWNX_CORE_PATTERN_MAX_LENGTH or compiling to more than NWNX_CORE_PATTERN_MAX_STATES states. A nullptr
+    // pattern never matches.
+    class Regex;
+    using RegexPtr = std::shared_ptr<const Regex>;
+    RegexPtr Compile(const std::string& pattern);
+    // Whether the whole string matches.
+    bool Match(const RegexPtr& regex, std::string_view str);
+    // Whether any part of the string matches.
+    bool Search(const RegexPtr& regex, std::string_view str);
+
+    // Cheap forms for the common cases: '*' matches any run of characters and '?' any single one.
+    bool Glob(std::string_view glob, std::string_view str);
+    bool Prefix(std::string_view prefix, std::string_view str);
+}
+
+namespace UpdateOverrides
+{
+    // Per player overrides of what the game sends a player about an object in its game object updates.
+    // Every override type shares a single CNWSMessage::ComputeGameObjectUpdateForObject hook, which only
+    // does work for the (observer, object) pairs that actually have overrides.
+    //
+    // The apply function is called with bApply=true before the update for the observer is computed, and
+    // with bApply=false after, in reverse registration order. Overrides are cleaned up when replaced,
+    // removed or when the object is destroyed; they're kept when the observer logs out.
+    using ApplyFunc = std::function<void(CNWSObject *pObject, void *pData, bool bApply)>;
+    using CleanupFunc = std::function<void(void*)>;
+
+    uint32_t RegisterType(ApplyFunc apply, CleanupFunc cleanup);
+
+    void *Get(ObjectID oidObserver, ObjectID oidObject, uint32_t type);
+    void Set(ObjectID oidObserver, ObjectID oidObject, uint32_t type, void *pData);
+    void Remove(ObjectID oidObserver, ObjectID oidObject, uint32_t type);
 }
 
 namespace Tasks
@@ -292,6 +427,7 @@ namespace Tasks
 #include "Assert.hpp"
 #include "ScriptVariant.hpp"
 #include "Config.hpp"
+#include "Random.hpp"
 #include "ScriptAPI.hpp"
 #include "Utils.hpp"
 
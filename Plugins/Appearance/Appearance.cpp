@@ -69,41 +69,29 @@ static void SetIntValue(int32_t type, int32_t value, std::bitset<OverrideType_MA
     }
 }
 
-static Hooks::Hook s_ComputeGameObjectUpdateForObjectHook =
-    Hooks::HookFunction(&CNWSMessage::ComputeGameObjectUpdateForObject,
-        +[](CNWSMessage *pMessage, CNWSPlayer *pPlayer, CNWSObject *pPlayerGameObject,
-                   CGameObjectArray *pGameObjectArray, ObjectID oidObjectToUpdate)
-        {
-            if (auto *pCreature = Utils::AsNWSCreature(Utils::GetGameObject(oidObjectToUpdate)))
-            {
-                if (auto appearanceOverrideData = pCreature->nwnxGet<void *>(Utils::ObjectIDToString(pPlayer->m_oidNWSObject)))
-                {
-                    auto *pAOD = static_cast<AppearanceOverrideData *>(*appearanceOverrideData);
-
-                    auto SwapValues = [&]() -> void
-                    {
-                        SwapIntValue(pAOD->bitSet[AppearanceType], pAOD->appearanceType, pCreature->m_cAppearance.m_nAppearanceType);
-                        SwapIntValue(pAOD->bitSet[Gender], pAOD->gender, pCreature->m_cAppearance.m_nGender);
-                        SwapIntValue(pAOD->bitSet[HitPoints], pAOD->currentHitPoints, pCreature->m_nCurrentHitPoints);
-                        SwapIntValue(pAOD->bitSet[HairColor], pAOD->hairColor, pCreature->m_cAppearance.m_nHairColor);
-                        SwapIntValue(pAOD->bitSet[SkinColor], pAOD->skinColor, pCreature->m_cAppearance.m_nSkinColor);
-                        SwapIntValue(pAOD->bitSet[PhenoType], pAOD->phenoType, pCreature->m_cAppearance.m_nPhenoType);
-                        SwapIntValue(pAOD->bitSet[HeadType], pAOD->headType, pCreature->m_cAppearance.m_nHeadVariation);
-                        SwapIntValue(pAOD->bitSet[SoundSet], pAOD->soundSet, pCreature->m_nSoundSet);
-                        SwapIntValue(pAOD->bitSet[TailType], pAOD->tailType, pCreature->m_cAppearance.m_nTailVariation);
-                        SwapIntValue(pAOD->bitSet[WingType], pAOD->wingType, pCreature->m_cAppearance.m_nWingVariation);
-                        SwapIntValue(pAOD->bitSet[FootstepSound], pAOD->footstepSound, pCreature->m_nFootstepType);
-                        SwapIntValue(pAOD->bitSet[Portrait], pAOD->portraitId, pCreature->m_nPortraitId);
-                    };
-
-                    SwapValues();
-                    s_ComputeGameObjectUpdateForObjectHook->CallOriginal<void>(pMessage, pPlayer, pPlayerGameObject, pGameObjectArray, oidObjectToUpdate);
-                    SwapValues();
-                    return;
-                }
-            }
-            s_ComputeGameObjectUpdateForObjectHook->CallOriginal<void>(pMessage, pPlayer, pPlayerGameObject, pGameObjectArray, oidObjectToUpdate);
-        }, Hooks::Order::Early);
+static void SwapValues(CNWSCreature *pCreature, AppearanceOverrideData *pAOD)
+{
+    SwapIntValue(pAOD->bitSet[AppearanceType], pAOD->appearanceType, pCreature->m_cAppearance.m_nAppearanceType);
+    SwapIntValue(pAOD->bitSet[Gender], pAOD->gender, pCreature->m_cAppearance.m_nGender);
+    SwapIntValue(pAOD->bitSet[HitPoints], pAOD->currentHitPoints, pCreature->m_nCurrentHitPoints);
+    SwapIntValue(pAOD->bitSet[HairColor], pAOD->hairColor, pCreature->m_cAppearance.m_nHairColor);
+    SwapIntValue(pAOD->bitSet[SkinColor], pAOD->skinColor, pCreature->m_cAppearance.m_nSkinColor);
+    SwapIntValue(pAOD->bitSet[PhenoType], pAOD->phenoType, pCreature->m_cAppearance.m_nPhenoType);
+    SwapIntValue(pAOD->bitSet[HeadType], pAOD->headType, pCreature->m_cAppearance.m_nHeadVariation);
+    SwapIntValue(pAOD->bitSet[SoundSet], pAOD->soundSet, pCreature->m_nSoundSet);
+    SwapIntValue(pAOD->bitSet[TailType], pAOD->tailType, pCreature->m_cAppearance.m_nTailVariation);
+    SwapIntValue(pAOD->bitSet[WingType], pAOD->wingType, pCreature->m_cAppearance.m_nWingVariation);
+    SwapIntValue(pAOD->bitSet[FootstepSound], pAOD->footstepSound, pCreature->m_nFootstepType);
+    SwapIntValue(pAOD->bitSet[Portrait], pAOD->portraitId, pCreature->m_nPortraitId);
+}
+
+static const uint32_t s_AppearanceOverrideType = UpdateOverrides::RegisterType(
+    [](CNWSObject *pObject, void *pData, bool)
+    {
+        if (auto *pCreature = Utils::AsNWSCreature(pObject))
+            SwapValues(pCreature, static_cast<AppearanceOverrideData*>(pData));
+    },
+    [](void *pData) { delete static_cast<AppearanceOverrideData*>(pData); });
 
 
 NWNX_EXPORT ArgumentStack SetOverride(ArgumentStack&& args)
@@ -112,35 +100,22 @@ NWNX_EXPORT ArgumentStack SetOverride(ArgumentStack&& args)
     {
         const auto oidCreature = args.extract<ObjectID>();
           ASSERT_OR_THROW(oidCreature != Constants::OBJECT_INVALID);
+          ASSERT_OR_THROW(Utils::GetGameObject(oidCreature));
         const auto type = args.extract<int32_t>();
           ASSERT_OR_THROW(type < OverrideType_MAX);
         const auto value = args.extract<int32_t>();
 
-        auto pCreature = Utils::GetGameObject(oidCreature);
         if (type < 0)
         {
-            if (auto appearanceOverrideData = pCreature->nwnxGet<void *>(Utils::ObjectIDToString(pPlayer->m_oidNWSObject)))
-            {
-                auto *pAOD = static_cast<AppearanceOverrideData *>(*appearanceOverrideData);
-                pCreature->nwnxRemove(Utils::ObjectIDToString(pPlayer->m_oidNWSObject));
-                delete pAOD;
-            }
+            UpdateOverrides::Remove(pPlayer->m_oidNWSObject, oidCreature, s_AppearanceOverrideType);
         }
         else
         {
-            AppearanceOverrideData *pAOD;
-            if (auto appearanceOverrideData = pCreature->nwnxGet<void *>(Utils::ObjectIDToString(pPlayer->m_oidNWSObject)))
+            auto *pAOD = static_cast<AppearanceOverrideData*>(UpdateOverrides::Get(pPlayer->m_oidNWSObject, oidCreature, s_AppearanceOverrideType));
+            if (!pAOD)
             {
-                pAOD = static_cast<AppearanceOverrideData *>(*appearanceOverrideData);
-            }
-            else
-            {
-                auto *pAppearanceOverrideData = new AppearanceOverrideData();
-                pCreature->nwnxSet(Utils::ObjectIDToString(pPlayer->m_oidNWSObject),
-                                   pAppearanceOverrideData,
-                                   [](void *p)
-                                   { delete static_cast<AppearanceOverrideData *>(p); });
-                pAOD = pAppearanceOverrideData;
+                pAOD = new AppearanceOverrideData();
+                UpdateOverrides::Set(pPlayer->m_oidNWSObject, oidCreature, s_AppearanceOverrideType, pAOD);
             }
 
             switch (type)
@@ -214,11 +189,8 @@ NWNX_EXPORT ArgumentStack GetOverride(ArgumentStack&& args)
           ASSERT_OR_THROW(type >= 0);
           ASSERT_OR_THROW(type < OverrideType_MAX);
 
-        auto pCreature = Utils::GetGameObject(oidCreature);
-        if (auto appearanceOverrideData = pCreature->nwnxGet<void*>(Utils::ObjectIDToString(pPlayer->m_oidNWSObject)))
+        if (auto *pAOD = static_cast<AppearanceOverrideData*>(UpdateOverrides::Get(pPlayer->m_oidNWSObject, oidCreature, s_AppearanceOverrideType)))
         {
-            auto *pAOD = static_cast<AppearanceOverrideData*>(*appearanceOverrideData);
-
             if(pAOD->bitSet[type])
             {
                 switch(type)
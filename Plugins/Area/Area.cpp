@@ -29,10 +29,13 @@
 
 #include <cmath>
 #include <set>
+#include <unordered_map>
 
 using namespace NWNXLib;
 using namespace NWNXLib::API;
 
+extern "C" void _ZN8CNWSAreaD1Ev(CNWSArea*);
+
 static std::set<ObjectID> s_ExportExclusionList;
 
 static constexpr int32_t MAX_REGIONS_PER_TILE = 6;
@@ -40,7 +43,6 @@ static constexpr float TILE_SIZE = 10.0f;
 static constexpr float EPSILON  = 0.0001f;
 static constexpr float MAX_TILE_EPSILON = TILE_SIZE - EPSILON;
 static constexpr float MIN_TILE_EPSILON = EPSILON;
-static std::vector<int32_t> s_pPathDepthTable;
 
 NWNX_EXPORT ArgumentStack GetNumberOfPlayersInArea(ArgumentStack&& args)
 {
@@ -1189,7 +1191,10 @@ NWNX_EXPORT ArgumentStack GetTileInfoByTileIndex(ArgumentStack&& args)
     return {id, height, orientation, x, y};
 }
 
-static bool InterTilePathDFS(CNWSArea *pArea, int32_t nDepth, uint8_t nStartX, uint8_t nStartY, uint8_t nStartRegion, uint8_t nEndX, uint8_t nEndY, uint8_t nEndRegion)
+// Calls fn(nIndex) for every tile region reachable in one step from region nRegion of tile (nX, nY),
+// where nIndex is the index of the successor in an AreaPathIndex.
+template <typename Fn>
+static void ForEachInterTileSuccessor(CNWSArea *pArea, int32_t nX, int32_t nY, uint8_t nRegion, Fn&& fn)
 {
     auto GetTile = [pArea](int32_t nX, int32_t nY) -> CNWSTile*
     {
@@ -1198,71 +1203,238 @@ static bool InterTilePathDFS(CNWSArea *pArea, int32_t nDepth, uint8_t nStartX, u
         return &pArea->m_pTile[nY * pArea->m_nWidth + nX];
     };
 
-    if (nStartX == nEndX && nStartY == nEndY && nStartRegion == nEndRegion)
-            return true;
+    auto *pTile = GetTile(nX, nY);
+    if (!pTile || !pTile->m_pTileData || !pTile->m_pTileData->m_pSurfaceMesh)
+        return;
 
-    int32_t nIndex = (nStartX + pArea->m_nWidth * nStartY) * MAX_REGIONS_PER_TILE + nStartRegion;
-    if (nIndex < 0 || nIndex >= (int32_t)s_pPathDepthTable.size() || s_pPathDepthTable[nIndex] >= nDepth)
-        return false;
+    auto *pTileSurfaceMesh = pTile->m_pTileData->m_pSurfaceMesh;
+    auto *pTilePathNode = Globals::AppManager()->m_pNWTileSetManager->GetTilePathNode(
+            pTileSurfaceMesh->GetPathNode(), pTileSurfaceMesh->GetPathNodeOrientation());
+    if (!pTilePathNode)
+        return;
+
+    float fExitX, fExitY, fNewEntranceX, fNewEntranceY;
+    int32_t nNewX, nNewY;
+
+    for (int32_t nExit = 0; nExit < pTilePathNode->m_nTileExits; nExit++)
+    {
+        if (pTilePathNode->m_pnTileExitRegion[nExit] != nRegion)
+            continue;
+
+        fExitX = pTilePathNode->m_pfTileExits[nExit * 2];
+        fExitY = pTilePathNode->m_pfTileExits[nExit * 2 + 1];
+        pTile->RotateCanonicalToReal(fExitX, fExitY, &fExitX, &fExitY);
+
+        nNewX = nX;
+        fNewEntranceX = fExitX;
+        if (fExitX > MAX_TILE_EPSILON)
+        {
+            nNewX++;
+            fNewEntranceX = 0.0f;
+        }
+        else if (fExitX < MIN_TILE_EPSILON)
+        {
+            nNewX--;
+            fNewEntranceX = TILE_SIZE;
+        }
+
+        nNewY = nY;
+        fNewEntranceY = fExitY;
+        if (fExitY > MAX_TILE_EPSILON)
+        {
+            nNewY++;
+            fNewEntranceY = 0.0f;
+        }
+        else if (fExitY < MIN_TILE_EPSILON)
+        {
+            nNewY--;
+            fNewEntranceY = TILE_SIZE;
+        }
+
+        if (auto *pNextTile = GetTile(nNewX, nNewY))
+        {
+            pNextTile->RotateRealToCanonical(fNewEntranceX, fNewEntranceY, &fNewEntranceX, &fNewEntranceY);
+            uint8_t nNewRegion = pNextTile->m_pTileData->m_pSurfaceMesh->GetRegionEntrance(fNewEntranceX, fNewEntranceY);
+
+            if (nNewRegion < MAX_REGIONS_PER_TILE)
+                fn((nNewX + pArea->m_nWidth * nNewY) * MAX_REGIONS_PER_TILE + nNewRegion);
+        }
+    }
+}
+
+// The tile region graph of an area, built on the first GetPathExists() query for the area and rebuilt
+// after one of its tiles changes.
+struct AreaPathIndex
+{
+    CNWSTile *pTiles = nullptr;
+    int32_t nWidth = 0;
+    int32_t nHeight = 0;
+    bool bTilesChanged = false;
+    bool bSymmetric = true;
+
+    std::vector<uint32_t> successorOffsets;
+    std::vector<int32_t> successors;
+    std::vector<int32_t> components;
+    std::vector<int32_t> componentSizes;
+
+    std::vector<uint32_t> visited;
+    uint32_t nVisitStamp = 0;
+};
+
+static std::unordered_map<ObjectID, AreaPathIndex> s_AreaPathIndex;
+
+// Tile changes are rare outside of area loading, and only areas that were queried have an index to check.
+static void InvalidateAreaPathIndex(CNWTile *pTile)
+{
+    for (auto& [oidArea, index] : s_AreaPathIndex)
+    {
+        if (pTile >= index.pTiles && pTile < index.pTiles + index.nWidth * index.nHeight)
+        {
+            index.bTilesChanged = true;
+            return;
+        }
+    }
+}
+
+static void BuildAreaPathIndex(CNWSArea *pArea, AreaPathIndex& index)
+{
+    const int32_t nNodes = pArea->m_nWidth * pArea->m_nHeight * MAX_REGIONS_PER_TILE;
+
+    index.pTiles = pArea->m_pTile;
+    index.nWidth = pArea->m_nWidth;
+    index.nHeight = pArea->m_nHeight;
+    index.bTilesChanged = false;
+    index.bSymmetric = true;
+    index.successorOffsets.assign(nNodes + 1, 0);
+    index.successors.clear();
 
-    s_pPathDepthTable[nIndex] = nDepth;
+    for (int32_t nIndex = 0; nIndex < nNodes; nIndex++)
+    {
+        const int32_t nTile = nIndex / MAX_REGIONS_PER_TILE;
+        ForEachInterTileSuccessor(pArea, nTile % pArea->m_nWidth, nTile / pArea->m_nWidth, nIndex % MAX_REGIONS_PER_TILE,
+            [&](int32_t nSuccessor) { index.successors.push_back(nSuccessor); });
+        index.successorOffsets[nIndex + 1] = index.successors.size();
+    }
 
-    if (nDepth == 1)
+    auto HasSuccessor = [&](int32_t nFrom, int32_t nTo) -> bool
+    {
+        for (auto i = index.successorOffsets[nFrom]; i < index.successorOffsets[nFrom + 1]; i++)
+        {
+            if (index.successors[i] == nTo)
+                return true;
+        }
         return false;
+    };
+
+    // Label the weakly connected components with a union-find; two regions in different components can
+    // never reach each other. If every edge is mirrored the components are exact reachability classes.
+    std::vector<int32_t> parent(nNodes);
+    for (int32_t i = 0; i < nNodes; i++)
+        parent[i] = i;
 
-    if (auto *pTile = GetTile(nStartX, nStartY))
+    auto Find = [&](int32_t n) -> int32_t
     {
-        auto *pTileSurfaceMesh = pTile->m_pTileData->m_pSurfaceMesh;
-        auto *pTilePathNode = Globals::AppManager()->m_pNWTileSetManager->GetTilePathNode(
-                pTileSurfaceMesh->GetPathNode(), pTileSurfaceMesh->GetPathNodeOrientation());
-        float fExitX, fExitY, fNewEntranceX, fNewEntranceY;
-        uint8_t nNewX, nNewY, nNewRegion, nExitRegion;
+        while (parent[n] != n)
+        {
+            parent[n] = parent[parent[n]];
+            n = parent[n];
+        }
+        return n;
+    };
 
-        for (int32_t nExit = 0; nExit < pTilePathNode->m_nTileExits; nExit++)
+    for (int32_t nFrom = 0; nFrom < nNodes; nFrom++)
+    {
+        for (auto i = index.successorOffsets[nFrom]; i < index.successorOffsets[nFrom + 1]; i++)
         {
-            fExitX = pTilePathNode->m_pfTileExits[nExit * 2];
-            fExitY = pTilePathNode->m_pfTileExits[nExit * 2 + 1];
-            pTile->RotateCanonicalToReal(fExitX, fExitY, &fExitX, &fExitY);
-            nExitRegion = pTilePathNode->m_pnTileExitRegion[nExit];
+            const int32_t nTo = index.successors[i];
+            if (index.bSymmetric && !HasSuccessor(nTo, nFrom))
+                index.bSymmetric = false;
+            parent[Find(nFrom)] = Find(nTo);
+        }
+    }
 
-            if (nExitRegion == nStartRegion)
-            {
-                nNewX = nStartX;
-                fNewEntranceX = fExitX;
-                if (fExitX > MAX_TILE_EPSILON)
-                {
-                    nNewX++;
-                    fNewEntranceX = 0.0f;
-                }
-                else if (fExitX < MIN_TILE_EPSILON)
-                {
-                    nNewX--;
-                    fNewEntranceX = TILE_SIZE;
-                }
+    index.components.assign(nNodes, -1);
+    index.componentSizes.clear();
+    std::vector<int32_t> rootComponent(nNodes, -1);
+    for (int32_t n = 0; n < nNodes; n++)
+    {
+        const int32_t nRoot = Find(n);
+        if (rootComponent[nRoot] == -1)
+        {
+            rootComponent[nRoot] = index.componentSizes.size();
+            index.componentSizes.push_back(0);
+        }
+        index.components[n] = rootComponent[nRoot];
+        index.componentSizes[index.components[n]]++;
+    }
 
-                nNewY = nStartY;
-                fNewEntranceY = fExitY;
-                if (fExitY > MAX_TILE_EPSILON)
-                {
-                    nNewY++;
-                    fNewEntranceY = 0.0f;
-                }
-                else if (fExitY < MIN_TILE_EPSILON)
-                {
-                    nNewY--;
-                    fNewEntranceY = TILE_SIZE;
-                }
+    index.visited.assign(nNodes, 0);
+    index.nVisitStamp = 0;
+}
 
-                if (auto *pNextTile = GetTile(nNewX, nNewY))
-                {
-                    pNextTile->RotateRealToCanonical(fNewEntranceX, fNewEntranceY, &fNewEntranceX, &fNewEntranceY);
-                    nNewRegion = pNextTile->m_pTileData->m_pSurfaceMesh->GetRegionEntrance(fNewEntranceX, fNewEntranceY);
+static AreaPathIndex& GetAreaPathIndex(CNWSArea *pArea)
+{
+    static Hooks::Hook pSetTileDataHook = Hooks::HookFunction(&CNWSTile::SetTileData,
+    +[](CNWSTile *pThis, CNWTileData *pTileData) -> void
+    {
+        InvalidateAreaPathIndex(pThis);
+        pSetTileDataHook->CallOriginal<void>(pThis, pTileData);
+    }, Hooks::Order::Early);
+
+    static Hooks::Hook pSetOrientationHook = Hooks::HookFunction(&CNWTile::SetOrientation,
+    +[](CNWTile *pThis, int32_t nOrientation) -> void
+    {
+        InvalidateAreaPathIndex(pThis);
+        pSetOrientationHook->CallOriginal<void>(pThis, nOrientation);
+    }, Hooks::Order::Early);
 
-                    if (InterTilePathDFS(pArea, nDepth - 1, nNewX, nNewY, nNewRegion, nEndX, nEndY, nEndRegion))
-                        return true;
+    static Hooks::Hook pAreaDestructorHook = Hooks::HookFunction(&_ZN8CNWSAreaD1Ev,
+    +[](CNWSArea *pThis) -> void
+    {
+        s_AreaPathIndex.erase(pThis->m_idSelf);
+        pAreaDestructorHook->CallOriginal<void>(pThis);
+    }, Hooks::Order::Early);
+
+    auto& index = s_AreaPathIndex[pArea->m_idSelf];
+    if (index.pTiles != pArea->m_pTile || index.nWidth != pArea->m_nWidth || index.nHeight != pArea->m_nHeight ||
+        index.bTilesChanged || index.successorOffsets.empty())
+    {
+        BuildAreaPathIndex(pArea, index);
+    }
+
+    return index;
+}
+
+// Breadth first search over the cached region graph; true if nEnd is at most nMaxDepth steps from nStart.
+static bool AreaPathIndexSearch(AreaPathIndex& index, int32_t nStart, int32_t nEnd, int32_t nMaxDepth)
+{
+    if (++index.nVisitStamp == 0)
+    {
+        std::fill(index.visited.begin(), index.visited.end(), 0);
+        index.nVisitStamp = 1;
+    }
+
+    std::vector<int32_t> frontier = {nStart}, next;
+    index.visited[nStart] = index.nVisitStamp;
+
+    for (int32_t nDepth = 0; nDepth < nMaxDepth && !frontier.empty(); nDepth++)
+    {
+        next.clear();
+        for (auto nNode : frontier)
+        {
+            for (auto i = index.successorOffsets[nNode]; i < index.successorOffsets[nNode + 1]; i++)
+            {
+                const int32_t nSuccessor = index.successors[i];
+                if (nSuccessor == nEnd)
+                    return true;
+                if (index.visited[nSuccessor] != index.nVisitStamp)
+                {
+                    index.visited[nSuccessor] = index.nVisitStamp;
+                    next.push_back(nSuccessor);
                 }
             }
         }
+        std::swap(frontier, next);
     }
 
     return false;
@@ -1307,10 +1479,22 @@ NWNX_EXPORT ArgumentStack GetPathExists(ArgumentStack&& args)
         if (nStartX == nEndX && nStartY == nEndY && nStartRegion == nEndRegion)
             return true;
 
-        s_pPathDepthTable.resize(pArea->m_nWidth * pArea->m_nHeight * MAX_REGIONS_PER_TILE);
-        std::fill(s_pPathDepthTable.begin(), s_pPathDepthTable.end(), 0);
+        if (nStartRegion >= MAX_REGIONS_PER_TILE || nEndRegion >= MAX_REGIONS_PER_TILE)
+            return false;
+
+        auto& index = GetAreaPathIndex(pArea);
+        const int32_t nStart = (nStartX + pArea->m_nWidth * nStartY) * MAX_REGIONS_PER_TILE + nStartRegion;
+        const int32_t nEnd = (nEndX + pArea->m_nWidth * nEndY) * MAX_REGIONS_PER_TILE + nEndRegion;
+
+        const int32_t nComponent = index.components[nStart];
+        if (nComponent != index.components[nEnd])
+            return false;
+
+        // A simple path never visits more regions than its component has.
+        if (index.bSymmetric && maxDepth >= index.componentSizes[nComponent] - 1)
+            return true;
 
-        return InterTilePathDFS(pArea, maxDepth + 1, nStartX, nStartY, nStartRegion, nEndX, nEndY, nEndRegion);
+        return AreaPathIndexSearch(index, nStart, nEnd, maxDepth);
     }
 
     return false;
@@ -11,6 +11,10 @@
 #include "API/CScriptEvent.hpp"
 #include "API/CServerAIMaster.hpp"
 
+#include <array>
+#include <cmath>
+#include <unordered_set>
+
 using namespace NWNXLib;
 using namespace NWNXLib::API;
 
@@ -23,10 +27,205 @@ static uint32_t s_Depth;
 static bool s_SkipMessage;
 static bool s_CustomHearingDistances;
 static std::string s_ChatScript = Config::Get<std::string>("CHAT_SCRIPT", "");
-static std::unordered_map<uint8_t, float> s_HearingDistances{{Constants::ChatChannel::DmTalk, 20.0f},
-                                                             {Constants::ChatChannel::PlayerTalk, 20.0f},
-                                                             {Constants::ChatChannel::DmWhisper, 3.0f},
-                                                             {Constants::ChatChannel::PlayerWhisper, 3.0f}};
+static std::array<float, 256> s_HearingDistances = []
+{
+    std::array<float, 256> hearingDistances{};
+    hearingDistances[Constants::ChatChannel::DmTalk] = 20.0f;
+    hearingDistances[Constants::ChatChannel::PlayerTalk] = 20.0f;
+    hearingDistances[Constants::ChatChannel::DmWhisper] = 3.0f;
+    hearingDistances[Constants::ChatChannel::PlayerWhisper] = 3.0f;
+    return hearingDistances;
+}();
+
+// The channels that support custom hearing distances.
+static constexpr uint8_t s_HearingChannels[] = { Constants::ChatChannel::PlayerTalk, Constants::ChatChannel::PlayerWhisper,
+                                                 Constants::ChatChannel::DmTalk, Constants::ChatChannel::DmWhisper };
+static constexpr size_t HEARING_CHANNEL_COUNT = std::size(s_HearingChannels);
+
+static int32_t GetHearingChannelIndex(uint8_t channel)
+{
+    for (size_t i = 0; i < HEARING_CHANNEL_COUNT; i++)
+    {
+        if (s_HearingChannels[i] == channel)
+            return i;
+    }
+    return -1;
+}
+
+// Per player hearing distances, negative if the server wide distance applies. The persistent POS entries
+// are only read the first time a player creature is seen, kept in sync when changed, and dropped when the
+// player leaves the world.
+using PlayerHearingDistances = std::array<float, HEARING_CHANNEL_COUNT>;
+static std::unordered_map<ObjectID, PlayerHearingDistances> s_PlayerHearingDistances;
+
+static uint64_t s_ServerLoop;
+static uint64_t s_ListenersServerLoop = ~0ull;
+
+static std::string GetHearingDistanceKey(uint8_t channel)
+{
+    return "HEARING_DISTANCE:" + std::to_string(channel);
+}
+
+static PlayerHearingDistances& GetPlayerHearingDistances(CNWSCreature *pCreature)
+{
+    static Hooks::Hook s_RemovePCFromWorldHook = Hooks::HookFunction(&CServerExoAppInternal::RemovePCFromWorld,
+        +[](CServerExoAppInternal *pServerExoAppInternal, CNWSPlayer *pPlayer) -> void
+        {
+            if (pPlayer && s_PlayerHearingDistances.erase(pPlayer->m_oidNWSObject))
+                s_ListenersServerLoop = ~0ull;
+            s_RemovePCFromWorldHook->CallOriginal<void>(pServerExoAppInternal, pPlayer);
+        }, Hooks::Order::Early);
+
+    auto it = s_PlayerHearingDistances.find(pCreature->m_idSelf);
+    if (it == s_PlayerHearingDistances.end())
+    {
+        PlayerHearingDistances hearingDistances;
+        for (size_t i = 0; i < HEARING_CHANNEL_COUNT; i++)
+        {
+            auto customHearingDistance = pCreature->nwnxGet<float>(GetHearingDistanceKey(s_HearingChannels[i]));
+            hearingDistances[i] = customHearingDistance ? *customHearingDistance : -1.0f;
+        }
+        it = s_PlayerHearingDistances.emplace(pCreature->m_idSelf, hearingDistances).first;
+    }
+    return it->second;
+}
+
+// Player creatures by area, bucketed in a grid so talk and whisper only look at the players near the
+// speaker. Rebuilt at most once per server loop iteration, the first time a message needs it.
+static constexpr float LISTENER_CELL_SIZE = 10.0f;
+
+struct Listener
+{
+    PlayerID playerId;
+    Vector position;
+    PlayerHearingDistances hearingDistances;
+};
+
+struct AreaListeners
+{
+    std::vector<Listener> listeners;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> cells;
+    // Largest distance any listener in the area hears each channel from.
+    std::array<float, HEARING_CHANNEL_COUNT> maxHearingDistances;
+};
+
+static std::unordered_map<CNWSArea*, AreaListeners> s_AreaListeners;
+
+static int32_t GetListenerCell(float coordinate)
+{
+    return static_cast<int32_t>(std::floor(coordinate / LISTENER_CELL_SIZE));
+}
+
+static uint32_t GetListenerCellKey(int32_t x, int32_t y)
+{
+    return (static_cast<uint32_t>(x & 0xFFFF) << 16) | static_cast<uint32_t>(y & 0xFFFF);
+}
+
+static void UpdateListeners()
+{
+    static Hooks::Hook s_MainLoopHook = Hooks::HookFunction(&CServerExoAppInternal::MainLoop,
+        +[](CServerExoAppInternal *pServerExoAppInternal) -> int32_t
+        {
+            ++s_ServerLoop;
+            return s_MainLoopHook->CallOriginal<int32_t>(pServerExoAppInternal);
+        }, Hooks::Order::Early);
+
+    if (s_ListenersServerLoop == s_ServerLoop)
+        return;
+    s_ListenersServerLoop = s_ServerLoop;
+
+    for (auto& [pArea, areaListeners] : s_AreaListeners)
+    {
+        areaListeners.listeners.clear();
+        areaListeners.cells.clear();
+    }
+
+    std::unordered_set<ObjectID> seen;
+    for (auto *pPlayer : Globals::AppManager()->m_pServerExoApp->GetPlayerList())
+    {
+        auto *pListenerCreature = Utils::AsNWSCreature(Utils::GetGameObject(pPlayer->m_oidNWSObject));
+
+        if (!pListenerCreature)// No valid creature, player likely on character selection, so skip them
+            continue;
+
+        seen.insert(pListenerCreature->m_idSelf);
+        auto& areaListeners = s_AreaListeners[pListenerCreature->GetArea()];
+        if (areaListeners.listeners.empty())
+        {
+            for (size_t i = 0; i < HEARING_CHANNEL_COUNT; i++)
+                areaListeners.maxHearingDistances[i] = s_HearingDistances[s_HearingChannels[i]];
+        }
+
+        const auto& hearingDistances = GetPlayerHearingDistances(pListenerCreature);
+        for (size_t i = 0; i < HEARING_CHANNEL_COUNT; i++)
+            areaListeners.maxHearingDistances[i] = std::max(areaListeners.maxHearingDistances[i], hearingDistances[i]);
+
+        const auto& position = pListenerCreature->m_vPosition;
+        areaListeners.cells[GetListenerCellKey(GetListenerCell(position.x), GetListenerCell(position.y))].push_back(areaListeners.listeners.size());
+        areaListeners.listeners.push_back({pPlayer->m_nPlayerID, position, hearingDistances});
+    }
+
+    // Drop areas and players that are gone, the POS entries are read again if a player comes back.
+    for (auto it = s_AreaListeners.begin(); it != s_AreaListeners.end();)
+        it = it->second.listeners.empty() ? s_AreaListeners.erase(it) : std::next(it);
+    for (auto it = s_PlayerHearingDistances.begin(); it != s_PlayerHearingDistances.end();)
+        it = seen.count(it->first) ? std::next(it) : s_PlayerHearingDistances.erase(it);
+}
+
+// Players in pArea that hear a message on the channel at hearingChannel index from speakerPos.
+static void GetListeners(CNWSArea *pArea, const Vector& speakerPos, size_t hearingChannel, std::vector<PlayerID>& playerIds)
+{
+    UpdateListeners();
+
+    auto it = s_AreaListeners.find(pArea);
+    if (it == s_AreaListeners.end())
+        return;
+
+    const auto& areaListeners = it->second;
+    const auto defaultDistance = s_HearingDistances[s_HearingChannels[hearingChannel]];
+
+    static std::vector<uint32_t> s_Indices;
+    s_Indices.clear();
+
+    auto TestListener = [&](uint32_t index)
+    {
+        const auto& listener = areaListeners.listeners[index];
+        const auto distance = listener.hearingDistances[hearingChannel] >= 0.0f ? listener.hearingDistances[hearingChannel] : defaultDistance;
+        if (Vector::MagnitudeSquared(listener.position - speakerPos) <= distance * distance)
+            s_Indices.push_back(index);
+    };
+
+    const auto radius = areaListeners.maxHearingDistances[hearingChannel];
+    const auto minX = GetListenerCell(speakerPos.x - radius), maxX = GetListenerCell(speakerPos.x + radius);
+    const auto minY = GetListenerCell(speakerPos.y - radius), maxY = GetListenerCell(speakerPos.y + radius);
+
+    // With huge hearing distances walking the cells costs more than testing everyone in the area.
+    if (static_cast<size_t>(maxX - minX + 1) * static_cast<size_t>(maxY - minY + 1) > areaListeners.listeners.size())
+    {
+        for (uint32_t index = 0; index < areaListeners.listeners.size(); index++)
+            TestListener(index);
+    }
+    else
+    {
+        for (auto x = minX; x <= maxX; x++)
+        {
+            for (auto y = minY; y <= maxY; y++)
+            {
+                auto cell = areaListeners.cells.find(GetListenerCellKey(x, y));
+                if (cell == areaListeners.cells.end())
+                    continue;
+
+                for (auto index : cell->second)
+                    TestListener(index);
+            }
+        }
+    }
+
+    // Listeners are indexed in player list order, which is the order the messages were always sent in.
+    std::sort(s_Indices.begin(), s_Indices.end());
+    for (auto index : s_Indices)
+        playerIds.push_back(areaListeners.listeners[index].playerId);
+}
 
 static Hooks::Hook s_SendServerToPlayerChatMessageHook = Hooks::HookFunction(
         &CNWSMessage::SendServerToPlayerChatMessage,
@@ -75,7 +274,7 @@ static Hooks::Hook s_SendServerToPlayerChatMessageHook = Hooks::HookFunction(
                         nChatMessageType == Constants::ChatChannel::DmTalk ||
                         nChatMessageType == Constants::ChatChannel::DmWhisper)
                     {
-                        auto distance = s_HearingDistances[nChatMessageType];
+                        const auto distance = s_HearingDistances[nChatMessageType];
                         auto speakerPos = Vector{0.0f, 0.0f, 0.0f};
                         CNWSArea *pSpeakerArea = nullptr;
 
@@ -86,37 +285,28 @@ static Hooks::Hook s_SendServerToPlayerChatMessageHook = Hooks::HookFunction(
                             pSpeaker->BroadcastDialog(sSpeakerMessage, distance);
                         }
 
-                        for (auto *pPlayer : Globals::AppManager()->m_pServerExoApp->GetPlayerList())
-                        {
-                            auto *pListenerCreature = Utils::AsNWSCreature(Utils::GetGameObject(pPlayer->m_oidNWSObject));
+                        static std::vector<PlayerID> s_PlayerIds;
+                        s_PlayerIds.clear();
+                        GetListeners(pSpeakerArea, speakerPos, GetHearingChannelIndex(nChatMessageType), s_PlayerIds);
 
-                            if (!pListenerCreature)// No valid creature, player likely on character selection, so skip them
-                                continue;
-
-                            if (auto customHearingDistance = pListenerCreature->nwnxGet<float>("HEARING_DISTANCE:" + std::to_string(nChatMessageType)))
-                                distance = *customHearingDistance;
-
-                            float vSquared = Vector::MagnitudeSquared(pListenerCreature->m_vPosition - speakerPos);
-
-                            if (pSpeakerArea == pListenerCreature->GetArea() && vSquared <= distance * distance)
+                        for (auto playerId : s_PlayerIds)
+                        {
+                            switch (nChatMessageType)
                             {
-                                switch (nChatMessageType)
-                                {
-                                    case Constants::ChatChannel::PlayerTalk:
-                                        thisPtr->SendServerToPlayerChat_Talk(pPlayer->m_nPlayerID, oidSpeaker, sSpeakerMessage);
-                                        break;
-                                    case Constants::ChatChannel::DmTalk:
-                                        thisPtr->SendServerToPlayerChat_DM_Talk(pPlayer->m_nPlayerID, oidSpeaker, sSpeakerMessage);
-                                        break;
-                                    case Constants::ChatChannel::PlayerWhisper:
-                                        thisPtr->SendServerToPlayerChat_Whisper(pPlayer->m_nPlayerID, oidSpeaker, sSpeakerMessage);
-                                        break;
-                                    case Constants::ChatChannel::DmWhisper:
-                                        thisPtr->SendServerToPlayerChat_DM_Whisper(pPlayer->m_nPlayerID, oidSpeaker, sSpeakerMessage);
-                                        break;
-                                    default:
-                                        break;
-                                }
+                                case Constants::ChatChannel::PlayerTalk:
+                                    thisPtr->SendServerToPlayerChat_Talk(playerId, oidSpeaker, sSpeakerMessage);
+                                    break;
+                                case Constants::ChatChannel::DmTalk:
+                                    thisPtr->SendServerToPlayerChat_DM_Talk(playerId, oidSpeaker, sSpeakerMessage);
+                                    break;
+                                case Constants::ChatChannel::PlayerWhisper:
+                                    thisPtr->SendServerToPlayerChat_Whisper(playerId, oidSpeaker, sSpeakerMessage);
+                                    break;
+                                case Constants::ChatChannel::DmWhisper:
+                                    thisPtr->SendServerToPlayerChat_DM_Whisper(playerId, oidSpeaker, sSpeakerMessage);
+                                    break;
+                                default:
+                                    break;
                             }
                         }
 
@@ -281,7 +471,8 @@ NWNX_EXPORT ArgumentStack SetChatHearingDistance(ArgumentStack &&args)
     if (playerOid == Constants::OBJECT_INVALID)
     {
         s_CustomHearingDistances = true;
-        s_HearingDistances[channel] = distance;
+        s_HearingDistances[static_cast<uint8_t>(channel)] = distance;
+        s_ListenersServerLoop = ~0ull;
     }
     else
     {
@@ -290,7 +481,14 @@ NWNX_EXPORT ArgumentStack SetChatHearingDistance(ArgumentStack &&args)
             if (auto *pCreature = Utils::AsNWSCreature(Utils::GetGameObject(pPlayer->m_oidNWSObject)))
             {
                 s_CustomHearingDistances = true;
-                pCreature->nwnxSet("HEARING_DISTANCE:" + std::to_string(channel), distance, true);
+                pCreature->nwnxSet(GetHearingDistanceKey(channel), distance, true);
+
+                const auto hearingChannel = GetHearingChannelIndex(channel);
+                if (hearingChannel >= 0)
+                {
+                    GetPlayerHearingDistances(pCreature)[hearingChannel] = distance;
+                    s_ListenersServerLoop = ~0ull;
+                }
             }
         }
         else
@@ -306,7 +504,7 @@ NWNX_EXPORT ArgumentStack GetChatHearingDistance(ArgumentStack &&args)
 {
     const auto playerOid = args.extract<ObjectID>();
     const auto channel = (Constants::ChatChannel::TYPE)args.extract<int32_t>();
-    float retVal = s_HearingDistances[channel];
+    float retVal = s_HearingDistances[static_cast<uint8_t>(channel)];
 
     if (playerOid != Constants::OBJECT_INVALID)
     {
@@ -314,7 +512,14 @@ NWNX_EXPORT ArgumentStack GetChatHearingDistance(ArgumentStack &&args)
         {
             if (auto *pCreature = Utils::AsNWSCreature(Utils::GetGameObject(pPlayer->m_oidNWSObject)))
             {
-                if (auto customHearingDistance = pCreature->nwnxGet<float>("HEARING_DISTANCE:" + std::to_string(channel)))
+                const auto hearingChannel = GetHearingChannelIndex(channel);
+                if (hearingChannel >= 0)
+                {
+                    const auto customHearingDistance = GetPlayerHearingDistances(pCreature)[hearingChannel];
+                    if (customHearingDistance >= 0.0f)
+                        retVal = customHearingDistance;
+                }
+                else if (auto customHearingDistance = pCreature->nwnxGet<float>(GetHearingDistanceKey(channel)))
                 {
                     retVal = *customHearingDistance;
                 }
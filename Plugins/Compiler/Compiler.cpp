@@ -5,23 +5,67 @@
 #include "API/CExoBase.hpp"
 #include "API/CExoResMan.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <csignal>
 #include <dirent.h>
 #include <fstream>
+#include <poll.h>
+#include <regex>
+#include <sstream>
 #include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
 #include <sys/stat.h>
+#include <sys/wait.h>
 
 namespace Compiler
 {
 using namespace NWNXLib;
 using namespace API;
 
+static constexpr const char* MANIFEST_FILE = "nwnx_compiler.manifest";
+
+struct SourceFile
+{
+    std::string scriptName;
+    std::string path;
+    size_t size = 0;
+    uint64_t contentHash = 0;
+    std::vector<std::string> includes;
+};
+
+struct CompileResult
+{
+    int32_t result;
+    uint32_t milliseconds;
+    std::string error;
+};
+
+// Input hash of every script as of its last successful compile. Include files are recorded too, so an
+// unchanged include isn't tried again on every run.
+struct ManifestEntry
+{
+    uint64_t inputHash;
+    bool include;
+};
+using Manifest = std::unordered_map<std::string, ManifestEntry>;
+using SourceMap = std::unordered_map<std::string, SourceFile>;
+
 static bool DirectoryExists(const std::string& path);
-static bool CompiledOutputIsNewer(const std::string& sourceFile, const std::string& outputFile);
+static bool FileExists(const std::string& path);
 static std::vector<std::string> GetFiles(const std::string& path, const std::string& extension);
+static SourceMap ScanSources(const std::string& sourcePath);
+static uint64_t GetInputHash(const std::string& scriptKey, const SourceMap& sources,
+                             std::unordered_map<std::string, uint64_t>& inputHashes, std::unordered_set<std::string>& visiting);
+static Manifest LoadManifest(const std::string& outputPath);
+static void SaveManifest(const std::string& outputPath, const Manifest& manifest);
 static void CleanOutput(const std::string& outputPath);
 static void CreateResourceDirectory(const CExoString& alias, const std::string& path, uint32_t priority);
 static std::unique_ptr<CScriptCompiler> CreateAndConfigureCompiler(const CExoString&);
-static int Compile(const std::string& sourcePath, const std::string& outputPath, std::unique_ptr<CScriptCompiler> scriptCompiler);
+static CompileResult CompileScript(CScriptCompiler& scriptCompiler, const std::string& scriptName);
+static int Compile(const std::string& sourcePath, const std::string& outputPath, const CExoString& outputAlias);
 
 void Compiler() __attribute__((constructor));
 
@@ -79,7 +123,7 @@ void Compiler()
         CreateResourceDirectory(sourceAlias, sourcePath, 90000001);
         CreateResourceDirectory(outputAlias, outputPath, 90000000);
 
-        const auto result = Compile(sourcePath, outputPath, CreateAndConfigureCompiler(outputAlias));
+        const auto result = Compile(sourcePath, outputPath, outputAlias);
 
         if (Config::Get<bool>("EXIT_ON_COMPLETE", true))
         {
@@ -100,14 +144,10 @@ static bool DirectoryExists(const std::string& path)
     return access(path.c_str(), F_OK) == 0;
 }
 
-static bool CompiledOutputIsNewer(const std::string& sourceFile, const std::string& outputFile)
+static bool FileExists(const std::string& path)
 {
-    struct stat sourceInfo{};
-    struct stat outputInfo{};
-
-    stat(sourceFile.c_str(), &sourceInfo);
-
-    return stat(outputFile.c_str(), &outputInfo) == 0 && outputInfo.st_mtim.tv_sec > sourceInfo.st_mtim.tv_sec;
+    struct stat info{};
+    return stat(path.c_str(), &info) == 0;
 }
 
 static std::vector<std::string> GetFiles(const std::string& path, const std::string& extension)
@@ -130,13 +170,118 @@ static std::vector<std::string> GetFiles(const std::string& path, const std::str
     return files;
 }
 
+static uint64_t HashBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+{
+    // FNV-1a, stable across runs and builds unlike std::hash.
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= static_cast<const uint8_t*>(data)[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static std::string GetScriptKey(const std::string& name)
+{
+    auto key = String::Basename(name);
+    std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+    return key;
+}
+
+static SourceMap ScanSources(const std::string& sourcePath)
+{
+    static const std::regex includeRegex(R"re(^\s*#include\s+"([^"]+)")re");
+
+    SourceMap sources;
+    for (const auto& file : GetFiles(sourcePath, ".nss"))
+    {
+        SourceFile source;
+        source.scriptName = String::Basename(file);
+        source.path = sourcePath + "/" + file;
+
+        std::ifstream sourceStream(source.path);
+        std::string sourceContent((std::istreambuf_iterator<char>(sourceStream)), std::istreambuf_iterator<char>());
+        source.size = sourceContent.size();
+        source.contentHash = HashBytes(sourceContent.data(), sourceContent.size());
+
+        std::istringstream lines(sourceContent);
+        std::string line;
+        std::smatch match;
+        while (std::getline(lines, line))
+        {
+            if (line.find("#include") != std::string::npos && std::regex_search(line, match, includeRegex))
+                source.includes.emplace_back(GetScriptKey(match[1].str()));
+        }
+        std::sort(source.includes.begin(), source.includes.end());
+        source.includes.erase(std::unique(source.includes.begin(), source.includes.end()), source.includes.end());
+
+        sources.emplace(GetScriptKey(file), std::move(source));
+    }
+    return sources;
+}
+
+// Hash of a script and everything it includes from the source directory, transitively. Includes that
+// aren't in the source directory come from the game resources and only contribute their name.
+static uint64_t GetInputHash(const std::string& scriptKey, const SourceMap& sources,
+                             std::unordered_map<std::string, uint64_t>& inputHashes, std::unordered_set<std::string>& visiting)
+{
+    if (auto it = inputHashes.find(scriptKey); it != inputHashes.end())
+        return it->second;
+
+    auto source = sources.find(scriptKey);
+    if (source == sources.end())
+        return HashBytes(scriptKey.data(), scriptKey.size());
+
+    // The compiler rejects recursive includes, a cycle just needs to terminate here.
+    if (!visiting.insert(scriptKey).second)
+        return source->second.contentHash;
+
+    uint64_t hash = source->second.contentHash;
+    for (const auto& include : source->second.includes)
+    {
+        const auto includeHash = GetInputHash(include, sources, inputHashes, visiting);
+        hash = HashBytes(&includeHash, sizeof(includeHash), hash);
+    }
+
+    visiting.erase(scriptKey);
+    inputHashes[scriptKey] = hash;
+    return hash;
+}
+
+static Manifest LoadManifest(const std::string& outputPath)
+{
+    Manifest manifest;
+    std::ifstream manifestStream(outputPath + "/" + MANIFEST_FILE);
+    std::string scriptKey;
+    uint64_t inputHash;
+    char kind;
+    while (manifestStream >> scriptKey >> std::hex >> inputHash >> kind)
+    {
+        manifest[scriptKey] = {inputHash, kind == 'I'};
+    }
+    return manifest;
+}
+
+static void SaveManifest(const std::string& outputPath, const Manifest& manifest)
+{
+    std::vector<std::pair<std::string, ManifestEntry>> entries(manifest.begin(), manifest.end());
+    std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::ofstream manifestStream(outputPath + "/" + MANIFEST_FILE, std::ios::trunc);
+    for (const auto& [scriptKey, entry] : entries)
+    {
+        manifestStream << scriptKey << " " << std::hex << entry.inputHash << " " << (entry.include ? 'I' : 'S') << "\n";
+    }
+}
+
 static void CleanOutput(const std::string& outputPath)
 {
     const auto files = GetFiles(outputPath, ".ncs");
     for (const auto& file : files)
     {
-        remove(file.c_str());
+        remove((outputPath + "/" + file).c_str());
     }
+    remove((outputPath + "/" + MANIFEST_FILE).c_str());
 }
 
 static void CreateResourceDirectory(const CExoString& alias, const std::string& path, uint32_t priority)
@@ -164,61 +309,251 @@ static std::unique_ptr<CScriptCompiler> CreateAndConfigureCompiler(const CExoStr
     return scriptCompiler;
 }
 
-static int Compile(const std::string& sourcePath, const std::string& outputPath, std::unique_ptr<CScriptCompiler> scriptCompiler)
+static bool IsIncludeOnly(const std::string& error)
+{
+    return String::EndsWith(error, "NO FUNCTION MAIN() IN SCRIPT\n");
+}
+
+static CompileResult CompileScript(CScriptCompiler& scriptCompiler, const std::string& scriptName)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const auto result = scriptCompiler.CompileFile(scriptName);
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    return {result, (uint32_t)elapsed.count(), result == 0 ? "" : scriptCompiler.m_sCapturedError.CStr()};
+}
+
+// The resource manager and the compiler aren't thread safe, so parallel jobs are forked processes that
+// share the loaded resources copy-on-write. Each job compiles its share of the scripts with its own
+// compiler and reports the results back over a pipe; only the parent logs.
+static void CompileInJob(int fd, const std::vector<std::pair<uint32_t, std::string>>& scripts, const CExoString& outputAlias, bool continueOnError)
+{
+    auto scriptCompiler = CreateAndConfigureCompiler(outputAlias);
+
+    auto Write = [fd](const void* data, size_t size)
+    {
+        auto* bytes = static_cast<const char*>(data);
+        while (size > 0)
+        {
+            const auto written = write(fd, bytes, size);
+            if (written <= 0)
+                _exit(2);
+            bytes += written;
+            size -= written;
+        }
+    };
+
+    for (const auto& [index, scriptName] : scripts)
+    {
+        const auto compileResult = CompileScript(*scriptCompiler, scriptName);
+        const uint32_t header[4] = { index, (uint32_t)compileResult.result, compileResult.milliseconds, (uint32_t)compileResult.error.size() };
+        Write(header, sizeof(header));
+        Write(compileResult.error.data(), compileResult.error.size());
+
+        if (compileResult.result != 0 && !continueOnError && !IsIncludeOnly(compileResult.error))
+            break;
+    }
+}
+
+static int Compile(const std::string& sourcePath, const std::string& outputPath, const CExoString& outputAlias)
 {
     const auto continueOnError = Config::Get<bool>("CONTINUE_ON_ERROR", false);
+    const auto jobs = std::max(1, Config::Get<int>("JOBS", 1));
     auto exitCode = 0;
 
-    const auto sourceFiles = GetFiles(sourcePath, ".nss");
+    const auto scanStart = std::chrono::steady_clock::now();
+    const auto sources = ScanSources(sourcePath);
+    auto manifest = LoadManifest(outputPath);
+
+    // Compile every script whose transitive inputs changed since its last successful compile, or whose
+    // output is missing.
+    std::unordered_map<std::string, uint64_t> inputHashes;
+    std::unordered_set<std::string> visiting;
+    std::vector<const SourceFile*> stale;
+    for (const auto& [scriptKey, source] : sources)
+    {
+        const auto inputHash = GetInputHash(scriptKey, sources, inputHashes, visiting);
+        auto entry = manifest.find(scriptKey);
+        if (entry != manifest.end() && entry->second.inputHash == inputHash &&
+            (entry->second.include || FileExists(outputPath + "/" + source.scriptName + ".ncs")))
+        {
+            continue;
+        }
+        manifest.erase(scriptKey);
+        stale.push_back(&source);
+    }
+    std::sort(stale.begin(), stale.end(), [](auto* a, auto* b) { return a->scriptName < b->scriptName; });
 
-    const auto fileCount = sourceFiles.size();
+    // Forget scripts that were deleted from the source directory.
+    for (auto it = manifest.begin(); it != manifest.end();)
+    {
+        it = sources.count(it->first) ? std::next(it) : manifest.erase(it);
+    }
+
+    LOG_INFO("%i of %i scripts need compiling. Dependency scan took %i ms.", stale.size(), sources.size(),
+             std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - scanStart).count());
+
+    const auto fileCount = stale.size();
     auto progress = 0;
+    uint64_t compileMilliseconds = 0;
 
-    for (const auto& sourceFile : sourceFiles)
+    // Returns false if compilation should stop.
+    auto HandleResult = [&](const SourceFile& source, const CompileResult& compileResult) -> bool
     {
         ++progress;
-        auto scriptName = String::Basename(sourceFile);
-
-        auto sourceFilePath = sourcePath;
-        sourceFilePath.append("/").append(sourceFile);
+        compileMilliseconds += compileResult.milliseconds;
+        const auto scriptKey = GetScriptKey(source.scriptName);
 
-        auto outFilePath = outputPath;
-        outFilePath.append("/").append(scriptName).append(".ncs");
+        if (compileResult.result == 0)
+        {
+            LOG_INFO("[%i/%i] Succeeded: %s (%i ms)", progress, fileCount, source.scriptName, compileResult.milliseconds);
+            manifest[scriptKey] = {inputHashes[scriptKey], false};
+            return true;
+        }
 
-        if (CompiledOutputIsNewer(sourceFilePath, outFilePath))
+        if (IsIncludeOnly(compileResult.error))
         {
-            continue;
+            LOG_INFO("[%i/%i] Skipping include file %s: The file does not define a main() or StartingConditional() function.", progress, fileCount, source.path);
+            manifest[scriptKey] = {inputHashes[scriptKey], true};
+            return true;
         }
 
-        LOG_INFO("[%i/%i] Compiling: %s", progress, fileCount, sourceFilePath.c_str());
+        exitCode = compileResult.result;
+        LOG_ERROR("[%i/%i] Failed: %s (%i ms): %s", progress, fileCount, source.path, compileResult.milliseconds, compileResult.error);
+        return continueOnError;
+    };
 
-        std::ifstream sourceStream(sourceFilePath);
-        std::string sourceContent((std::istreambuf_iterator<char>(sourceStream)), std::istreambuf_iterator<char>());
+    const auto compileStart = std::chrono::steady_clock::now();
 
-        const auto compileResult = scriptCompiler->CompileFile(scriptName);
-        if (compileResult == 0)
+    if (jobs == 1 || stale.size() < 2)
+    {
+        auto scriptCompiler = CreateAndConfigureCompiler(outputAlias);
+        for (const auto* source : stale)
         {
-            LOG_INFO("[%i/%i] Succeeded: %s", progress, fileCount, outFilePath);
+            LOG_DEBUG("Compiling: %s", source->path);
+            if (!HandleResult(*source, CompileScript(*scriptCompiler, source->scriptName)))
+                break;
         }
-        else
+    }
+    else
+    {
+        // Largest scripts first, each to the job with the least source queued so far.
+        std::vector<uint32_t> order(stale.size());
+        for (uint32_t i = 0; i < order.size(); i++)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return stale[a]->size > stale[b]->size; });
+
+        const size_t jobCount = std::min<size_t>(jobs, stale.size());
+        std::vector<std::vector<std::pair<uint32_t, std::string>>> jobScripts(jobCount);
+        std::vector<size_t> jobSizes(jobCount, 0);
+        for (auto index : order)
         {
-            const auto* error = scriptCompiler->m_sCapturedError.CStr();
+            const auto job = std::min_element(jobSizes.begin(), jobSizes.end()) - jobSizes.begin();
+            jobScripts[job].emplace_back(index, stale[index]->scriptName);
+            jobSizes[job] += stale[index]->size;
+        }
+
+        LOG_INFO("Compiling with %i parallel jobs.", jobCount);
+        // The jobs are forked, they mustn't inherit the writer thread's locks or anything still queued.
+        Log::SuspendAsyncWriter();
+
+        std::vector<pid_t> pids;
+        std::vector<pollfd> pipes;
+        for (size_t job = 0; job < jobCount; job++)
+        {
+            int fds[2];
+            if (pipe(fds) != 0)
+            {
+                Log::ResumeAsyncWriter();
+                throw std::runtime_error("Unable to create a pipe for a compile job.");
+            }
+
+            const auto pid = fork();
+            if (pid < 0)
+            {
+                Log::ResumeAsyncWriter();
+                throw std::runtime_error("Unable to fork a compile job.");
+            }
 
-            if (String::EndsWith(error, "NO FUNCTION MAIN() IN SCRIPT\n"))
+            if (pid == 0)
             {
-                LOG_INFO("Skipping include file %s: The file does not define a main() or StartingConditional() function.", sourceFilePath);
+                Log::DisableLogging();
+                close(fds[0]);
+                CompileInJob(fds[1], jobScripts[job], outputAlias, continueOnError);
+                close(fds[1]);
+                _exit(0);
+            }
+
+            close(fds[1]);
+            pids.push_back(pid);
+            pipes.push_back({fds[0], POLLIN, 0});
+        }
+        Log::ResumeAsyncWriter();
+
+        std::vector<std::string> buffers(jobCount);
+        bool keepGoing = true;
+        size_t openPipes = pipes.size();
+        while (openPipes > 0)
+        {
+            if (poll(pipes.data(), pipes.size(), -1) < 0)
                 continue;
+
+            for (size_t job = 0; job < pipes.size(); job++)
+            {
+                if (pipes[job].fd < 0 || !(pipes[job].revents & (POLLIN | POLLHUP | POLLERR)))
+                    continue;
+
+                char chunk[4096];
+                const auto bytes = read(pipes[job].fd, chunk, sizeof(chunk));
+                if (bytes <= 0)
+                {
+                    close(pipes[job].fd);
+                    pipes[job].fd = -1;
+                    openPipes--;
+                    continue;
+                }
+
+                auto& buffer = buffers[job];
+                buffer.append(chunk, bytes);
+
+                uint32_t header[4];
+                while (buffer.size() >= sizeof(header))
+                {
+                    std::memcpy(header, buffer.data(), sizeof(header));
+                    if (buffer.size() < sizeof(header) + header[3])
+                        break;
+
+                    CompileResult compileResult{(int32_t)header[1], header[2], buffer.substr(sizeof(header), header[3])};
+                    buffer.erase(0, sizeof(header) + header[3]);
+
+                    if (keepGoing && !HandleResult(*stale[header[0]], compileResult))
+                    {
+                        keepGoing = false;
+                        for (auto pid : pids)
+                            kill(pid, SIGTERM);
+                    }
+                }
             }
+        }
 
-            exitCode = compileResult;
-            LOG_ERROR("Failed: %s", error);
-            if (!continueOnError)
+        for (auto pid : pids)
+        {
+            int status;
+            waitpid(pid, &status, 0);
+            if (keepGoing && (!WIFEXITED(status) || WEXITSTATUS(status) != 0))
             {
-                break;
+                LOG_ERROR("A compile job terminated abnormally.");
+                exitCode = exitCode ? exitCode : -1;
             }
         }
     }
 
+    SaveManifest(outputPath, manifest);
+
+    LOG_INFO("Compiled %i scripts in %i ms, %i ms of compile time.", progress,
+             std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - compileStart).count(),
+             compileMilliseconds);
+
     return exitCode;
 }
 }
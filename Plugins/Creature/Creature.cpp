@@ -1833,76 +1833,138 @@ NWNX_EXPORT ArgumentStack JumpToLimbo(ArgumentStack&& args)
     return {};
 }
 
-static void InitCriticalMultiplierHook()
+// Critical hit and effect immunity bypass values of a creature, mirrored from its POS so the combat hooks don't
+// have to build and look up variable names on every attack.
+struct CombatOverrides
 {
-    static Hooks::Hook pGetCriticalHitMultiplier_hook =
-        Hooks::HookFunction(&CNWSCreatureStats::GetCriticalHitMultiplier,
-        +[](CNWSCreatureStats *pThis, int32_t bOffHand = false) -> int32_t
+    struct CriticalValue
+    {
+        int32_t hand;
+        int32_t baseItem; // -1 for any base item
+        int32_t value;
+    };
+    std::vector<CriticalValue> multiplierOverride;
+    std::vector<CriticalValue> multiplierModifier;
+    std::vector<CriticalValue> rangeOverride;
+    std::vector<CriticalValue> rangeModifier;
+    std::vector<std::pair<int32_t, int32_t>> bypassIn; // {immunity type, chance}
+    std::vector<std::pair<int32_t, int32_t>> bypassOut;
+};
+
+static void LoadCombatOverrides(CGameObject *pGameObject, CombatOverrides& overrides)
+{
+    POS::ForEachInt(pGameObject, PLUGIN_NAME, "CRITICAL_",
+        [&](const std::string& key, int32_t value)
+        {
+            // CRITICAL_<MULTIPLIER|RANGE>_<OVERRIDE|MODIFIER>!<hand>[!BI<baseitem>]
+            const auto handPos = key.find('!');
+            if (handPos == std::string::npos)
+                return;
+
+            std::vector<CombatOverrides::CriticalValue> *pValues;
+            const auto name = key.substr(0, handPos);
+            if (name == "CRITICAL_MULTIPLIER_OVERRIDE")
+                pValues = &overrides.multiplierOverride;
+            else if (name == "CRITICAL_MULTIPLIER_MODIFIER")
+                pValues = &overrides.multiplierModifier;
+            else if (name == "CRITICAL_RANGE_OVERRIDE")
+                pValues = &overrides.rangeOverride;
+            else if (name == "CRITICAL_RANGE_MODIFIER")
+                pValues = &overrides.rangeModifier;
+            else
+                return;
+
+            const auto baseItemPos = key.find("!BI", handPos + 1);
+            const auto hand = String::FromString<int32_t>(key.substr(handPos + 1, baseItemPos - handPos - 1));
+            const auto baseItem = baseItemPos == std::string::npos ? std::optional<int32_t>(-1) : String::FromString<int32_t>(key.substr(baseItemPos + 3));
+            if (hand && baseItem)
+                pValues->push_back({*hand, *baseItem, value});
+        });
+
+    POS::ForEachInt(pGameObject, PLUGIN_NAME, "BYPASS_EFF_IMM_",
+        [&](const std::string& key, int32_t value)
         {
-            int32_t retVal;
-            if (!bOffHand) //mainhand
+            static const std::string in = "BYPASS_EFF_IMM_IN", out = "BYPASS_EFF_IMM_OUT";
+            if (key.compare(0, in.size(), in) == 0)
             {
-                auto pItem = pThis->m_pBaseCreature->m_pInventory->GetItemInSlot(Constants::EquipmentSlot::RightHand);
-                std::string baseitem;
-                if (!pItem)
-                    baseitem = std::to_string(Constants::BaseItem::Gloves);
-                else
-                    baseitem = std::to_string(pItem->m_nBaseItem);
-
-                if (auto critMultOvr = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_MULTIPLIER_OVERRIDE!1!BI" + baseitem))
-                    retVal = critMultOvr.value();
-                else if (auto critMultOvr = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_MULTIPLIER_OVERRIDE!0!BI" + baseitem))
-                    retVal = critMultOvr.value();
-                else if (auto critMultOvr = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_MULTIPLIER_OVERRIDE!1"))
-                    retVal = critMultOvr.value();
-                else if (auto critMultOvr = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_MULTIPLIER_OVERRIDE!0"))
-                    retVal = critMultOvr.value();
-                else
-                    retVal = pGetCriticalHitMultiplier_hook->CallOriginal<int32_t>(pThis, bOffHand);
-
-                //Override-Modifier gap
-                if (auto critMultMod = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_MULTIPLIER_MODIFIER!1!BI" + baseitem))
-                    retVal = retVal + critMultMod.value();
-                if (auto critMultMod = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_MULTIPLIER_MODIFIER!0!BI" + baseitem))
-                    retVal = retVal + critMultMod.value();
-                if (auto critMultMod = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_MULTIPLIER_MODIFIER!1"))
-                    retVal = retVal + critMultMod.value();
-                if (auto critMultMod = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_MULTIPLIER_MODIFIER!0"))
-                    retVal = retVal + critMultMod.value();
+                if (auto type = String::FromString<int32_t>(key.substr(in.size())))
+                    overrides.bypassIn.emplace_back(*type, value);
             }
-            else //Offhand
+            else if (key.compare(0, out.size(), out) == 0)
             {
-                auto pItem = pThis->m_pBaseCreature->m_pInventory->GetItemInSlot(Constants::EquipmentSlot::LeftHand);
-                if (!pItem) // Could be a double-sided weapon
-                    pItem = pThis->m_pBaseCreature->m_pInventory->GetItemInSlot(Constants::EquipmentSlot::RightHand);
-
-                std::string baseitem;
-                if (!pItem)
-                    baseitem = std::to_string(Constants::BaseItem::Gloves);
-                else
-                    baseitem = std::to_string(pItem->m_nBaseItem);
-
-                if (auto critMultOvr = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_MULTIPLIER_OVERRIDE!2!BI" + baseitem))
-                    retVal = critMultOvr.value();
-                else if (auto critMultOvr = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_MULTIPLIER_OVERRIDE!0!BI" + baseitem))
-                    retVal = critMultOvr.value();
-                else if (auto critMultOvr = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_MULTIPLIER_OVERRIDE!2"))
-                    retVal = critMultOvr.value();
-                else if (auto critMultOvr = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_MULTIPLIER_OVERRIDE!0"))
-                    retVal = critMultOvr.value();
-                else
-                    retVal = pGetCriticalHitMultiplier_hook->CallOriginal<int32_t>(pThis, bOffHand);
-
-                //Override-Modifier gap
-                if (auto critMultMod = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_MULTIPLIER_MODIFIER!2!BI" + baseitem))
-                    retVal = retVal + critMultMod.value();
-                if (auto critMultMod = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_MULTIPLIER_MODIFIER!0!BI" + baseitem))
-                    retVal = retVal + critMultMod.value();
-                if (auto critMultMod = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_MULTIPLIER_MODIFIER!2"))
-                    retVal = retVal + critMultMod.value();
-                if (auto critMultMod = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_MULTIPLIER_MODIFIER!0"))
-                    retVal = retVal + critMultMod.value();
+                if (auto type = String::FromString<int32_t>(key.substr(out.size())))
+                    overrides.bypassOut.emplace_back(*type, value);
             }
+        });
+}
+
+static POS::Extension<CombatOverrides> s_CombatOverrides(&LoadCombatOverrides);
+
+// Overrides are tried in the order (hand, base item), (any hand, base item), (hand), (any hand).
+static std::optional<int32_t> GetCriticalOverride(const std::vector<CombatOverrides::CriticalValue>& values, int32_t hand, int32_t baseItem)
+{
+    std::optional<int32_t> retVal;
+    int32_t bestRank = 4;
+    for (const auto& value : values)
+    {
+        if ((value.hand != hand && value.hand != 0) || (value.baseItem != baseItem && value.baseItem != -1))
+            continue;
+
+        const int32_t rank = (value.baseItem == -1) * 2 + (value.hand == 0);
+        if (rank < bestRank)
+        {
+            bestRank = rank;
+            retVal = value.value;
+        }
+    }
+    return retVal;
+}
+
+static int32_t GetCriticalModifier(const std::vector<CombatOverrides::CriticalValue>& values, int32_t hand, int32_t baseItem)
+{
+    int32_t retVal = 0;
+    for (const auto& value : values)
+    {
+        if ((value.hand == hand || value.hand == 0) && (value.baseItem == baseItem || value.baseItem == -1))
+            retVal += value.value;
+    }
+    return retVal;
+}
+
+static int32_t GetCriticalBaseItem(CNWSCreatureStats *pThis, int32_t bOffHand)
+{
+    auto *pInventory = pThis->m_pBaseCreature->m_pInventory;
+    auto *pItem = bOffHand ? pInventory->GetItemInSlot(Constants::EquipmentSlot::LeftHand) : nullptr;
+    if (!pItem) // Mainhand, or offhand could be a double-sided weapon
+        pItem = pInventory->GetItemInSlot(Constants::EquipmentSlot::RightHand);
+
+    return pItem ? (int32_t)pItem->m_nBaseItem : (int32_t)Constants::BaseItem::Gloves;
+}
+
+template <typename F>
+static int32_t GetCriticalValue(CNWSCreatureStats *pThis, int32_t bOffHand,
+                                const std::vector<CombatOverrides::CriticalValue>& overrides,
+                                const std::vector<CombatOverrides::CriticalValue>& modifiers, F&& callOriginal)
+{
+    if (overrides.empty() && modifiers.empty())
+        return callOriginal();
+
+    const int32_t hand = bOffHand ? 2 : 1;
+    const int32_t baseItem = GetCriticalBaseItem(pThis, bOffHand);
+    auto retVal = GetCriticalOverride(overrides, hand, baseItem);
+    //Override-Modifier gap
+    return (retVal ? *retVal : callOriginal()) + GetCriticalModifier(modifiers, hand, baseItem);
+}
+
+static void InitCriticalMultiplierHook()
+{
+    static Hooks::Hook pGetCriticalHitMultiplier_hook =
+        Hooks::HookFunction(&CNWSCreatureStats::GetCriticalHitMultiplier,
+        +[](CNWSCreatureStats *pThis, int32_t bOffHand = false) -> int32_t
+        {
+            auto *pOverrides = s_CombatOverrides.Get(pThis->m_pBaseCreature);
+            const auto retVal = GetCriticalValue(pThis, bOffHand, pOverrides->multiplierOverride, pOverrides->multiplierModifier,
+                [&]() { return pGetCriticalHitMultiplier_hook->CallOriginal<int32_t>(pThis, bOffHand); });
 
             return retVal > 0 ? retVal : 0;
         }, Hooks::Order::Late);
@@ -1936,6 +1998,7 @@ NWNX_EXPORT ArgumentStack SetCriticalMultiplierModifier(ArgumentStack&& args)
         else
             pCreature->nwnxRemove(varname);
 
+        s_CombatOverrides.Reset(pCreature);
         pCreature->m_pStats->UpdateCombatInformation();
     }
     return {};
@@ -1988,6 +2051,7 @@ NWNX_EXPORT ArgumentStack SetCriticalMultiplierOverride(ArgumentStack&& args)
         else
             pCreature->nwnxRemove(varname);
 
+        s_CombatOverrides.Reset(pCreature);
         pCreature->m_pStats->UpdateCombatInformation();
     }
     return {};
@@ -2020,70 +2084,10 @@ static void InitCriticalRangeHook()
         Hooks::HookFunction(&CNWSCreatureStats::GetCriticalHitRoll,
         +[](CNWSCreatureStats *pThis, int32_t bOffHand = false) -> int32_t
         {
-            int32_t retVal;
-            if (!bOffHand) //mainhand
-            {
-                auto pItem = pThis->m_pBaseCreature->m_pInventory->GetItemInSlot(Constants::EquipmentSlot::RightHand);
-                std::string baseitem;
-                if (!pItem)
-                    baseitem = std::to_string(Constants::BaseItem::Gloves);
-                else
-                    baseitem = std::to_string(pItem->m_nBaseItem);
-
-                if (auto critRngOvr = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_RANGE_OVERRIDE!1!BI" + baseitem))
-                    retVal = critRngOvr.value();
-                else if (auto critRngOvr = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_RANGE_OVERRIDE!0!BI" + baseitem))
-                    retVal = critRngOvr.value();
-                else if (auto critRngOvr = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_RANGE_OVERRIDE!1"))
-                    retVal = critRngOvr.value();
-                else if (auto critRngOvr = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_RANGE_OVERRIDE!0"))
-                    retVal = critRngOvr.value();
-                else
-                    retVal = pGetCriticalHitRoll_hook->CallOriginal<int32_t>(pThis, bOffHand);
-
-                //Override-Modifier gap
-                if (auto critRngMod = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_RANGE_MODIFIER!1!BI" + baseitem))
-                    retVal = retVal + critRngMod.value();
-                if (auto critRngMod = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_RANGE_MODIFIER!0!BI" + baseitem))
-                    retVal = retVal + critRngMod.value();
-                if (auto critRngMod = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_RANGE_MODIFIER!1"))
-                    retVal = retVal + critRngMod.value();
-                if (auto critRngMod = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_RANGE_MODIFIER!0"))
-                    retVal = retVal + critRngMod.value();
-            }
-            else //Offhand
-            {
-                auto pItem = pThis->m_pBaseCreature->m_pInventory->GetItemInSlot(Constants::EquipmentSlot::LeftHand);
-                if (!pItem) // Could be a double-sided weapon
-                    pItem = pThis->m_pBaseCreature->m_pInventory->GetItemInSlot(Constants::EquipmentSlot::RightHand);
+            auto *pOverrides = s_CombatOverrides.Get(pThis->m_pBaseCreature);
+            const auto retVal = GetCriticalValue(pThis, bOffHand, pOverrides->rangeOverride, pOverrides->rangeModifier,
+                [&]() { return pGetCriticalHitRoll_hook->CallOriginal<int32_t>(pThis, bOffHand); });
 
-                std::string baseitem;
-                if (!pItem)
-                    baseitem = std::to_string(Constants::BaseItem::Gloves);
-                else
-                    baseitem = std::to_string(pItem->m_nBaseItem);
-
-                if (auto critRngOvr = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_RANGE_OVERRIDE!2!BI" + baseitem))
-                    retVal = critRngOvr.value();
-                else if (auto critRngOvr = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_RANGE_OVERRIDE!0!BI" + baseitem))
-                    retVal = critRngOvr.value();
-                else if (auto critRngOvr = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_RANGE_OVERRIDE!2"))
-                    retVal = critRngOvr.value();
-                else if (auto critRngOvr = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_RANGE_OVERRIDE!0"))
-                    retVal = critRngOvr.value();
-                else
-                    retVal = pGetCriticalHitRoll_hook->CallOriginal<int32_t>(pThis, bOffHand);
-
-                //Override-Modifier gap
-                if (auto critRngMod = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_RANGE_MODIFIER!2!BI" + baseitem))
-                    retVal = retVal + critRngMod.value();
-                if (auto critRngMod = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_RANGE_MODIFIER!0!BI" + baseitem))
-                    retVal = retVal + critRngMod.value();
-                if (auto critRngMod = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_RANGE_MODIFIER!2"))
-                    retVal = retVal + critRngMod.value();
-                if (auto critRngMod = pThis->m_pBaseCreature->nwnxGet<int32_t>("CRITICAL_RANGE_MODIFIER!0"))
-                    retVal = retVal + critRngMod.value();
-            }
             return std::clamp(retVal, 0, 20);
         });
 
@@ -2116,6 +2120,7 @@ NWNX_EXPORT ArgumentStack SetCriticalRangeModifier(ArgumentStack&& args)
         else
             pCreature->nwnxRemove(varname);
 
+        s_CombatOverrides.Reset(pCreature);
         pCreature->m_pStats->UpdateCombatInformation();
     }
     return {};
@@ -2168,6 +2173,7 @@ NWNX_EXPORT ArgumentStack SetCriticalRangeOverride(ArgumentStack&& args)
         else
             pCreature->nwnxRemove(varname);
 
+        s_CombatOverrides.Reset(pCreature);
         pCreature->m_pStats->UpdateCombatInformation();
     }
     return {};
@@ -2764,15 +2770,16 @@ NWNX_EXPORT ArgumentStack SetBypassEffectImmunity(ArgumentStack&& args)
         Hooks::HookFunction(&CNWSCreatureStats::GetEffectImmunity,
         +[](CNWSCreatureStats *pThis, uint8_t nType, CNWSCreature * pVersus, int32_t bConsiderFeats) -> int32_t
         {
+            static auto& rng = Random::GetStream("Creature!BypassEffectImmunity");
             int32_t BypassCounter = 0;
 
-            auto ReturnImmBypass = [&](CNWSCreature *pBypassCreature, std::string Bypass)
+            auto ReturnImmBypass = [&](const std::vector<std::pair<int32_t, int32_t>>& bypasses, int32_t type)
             {
-                if (auto BypassChance = pBypassCreature->nwnxGet<int32_t>(Bypass))
+                for (const auto& [bypassType, BypassChance] : bypasses)
                 {
-                    if (rand() % 100 < abs(BypassChance.value()))
+                    if (bypassType == type && (int32_t)rng.Range(100) < abs(BypassChance))
                     {
-                        if (BypassChance.value() > 0) //Positive being "Force not immune"
+                        if (BypassChance > 0) //Positive being "Force not immune"
                             BypassCounter -= 1;
                         else //Negative being "Force as immune"
                             BypassCounter += 1;
@@ -2780,10 +2787,14 @@ NWNX_EXPORT ArgumentStack SetBypassEffectImmunity(ArgumentStack&& args)
                 }
             };
 
-            ReturnImmBypass(pThis->m_pBaseCreature, "BYPASS_EFF_IMM_IN" + std::to_string(nType));
-            ReturnImmBypass(pVersus, "BYPASS_EFF_IMM_OUT" + std::to_string(nType));
-            ReturnImmBypass(pThis->m_pBaseCreature, "BYPASS_EFF_IMM_IN255"); //255 used for "all"
-            ReturnImmBypass(pVersus, "BYPASS_EFF_IMM_OUT255"); //255 used for "all"
+            auto *pInOverrides = s_CombatOverrides.Get(pThis->m_pBaseCreature);
+            auto *pOutOverrides = s_CombatOverrides.Get(pVersus);
+            ReturnImmBypass(pInOverrides->bypassIn, nType);
+            if (pOutOverrides)
+                ReturnImmBypass(pOutOverrides->bypassOut, nType);
+            ReturnImmBypass(pInOverrides->bypassIn, 255); //255 used for "all"
+            if (pOutOverrides)
+                ReturnImmBypass(pOutOverrides->bypassOut, 255); //255 used for "all"
 
             if (BypassCounter > 0)
                 return true;
@@ -2809,6 +2820,7 @@ NWNX_EXPORT ArgumentStack SetBypassEffectImmunity(ArgumentStack&& args)
             pCreature->nwnxSet(varname, chance, persist);
         else
             pCreature->nwnxRemove(varname);
+        s_CombatOverrides.Reset(pCreature);
     }
     return {};
 }
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+
+// Binary combat log format, shared by the recorder and the standalone reader. Every file starts with a
+// FileHeader and is followed by fixed size records, each starting with a RecordHeader. Readers should
+// skip records with an unknown type using RecordHeader::size.
+namespace CombatLog
+{
+
+constexpr char MAGIC[4] = { 'N', 'X', 'C', 'L' };
+constexpr uint32_t VERSION = 1;
+constexpr int32_t DAMAGE_TYPES = 32;
+
+enum class RecordType : uint8_t
+{
+    Attack      = 1,
+    Damage      = 2,
+    SavingThrow = 3,
+    Effect      = 4,
+};
+
+enum AttackFlags : uint8_t
+{
+    SneakAttack    = 1 << 0,
+    DeathAttack    = 1 << 1,
+    RangedAttack   = 1 << 2,
+    KillingBlow    = 1 << 3,
+    CriticalThreat = 1 << 4,
+};
+
+#pragma pack(push, 1)
+
+struct FileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t startTime; // Microseconds since the unix epoch.
+};
+
+struct RecordHeader
+{
+    RecordType type;
+    uint8_t reserved;
+    uint16_t size; // Including this header.
+    uint32_t oidSource;
+    uint32_t oidTarget;
+    uint64_t time; // Microseconds since the unix epoch.
+};
+
+// One attack of a combat round, after NWNX_Damage attack event scripts ran.
+struct AttackRecord
+{
+    RecordHeader header;
+    uint8_t attackNumber;
+    uint8_t attackResult;
+    uint8_t weaponAttackType;
+    uint8_t flags;
+    uint16_t attackType;
+    uint8_t toHitRoll;
+    uint8_t threatRoll;
+    int32_t toHitModifier;
+    int16_t targetArmorClass; // -1 if the target is not a creature.
+    int16_t damage[DAMAGE_TYPES];
+};
+
+// A damage effect applied to its target, after NWNX_Damage damage event scripts ran. -1 for damage types
+// that were not dealt.
+struct DamageRecord
+{
+    RecordHeader header;
+    int32_t spellId;
+    int32_t damage[DAMAGE_TYPES];
+};
+
+struct SavingThrowRecord
+{
+    RecordHeader header;
+    uint8_t saveType;
+    uint8_t saveVsType;
+    uint8_t result; // 0 = failed, 1 = succeeded, 2 = immune.
+    int8_t modifier; // The saving throw bonus of the creature when rolling.
+    uint16_t difficultyClass;
+    uint16_t feat;
+};
+
+struct EffectRecord
+{
+    RecordHeader header;
+    uint16_t effectType;
+    uint16_t subType; // Duration type and subtype bits.
+    int32_t spellId;
+    float duration;
+    int32_t params[4];
+};
+
+#pragma pack(pop)
+
+}
@@ -0,0 +1,320 @@
+#include "nwnx.hpp"
+#include "CombatLog.hpp"
+
+#include "API/CGameEffect.hpp"
+#include "API/CNWSObject.hpp"
+#include "API/CNWSCreature.hpp"
+#include "API/CNWSCreatureStats.hpp"
+#include "API/CNWSCombatRound.hpp"
+#include "API/CNWSCombatAttackData.hpp"
+#include "API/CNWSEffectListHandler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+using namespace NWNXLib;
+using namespace NWNXLib::API;
+
+namespace CombatRecorder
+{
+
+// Records are copied into a pending buffer on the main thread and written out by a background thread,
+// so recording never waits on the disk. If the writer falls behind by more than MAX_PENDING_BYTES the
+// records are dropped and counted instead.
+static constexpr size_t MAX_PENDING_BYTES = 16 * 1024 * 1024;
+static constexpr size_t WAKE_PENDING_BYTES = 256 * 1024;
+
+class Recorder
+{
+public:
+    Recorder(std::string path, size_t maxFileSize, int32_t maxFiles)
+        : m_Path(std::move(path)), m_MaxFileSize(maxFileSize), m_MaxFiles(std::max(1, maxFiles))
+    {
+        m_Thread = std::thread([this]() { WriterThread(); });
+    }
+
+    ~Recorder()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stop = true;
+        }
+        m_Wake.notify_one();
+        m_Thread.join();
+    }
+
+    template <typename T>
+    void Append(const T& record)
+    {
+        static_assert(sizeof(T) <= UINT16_MAX);
+
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        if (m_Pending.size() + sizeof(T) > MAX_PENDING_BYTES)
+        {
+            m_Dropped++;
+            return;
+        }
+
+        const auto offset = m_Pending.size();
+        m_Pending.resize(offset + sizeof(T));
+        std::memcpy(m_Pending.data() + offset, &record, sizeof(T));
+
+        if (m_Pending.size() >= WAKE_PENDING_BYTES)
+        {
+            lock.unlock();
+            m_Wake.notify_one();
+        }
+    }
+
+private:
+    void WriterThread()
+    {
+        std::vector<uint8_t> writing;
+        bool stop = false;
+        while (!stop)
+        {
+            uint64_t dropped;
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_Wake.wait_for(lock, std::chrono::milliseconds(500),
+                                [this]() { return m_Stop || m_Pending.size() >= WAKE_PENDING_BYTES; });
+                std::swap(writing, m_Pending);
+                dropped = m_Dropped;
+                m_Dropped = 0;
+                stop = m_Stop;
+            }
+
+            if (dropped)
+                LOG_WARNING("Combat log writer fell behind, dropped %llu records.", (unsigned long long)dropped);
+
+            if (!writing.empty())
+            {
+                Write(writing.data(), writing.size());
+                writing.clear();
+            }
+        }
+
+        if (m_File)
+            std::fclose(m_File);
+    }
+
+    void Write(const uint8_t *data, size_t size)
+    {
+        if (m_File && m_FileSize + size > m_MaxFileSize)
+            Rotate();
+
+        if (!m_File && !Open())
+            return;
+
+        if (std::fwrite(data, 1, size, m_File) != size)
+            LOG_ERROR("Unable to write to the combat log '%s'.", m_Path);
+        std::fflush(m_File);
+        m_FileSize += size;
+    }
+
+    bool Open()
+    {
+        m_File = std::fopen(m_Path.c_str(), "ab");
+        if (!m_File)
+        {
+            LOG_ERROR("Unable to open the combat log '%s'.", m_Path);
+            return false;
+        }
+
+        std::fseek(m_File, 0, SEEK_END);
+        m_FileSize = std::ftell(m_File);
+        if (m_FileSize == 0)
+        {
+            CombatLog::FileHeader header;
+            std::memcpy(header.magic, CombatLog::MAGIC, sizeof(header.magic));
+            header.version = CombatLog::VERSION;
+            header.startTime = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            std::fwrite(&header, sizeof(header), 1, m_File);
+            m_FileSize = sizeof(header);
+        }
+        return true;
+    }
+
+    // path -> path.1 -> ... -> path.<maxFiles - 1>, the oldest file is overwritten.
+    void Rotate()
+    {
+        std::fclose(m_File);
+        m_File = nullptr;
+
+        for (int32_t i = m_MaxFiles - 1; i > 0; i--)
+        {
+            const auto from = i == 1 ? m_Path : m_Path + "." + std::to_string(i - 1);
+            std::rename(from.c_str(), (m_Path + "." + std::to_string(i)).c_str());
+        }
+        if (m_MaxFiles == 1)
+            std::remove(m_Path.c_str());
+    }
+
+    const std::string m_Path;
+    const size_t m_MaxFileSize;
+    const int32_t m_MaxFiles;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_Wake;
+    std::vector<uint8_t> m_Pending;
+    uint64_t m_Dropped = 0;
+    bool m_Stop = false;
+    std::thread m_Thread;
+
+    std::FILE *m_File = nullptr;
+    size_t m_FileSize = 0;
+};
+
+static std::unique_ptr<Recorder> s_Recorder;
+
+static CombatLog::RecordHeader MakeHeader(CombatLog::RecordType type, uint16_t size, ObjectID oidSource, ObjectID oidTarget)
+{
+    CombatLog::RecordHeader header;
+    header.type = type;
+    header.reserved = 0;
+    header.size = size;
+    header.oidSource = oidSource;
+    header.oidTarget = oidTarget;
+    header.time = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    return header;
+}
+
+static void RecordAttacks(CNWSCreature *pThis, CNWSObject *pTarget, int32_t nAttacks)
+{
+    int16_t targetArmorClass = -1;
+    if (auto *pTargetCreature = Utils::AsNWSCreature(pTarget))
+        targetArmorClass = pTargetCreature->m_pStats->GetArmorClassVersus(pThis, false);
+
+    // m_nCurrentAttack points to the attack *after* this flurry
+    const uint8_t nAttackNumberOffset = pThis->m_pcCombatRound->m_nCurrentAttack - nAttacks;
+    for (int32_t i = 0; i < nAttacks; i++)
+    {
+        auto *pCombatAttackData = pThis->m_pcCombatRound->GetAttack(nAttackNumberOffset + i);
+
+        CombatLog::AttackRecord record;
+        record.header = MakeHeader(CombatLog::RecordType::Attack, sizeof(record), pThis->m_idSelf, pTarget->m_idSelf);
+        record.attackNumber = nAttackNumberOffset + i + 1;
+        record.attackResult = pCombatAttackData->m_nAttackResult;
+        record.weaponAttackType = pCombatAttackData->m_nWeaponAttackType;
+        record.flags = (pCombatAttackData->m_bSneakAttack ? CombatLog::SneakAttack : 0) |
+                       (pCombatAttackData->m_bDeathAttack ? CombatLog::DeathAttack : 0) |
+                       (pCombatAttackData->m_bRangedAttack ? CombatLog::RangedAttack : 0) |
+                       (pCombatAttackData->m_bKillingBlow ? CombatLog::KillingBlow : 0) |
+                       (pCombatAttackData->m_bCriticalThreat ? CombatLog::CriticalThreat : 0);
+        record.attackType = pCombatAttackData->m_nAttackType;
+        record.toHitRoll = pCombatAttackData->m_nToHitRoll;
+        record.threatRoll = pCombatAttackData->m_nThreatRoll;
+        record.toHitModifier = pCombatAttackData->m_nToHitMod;
+        record.targetArmorClass = targetArmorClass;
+        std::memcpy(record.damage, pCombatAttackData->m_nDamage, sizeof(record.damage));
+
+        s_Recorder->Append(record);
+    }
+}
+
+static void InitializeRecorder()
+{
+    const auto path = Config::Get<std::string>("COMBAT_LOG", "");
+    if (path.empty())
+        return;
+
+    const auto maxFileSize = std::max(1, Config::Get<int32_t>("COMBAT_LOG_MAX_SIZE_MB", 64)) * size_t(1024 * 1024);
+    const auto maxFiles = Config::Get<int32_t>("COMBAT_LOG_FILES", 4);
+    s_Recorder = std::make_unique<Recorder>(path, maxFileSize, maxFiles);
+    LOG_INFO("Recording combat to '%s', rotating every %i MB over %i files.", path, maxFileSize / (1024 * 1024), maxFiles);
+
+    // Very late so the data is recorded after NWNX_Damage event scripts and other plugins changed it.
+    static Hooks::Hook s_SignalMeleeDamageHook = Hooks::HookFunction(&CNWSCreature::SignalMeleeDamage,
+        +[](CNWSCreature *pThis, CNWSObject *pTarget, int32_t nAttacks) -> void
+        {
+            RecordAttacks(pThis, pTarget, nAttacks);
+            s_SignalMeleeDamageHook->CallOriginal<void>(pThis, pTarget, nAttacks);
+        }, Hooks::Order::VeryLate);
+
+    static Hooks::Hook s_SignalRangedDamageHook = Hooks::HookFunction(&CNWSCreature::SignalRangedDamage,
+        +[](CNWSCreature *pThis, CNWSObject *pTarget, int32_t nAttacks) -> void
+        {
+            RecordAttacks(pThis, pTarget, nAttacks);
+            s_SignalRangedDamageHook->CallOriginal<void>(pThis, pTarget, nAttacks);
+        }, Hooks::Order::VeryLate);
+
+    static Hooks::Hook s_OnApplyDamageHook = Hooks::HookFunction(&CNWSEffectListHandler::OnApplyDamage,
+        +[](CNWSEffectListHandler *pThis, CNWSObject *pObject, CGameEffect *pEffect, BOOL bLoadingGame) -> BOOL
+        {
+            if (!bLoadingGame)
+            {
+                CombatLog::DamageRecord record;
+                record.header = MakeHeader(CombatLog::RecordType::Damage, sizeof(record), pEffect->m_oidCreator, pObject->m_idSelf);
+                record.spellId = pEffect->m_nSpellId;
+                const auto numIntegers = std::clamp(pEffect->m_nNumIntegers, 0, CombatLog::DAMAGE_TYPES);
+                std::fill(std::begin(record.damage), std::end(record.damage), -1);
+                std::memcpy(record.damage, pEffect->m_nParamInteger, numIntegers * sizeof(int32_t));
+
+                s_Recorder->Append(record);
+            }
+            return s_OnApplyDamageHook->CallOriginal<BOOL>(pThis, pObject, pEffect, bLoadingGame);
+        }, Hooks::Order::VeryLate);
+
+    static Hooks::Hook s_SavingThrowRollHook = Hooks::HookFunction(&CNWSCreature::SavingThrowRoll,
+        +[](CNWSCreature *pThis, uint8_t nSaveType, uint16_t nDifficultyClass, uint8_t nSaveVsType, ObjectID oidSaveVersus,
+            BOOL bPrint, uint16_t nFeat, BOOL bQueueFeedback) -> uint8_t
+        {
+            auto retVal = s_SavingThrowRollHook->CallOriginal<uint8_t>(pThis, nSaveType, nDifficultyClass, nSaveVsType,
+                                                                        oidSaveVersus, bPrint, nFeat, bQueueFeedback);
+
+            // The d20 roll isn't exposed by the game, only the bonus it was added to.
+            int8_t modifier = 0;
+            switch (nSaveType)
+            {
+                case Constants::SavingThrow::Fortitude: modifier = pThis->m_pStats->GetFortSavingThrow(false);   break;
+                case Constants::SavingThrow::Reflex:    modifier = pThis->m_pStats->GetReflexSavingThrow(false); break;
+                case Constants::SavingThrow::Will:      modifier = pThis->m_pStats->GetWillSavingThrow(false);   break;
+                default: break;
+            }
+
+            CombatLog::SavingThrowRecord record;
+            record.header = MakeHeader(CombatLog::RecordType::SavingThrow, sizeof(record), oidSaveVersus, pThis->m_idSelf);
+            record.saveType = nSaveType;
+            record.saveVsType = nSaveVsType;
+            record.result = retVal;
+            record.modifier = modifier;
+            record.difficultyClass = nDifficultyClass;
+            record.feat = nFeat;
+            s_Recorder->Append(record);
+
+            return retVal;
+        }, Hooks::Order::VeryLate);
+
+    static Hooks::Hook s_ApplyEffectHook = Hooks::HookFunction(&CNWSObject::ApplyEffect,
+        +[](CNWSObject *pThis, CGameEffect *pEffect, BOOL bLoadingGame, BOOL bInitialApplication) -> void
+        {
+            if (!bLoadingGame)
+            {
+                CombatLog::EffectRecord record;
+                record.header = MakeHeader(CombatLog::RecordType::Effect, sizeof(record), pEffect->m_oidCreator, pThis->m_idSelf);
+                record.effectType = pEffect->m_nType;
+                record.subType = pEffect->m_nSubType;
+                record.spellId = pEffect->m_nSpellId;
+                record.duration = pEffect->m_fDuration;
+                for (int32_t i = 0; i < 4; i++)
+                    record.params[i] = i < pEffect->m_nNumIntegers ? pEffect->m_nParamInteger[i] : 0;
+                s_Recorder->Append(record);
+            }
+            s_ApplyEffectHook->CallOriginal<void>(pThis, pEffect, bLoadingGame, bInitialApplication);
+        }, Hooks::Order::VeryLate);
+}
+
+void CombatRecorder() __attribute__((constructor));
+void CombatRecorder()
+{
+    InitializeRecorder();
+}
+
+}
@@ -9,7 +9,9 @@
 #include "API/CNWSCreature.hpp"
 #include "API/CNWSCombatRound.hpp"
 #include "API/CNWSEffectListHandler.hpp"
+#include "API/CNWSUUID.hpp"
 
+#include <array>
 #include <cstring>
 #include <bitset>
 
@@ -40,17 +42,56 @@ struct AttackData
     int32_t nToHitModifier;
 };
 
-static std::unordered_map<std::string, std::string> s_EventScriptMap;
+enum EventType : uint8_t
+{
+    DamageEvent,
+    AttackEvent,
+    EventType_MAX // Keep as last
+};
+static constexpr const char* s_EventTypeNames[EventType_MAX] = { "DAMAGE", "ATTACK" };
+
+using EventScripts = std::array<std::string, EventType_MAX>;
+
+// Per object scripts are persisted in POS, and read from there the first time an object is seen and after its
+// POS is loaded.
+struct ObjectEventScripts
+{
+    bool bHasScripts = false;
+    EventScripts scripts;
+};
+
+static std::string GetEventScriptKey(EventType eventType)
+{
+    return std::string(s_EventTypeNames[eventType]) + "_EVENT_SCRIPT";
+}
+
+static void LoadObjectEventScripts(CGameObject *pObject, ObjectEventScripts& objectEventScripts)
+{
+    for (uint8_t eventType = 0; eventType < EventType_MAX; eventType++)
+    {
+        if (auto posScript = pObject->nwnxGet<std::string>(GetEventScriptKey((EventType)eventType)))
+        {
+            objectEventScripts.scripts[eventType] = *posScript;
+            objectEventScripts.bHasScripts = true;
+        }
+    }
+}
+
+static EventScripts s_EventScripts;
+// Until some object gets a script of its own, from SetEventScript() or loaded with its POS, only the global
+// scripts are checked and objects don't get an extension at all.
+static bool s_bObjectEventScripts = false;
+static POS::Extension<ObjectEventScripts> s_ObjectEventScripts(&LoadObjectEventScripts);
 static DamageData s_DamageData;
 static AttackData s_AttackData;
 
-static std::string GetEventScript(CNWSObject*, const std::string&);
+static const std::string& GetEventScript(CNWSObject*, EventType);
 static void HandleSignalDamage(CNWSCreature*, CNWSObject*, int32_t);
 
 static Hooks::Hook s_OnApplyDamageHook = Hooks::HookFunction(&CNWSEffectListHandler::OnApplyDamage,
     +[](CNWSEffectListHandler *pThis, CNWSObject *pObject, CGameEffect *pEffect, BOOL bLoadingGame) -> BOOL
     {
-        std::string sScript = GetEventScript(pObject, "DAMAGE");
+        const auto& sScript = GetEventScript(pObject, DamageEvent);
 
         if (!sScript.empty())
         {
@@ -81,12 +122,29 @@ static Hooks::Hook s_SignalRangedDamageHook = Hooks::HookFunction(&CNWSCreature:
         s_SignalRangedDamageHook->CallOriginal<void>(pThis, pTarget, nAttacks);
     }, Hooks::Order::Late);
 
-static std::string GetEventScript(CNWSObject *pObject, const std::string& sEventType)
+// Objects loaded from a save or a copy carry their scripts in POS, which the POS hook has just restored.
+static Hooks::Hook s_UUIDLoadFromGffHook = Hooks::HookFunction(&CNWSUUID::LoadFromGff,
+    +[](CNWSUUID *pThis, CResGFF *pRes, CResStruct *pStruct) -> bool
+    {
+        const auto retVal = s_UUIDLoadFromGffHook->CallOriginal<bool>(pThis, pRes, pStruct);
+        if (!s_bObjectEventScripts && pThis->m_parent)
+        {
+            for (uint8_t eventType = 0; eventType < EventType_MAX && !s_bObjectEventScripts; eventType++)
+                s_bObjectEventScripts = pThis->m_parent->nwnxGet<std::string>(GetEventScriptKey((EventType)eventType)).has_value();
+        }
+        return retVal;
+    }, Hooks::Order::Late);
+
+static const std::string& GetEventScript(CNWSObject *pObject, EventType eventType)
 {
-    if (auto posScript = pObject->nwnxGet<std::string>(sEventType + "_EVENT_SCRIPT"))
-        return *posScript;
-    else
-        return s_EventScriptMap[sEventType];
+    if (s_bObjectEventScripts)
+    {
+        const auto *pObjectEventScripts = s_ObjectEventScripts.Get(pObject);
+        if (pObjectEventScripts && pObjectEventScripts->bHasScripts && !pObjectEventScripts->scripts[eventType].empty())
+            return pObjectEventScripts->scripts[eventType];
+    }
+
+    return s_EventScripts[eventType];
 }
 
 static void OnCombatAttack(CNWSCreature *pThis, CNWSObject *pTarget, const std::string& sScript, uint8_t nAttackNumber)
@@ -115,7 +173,7 @@ static void OnCombatAttack(CNWSCreature *pThis, CNWSObject *pTarget, const std::
 
 static void HandleSignalDamage(CNWSCreature *pThis, CNWSObject *pTarget, int32_t nAttacks)
 {
-    std::string sScript = GetEventScript(pThis, "ATTACK");
+    const auto& sScript = GetEventScript(pThis, AttackEvent);
     if (!sScript.empty())
     {
         // m_nCurrentAttack points to the attack *after* this flurry
@@ -132,23 +190,39 @@ NWNX_EXPORT ArgumentStack SetEventScript(ArgumentStack&& args)
     const auto sScript = args.extract<std::string>();
     const auto oidTarget = args.extract<ObjectID>();
 
+    const auto eventType = std::find_if(std::begin(s_EventTypeNames), std::end(s_EventTypeNames),
+                                        [&](const char* name) { return sEvent == name; }) - std::begin(s_EventTypeNames);
+    if (eventType == EventType_MAX)
+    {
+        LOG_WARNING("Unknown event '%s', expected DAMAGE or ATTACK.", sEvent);
+        return {};
+    }
+
     if (oidTarget == Constants::OBJECT_INVALID)
     {
-        s_EventScriptMap[sEvent] = sScript;
+        s_EventScripts[eventType] = sScript;
         LOG_INFO("Set Global %s Event Script to %s", sEvent, sScript);
     }
     else
     {
         if (auto pTarget = Utils::GetGameObject(oidTarget))
         {
+            if (!sScript.empty())
+                s_bObjectEventScripts = true;
+
+            auto& objectEventScripts = *s_ObjectEventScripts.Get(pTarget);
+            objectEventScripts.scripts[eventType] = sScript;
+            objectEventScripts.bHasScripts = std::any_of(objectEventScripts.scripts.begin(), objectEventScripts.scripts.end(),
+                                                         [](const std::string& script) { return !script.empty(); });
+
             if (!sScript.empty())
             {
-                pTarget->nwnxSet(sEvent + "_EVENT_SCRIPT", sScript, true);
+                pTarget->nwnxSet(GetEventScriptKey((EventType)eventType), sScript, true);
                 LOG_INFO("Set object %s %s Event Script to %s", Utils::ObjectIDToString(oidTarget), sEvent, sScript);
             }
             else
             {
-                pTarget->nwnxRemove(sEvent + "_EVENT_SCRIPT");
+                pTarget->nwnxRemove(GetEventScriptKey((EventType)eventType));
                 LOG_INFO("Clearing %s Event Script for object %s", sEvent, Utils::ObjectIDToString(oidTarget));
             }
         }
@@ -0,0 +1,243 @@
+// Standalone reader for the NWNX_Damage combat log. Replays one or more log files, in the order given,
+// into aggregate statistics for comparing builds or server versions:
+//
+//   CombatLogReader combat.log.3 combat.log.2 combat.log.1 combat.log
+//
+// Object IDs are only meaningful within a single server run.
+
+#include "../CombatLog.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+const char* DAMAGE_TYPE_NAMES[] = {
+    "Bludgeoning", "Piercing", "Slashing", "Magical", "Acid", "Cold", "Divine", "Electrical",
+    "Fire", "Negative", "Positive", "Sonic", "Base",
+};
+
+const char* SAVE_TYPE_NAMES[] = { "All", "Fortitude", "Reflex", "Will" };
+
+bool IsHit(uint8_t attackResult)
+{
+    // 1 = hit, 3 = critical hit, 5 = resisted, 7 = automatic hit, 10 = devastating crit
+    return attackResult == 1 || attackResult == 3 || attackResult == 5 || attackResult == 7 || attackResult == 10;
+}
+
+struct DamageDealt
+{
+    int64_t total = 0;
+    uint64_t hits = 0;
+    uint64_t firstTime = 0;
+    uint64_t lastTime = 0;
+};
+
+struct Rate
+{
+    uint64_t success = 0;
+    uint64_t count = 0;
+};
+
+struct Stats
+{
+    uint64_t records = 0;
+    uint64_t unknownRecords = 0;
+    std::unordered_map<uint32_t, DamageDealt> damageBySource;
+    std::map<int16_t, Rate> hitsByArmorClass;
+    std::map<uint8_t, uint64_t> attackResults;
+    int64_t damageByType[CombatLog::DAMAGE_TYPES] = {};
+    std::map<uint8_t, Rate> savesByType;
+    std::map<uint16_t, uint64_t> effectsByType;
+};
+
+template <typename T>
+bool ReadRecord(const std::vector<uint8_t>& buffer, T& record)
+{
+    if (buffer.size() < sizeof(T))
+        return false;
+    std::memcpy(&record, buffer.data(), sizeof(T));
+    return true;
+}
+
+void AddRecord(Stats& stats, const std::vector<uint8_t>& buffer, const CombatLog::RecordHeader& header)
+{
+    stats.records++;
+    switch (header.type)
+    {
+        case CombatLog::RecordType::Attack:
+        {
+            CombatLog::AttackRecord record;
+            if (!ReadRecord(buffer, record))
+                break;
+            stats.attackResults[record.attackResult]++;
+            auto& rate = stats.hitsByArmorClass[record.targetArmorClass];
+            rate.count++;
+            rate.success += IsHit(record.attackResult);
+            return;
+        }
+        case CombatLog::RecordType::Damage:
+        {
+            CombatLog::DamageRecord record;
+            if (!ReadRecord(buffer, record))
+                break;
+
+            int64_t total = 0;
+            for (int32_t i = 0; i < CombatLog::DAMAGE_TYPES; i++)
+            {
+                if (record.damage[i] > 0)
+                {
+                    stats.damageByType[i] += record.damage[i];
+                    total += record.damage[i];
+                }
+            }
+
+            auto& dealt = stats.damageBySource[header.oidSource];
+            if (dealt.hits++ == 0)
+                dealt.firstTime = header.time;
+            dealt.lastTime = header.time;
+            dealt.total += total;
+            return;
+        }
+        case CombatLog::RecordType::SavingThrow:
+        {
+            CombatLog::SavingThrowRecord record;
+            if (!ReadRecord(buffer, record))
+                break;
+            auto& rate = stats.savesByType[record.saveType];
+            rate.count++;
+            rate.success += record.result != 0;
+            return;
+        }
+        case CombatLog::RecordType::Effect:
+        {
+            CombatLog::EffectRecord record;
+            if (!ReadRecord(buffer, record))
+                break;
+            stats.effectsByType[record.effectType]++;
+            return;
+        }
+    }
+    stats.unknownRecords++;
+}
+
+bool ReadFile(const char* path, Stats& stats)
+{
+    auto *file = std::fopen(path, "rb");
+    if (!file)
+    {
+        std::fprintf(stderr, "%s: unable to open\n", path);
+        return false;
+    }
+
+    CombatLog::FileHeader fileHeader;
+    if (std::fread(&fileHeader, sizeof(fileHeader), 1, file) != 1 ||
+        std::memcmp(fileHeader.magic, CombatLog::MAGIC, sizeof(fileHeader.magic)) != 0 ||
+        fileHeader.version != CombatLog::VERSION)
+    {
+        std::fprintf(stderr, "%s: not a version %u combat log\n", path, CombatLog::VERSION);
+        std::fclose(file);
+        return false;
+    }
+
+    std::vector<uint8_t> buffer;
+    CombatLog::RecordHeader header;
+    while (std::fread(&header, sizeof(header), 1, file) == 1)
+    {
+        if (header.size < sizeof(header))
+        {
+            std::fprintf(stderr, "%s: corrupt record, stopping\n", path);
+            break;
+        }
+
+        buffer.resize(header.size);
+        std::memcpy(buffer.data(), &header, sizeof(header));
+        const size_t remaining = header.size - sizeof(header);
+        if (std::fread(buffer.data() + sizeof(header), 1, remaining, file) != remaining)
+        {
+            std::fprintf(stderr, "%s: truncated record, stopping\n", path);
+            break;
+        }
+        AddRecord(stats, buffer, header);
+    }
+
+    std::fclose(file);
+    return true;
+}
+
+void PrintStats(const Stats& stats)
+{
+    std::printf("%" PRIu64 " records, %" PRIu64 " unknown.\n", stats.records, stats.unknownRecords);
+
+    std::printf("\nDamage per source:\n%-12s %12s %8s %10s %10s\n", "Object", "Damage", "Hits", "Seconds", "DPS");
+    std::vector<std::pair<uint32_t, DamageDealt>> sources(stats.damageBySource.begin(), stats.damageBySource.end());
+    std::sort(sources.begin(), sources.end(), [](const auto& a, const auto& b) { return a.second.total > b.second.total; });
+    for (const auto& [oidSource, dealt] : sources)
+    {
+        const double seconds = (dealt.lastTime - dealt.firstTime) / 1000000.0;
+        // A single hit has no duration, report its damage as dealt over one second.
+        const double dps = dealt.total / std::max(seconds, 1.0);
+        std::printf("0x%08x   %12" PRId64 " %8" PRIu64 " %10.1f %10.2f\n", oidSource, dealt.total, dealt.hits, seconds, dps);
+    }
+
+    std::printf("\nHit rate by target AC:\n%-6s %10s %8s\n", "AC", "Attacks", "Hit %");
+    for (const auto& [armorClass, rate] : stats.hitsByArmorClass)
+    {
+        std::printf("%-6d %10" PRIu64 " %8.1f\n", armorClass, rate.count, 100.0 * rate.success / rate.count);
+    }
+
+    std::printf("\nAttack results:\n");
+    for (const auto& [attackResult, count] : stats.attackResults)
+    {
+        std::printf("%-6u %10" PRIu64 "\n", attackResult, count);
+    }
+
+    std::printf("\nDamage by type:\n");
+    for (int32_t i = 0; i < CombatLog::DAMAGE_TYPES; i++)
+    {
+        if (stats.damageByType[i] == 0)
+            continue;
+        if (i < (int32_t)std::size(DAMAGE_TYPE_NAMES))
+            std::printf("%-12s %12" PRId64 "\n", DAMAGE_TYPE_NAMES[i], stats.damageByType[i]);
+        else
+            std::printf("Custom%-6d %12" PRId64 "\n", i, stats.damageByType[i]);
+    }
+
+    std::printf("\nSaving throws:\n%-10s %10s %10s\n", "Type", "Rolls", "Success %");
+    for (const auto& [saveType, rate] : stats.savesByType)
+    {
+        std::printf("%-10s %10" PRIu64 " %10.1f\n", saveType < std::size(SAVE_TYPE_NAMES) ? SAVE_TYPE_NAMES[saveType] : "?",
+                    rate.count, 100.0 * rate.success / rate.count);
+    }
+
+    std::printf("\nEffects applied:\n%-6s %10s\n", "Type", "Count");
+    for (const auto& [effectType, count] : stats.effectsByType)
+    {
+        std::printf("%-6u %10" PRIu64 "\n", effectType, count);
+    }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "Usage: %s <combat log> [combat log...]\n", argv[0]);
+        return 1;
+    }
+
+    Stats stats;
+    bool ok = true;
+    for (int i = 1; i < argc; i++)
+        ok &= ReadFile(argv[i], stats);
+
+    PrintStats(stats);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,411 @@
+#include "nwnx.hpp"
+#include "AllocationProfiler.hpp"
+
+#include "API/Functions.hpp"
+#include "API/CExoBase.hpp"
+#include "API/CServerExoAppInternal.hpp"
+#include "API/CVirtualMachine.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <mutex>
+#include <pthread.h>
+#include <unordered_map>
+#include <vector>
+
+
+namespace Diagnostics::AllocationProfiler {
+
+using namespace NWNXLib;
+using namespace NWNXLib::API;
+
+bool enabled = false;
+thread_local int64_t bytesUntilSample = 0;
+
+static constexpr int32_t MAX_FRAMES = 32;
+static constexpr size_t SHARD_COUNT = 64;
+static constexpr size_t FILTER_SIZE = 1 << 20;
+
+// A deduplicated allocation call stack, with the script that was running if it was on the main thread.
+struct Stack
+{
+    void* frames[MAX_FRAMES];
+    int32_t frameCount;
+    char script[64];
+};
+
+struct StackTable
+{
+    std::mutex mutex;
+    std::vector<Stack> stacks;
+    std::unordered_map<std::string, uint32_t> ids;
+};
+
+// Live sampled allocations, sharded by pointer so threads rarely contend.
+struct Shard
+{
+    std::mutex mutex;
+    std::unordered_map<void*, std::pair<uint32_t, size_t>> samples; // Stack id and size.
+};
+
+struct Usage
+{
+    double bytes = 0;
+    uint64_t samples = 0;
+};
+
+static uint64_t s_sampleRate;
+static uint32_t s_snapshotInterval;
+static void *s_moduleBase;
+static pthread_t s_mainThread;
+static bool s_mainThreadKnown;
+
+// Counts the sampled pointers per slot, so freeing an unsampled pointer costs a single load.
+static std::atomic<uint16_t> s_filter[FILTER_SIZE];
+
+// Set while the profiler itself allocates, its own allocations are never sampled.
+static thread_local bool t_inProfiler;
+static thread_local uint64_t t_random;
+
+void AllocationProfiler() __attribute__((constructor));
+static void WriteSnapshot();
+
+// Function local, malloc and the constructor below can run before this file's static initializers.
+static StackTable& Stacks()
+{
+    static StackTable s_stacks;
+    return s_stacks;
+}
+
+static Shard* Shards()
+{
+    static Shard s_shards[SHARD_COUNT];
+    return s_shards;
+}
+
+static uint64_t HashPointer(void *ptr)
+{
+    return (uintptr_t)ptr * 0x9E3779B97F4A7C15ull;
+}
+
+static Shard& ShardOf(void *ptr)
+{
+    return Shards()[HashPointer(ptr) >> 58];
+}
+
+static std::atomic<uint16_t>& FilterOf(void *ptr)
+{
+    return s_filter[(HashPointer(ptr) >> 32) & (FILTER_SIZE - 1)];
+}
+
+// xorshift64*, NWNXLib::Random streams allocate and lock so they can't be used from inside malloc.
+static double NextUniform()
+{
+    if (!t_random)
+        t_random = ((uintptr_t)&t_random ^ (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count()) | 1;
+    t_random ^= t_random >> 12;
+    t_random ^= t_random << 25;
+    t_random ^= t_random >> 27;
+    return ((t_random * 0x2545F4914F6CDD1Dull) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Exponentially distributed byte counts between samples make every allocated byte equally likely to be
+// sampled, so an allocation of size s is sampled with probability 1 - exp(-s / rate).
+static int64_t NextSampleInterval()
+{
+    return (int64_t)(-std::log(1.0 - NextUniform()) * s_sampleRate) + 1;
+}
+
+// The number of bytes a sampled allocation stands for.
+static double Weight(size_t size)
+{
+    return size / (1.0 - std::exp(-(double)size / s_sampleRate));
+}
+
+static uint32_t InternStack(const Stack& stack)
+{
+    std::string key((const char*)stack.frames, stack.frameCount * sizeof(void*));
+    key += stack.script;
+
+    auto& table = Stacks();
+    std::lock_guard<std::mutex> guard(table.mutex);
+    auto [it, inserted] = table.ids.try_emplace(std::move(key), (uint32_t)table.stacks.size());
+    if (inserted)
+        table.stacks.push_back(stack);
+    return it->second;
+}
+
+void RecordSample(void *ptr, size_t size)
+{
+    if (t_inProfiler)
+        return;
+    t_inProfiler = true;
+
+    const bool firstSample = t_random == 0;
+    const int64_t nextSampleInterval = NextSampleInterval();
+    // A thread's first allocation always lands here, it would bias the samples towards thread startup.
+    if (firstSample)
+    {
+        bytesUntilSample = nextSampleInterval;
+        t_inProfiler = false;
+        return;
+    }
+
+    Stack stack;
+    stack.frameCount = backtrace(stack.frames, MAX_FRAMES);
+    stack.script[0] = '\0';
+    if (s_mainThreadKnown && pthread_equal(pthread_self(), s_mainThread))
+    {
+        auto *pVM = Globals::VirtualMachine();
+        if (pVM && pVM->m_nRecursionLevel >= 0 && pVM->m_nRecursionLevel < (int32_t)std::size(pVM->m_pVirtualMachineScript))
+        {
+            const char *name = pVM->m_pVirtualMachineScript[pVM->m_nRecursionLevel].m_sScriptName.CStr();
+            std::strncpy(stack.script, name, sizeof(stack.script) - 1);
+            stack.script[sizeof(stack.script) - 1] = '\0';
+        }
+    }
+    const uint32_t stackId = InternStack(stack);
+
+    bool inserted;
+    {
+        auto& shard = ShardOf(ptr);
+        std::lock_guard<std::mutex> guard(shard.mutex);
+        inserted = shard.samples.insert_or_assign(ptr, std::make_pair(stackId, size)).second;
+    }
+    if (inserted)
+        FilterOf(ptr).fetch_add(1, std::memory_order_relaxed);
+
+    // Our own allocations above counted down too, the next interval starts once we're done.
+    bytesUntilSample = nextSampleInterval;
+    t_inProfiler = false;
+}
+
+bool MaybeSampled(void *ptr)
+{
+    return FilterOf(ptr).load(std::memory_order_relaxed) != 0;
+}
+
+void ForgetSample(void *ptr)
+{
+    if (t_inProfiler)
+        return;
+    t_inProfiler = true;
+
+    bool erased;
+    {
+        auto& shard = ShardOf(ptr);
+        std::lock_guard<std::mutex> guard(shard.mutex);
+        erased = shard.samples.erase(ptr) != 0;
+    }
+    if (erased)
+        FilterOf(ptr).fetch_sub(1, std::memory_order_relaxed);
+
+    t_inProfiler = false;
+}
+
+void AllocationProfiler()
+{
+    if (!Config::Get<bool>("ALLOCATION_PROFILER", false))
+        return;
+
+    if (Config::Get<bool>("MEMORY_SANITIZER", false))
+    {
+        LOG_WARNING("The allocation profiler can't be used together with the memory sanitizer.");
+        return;
+    }
+
+    Dl_info info, mallocInfo;
+    dladdr((void*)&RecordSample, &info);
+    s_moduleBase = info.dli_fbase;
+    if (!dladdr(dlsym(RTLD_DEFAULT, "malloc"), &mallocInfo) || mallocInfo.dli_fbase != s_moduleBase)
+    {
+        LOG_WARNING("NWNX_Diagnostics.so is not preloaded, the allocation profiler will not work.");
+        LOG_WARNING("Please see Diagnostics/README.md for instructions");
+        return;
+    }
+
+    s_sampleRate = std::max<uint64_t>(Config::Get<uint64_t>("ALLOCATION_PROFILER_SAMPLE_RATE", 512 * 1024), 1);
+    s_snapshotInterval = Config::Get<uint32_t>("ALLOCATION_PROFILER_INTERVAL", 600);
+
+    static Hooks::Hook pMainLoopHook = Hooks::HookFunction(&CServerExoAppInternal::MainLoop,
+            +[](CServerExoAppInternal *pServerExoAppInternal) -> int32_t
+            {
+                static auto nextSnapshot = std::chrono::steady_clock::now() + std::chrono::seconds(s_snapshotInterval);
+                if (!s_mainThreadKnown)
+                {
+                    s_mainThread = pthread_self();
+                    s_mainThreadKnown = true;
+                }
+
+                auto retVal = pMainLoopHook->CallOriginal<int32_t>(pServerExoAppInternal);
+
+                if (s_snapshotInterval && std::chrono::steady_clock::now() >= nextSnapshot)
+                {
+                    WriteSnapshot();
+                    nextSnapshot = std::chrono::steady_clock::now() + std::chrono::seconds(s_snapshotInterval);
+                }
+                return retVal;
+            }, Hooks::Order::Earliest);
+
+    Commands::Register("allocsnapshot", [](std::string&, std::string&)
+    {
+        WriteSnapshot();
+    });
+
+    LOG_INFO("Allocation profiler enabled, sampling every %llu bytes on average.", s_sampleRate);
+    enabled = true;
+}
+
+// "module!symbol", or an empty string for frames of the profiler and the malloc interposer.
+static const std::string& Symbolise(void *address)
+{
+    static std::unordered_map<void*, std::string> s_symbols;
+    auto [it, inserted] = s_symbols.try_emplace(address);
+    if (!inserted)
+        return it->second;
+
+    // Return addresses point past the call, look up the call itself.
+    void *callSite = (char*)address - 1;
+    Dl_info info;
+    if (!dladdr(callSite, &info))
+    {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%p", address);
+        it->second = buffer;
+        return it->second;
+    }
+    if (info.dli_fbase == s_moduleBase)
+        return it->second;
+
+    std::string module = info.dli_fname ? info.dli_fname : "?";
+    module = module.substr(module.find_last_of('/') + 1);
+    if (info.dli_sname)
+    {
+        int status;
+        std::unique_ptr<char, decltype(&std::free)> demangled(abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status), &std::free);
+        it->second = module + "!" + (status == 0 ? demangled.get() : info.dli_sname);
+    }
+    else
+    {
+        char offset[32];
+        std::snprintf(offset, sizeof(offset), "+0x%zx", (size_t)((char*)callSite - (char*)info.dli_fbase));
+        it->second = module + offset;
+    }
+    return it->second;
+}
+
+// Folded stack, root first, starting with the script if one was running.
+static std::string FoldStack(const Stack& stack)
+{
+    std::string folded;
+    if (stack.script[0])
+        folded = std::string("nwscript:") + stack.script;
+    for (int32_t i = stack.frameCount - 1; i >= 0; i--)
+    {
+        const auto& symbol = Symbolise(stack.frames[i]);
+        if (symbol.empty())
+            continue;
+        if (!folded.empty())
+            folded += ';';
+        folded += symbol;
+    }
+    return folded.empty() ? "?" : folded;
+}
+
+// Writes the estimated live bytes per call stack, and their growth since the previous snapshot, as
+// folded stacks that flamegraph.pl and speedscope read.
+static void WriteSnapshot()
+{
+    static std::unordered_map<uint32_t, Usage> s_previous;
+    static uint32_t s_snapshot;
+
+    const bool inProfiler = t_inProfiler;
+    const int64_t untilSample = bytesUntilSample;
+    t_inProfiler = true;
+
+    std::unordered_map<uint32_t, Usage> usage;
+    for (size_t i = 0; i < SHARD_COUNT; i++)
+    {
+        auto& shard = Shards()[i];
+        std::lock_guard<std::mutex> guard(shard.mutex);
+        for (const auto& [ptr, sample] : shard.samples)
+        {
+            auto& entry = usage[sample.first];
+            entry.bytes += Weight(sample.second);
+            entry.samples++;
+        }
+    }
+
+    std::vector<Stack> stacks;
+    {
+        auto& table = Stacks();
+        std::lock_guard<std::mutex> guard(table.mutex);
+        stacks = table.stacks;
+    }
+
+    struct Line
+    {
+        std::string stack;
+        double bytes;
+        double growth;
+    };
+    std::vector<Line> lines;
+    double totalBytes = 0, totalGrowth = 0;
+    for (const auto& [stackId, entry] : usage)
+    {
+        const double growth = entry.bytes - s_previous[stackId].bytes;
+        lines.push_back({FoldStack(stacks[stackId]), entry.bytes, growth});
+        totalBytes += entry.bytes;
+        totalGrowth += growth;
+    }
+    for (const auto& [stackId, entry] : s_previous)
+    {
+        if (!usage.count(stackId))
+            totalGrowth -= entry.bytes;
+    }
+    std::sort(lines.begin(), lines.end(), [](const Line& a, const Line& b) { return a.growth > b.growth; });
+
+    const std::string directory = Config::Get<std::string>("ALLOCATION_PROFILER_DIR", Globals::ExoBase()->m_sUserDirectory.CStr());
+    const std::string path = directory + "/allocations_" + std::to_string(std::time(nullptr));
+    auto *live = std::fopen((path + ".folded").c_str(), "w");
+    auto *diff = std::fopen((path + ".diff.folded").c_str(), "w");
+    if (live && diff)
+    {
+        for (const auto& line : lines)
+        {
+            std::fprintf(live, "%s %.0f\n", line.stack.c_str(), line.bytes);
+            if (line.growth >= 1)
+                std::fprintf(diff, "%s %.0f\n", line.stack.c_str(), line.growth);
+        }
+
+        LOG_INFO("Allocation snapshot %u: %.1f MiB live, %+.1f MiB since the previous one, written to '%s.folded'.",
+                 ++s_snapshot, totalBytes / (1024 * 1024), totalGrowth / (1024 * 1024), path);
+        for (size_t i = 0; i < std::min<size_t>(lines.size(), 5) && lines[i].growth >= 1; i++)
+        {
+            const auto& stack = lines[i].stack;
+            LOG_INFO("  %+.1f KiB: %s", lines[i].growth / 1024, stack.substr(stack.find_last_of(';') + 1));
+        }
+    }
+    else
+    {
+        LOG_ERROR("Unable to write allocation snapshot '%s'.", path);
+    }
+    if (live)
+        std::fclose(live);
+    if (diff)
+        std::fclose(diff);
+
+    s_previous = std::move(usage);
+    bytesUntilSample = untilSample;
+    t_inProfiler = inProfiler;
+}
+
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Sampling allocation profiler. The malloc interposer in MemorySanitizer.cpp passes every allocation and
+// free it doesn't sanitize through here. Only the inline fast paths run for unsampled allocations.
+namespace Diagnostics::AllocationProfiler {
+
+extern bool enabled;
+extern thread_local int64_t bytesUntilSample;
+
+void RecordSample(void *ptr, size_t size);
+bool MaybeSampled(void *ptr);
+void ForgetSample(void *ptr);
+
+inline void* OnAllocate(void *ptr, size_t size)
+{
+    // Zero sized allocations carry no bytes to attribute.
+    if (enabled && ptr && size && (bytesUntilSample -= size) < 0)
+        RecordSample(ptr, size);
+    return ptr;
+}
+
+inline void OnFree(void *ptr)
+{
+    if (enabled && ptr && MaybeSampled(ptr))
+        ForgetSample(ptr);
+}
+
+}
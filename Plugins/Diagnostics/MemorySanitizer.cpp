@@ -1,4 +1,5 @@
 #include "nwnx.hpp"
+#include "AllocationProfiler.hpp"
 
 #include "API/Functions.hpp"
 #include "API/CServerExoAppInternal.hpp"
@@ -152,7 +153,7 @@ static inline size_t CheckFence(void *ptr)
 void *malloc(size_t size)
 {
     ResolveSymbols();
-    if (!enabled || meta) return real_malloc(size);
+    if (!enabled || meta) return AllocationProfiler::OnAllocate(real_malloc(size), size);
     MetaFunction mf;
 
     void *ptr = malloc(size + FenceSize);
@@ -169,7 +170,11 @@ void *malloc(size_t size)
 void free(void *ptr)
 {
     ResolveSymbols();
-    if (!enabled || meta) return real_free(ptr);
+    if (!enabled || meta)
+    {
+        AllocationProfiler::OnFree(ptr);
+        return real_free(ptr);
+    }
     MetaFunction mf;
 
     {
@@ -195,7 +200,7 @@ void *calloc(size_t num, size_t size)
     // dlsym calls calloc(), so just return null to avoid infinite recursion
     //ResolveSymbols();
     if (real_calloc == nullptr) return nullptr;
-    if (!enabled || meta) return real_calloc(num, size);
+    if (!enabled || meta) return AllocationProfiler::OnAllocate(real_calloc(num, size), num * size);
 
     size_t fullsize = num * size;
     void *ptr = malloc(fullsize);
@@ -205,7 +210,14 @@ void *calloc(size_t num, size_t size)
 void *realloc(void *ptr, size_t size)
 {
     ResolveSymbols();
-    if (!enabled || meta) return real_realloc(ptr, size);
+    if (!enabled || meta)
+    {
+        void *newptr = real_realloc(ptr, size);
+        // A failed realloc leaves the old block, and its sample, alive. A zero size one frees it.
+        if (newptr || !size)
+            AllocationProfiler::OnFree(ptr);
+        return AllocationProfiler::OnAllocate(newptr, size);
+    }
 
     if (ptr == nullptr) return malloc(size);
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 namespace DotNET {
     using MainLoopHandler =  void (*)(uint64_t);
     using RunScriptHandler = int (*)(const char*, uint32_t);
@@ -17,4 +19,39 @@ namespace DotNET {
         AssertHandler        Assert;
         CrashHandler         Crash;
     };
+
+    // Packed values for CallBuiltIns(). String arguments are borrowed views that only need to stay valid for
+    // the call, returned strings point into a buffer that is reused by the next CallBuiltIns().
+    enum class MarshalType : int32_t
+    {
+        Void,
+        Integer,
+        Float,
+        String,
+        Object,
+        Vector,
+        GameDefinedStructure,
+    };
+
+    struct MarshalValue
+    {
+        MarshalType type;
+        int32_t structId; // GameDefinedStructure only
+        union
+        {
+            int32_t integer;
+            float number;
+            uint32_t object;
+            struct { float x, y, z; } vector;
+            struct { const char* data; int32_t length; } string;
+            void* structure;
+        };
+    };
+    static_assert(sizeof(MarshalValue) == 24);
+
+    struct BuiltInCall
+    {
+        int32_t id;
+        int32_t argCount;
+    };
 }
@@ -11,6 +11,7 @@
 #include "API/CWorldTimer.hpp"
 
 #include <csignal>
+#include <deque>
 #include <dlfcn.h>
 
 using namespace NWNXLib;
@@ -27,6 +28,8 @@ static int32_t s_pushedCount;
 static std::vector<std::unique_ptr<NWNXLib::Hooks::FunctionHook>> s_managedHooks;
 static std::string s_nwnxActivePlugin;
 static std::string s_nwnxActiveFunction;
+static std::deque<CExoString> s_marshaledStrings;
+static int32_t s_callBuiltInsDepth;
 
 static Hooks::Hook s_mainLoopHook;
 static Hooks::Hook s_runScriptHook;
@@ -550,6 +553,161 @@ NWNX_EXPORT void FreeGameDefinedStructure(int32_t structId, void* ptr)
     }
 }
 
+static bool PushMarshalValue(CVirtualMachine* vm, const MarshalValue& value)
+{
+    switch (value.type)
+    {
+        case MarshalType::Integer:
+            return vm->StackPushInteger(value.integer);
+        case MarshalType::Float:
+            return vm->StackPushFloat(value.number);
+        case MarshalType::String:
+            return vm->StackPushString(value.string.data ? CExoString(value.string.data, value.string.length) : CExoString());
+        case MarshalType::Object:
+            return vm->StackPushObject(value.object);
+        case MarshalType::Vector:
+            return vm->StackPushVector(Vector(value.vector.x, value.vector.y, value.vector.z));
+        case MarshalType::GameDefinedStructure:
+            return vm->StackPushEngineStructure(value.structId, value.structure);
+        default:
+            return false;
+    }
+}
+
+static bool PopMarshalValue(CVirtualMachine* vm, MarshalValue& value)
+{
+    switch (value.type)
+    {
+        case MarshalType::Void:
+            return true;
+        case MarshalType::Integer:
+            return vm->StackPopInteger(&value.integer);
+        case MarshalType::Float:
+            return vm->StackPopFloat(&value.number);
+        case MarshalType::String:
+        {
+            auto& str = s_marshaledStrings.emplace_back();
+            if (!vm->StackPopString(&str))
+                return false;
+
+            value.string.data = str.CStr();
+            value.string.length = str.GetLength();
+            return true;
+        }
+        case MarshalType::Object:
+            return vm->StackPopObject(&value.object);
+        case MarshalType::Vector:
+        {
+            Vector vector;
+            if (!vm->StackPopVector(&vector))
+                return false;
+
+            value.vector = {vector.x, vector.y, vector.z};
+            return true;
+        }
+        case MarshalType::GameDefinedStructure:
+            return vm->StackPopEngineStructure(value.structId, &value.structure);
+        default:
+            return false;
+    }
+}
+
+// Pops an argument that was pushed for a call that never ran.
+static void DiscardMarshalValue(CVirtualMachine* vm, const MarshalValue& value)
+{
+    if (value.type == MarshalType::String)
+    {
+        CExoString str;
+        vm->StackPopString(&str);
+    }
+    else if (value.type == MarshalType::GameDefinedStructure)
+    {
+        void* structure;
+        if (vm->StackPopEngineStructure(value.structId, &structure))
+            FreeGameDefinedStructure(value.structId, structure);
+    }
+    else
+    {
+        MarshalValue discarded = value;
+        PopMarshalValue(vm, discarded);
+    }
+}
+
+static bool IsValidMarshalType(MarshalType type)
+{
+    return type >= MarshalType::Void && type <= MarshalType::GameDefinedStructure;
+}
+
+static int32_t RunBuiltIns(const BuiltInCall* calls, int32_t callCount, const MarshalValue* args, MarshalValue* results)
+{
+    auto vm = Globals::VirtualMachine();
+    auto cmd = static_cast<CNWSVirtualMachineCommands*>(Globals::VirtualMachine()->m_pCmdImplementer);
+    ASSERT(vm->m_nRecursionLevel >= 0);
+
+    for (int32_t i = 0; i < callCount; i++)
+    {
+        const auto& call = calls[i];
+        for (int32_t arg = 0; arg < call.argCount; arg++)
+        {
+            if (!IsValidMarshalType(args[arg].type) || args[arg].type == MarshalType::Void)
+            {
+                LOG_WARNING("Invalid type %i for argument %i of BuiltIn %i.", (int32_t)args[arg].type, arg, call.id);
+                return i;
+            }
+        }
+        if (!IsValidMarshalType(results[i].type))
+        {
+            LOG_WARNING("Invalid result type %i for BuiltIn %i.", (int32_t)results[i].type, call.id);
+            return i;
+        }
+
+        // The command pops its first parameter first, so they go on the stack last to first.
+        for (int32_t arg = call.argCount - 1; arg >= 0; arg--)
+        {
+            if (!PushMarshalValue(vm, args[arg]))
+            {
+                LOG_WARNING("Failed to push argument %i of BuiltIn %i - recursion level %i.",
+                    arg, call.id, vm->m_nRecursionLevel);
+                for (int32_t pushed = arg + 1; pushed < call.argCount; pushed++)
+                    DiscardMarshalValue(vm, args[pushed]);
+                return i;
+            }
+        }
+        args += call.argCount;
+
+        LOG_DEBUG("Calling BuiltIn %i.", call.id);
+        if (cmd->ExecuteCommand(call.id, call.argCount) < 0)
+        {
+            LOG_WARNING("BuiltIn %i failed - recursion level %i.", call.id, vm->m_nRecursionLevel);
+            return i;
+        }
+
+        if (!PopMarshalValue(vm, results[i]))
+        {
+            LOG_WARNING("Failed to pop the result of BuiltIn %i - recursion level %i.", call.id, vm->m_nRecursionLevel);
+            return i;
+        }
+    }
+
+    return callCount;
+}
+
+// Runs a batch of built-ins in one call. The arguments of all calls are packed back to back in args, each
+// call's in declaration order. Before the call results[i] holds the return type of calls[i], MarshalType::Void
+// if there is none. Returns the number of calls that completed, the batch stops at the first one that fails.
+// Built-ins such as ExecuteScript can run managed code that calls back in here, so returned strings are only
+// released when the outermost batch starts.
+NWNX_EXPORT int32_t CallBuiltIns(const BuiltInCall* calls, int32_t callCount, const MarshalValue* args, MarshalValue* results)
+{
+    if (s_callBuiltInsDepth == 0)
+        s_marshaledStrings.clear();
+
+    ++s_callBuiltInsDepth;
+    auto completed = RunBuiltIns(calls, callCount, args, results);
+    --s_callBuiltInsDepth;
+    return completed;
+}
+
 NWNX_EXPORT int32_t ClosureAssignCommand(uint32_t oid, uint64_t eventId)
 {
     if (Utils::GetGameObject(oid))
@@ -832,6 +990,7 @@ std::vector<void*> GetExports()
     exports.push_back((void*)&StackPopRawString);
     exports.push_back((void*)&NWNXPushRawString);
     exports.push_back((void*)&NWNXPopRawString);
+    exports.push_back((void*)&CallBuiltIns);
 
     return exports;
 }
@@ -0,0 +1,42 @@
+using System;
+using System.Numerics;
+using System.Runtime.InteropServices;
+
+namespace NWN
+{
+  public enum MarshalType : int
+  {
+    Void,
+    Integer,
+    Float,
+    String,
+    Object,
+    Vector,
+    GameDefinedStructure
+  }
+
+  /// <summary>
+  /// A packed argument or result for NWNXPInvoke.CallBuiltIns(). String arguments only need to stay valid for the call,
+  /// returned strings are windows-1252 bytes that stay valid until the next CallBuiltIns().
+  /// </summary>
+  [StructLayout(LayoutKind.Explicit, Size = 24)]
+  public unsafe struct MarshalValue
+  {
+    [FieldOffset(0)] public MarshalType Type;
+    [FieldOffset(4)] public int StructId;
+    [FieldOffset(8)] public int Integer;
+    [FieldOffset(8)] public float Float;
+    [FieldOffset(8)] public uint Object;
+    [FieldOffset(8)] public Vector3 Vector;
+    [FieldOffset(8)] public byte* StringData;
+    [FieldOffset(16)] public int StringLength;
+    [FieldOffset(8)] public IntPtr Structure;
+  }
+
+  [StructLayout(LayoutKind.Sequential)]
+  public struct BuiltInCall
+  {
+    public int Id;
+    public int ArgCount;
+  }
+}
@@ -134,5 +134,8 @@ namespace NWN
 
     [DllImport("NWNX_DotNET", CallingConvention = CallingConvention.Cdecl)]
     public static extern IntPtr NWNXPopRawString();
+
+    [DllImport("NWNX_DotNET", CallingConvention = CallingConvention.Cdecl)]
+    public static extern int CallBuiltIns(BuiltInCall* calls, int callCount, MarshalValue* args, MarshalValue* results);
   }
 }
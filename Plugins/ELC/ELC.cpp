@@ -1,4 +1,4 @@
-#include "nwnx.hpp"
+#include "Validation.hpp"
 
 #include "API/CAppManager.hpp"
 #include "API/CServerExoApp.hpp"
@@ -7,141 +7,28 @@
 #include "API/CNWSCreature.hpp"
 #include "API/CNWSPlayer.hpp"
 #include "API/CNWSCreatureStats.hpp"
-#include "API/CNWLevelStats.hpp"
 #include "API/CNWSInventory.hpp"
 #include "API/CNWSItem.hpp"
-#include "API/CNWRace.hpp"
+#include "API/CNWSMessage.hpp"
+#include "API/CNWSArea.hpp"
 #include "API/CNWRules.hpp"
-#include "API/CNWClass.hpp"
-#include "API/CNWDomain.hpp"
-#include "API/CNWSkill.hpp"
-#include "API/CNWFeat.hpp"
-#include "API/CNWSpell.hpp"
-#include "API/CNWSpellArray.hpp"
-#include "API/CTwoDimArrays.hpp"
+#include "API/CNetLayer.hpp"
+#include "API/Vector.hpp"
 
-#include <set>
-#include <map>
+#include <algorithm>
+#include <unordered_map>
 
 
 using namespace NWNXLib;
 using namespace NWNXLib::API;
 using namespace NWNXLib::API::Constants;
-
-namespace ValidationFailureType
-{
-    enum TYPE
-    {
-        None = 0,
-        Character,
-        Item,
-        Skill,
-        Feat,
-        Spell,
-        Custom
-    };
-}
-namespace ValidationFailureSubType
-{
-    enum TYPE
-    {
-        None = 0,
-        ServerLevelRestriction,
-        LevelHack,
-        ColoredName,
-        UnidentifiedEquippedItem,
-        MinEquipLevel,
-        NonPCCharacter,
-        DMCharacter,
-        NonPlayerRace,
-        NonPlayerClass,
-        ClassLevelRestriction,
-        PrestigeClassRequirements,
-        ClassAlignmentRestriction,
-        StartingAbilityValueMax,
-        AbilityPointBuySystemCalculation,
-        ClassSpellcasterInvalidPrimaryStat,
-        EpicLevelFlag,
-        TooManyHitPoints,
-        UnusableSkill,
-        NotEnoughSkillPoints,
-        InvalidNumRanksInClassSkill,
-        InvalidNumRanksInNonClassSkill,
-        InvalidNumRemainingSkillPoints,
-        InvalidFeat,
-        FeatRequiredSpellLevelNotMet,
-        FeatRequiredBaseAttackBonusNotMet,
-        FeatRequiredAbilityValueNotMet,
-        FeatRequiredSkillNotMet,
-        FeatRequiredFeatNotMet,
-        TooManyFeatsThisLevel,
-        FeatNotAvailableToClass,
-        FeatIsNormalFeatOnly,
-        FeatIsBonusFeatOnly,
-        SpellInvalidSpellGainWizard,
-        SpellInvalidSpellGainBardSorcerer,
-        SpellInvalidSpellGainOtherClasses,
-        InvalidSpell,
-        SpellInvalidSpellLevel,
-        SpellMinimumAbilityBardSorcerer_Unused,
-        SpellMinimumAbilityWizard_Unused,
-        SpellMinimumAbility,
-        SpellRestrictedSpellSchool,
-        SpellAlreadyKnown,
-        SpellWizardExceedsNumSpellsToAdd,
-        IllegalRemovedSpell,
-        RemovedNotKnownSpell,
-        InvalidNumSpells,
-        SpellListComparison,
-        SkillListComparison,
-        FeatListComparison,
-        MiscSavingThrow,
-        NumFeatComparison,
-        NumMulticlass
-    };
-}
-// Validation Failure STRREFS
-const int32_t STRREF_CHARACTER_DOES_NOT_EXIST               = 63767;
-const int32_t STRREF_CHARACTER_LEVEL_RESTRICTION            = 57924;
-const int32_t STRREF_CHARACTER_NON_PLAYER                   = 63760;
-const int32_t STRREF_CHARACTER_DUNGEON_MASTER               = 67641;
-const int32_t STRREF_CHARACTER_NON_PLAYER_RACE              = 66166;
-const int32_t STRREF_CHARACTER_NON_PLAYER_CLASS             = 66167;
-const int32_t STRREF_CHARACTER_TOO_MANY_HITPOINTS           = 3109;
-const int32_t STRREF_CHARACTER_SAVING_THROW                 = 8066;
-const int32_t STRREF_CHARACTER_INVALID_ABILITY_SCORES       = 63761;
-const int32_t STRREF_CHARACTER_NUMBERMULTICLASSES           = 63764;
-const int32_t STRREF_ITEM_LEVEL_RESTRICTION                 = 68521;
-const int32_t STRREF_SKILL_UNUSEABLE                        = 63815;
-const int32_t STRREF_SKILL_INVALID_RANKS                    = 66165;
-const int32_t STRREF_SKILL_INVALID_NUM_SKILLPOINTS          = 66155;
-const int32_t STRREF_FEAT_INVALID                           = 76383;
-const int32_t STRREF_FEAT_TOO_MANY                          = 66222;
-const int32_t STRREF_FEAT_REQ_ABILITY                       = 66175;
-const int32_t STRREF_FEAT_REQ_SPELL_LEVEL                   = 66176;
-const int32_t STRREF_FEAT_REQ_FEAT                          = 66182;
-const int32_t STRREF_FEAT_REQ_SKILL                         = 66183;
-const int32_t STRREF_SPELL_REQ_SPELL_LEVEL                  = 66498;
-const int32_t STRREF_SPELL_INVALID_SPELL                    = 66499;
-const int32_t STRREF_SPELL_ILLEGAL_LEVEL                    = 68627;
-const int32_t STRREF_SPELL_REQ_ABILITY                      = 68628;
-const int32_t STRREF_SPELL_LEARNED_TWICE                    = 68629;
-const int32_t STRREF_SPELL_ILLEGAL_NUM_SPELLS               = 68630;
-const int32_t STRREF_SPELL_ILLEGAL_REMOVED_SPELLS           = 68631;
-const int32_t STRREF_SPELL_OPPOSITE_SPELL_SCHOOL            = 66500;
-const int32_t STRREF_CUSTOM                                 = 164;
-
-// Magic Numbers
-const int32_t NUM_CREATURE_ITEM_SLOTS       = 4;
-const int32_t NUM_MULTICLASS                = 8;
-const int32_t CHARACTER_EPIC_LEVEL          = 21;
-const int32_t NUM_SPELL_LEVELS              = 10;
+using namespace ELC;
 
 static std::string s_elcScript = Config::Get<std::string>("ELC_SCRIPT", "");
 static bool s_enableCustomELCCheck = Config::Get<bool>("CUSTOM_ELC_CHECK", false);
 static bool s_enforceDefaultEventScripts = Config::Get<bool>("ENFORCE_DEFAULT_EVENT_SCRIPTS", false);
 static bool s_enforceEmptyDialogResRef = Config::Get<bool>("ENFORCE_EMPTY_DIALOG_RESREF", false);
-static bool s_enforceCasterPrimaryStatIs11 = Config::Get<bool>("ENFORCE_CASTER_PRIMARY_STAT_IS_11", false);
+static bool s_asyncValidation = Config::Get<bool>("ASYNC_VALIDATION", false);
 static uint32_t s_elcDepth = 0;
 static bool s_skipValidationFailure;
 static int32_t s_validationFailureType;
@@ -153,6 +40,141 @@ static int32_t s_ELCSkillID;
 static int32_t s_ELCFeatID;
 static int32_t s_ELCSpellID;
 
+// A character whose validation is running on the async thread. Its player is kept out of the game until the result
+// arrives: the area the server would send it to is held here and sent once the character passes.
+struct PendingValidation
+{
+    uint64_t serial;
+    ObjectID oidCreature;
+    bool bAreaDeferred;
+    ObjectID oidArea;
+    Vector vPosition;
+    Vector vOrientation;
+    BOOL bPlayerIsNewToModule;
+};
+static std::unordered_map<uint32_t, PendingValidation> s_pendingValidations;
+static uint64_t s_validationSerial;
+
+static int32_t HandleValidationFailure(ObjectID oidPlayer, ValidationFailureType::TYPE type,
+                                       ValidationFailureSubType::TYPE subType, int32_t strRef)
+{
+    s_skipValidationFailure = false;
+    s_validationFailureType = type;
+    s_validationFailureSubType = subType;
+    s_validationFailureMessageStrRef = strRef;
+
+    if (!s_elcScript.empty())
+    {
+        LOG_DEBUG("Running ELC Script '%s' on object '%x' with Type '%i', subType '%i' and strRef '%i'",
+                  s_elcScript, oidPlayer,
+                  s_validationFailureType, s_validationFailureSubType,
+                  s_validationFailureMessageStrRef);
+
+        ++s_elcDepth;
+        Utils::ExecuteScript(s_elcScript, oidPlayer);
+        --s_elcDepth;
+
+        if (s_skipValidationFailure)
+        {
+            LOG_DEBUG("Skipping ELC Validation Failure of object '%x' with Type '%i', subType '%i' and strRef '%i'",
+                      oidPlayer, s_validationFailureType,
+                      s_validationFailureSubType,
+                      s_validationFailureMessageStrRef);
+
+            s_validationFailureMessageStrRef = 0;
+        }
+    }
+
+    return s_validationFailureMessageStrRef;
+}
+
+// Runs the ELC script for each failure found by ValidateCharacter() in order and returns the strref of the first one
+// it doesn't skip, then the custom check. Main thread only.
+static int32_t ResolveValidationFailures(ObjectID oidPlayer, const std::vector<ValidationFailure> &failures)
+{
+    s_ILRItemOID = Constants::OBJECT_INVALID;
+
+    for (const auto &failure : failures)
+    {
+        s_ELCLevel = failure.level;
+        s_ELCSkillID = failure.skillId;
+        s_ELCFeatID = failure.featId;
+        s_ELCSpellID = failure.spellId;
+
+        if (auto strrefFailure = HandleValidationFailure(oidPlayer, failure.type, failure.subType, failure.strRef))
+        {
+            return strrefFailure;
+        }
+    }
+
+    s_ELCSkillID = -1;
+    s_ELCFeatID = -1;
+    s_ELCSpellID = -1;
+
+    // Run a custom ELC check if enabled and there is an ELC script set
+    if (s_enableCustomELCCheck)
+    {
+        if (!s_elcScript.empty())
+        {
+            if (auto strrefFailure = HandleValidationFailure(
+                    oidPlayer,
+                    ValidationFailureType::Custom,
+                    ValidationFailureSubType::None,
+                    STRREF_CUSTOM))
+            {
+                return strrefFailure;
+            }
+        }
+        else
+        {
+            LOG_WARNING("NWNX_ELC: Skipping Custom ELC Check because an ELC script is not set!");
+        }
+    }
+
+    MessageBus::Broadcast("NWNX_EVENT_SIGNAL_EVENT", {"NWNX_ON_ELC_VALIDATE_CHARACTER_AFTER",
+                                                      Utils::ObjectIDToString(oidPlayer)});
+
+    return 0;
+}
+
+static void FinishAsyncValidation(uint32_t playerId, uint64_t serial, const std::vector<ValidationFailure> &failures)
+{
+    auto it = s_pendingValidations.find(playerId);
+    if (it == s_pendingValidations.end() || it->second.serial != serial)
+        return;
+
+    auto pending = it->second;
+    s_pendingValidations.erase(it);
+
+    // The player left, or the slot was reused, before the result arrived
+    auto *pServerExoApp = Globals::AppManager()->m_pServerExoApp;
+    auto *pPlayer = pServerExoApp->GetClientObjectByPlayerId(playerId);
+    if (!pPlayer || pPlayer->m_oidNWSObject != pending.oidCreature)
+        return;
+
+    if (auto strrefFailure = ResolveValidationFailures(pending.oidCreature, failures))
+    {
+        LOG_INFO("Character '%x' of player '%u' failed validation with strRef '%i'", pending.oidCreature, playerId, strrefFailure);
+        pServerExoApp->GetNetLayer()->DisconnectPlayer(playerId, strrefFailure, true);
+        return;
+    }
+
+    if (pending.bAreaDeferred)
+    {
+        auto *pArea = Utils::AsNWSArea(Utils::GetGameObject(pending.oidArea));
+        if (!pArea)
+        {
+            LOG_WARNING("The area of validated character '%x' no longer exists", pending.oidCreature);
+            pServerExoApp->GetNetLayer()->DisconnectPlayer(playerId);
+            return;
+        }
+
+        pServerExoApp->GetNWSMessage()->SendServerToPlayerArea_ClientArea(pPlayer, pArea,
+                pending.vPosition.x, pending.vPosition.y, pending.vPosition.z,
+                pending.vOrientation, pending.bPlayerIsNewToModule);
+    }
+}
+
 static auto s_ValidateCharacter = Hooks::HookFunction(&CNWSPlayer::ValidateCharacter,
         +[](CNWSPlayer *pPlayer, int32_t *bFailedServerRestriction) -> int32_t
         {
@@ -184,39 +206,6 @@ static auto s_ValidateCharacter = Hooks::HookFunction(&CNWSPlayer::ValidateChara
                 return STRREF_CHARACTER_DOES_NOT_EXIST;
             // **********************************************************************************************************************
 
-            auto HandleValidationFailure = [&](ValidationFailureType::TYPE type, ValidationFailureSubType::TYPE subType,
-                                               int32_t strRef) -> int32_t
-            {
-                s_skipValidationFailure = false;
-                s_validationFailureType = type;
-                s_validationFailureSubType = subType;
-                s_validationFailureMessageStrRef = strRef;
-
-                if (!s_elcScript.empty())
-                {
-                    LOG_DEBUG("Running ELC Script '%s' on object '%x' with Type '%i', subType '%i' and strRef '%i'",
-                              s_elcScript, pPlayer->m_oidNWSObject,
-                              s_validationFailureType, s_validationFailureSubType,
-                              s_validationFailureMessageStrRef);
-
-                    ++s_elcDepth;
-                    Utils::ExecuteScript(s_elcScript, pPlayer->m_oidNWSObject);
-                    --s_elcDepth;
-
-                    if (s_skipValidationFailure)
-                    {
-                        LOG_DEBUG("Skipping ELC Validation Failure of object '%x' with Type '%i', subType '%i' and strRef '%i'",
-                                  pPlayer->m_oidNWSObject, s_validationFailureType,
-                                  s_validationFailureSubType,
-                                  s_validationFailureMessageStrRef);
-
-                        s_validationFailureMessageStrRef = 0;
-                    }
-                }
-
-                return s_validationFailureMessageStrRef;
-            };
-
             MessageBus::Broadcast("NWNX_EVENT_SIGNAL_EVENT", {"NWNX_ON_ELC_VALIDATE_CHARACTER_BEFORE",
                                                              Utils::ObjectIDToString(pPlayer->m_oidNWSObject)});
 
@@ -231,6 +220,7 @@ static auto s_ValidateCharacter = Hooks::HookFunction(&CNWSPlayer::ValidateChara
                 nCharacterLevel > pServerInfo->m_JoiningRestrictions.nMaxLevel)
             {
                 if (auto strrefFailure = HandleValidationFailure(
+                        pPlayer->m_oidNWSObject,
                         ValidationFailureType::Character,
                         ValidationFailureSubType::ServerLevelRestriction,
                         STRREF_CHARACTER_LEVEL_RESTRICTION))
@@ -244,6 +234,7 @@ static auto s_ValidateCharacter = Hooks::HookFunction(&CNWSPlayer::ValidateChara
             if (pCreatureStats->m_nNumMultiClasses > std::clamp<int32_t>(Globals::Rules()->GetRulesetIntEntry(CRULES_HASHEDSTR("MULTICLASS_LIMIT"), 3), 1, 8))
             {
                 if (auto strrefFailure = HandleValidationFailure(
+                        pPlayer->m_oidNWSObject,
                         ValidationFailureType::Character,
                         ValidationFailureSubType::NumMulticlass,
                         STRREF_CHARACTER_NUMBERMULTICLASSES))
@@ -264,6 +255,7 @@ static auto s_ValidateCharacter = Hooks::HookFunction(&CNWSPlayer::ValidateChara
                 if (nTotalLevels > pServerInfo->m_JoiningRestrictions.nMaxLevel)
                 {
                     if (auto strrefFailure = HandleValidationFailure(
+                            pPlayer->m_oidNWSObject,
                             ValidationFailureType::Character,
                             ValidationFailureSubType::LevelHack,
                             STRREF_CHARACTER_LEVEL_RESTRICTION))
@@ -299,6 +291,7 @@ static auto s_ValidateCharacter = Hooks::HookFunction(&CNWSPlayer::ValidateChara
             if (CheckColoredName(pCreatureStats->m_lsFirstName) || CheckColoredName(pCreatureStats->m_lsLastName))
             {
                 if (auto strrefFailure = HandleValidationFailure(
+                        pPlayer->m_oidNWSObject,
                         ValidationFailureType::Character,
                         ValidationFailureSubType::ColoredName,
                         STRREF_CHARACTER_DOES_NOT_EXIST))
@@ -328,6 +321,7 @@ static auto s_ValidateCharacter = Hooks::HookFunction(&CNWSPlayer::ValidateChara
                     if (!pItem->m_bIdentified)
                     {
                         if (auto strrefFailure = HandleValidationFailure(
+                                pPlayer->m_oidNWSObject,
                                 ValidationFailureType::Item,
                                 ValidationFailureSubType::UnidentifiedEquippedItem,
                                 STRREF_ITEM_LEVEL_RESTRICTION))
@@ -341,6 +335,7 @@ static auto s_ValidateCharacter = Hooks::HookFunction(&CNWSPlayer::ValidateChara
                     if (pItem->GetMinEquipLevel() > nCharacterLevel)
                     {
                         if (auto strrefFailure = HandleValidationFailure(
+                                pPlayer->m_oidNWSObject,
                                 ValidationFailureType::Item,
                                 ValidationFailureSubType::MinEquipLevel,
                                 STRREF_ITEM_LEVEL_RESTRICTION))
@@ -369,8 +364,6 @@ static auto s_ValidateCharacter = Hooks::HookFunction(&CNWSPlayer::ValidateChara
             // **********************************************************************************************************************
 
             // *** Character Validation (ELC) ***************************************************************************************
-            CNWRules *pRules = Globals::Rules();
-
             // Return early if ELC is off
             if (!pServerInfo->m_PlayOptions.bEnforceLegalCharacters)
             {
@@ -392,1496 +385,65 @@ static auto s_ValidateCharacter = Hooks::HookFunction(&CNWSPlayer::ValidateChara
                 pCreature->m_pStats->m_cDialog = CResRef("");
             }
 
-            // Check for non PC
-            if (!pCreatureStats->m_bIsPC)
-            {
-                if (auto strrefFailure = HandleValidationFailure(
-                        ValidationFailureType::Character,
-                        ValidationFailureSubType::NonPCCharacter,
-                        STRREF_CHARACTER_NON_PLAYER))
-                {
-                    return strrefFailure;
-                }
-            }
-
-            // Check for DM character file
-            if (pCreatureStats->m_bIsDMCharacterFile)
-            {
-                if (auto strrefFailure = HandleValidationFailure(
-                        ValidationFailureType::Character,
-                        ValidationFailureSubType::DMCharacter,
-                        STRREF_CHARACTER_DUNGEON_MASTER))
-                {
-                    return strrefFailure;
-                }
-            }
-
-            // Check for non player race
-            CNWRace *pRace =
-                    pCreatureStats->m_nRace < pRules->m_nNumRaces ? &pRules->m_lstRaces[pCreatureStats->m_nRace] : nullptr;
-            if (!pRace || !pRace->m_bIsPlayerRace)
-            {
-                if (auto strrefFailure = HandleValidationFailure(
-                        ValidationFailureType::Character,
-                        ValidationFailureSubType::NonPlayerRace,
-                        STRREF_CHARACTER_NON_PLAYER_RACE))
-                {
-                    return strrefFailure;
-                }
-            }
-
-            // Check for non player classes, class level restrictions and prestige class requirements
-            // We also check class alignment restrictions for new characters only
-            for (int nMultiClass = 0; nMultiClass < pCreatureStats->m_nNumMultiClasses; nMultiClass++)
-            {
-                uint8_t classId = pCreatureStats->m_ClassInfo[nMultiClass].m_nClass;
-
-                CNWClass *pClass = classId < pRules->m_nNumClasses ? &pRules->m_lstClasses[classId] : nullptr;
-
-                if (!pClass || !pClass->m_bIsPlayerClass)
-                {
-                    if (auto strrefFailure = HandleValidationFailure(
-                            ValidationFailureType::Character,
-                            ValidationFailureSubType::NonPlayerClass,
-                            STRREF_CHARACTER_NON_PLAYER_CLASS))
-                    {
-                        return strrefFailure;
-                    }
-                }
-
-                if (pClass->m_nMaxLevel > 0 && pCreatureStats->GetClassLevel(nMultiClass, false) > pClass->m_nMaxLevel)
-                {
-                    if (auto strrefFailure = HandleValidationFailure(
-                            ValidationFailureType::Character,
-                            ValidationFailureSubType::ClassLevelRestriction,
-                            STRREF_CHARACTER_NON_PLAYER_CLASS))
-                    {
-                        return strrefFailure;
-                    }
-                }
-
-                if (!pCreatureStats->GetMeetsPrestigeClassRequirements(pClass))
-                {
-                    if (auto strrefFailure = HandleValidationFailure(
-                            ValidationFailureType::Character,
-                            ValidationFailureSubType::PrestigeClassRequirements,
-                            STRREF_CHARACTER_NON_PLAYER_CLASS))
-                    {
-                        return strrefFailure;
-                    }
-                }
-
-                if (nMultiClass == 0 && nCharacterLevel == 1 && pCreatureStats->m_nExperience == 0)
-                {
-                    if (!pClass->GetIsAlignmentAllowed(pCreatureStats->GetSimpleAlignmentGoodEvil(),
-                                                       pCreatureStats->GetSimpleAlignmentLawChaos()))
-                    {
-                        if (auto strrefFailure = HandleValidationFailure(
-                                ValidationFailureType::Character,
-                                ValidationFailureSubType::ClassAlignmentRestriction,
-                                STRREF_CHARACTER_NON_PLAYER_CLASS))
-                        {
-                            return strrefFailure;
-                        }
-                    }
-                }
-            }
-
             // Check movement rate
             if (pCreatureStats->m_nMovementRate != MovementRate::PC)
             {
                 pCreatureStats->SetMovementRate(MovementRate::PC);
             }
 
-            // Calculate Ability Scores
-            uint8_t nAbility[6] = {0};
-            int32_t nMods[6] = {0};
-
-            CNWSCreatureStats::GetStatBonusesFromFeats(&pCreatureStats->m_lstFeats, nMods, true);
-
-            //LOG_DEBUG("(GetStatBonusesFromFeats) STR: %i, DEX: %i, CON: %i, INT: %i, WIS: %i, CHA: %i", nMods[0], nMods[1], nMods[2], nMods[3], nMods[4], nMods[5]);
-
-            // Get our base ability stats
-            nAbility[Ability::Strength] = (pCreature->m_bIsPolymorphed ?
-                                           pCreature->m_nPrePolymorphSTR : pCreatureStats->m_nStrengthBase) +
-                                          nMods[Ability::Strength];
-            nAbility[Ability::Dexterity] = (pCreature->m_bIsPolymorphed ?
-                                            pCreature->m_nPrePolymorphDEX : pCreatureStats->m_nDexterityBase) +
-                                           nMods[Ability::Dexterity];
-            nAbility[Ability::Constitution] = (pCreature->m_bIsPolymorphed ?
-                                               pCreature->m_nPrePolymorphCON : pCreatureStats->m_nConstitutionBase) +
-                                              nMods[Ability::Constitution];
-            nAbility[Ability::Intelligence] = pCreatureStats->m_nIntelligenceBase + nMods[Ability::Intelligence];
-            nAbility[Ability::Wisdom] = pCreatureStats->m_nWisdomBase + nMods[Ability::Wisdom];
-            nAbility[Ability::Charisma] = pCreatureStats->m_nCharismaBase + nMods[Ability::Charisma];
-
-            // Get the level 1 ability values
-            for (int nLevel = 4; nLevel <= nCharacterLevel; nLevel += 4)
-            {
-                uint8_t nAbilityGain = pCreatureStats->GetLevelStats(nLevel - 1)->m_nAbilityGain;
-
-                if (nAbilityGain < Ability::MAX)
-                    nAbility[nAbilityGain]--;
-            }
-
-            static int32_t charGenBaseAbilityMin = Globals::Rules()->GetRulesetIntEntry(CRULES_HASHEDSTR("CHARGEN_BASE_ABILITY_MIN"), 8);
-            static int32_t charGenBaseAbilityMax = Globals::Rules()->GetRulesetIntEntry(CRULES_HASHEDSTR("CHARGEN_BASE_ABILITY_MAX"), 18);
+            // Everything below reads the snapshot only. It is taken here, inside any outer ValidateCharacter hooks, so
+            // changes they make to the character for the duration of the validation are part of it.
+            auto rules = GetRulesSnapshot(pCreatureStats);
+            auto character = TakeCharacterSnapshot(pPlayer, pCreature, *rules);
 
-            // Check if >18 in an ability
-            for (int nAbilityIndex = 0; nAbilityIndex < Ability::MAX; nAbilityIndex++)
+            if (!s_asyncValidation)
             {
-                if (nAbility[nAbilityIndex] > charGenBaseAbilityMax)
-                {
-                    if (auto strrefFailure = HandleValidationFailure(
-                            ValidationFailureType::Character,
-                            ValidationFailureSubType::StartingAbilityValueMax,
-                            STRREF_CHARACTER_INVALID_ABILITY_SCORES))
-                    {
-                        return strrefFailure;
-                    }
-                }
+                return ResolveValidationFailures(pPlayer->m_oidNWSObject, ValidateCharacter(*character, *rules));
             }
 
-            // Point Buy System calculation
-            uint8_t nAbilityAtLevel[6] = {0};
-            uint8_t nPointBuy = pRace->m_nAbilitiesPointBuyNumber;
-
-            static int32_t abilityCostIncrement2 = Globals::Rules()->GetRulesetIntEntry(CRULES_HASHEDSTR("CHARGEN_ABILITY_COST_INCREMENT2"), 14);
-            static int32_t abilityCostIncrement3 = Globals::Rules()->GetRulesetIntEntry(CRULES_HASHEDSTR("CHARGEN_ABILITY_COST_INCREMENT3"), 16);
-
-            for (int nAbilityIndex = 0; nAbilityIndex < Ability::MAX; nAbilityIndex++)
+            // Let the login continue and hold the player out of the game until the result is in
+            auto playerId = pPlayer->m_nPlayerID;
+            auto serial = ++s_validationSerial;
+            auto &pending = s_pendingValidations[playerId];
+            if (pending.oidCreature != pPlayer->m_oidNWSObject)
             {
-                nAbilityAtLevel[nAbilityIndex] = nAbility[nAbilityIndex];
-
-                while (nAbility[nAbilityIndex] > charGenBaseAbilityMin)
-                {
-                    if (nAbility[nAbilityIndex] > abilityCostIncrement3)
-                    {
-                        if (nPointBuy < 3)
-                        {
-                            if (auto strrefFailure = HandleValidationFailure(
-                                    ValidationFailureType::Character,
-                                    ValidationFailureSubType::AbilityPointBuySystemCalculation,
-                                    STRREF_CHARACTER_INVALID_ABILITY_SCORES))
-                            {
-                                return strrefFailure;
-                            }
-                        }
-
-                        nAbility[nAbilityIndex]--;
-                        nPointBuy -= 3;
-                    }
-                    else if (nAbility[nAbilityIndex] > abilityCostIncrement2)
-                    {
-                        if (nPointBuy < 2)
-                        {
-                            if (auto strrefFailure = HandleValidationFailure(
-                                    ValidationFailureType::Character,
-                                    ValidationFailureSubType::AbilityPointBuySystemCalculation,
-                                    STRREF_CHARACTER_INVALID_ABILITY_SCORES))
-                            {
-                                return strrefFailure;
-                            }
-                        }
-
-                        nAbility[nAbilityIndex]--;
-                        nPointBuy -= 2;
-                    }
-                    else
-                    {
-                        if (nPointBuy < 1)
-                        {
-                            if (auto strrefFailure = HandleValidationFailure(
-                                    ValidationFailureType::Character,
-                                    ValidationFailureSubType::AbilityPointBuySystemCalculation,
-                                    STRREF_CHARACTER_INVALID_ABILITY_SCORES))
-                            {
-                                return strrefFailure;
-                            }
-                        }
-
-                        nAbility[nAbilityIndex]--;
-                        nPointBuy--;
-                    }
-                }
+                pending = {};
+                pending.oidCreature = pPlayer->m_oidNWSObject;
             }
+            pending.serial = serial;
 
-            // Get Cleric Domain Feats
-            uint16_t nDomainFeat1 = -1, nDomainFeat2 = -1;
-            for (int nMultiClass = 0; nMultiClass < pCreatureStats->m_nNumMultiClasses; nMultiClass++)
+            Tasks::QueueOnAsyncThread([playerId, serial, character = std::move(character), rules = std::move(rules)]()
             {
-                if (Globals::Rules()->m_lstClasses[pCreatureStats->GetClass(nMultiClass)].m_bHasDomains)
+                auto failures = ValidateCharacter(*character, *rules);
+                Tasks::QueueOnMainThread([playerId, serial, failures = std::move(failures)]()
                 {
-                    CNWDomain *pDomain = pRules->GetDomain(pCreatureStats->GetDomain1(nMultiClass));
-
-                    if (pDomain)
-                    {
-                        nDomainFeat1 = pDomain->m_nGrantedFeat;
-                    }
-
-                    pDomain = pRules->GetDomain(pCreatureStats->GetDomain2(nMultiClass));
+                    FinishAsyncValidation(playerId, serial, failures);
+                });
+            });
 
-                    if (pDomain)
-                    {
-                        nDomainFeat2 = pDomain->m_nGrantedFeat;
-                    }
-                }
-            }
+            return 0;
+        }, Hooks::Order::Final);
 
-            // Init some vars
-            uint8_t nMultiClassLevel[NUM_MULTICLASS] = {0};
-            uint16_t nSkillPointsRemaining = 0;
-            std::vector<uint8_t> listSkillRanks;
-            listSkillRanks.resize(pRules->m_nNumSkills, 0);
-            std::set<uint16_t> listFeats;
-            std::set<uint16_t> listChosenFeats;
-            // [nMultiClass][nSpellLevel] -> {SpellIDs}
-            std::vector<std::map<uint32_t, std::set<uint32_t>>> listSpells;
-            listSpells.resize(NUM_MULTICLASS);
-
-// *** Character Per-Level Checks********************************************************************************************
-            for (int nLevel = 1; nLevel <= nCharacterLevel; nLevel++)
+static Hooks::Hook s_SendServerToPlayerArea_ClientArea = s_asyncValidation ?
+    Hooks::HookFunction(&CNWSMessage::SendServerToPlayerArea_ClientArea,
+        +[](CNWSMessage *pMessage, CNWSPlayer *pPlayer, CNWSArea *pArea, float fX, float fY, float fZ,
+            const Vector *vNewOrientation, BOOL bPlayerIsNewToModule) -> int32_t
+        {
+            auto it = s_pendingValidations.find(pPlayer->m_nPlayerID);
+            if (it != s_pendingValidations.end() && it->second.oidCreature == pPlayer->m_oidNWSObject)
             {
-                // Grab our level stats and figure out which class was leveled
-                CNWLevelStats *pLevelStats = pCreatureStats->GetLevelStats(nLevel - 1);
-                uint8_t nClassLeveledUpIn = pLevelStats->m_nClass;
-                CNWClass *pClassLeveledUpIn = &pRules->m_lstClasses[nClassLeveledUpIn];
-
-                // Reset variables
-                s_ELCSkillID = -1;
-                s_ELCFeatID = -1;
-                s_ELCSpellID = -1;
-
-                // Store our current level so we can retrieve it
-                s_ELCLevel = nLevel;
-
-                // Keep track of multiclass levels
-                uint8_t nMultiClassLeveledUpIn = 0;
-                for (int nMultiClass = 0; nMultiClass < pCreatureStats->m_nNumMultiClasses; nMultiClass++)
-                {
-                    if (nClassLeveledUpIn == pCreatureStats->GetClass(nMultiClass))
-                    {
-                        nMultiClassLevel[nMultiClass]++;
-                        nMultiClassLeveledUpIn = nMultiClass;
-                    }
-                }
-
-                if (s_enforceCasterPrimaryStatIs11)
-                {
-                    // Check if our first level class is a spellcaster and if their primary casting stat is >= 11
-                    if (nLevel == 1 && pClassLeveledUpIn->m_bIsSpellCasterClass)
-                    {
-                        if (nAbilityAtLevel[pClassLeveledUpIn->m_nPrimaryAbility] < 11)
-                        {
-                            if (auto strrefFailure = HandleValidationFailure(
-                                    ValidationFailureType::Character,
-                                    ValidationFailureSubType::ClassSpellcasterInvalidPrimaryStat,
-                                    STRREF_CHARACTER_INVALID_ABILITY_SCORES))
-                            {
-                                return strrefFailure;
-                            }
-                        }
-                    }
-                }
-
-                // Check Epic Level Flag
-                if (nLevel < CHARACTER_EPIC_LEVEL)
-                {
-                    if (pLevelStats->m_bEpic != 0)
-                    {
-                        if (auto strrefFailure = HandleValidationFailure(
-                                ValidationFailureType::Feat,
-                                ValidationFailureSubType::EpicLevelFlag,
-                                STRREF_FEAT_INVALID))
-                        {
-                            return strrefFailure;
-                        }
-                    }
-                }
-                else
-                {
-                    if (pLevelStats->m_bEpic == 0)
-                    {
-                        if (auto strrefFailure = HandleValidationFailure(
-                                ValidationFailureType::Feat,
-                                ValidationFailureSubType::EpicLevelFlag,
-                                STRREF_FEAT_INVALID))
-                        {
-                            return strrefFailure;
-                        }
-                    }
-                }
-
-                // Keep track of our ability values
-                if (((nLevel) % 4) == 0)
-                {
-                    nAbilityAtLevel[pLevelStats->m_nAbilityGain]++;
-                }
-
-                // Add the stat bonus from feats
-                int32_t nStatMods[6] = {0};
-                CNWSCreatureStats::GetStatBonusesFromFeats(&pLevelStats->m_lstFeats, nStatMods, false);
-
-                // Update our ability values
-                for (int nAbilityIndex = 0; nAbilityIndex < Ability::MAX; nAbilityIndex++)
-                {
-                    nAbilityAtLevel[nAbilityIndex] += nStatMods[nAbilityIndex];
-                }
-
-                for (int nAbilityIndex = 0; nAbilityIndex < Ability::MAX; nAbilityIndex++)
-                {
-                    nAbilityAtLevel[nAbilityIndex] += pClassLeveledUpIn->GetAbilityGainForSingleLevel(nAbilityIndex, nMultiClassLevel[nMultiClassLeveledUpIn]);
-                }
-
-// *** Check Hit Die ********************************************************************************************************
-                if (pLevelStats->m_nHitDie > pCreatureStats->GetHitDie(nMultiClassLeveledUpIn, nClassLeveledUpIn))
-                {
-                    if (auto strrefFailure = HandleValidationFailure(
-                            ValidationFailureType::Character,
-                            ValidationFailureSubType::TooManyHitPoints,
-                            STRREF_CHARACTER_TOO_MANY_HITPOINTS))
-                    {
-                        return strrefFailure;
-                    }
-                }
-// **************************************************************************************************************************
-
-// *** Check Skills *********************************************************************************************************
-                // Calculate the skillpoints we gained this level
-                auto GetSkillPointAbilityAdjust = [&]() -> int32_t
-                {
-                    switch (pRace->m_nSkillPointModifierAbility)
-                    {
-                        case Constants::Ability::Strength:
-                            return pRace->m_nSTRAdjust;
-                        case Constants::Ability::Dexterity:
-                            return pRace->m_nDEXAdjust;
-                        case Constants::Ability::Constitution:
-                            return pRace->m_nCONAdjust;
-                        case Constants::Ability::Intelligence:
-                            return pRace->m_nINTAdjust;
-                        case Constants::Ability::Wisdom:
-                            return pRace->m_nWISAdjust;
-                        case Constants::Ability::Charisma:
-                            return pRace->m_nCHAAdjust;
-                        default:
-                            return 0;
-                    }
-                };
-
-                auto numSkillPoints =
-                        pRace->m_nSkillPointModifierAbility >= 0 && pRace->m_nSkillPointModifierAbility < Ability::MAX ?
-                        pCreatureStats->CalcStatModifier(
-                                nAbilityAtLevel[pRace->m_nSkillPointModifierAbility] + GetSkillPointAbilityAdjust()) : 0;
-
-                if (nLevel == 1)
-                {
-                    nSkillPointsRemaining += pRace->m_nFirstLevelSkillPointsMultiplier *
-                                             std::max(1, pClassLeveledUpIn->m_nSkillPointBase + numSkillPoints);
-                    nSkillPointsRemaining += pRace->m_nFirstLevelSkillPointsMultiplier * pRace->m_nExtraSkillPointsPerLevel;
-                }
-                else
-                {
-                    nSkillPointsRemaining += std::max(1, pClassLeveledUpIn->m_nSkillPointBase + numSkillPoints);
-                    nSkillPointsRemaining += pRace->m_nExtraSkillPointsPerLevel;
-                }
-
-                // Loop all the skills and check our LevelStats to see what changed
-                for (int nSkill = 0; nSkill < pRules->m_nNumSkills; nSkill++)
-                {
-                    CNWSkill *pSkill = &pRules->m_lstSkills[nSkill];
-                    uint8_t nRankChange = pLevelStats->m_lstSkillRanks[nSkill];
-
-                    // Set the id of the skill we're checking so we can retrieve it
-                    s_ELCSkillID = nSkill;
-
-                    if (nRankChange)
-                    {
-                        // Figure out if we can use the skill and if it's a class skill
-                        bool bCanUse = false;
-                        bool bClassSkill = false;
-
-                        if (pSkill->m_bAllClassesCanUse)
-                        {
-                            bCanUse = true;
-                        }
-
-                        if (pClassLeveledUpIn->IsSkillUseable(nSkill))
-                        {
-                            bCanUse = true;
-
-                            if (pClassLeveledUpIn->IsSkillClassSkill(nSkill))
-                            {
-                                bClassSkill = true;
-                            }
-                        }
-
-                        // We must be able to use the skill
-                        if (!bCanUse)
-                        {
-                            if (auto strrefFailure = HandleValidationFailure(
-                                    ValidationFailureType::Skill,
-                                    ValidationFailureSubType::UnusableSkill,
-                                    STRREF_SKILL_UNUSEABLE))
-                            {
-                                return strrefFailure;
-                            }
-                        }
-
-                        // Check if we have enough available points
-                        if (bClassSkill)
-                        {
-                            if (nRankChange > nSkillPointsRemaining)
-                            {
-                                if (auto strrefFailure = HandleValidationFailure(
-                                        ValidationFailureType::Skill,
-                                        ValidationFailureSubType::NotEnoughSkillPoints,
-                                        STRREF_SKILL_INVALID_NUM_SKILLPOINTS))
-                                {
-                                    return strrefFailure;
-                                }
-                            }
-
-                            nSkillPointsRemaining -= nRankChange;
-                        }
-                        else
-                        {
-                            if (nRankChange * 2 > nSkillPointsRemaining)
-                            {
-                                if (auto strrefFailure = HandleValidationFailure(
-                                        ValidationFailureType::Skill,
-                                        ValidationFailureSubType::NotEnoughSkillPoints,
-                                        STRREF_SKILL_INVALID_NUM_SKILLPOINTS))
-                                {
-                                    return strrefFailure;
-                                }
-                            }
-
-                            nSkillPointsRemaining -= nRankChange * 2;
-                        }
-                        // Increase the rank for the skill
-                        listSkillRanks[nSkill] += nRankChange;
-
-                        // Can't have more than Level + 3 in a class skill, or (Level + 3) / 2 for a non class skill
-                        static int32_t skillMaxLevel1Bonus = Globals::Rules()->GetRulesetIntEntry(CRULES_HASHEDSTR("CHARGEN_SKILL_MAX_LEVEL_1_BONUS"), 3);
-                        if (bClassSkill)
-                        {
-                            if (listSkillRanks[nSkill] > nLevel + skillMaxLevel1Bonus)
-                            {
-                                if (auto strrefFailure = HandleValidationFailure(
-                                        ValidationFailureType::Skill,
-                                        ValidationFailureSubType::InvalidNumRanksInClassSkill,
-                                        STRREF_SKILL_INVALID_RANKS))
-                                {
-                                    return strrefFailure;
-                                }
-                            }
-                        }
-                        else
-                        {
-                            if (listSkillRanks[nSkill] > (nLevel + skillMaxLevel1Bonus) / 2)
-                            {
-                                if (auto strrefFailure = HandleValidationFailure(
-                                        ValidationFailureType::Skill,
-                                        ValidationFailureSubType::InvalidNumRanksInNonClassSkill,
-                                        STRREF_SKILL_INVALID_RANKS))
-                                {
-                                    return strrefFailure;
-                                }
-                            }
-                        }
-                    }
-                }
-
-                // Reset the skill id
-                s_ELCSkillID = -1;
-
-                // Compare the remaining skillpoints in LevelStats with our own calculation
-                if (pLevelStats->m_nSkillPointsRemaining > nSkillPointsRemaining)
-                {
-                    if (auto strrefFailure = HandleValidationFailure(
-                            ValidationFailureType::Skill,
-                            ValidationFailureSubType::InvalidNumRemainingSkillPoints,
-                            STRREF_SKILL_INVALID_NUM_SKILLPOINTS))
-                    {
-                        return strrefFailure;
-                    }
-                }
-// **************************************************************************************************************************
-
-// *** Check Feats **********************************************************************************************************
-                // Calculate the number of normal and bonus feats for this level
-                uint8_t nNumberNormalFeats = 0;
-                uint8_t nNumberBonusFeats = 0;
+                auto &pending = it->second;
+                pending.bAreaDeferred = true;
+                pending.oidArea = pArea->m_idSelf;
+                pending.vPosition = {fX, fY, fZ};
+                pending.vOrientation = *vNewOrientation;
+                pending.bPlayerIsNewToModule = bPlayerIsNewToModule;
+                return true;
+            }
 
-                // First and every nth level gets a normal feat
-                if ((nLevel == 1) ||
-                    ((pRace->m_nNormalFeatEveryNthLevel != 0) && (nLevel % pRace->m_nNormalFeatEveryNthLevel == 0)))
-                {
-                    nNumberNormalFeats = pRace->m_nNumberNormalFeatsEveryNthLevel;
-                }
-
-                // Add any extra first level feats
-                if (nLevel == 1)
-                {
-                    nNumberNormalFeats += pRace->m_nExtraFeatsAtFirstLevel;
-                }
-
-                nNumberBonusFeats = pClassLeveledUpIn->GetBonusFeats(nMultiClassLevel[nMultiClassLeveledUpIn]);
-
-                // Add this level's gained feats to our own list
-                for (int nFeatIndex = 0; nFeatIndex < pLevelStats->m_lstFeats.num; nFeatIndex++)
-                {
-                    uint16_t nFeat = pLevelStats->m_lstFeats.element[nFeatIndex];
-                    CNWFeat *pFeat = nFeat < pRules->m_nNumFeats ? &pRules->m_lstFeats[nFeat] : nullptr;
-
-                    if (!pFeat)
-                    {
-                        if (auto strrefFailure = HandleValidationFailure(
-                                ValidationFailureType::Feat,
-                                ValidationFailureSubType::InvalidFeat,
-                                STRREF_FEAT_INVALID))
-                        {
-                            return strrefFailure;
-                        }
-                    }
-
-                    bool bGranted = false;
-
-                    // Check if this is a feat that's automatically granted at first level
-                    if (nLevel == 1)
-                    {
-                        if (pRace->IsFirstLevelGrantedFeat(nFeat))
-                        {
-                            listFeats.insert(nFeat);
-                            bGranted = true;
-                        }
-                    }
-
-                    // Check if this is a feat that's automatically granted for this level
-                    if (!bGranted)
-                    {
-                        uint8_t nLevelGranted;
-                        if (pClassLeveledUpIn->IsGrantedFeat(nFeat, nLevelGranted))
-                        {
-                            if (nLevelGranted == nMultiClassLevel[nMultiClassLeveledUpIn])
-                            {
-                                listFeats.insert(nFeat);
-                                bGranted = true;
-                            }
-                        }
-                    }
-
-                    // Check if it's one of our cleric domain feats
-                    if (!bGranted)
-                    {
-                        if (pClassLeveledUpIn->m_bHasDomains && (nMultiClassLevel[nMultiClassLeveledUpIn] == 1))
-                        {
-                            if ((nFeat == nDomainFeat1) || (nFeat == nDomainFeat2))
-                            {
-                                listFeats.insert(nFeat);
-                                bGranted = true;
-                            }
-                        }
-                    }
-
-                    // Check if it's the "EpicCharacter" feat and we're level 21
-                    if (!bGranted)
-                    {
-                        if (nLevel == CHARACTER_EPIC_LEVEL && nFeat == Feat::EpicCharacter)
-                        {
-                            listFeats.insert(nFeat);
-                            bGranted = true;
-                        }
-                    }
-
-                    // Not a granted feat, add it to listChosenFeats
-                    if (!bGranted)
-                    {
-                        listChosenFeats.insert(nFeat);
-                    }
-                }
-
-                // Check the requirements of the chosen feats
-                for (uint16_t nFeat : listChosenFeats)
-                {
-                    CNWFeat *pFeat = nFeat < pRules->m_nNumFeats ? &pRules->m_lstFeats[nFeat] : nullptr;
-
-                    if (!pFeat)
-                    {
-                        if (auto strrefFailure = HandleValidationFailure(
-                                ValidationFailureType::Feat,
-                                ValidationFailureSubType::InvalidFeat,
-                                STRREF_FEAT_INVALID))
-                        {
-                            return strrefFailure;
-                        }
-                    }
-
-                    // Set the id of the feat we're checking so we can retrieve it
-                    s_ELCFeatID = nFeat;
-
-                    // Spell Level Requirements
-                    if (pFeat->m_nMinSpellLevel)
-                    {
-                        bool bSpellLevelMet = false;
-
-                        for (int nMultiClass = 0;
-                             !bSpellLevelMet && (nMultiClass < pCreatureStats->m_nNumMultiClasses); nMultiClass++)
-                        {
-                            if (nMultiClassLevel[nMultiClass])
-                            {
-                                uint8_t nClass = pCreatureStats->GetClass(nMultiClass);
-                                CNWClass *pClass = &pRules->m_lstClasses[nClass];
-
-                                if (pClass->m_bIsSpellCasterClass)
-                                {
-                                    if (!pClass->m_bNeedsToMemorizeSpells)
-                                    {
-                                        if (pClass->GetSpellsKnownPerLevel(nMultiClassLevel[nMultiClass],
-                                                                           pFeat->m_nMinSpellLevel,
-                                                                           nClass, pCreatureStats->m_nRace,
-                                                                           nAbilityAtLevel[pClass->m_nSpellcastingAbility]))
-                                        {
-                                            bSpellLevelMet = true;
-                                        }
-                                    }
-                                    else
-                                    {
-                                        if (pCreatureStats->GetSpellGainWithBonus(nMultiClass, pFeat->m_nMinSpellLevel))
-                                        {
-                                            bSpellLevelMet = true;
-                                        }
-                                    }
-                                }
-                            }
-                        }
-
-                        if (!bSpellLevelMet)
-                        {
-                            if (auto strrefFailure = HandleValidationFailure(
-                                    ValidationFailureType::Feat,
-                                    ValidationFailureSubType::FeatRequiredSpellLevelNotMet,
-                                    STRREF_FEAT_REQ_SPELL_LEVEL))
-                            {
-                                return strrefFailure;
-                            }
-                        }
-                    }
-
-                    // Ability Requirements
-                    uint8_t nBaseAttackBonus = 0;
-
-                    for (int nMultiClass = 0; nMultiClass < pCreatureStats->m_nNumMultiClasses; nMultiClass++)
-                    {
-                        if (nMultiClassLevel[nMultiClass])
-                        {
-                            CNWClass *pClass = &pRules->m_lstClasses[pCreatureStats->GetClass(nMultiClass)];
-
-                            nBaseAttackBonus += pClass->GetAttackBonus(nMultiClassLevel[nMultiClass]);
-                        }
-                    }
-
-                    if (pFeat->m_nMinAttackBonus > nBaseAttackBonus)
-                    {
-                        if (auto strrefFailure = HandleValidationFailure(
-                                ValidationFailureType::Feat,
-                                ValidationFailureSubType::FeatRequiredBaseAttackBonusNotMet,
-                                STRREF_FEAT_REQ_ABILITY))
-                        {
-                            return strrefFailure;
-                        }
-                    }
-
-                    if (pFeat->m_nMinSTR > nAbilityAtLevel[Ability::Strength] + pRace->m_nSTRAdjust)
-                    {
-                        if (auto strrefFailure = HandleValidationFailure(
-                                ValidationFailureType::Feat,
-                                ValidationFailureSubType::FeatRequiredAbilityValueNotMet,
-                                STRREF_FEAT_REQ_ABILITY))
-                        {
-                            return strrefFailure;
-                        }
-                    }
-
-                    if (pFeat->m_nMinDEX > nAbilityAtLevel[Ability::Dexterity] + pRace->m_nDEXAdjust)
-                    {
-                        if (auto strrefFailure = HandleValidationFailure(
-                                ValidationFailureType::Feat,
-                                ValidationFailureSubType::FeatRequiredAbilityValueNotMet,
-                                STRREF_FEAT_REQ_ABILITY))
-                        {
-                            return strrefFailure;
-                        }
-                    }
-
-                    if (pFeat->m_nMinINT > nAbilityAtLevel[Ability::Intelligence] + pRace->m_nINTAdjust)
-                    {
-                        if (auto strrefFailure = HandleValidationFailure(
-                                ValidationFailureType::Feat,
-                                ValidationFailureSubType::FeatRequiredAbilityValueNotMet,
-                                STRREF_FEAT_REQ_ABILITY))
-                        {
-                            return strrefFailure;
-                        }
-                    }
-
-                    if (pFeat->m_nMinWIS > nAbilityAtLevel[Ability::Wisdom] + pRace->m_nWISAdjust)
-                    {
-                        if (auto strrefFailure = HandleValidationFailure(
-                                ValidationFailureType::Feat,
-                                ValidationFailureSubType::FeatRequiredAbilityValueNotMet,
-                                STRREF_FEAT_REQ_ABILITY))
-                        {
-                            return strrefFailure;
-                        }
-                    }
-
-                    if (pFeat->m_nMinCON > nAbilityAtLevel[Ability::Constitution] + pRace->m_nCONAdjust)
-                    {
-                        if (auto strrefFailure = HandleValidationFailure(
-                                ValidationFailureType::Feat,
-                                ValidationFailureSubType::FeatRequiredAbilityValueNotMet,
-                                STRREF_FEAT_REQ_ABILITY))
-                        {
-                            return strrefFailure;
-                        }
-                    }
-
-                    if (pFeat->m_nMinCHA > nAbilityAtLevel[Ability::Charisma] + pRace->m_nCHAAdjust)
-                    {
-                        if (auto strrefFailure = HandleValidationFailure(
-                                ValidationFailureType::Feat,
-                                ValidationFailureSubType::FeatRequiredAbilityValueNotMet,
-                                STRREF_FEAT_REQ_ABILITY))
-                        {
-                            return strrefFailure;
-                        }
-                    }
-
-                    // Skill Focus Feats
-                    auto SkillFocusFeatCheck = [&](uint16_t nReqSkill) -> int32_t
-                    {
-                        if (nReqSkill != (uint16_t) -1)
-                        {
-                            bool bSkillRequirementMet = false;
-                            CNWSkill *pReqSkill = &pRules->m_lstSkills[nReqSkill];
-
-                            if (pReqSkill->m_bUntrained)
-                            {
-                                // Make sure we have a class that can use the skill
-                                for (int nMultiClass = 0; nMultiClass < pCreatureStats->m_nNumMultiClasses; nMultiClass++)
-                                {
-                                    if (pRules->m_lstClasses[pCreatureStats->GetClass(nMultiClass)].IsSkillUseable(
-                                            nReqSkill))
-                                    {
-                                        bSkillRequirementMet = true;
-                                    }
-                                }
-
-                                if (!bSkillRequirementMet)
-                                {
-                                    return STRREF_FEAT_REQ_SKILL;
-                                }
-                            }
-
-                            if (!bSkillRequirementMet)
-                            {
-                                if (listSkillRanks[nReqSkill] > 0)
-                                {
-                                    bSkillRequirementMet = true;
-                                }
-                                else
-                                {
-                                    return STRREF_FEAT_REQ_SKILL;
-                                }
-                            }
-
-                            uint16_t nSkillRanks = pFeat->m_nMinRequiredSkillRank2;
-
-                            if (listSkillRanks[nReqSkill] < nSkillRanks)
-                            {
-                                return STRREF_SKILL_UNUSEABLE;
-                            }
-                        }
-
-                        return 0;
-                    };
-
-                    int32_t retVal = SkillFocusFeatCheck(pFeat->m_nRequiredSkill);
-                    if (retVal)
-                    {
-                        if (auto strrefFailure = HandleValidationFailure(
-                                ValidationFailureType::Feat,
-                                ValidationFailureSubType::FeatRequiredSkillNotMet,
-                                retVal))
-                        {
-                            return strrefFailure;
-                        }
-                    }
-
-                    retVal = SkillFocusFeatCheck(pFeat->m_nRequiredSkill2);
-                    if (retVal)
-                    {
-                        if (auto strrefFailure = HandleValidationFailure(
-                                ValidationFailureType::Feat,
-                                ValidationFailureSubType::FeatRequiredSkillNotMet,
-                                retVal))
-                        {
-                            return strrefFailure;
-                        }
-                    }
-
-                    // Check Feat Prereqs
-                    auto PrerequisitesFeatCheck = [&](uint16_t nPrereqFeat) -> int32_t
-                    {
-                        if (nPrereqFeat != (uint16_t) -1)
-                        {
-                            if (listFeats.find(nPrereqFeat) == listFeats.end() &&
-                                listChosenFeats.find(nPrereqFeat) == listChosenFeats.end())
-                            {
-                                return STRREF_FEAT_REQ_FEAT;
-                            }
-                        }
-
-                        return 0;
-                    };
-
-                    retVal = PrerequisitesFeatCheck(pFeat->m_lstPrereqFeats[0]);
-                    if (retVal)
-                    {
-                        if (auto strrefFailure = HandleValidationFailure(
-                                ValidationFailureType::Feat,
-                                ValidationFailureSubType::FeatRequiredFeatNotMet,
-                                retVal))
-                        {
-                            return strrefFailure;
-                        }
-                    }
-
-                    retVal = PrerequisitesFeatCheck(pFeat->m_lstPrereqFeats[1]);
-                    if (retVal)
-                    {
-                        if (auto strrefFailure = HandleValidationFailure(
-                                ValidationFailureType::Feat,
-                                ValidationFailureSubType::FeatRequiredFeatNotMet,
-                                retVal))
-                        {
-                            return strrefFailure;
-                        }
-                    }
-
-                    // The feat requires a "OrPrereq" feat
-                    bool bHasOrPrereqFeat = false;
-                    // The character has one of these feats
-                    bool bOrPrereqFeatAcquired = false;
-
-                    for (int32_t nOrPrereqFeat = 0; !bOrPrereqFeatAcquired && nOrPrereqFeat < 5; nOrPrereqFeat++)
-                    {
-                        uint16_t nPrereqFeat = pFeat->m_lstOrPrereqFeats[nOrPrereqFeat];
-
-                        if (nPrereqFeat != (uint16_t) -1)
-                        {
-                            bHasOrPrereqFeat = true;
-                            bOrPrereqFeatAcquired = listFeats.find(nPrereqFeat) != listFeats.end() ||
-                                                    listChosenFeats.find(nPrereqFeat) != listChosenFeats.end();
-                        }
-                    }
-
-                    if (bHasOrPrereqFeat && !bOrPrereqFeatAcquired)
-                    {
-                        if (auto strrefFailure = HandleValidationFailure(
-                                ValidationFailureType::Feat,
-                                ValidationFailureSubType::FeatRequiredFeatNotMet,
-                                STRREF_FEAT_REQ_FEAT))
-                        {
-                            return strrefFailure;
-                        }
-                    }
-
-                    // Reset feat id
-                    s_ELCFeatID = -1;
-                }
-
-                // Check if we can actually pick our chosen feats this level
-                if (!listChosenFeats.empty() && !nNumberNormalFeats && !nNumberBonusFeats)
-                {
-                    if (auto strrefFailure = HandleValidationFailure(
-                            ValidationFailureType::Feat,
-                            ValidationFailureSubType::TooManyFeatsThisLevel,
-                            STRREF_FEAT_TOO_MANY))
-                    {
-                        return strrefFailure;
-                    }
-                }
-
-                // List to hold moved chosen feats
-                std::vector<uint16_t> listMovedFeats;
-
-                for (auto nFeatIndex : listChosenFeats)
-                {
-                    // Set the id of the feat we're checking so we can retrieve it
-                    s_ELCFeatID = nFeatIndex;
-
-                    int32_t bNormalListFeat;
-                    int32_t bBonusListFeat;
-
-                    pPlayer->ValidateCharacter_SetNormalBonusFlags(nFeatIndex, bNormalListFeat, bBonusListFeat,
-                                                                   nClassLeveledUpIn);
-
-                    // Not available to class
-                    if (!bNormalListFeat && !bBonusListFeat)
-                    {
-                        if (auto strrefFailure = HandleValidationFailure(
-                                ValidationFailureType::Feat,
-                                ValidationFailureSubType::FeatNotAvailableToClass,
-                                STRREF_FEAT_TOO_MANY))
-                        {
-                            return strrefFailure;
-                        }
-                    }
-
-                    // Normal Feat Only
-                    if (bNormalListFeat && !bBonusListFeat)
-                    {
-                        if (!nNumberNormalFeats)
-                        {
-                            if (auto strrefFailure = HandleValidationFailure(
-                                    ValidationFailureType::Feat,
-                                    ValidationFailureSubType::FeatIsNormalFeatOnly,
-                                    STRREF_FEAT_TOO_MANY))
-                            {
-                                return strrefFailure;
-                            }
-                        }
-
-                        // Move the feat from our level list to the main list
-                        listFeats.insert(nFeatIndex);
-                        // Add the feat that's being moved to a different list because removing stuff while iterating is bad
-                        listMovedFeats.push_back(nFeatIndex);
-                        nNumberNormalFeats--;
-                    }
-
-                    // Bonus Feat Only
-                    if (!bNormalListFeat && bBonusListFeat)
-                    {
-                        if (!nNumberBonusFeats)
-                        {
-                            if (auto strrefFailure = HandleValidationFailure(
-                                    ValidationFailureType::Feat,
-                                    ValidationFailureSubType::FeatIsBonusFeatOnly,
-                                    STRREF_FEAT_TOO_MANY))
-                            {
-                                return strrefFailure;
-                            }
-                        }
-
-                        // Move the feat from our level list to the main list
-                        listFeats.insert(nFeatIndex);
-                        // Add the feat that's being moved to a different list because removing stuff while iterating is bad
-                        listMovedFeats.push_back(nFeatIndex);
-                        nNumberBonusFeats--;
-                    }
-
-                    // Reset the feat id
-                    s_ELCFeatID = -1;
-                }
-
-                // Remove the moved feats from the chosen feat list
-                for (auto remove : listMovedFeats)
-                {
-                    listChosenFeats.erase(remove);
-                }
-                listMovedFeats.clear();
-
-                // The feats that are left can be normal or bonus
-                for (auto nFeatIndex : listChosenFeats)
-                {
-                    // Set the id of the feat we're checking so we can retrieve it
-                    s_ELCFeatID = nFeatIndex;
-
-                    if (nNumberBonusFeats)
-                    {
-                        // Move the feat from our level list to the main list
-                        listFeats.insert(nFeatIndex);
-                        // Add the feat that's being moved to a different list because removing stuff while iterating is bad
-                        listMovedFeats.push_back(nFeatIndex);
-                        nNumberBonusFeats--;
-                    }
-                    else
-                    {
-                        if (nNumberNormalFeats)
-                        {
-                            // Move the feat from our level list to the main list
-                            listFeats.insert(nFeatIndex);
-                            // Add the feat that's being moved to a different list because removing stuff while iterating is bad
-                            listMovedFeats.push_back(nFeatIndex);
-                            nNumberNormalFeats--;
-                        }
-                        else
-                        {
-                            if (auto strrefFailure = HandleValidationFailure(
-                                    ValidationFailureType::Feat,
-                                    ValidationFailureSubType::TooManyFeatsThisLevel,
-                                    STRREF_FEAT_TOO_MANY))
-                            {
-                                return strrefFailure;
-                            }
-                        }
-                    }
-
-                    // Reset the feat id
-                    s_ELCFeatID = -1;
-                }
-
-                // Remove the moved feats from the chosen feat list
-                for (auto remove : listMovedFeats)
-                {
-                    listChosenFeats.erase(remove);
-                }
-                listMovedFeats.clear();
-// **************************************************************************************************************************
-
-
-// *** Check Known Spells ***************************************************************************************************
-                uint32_t nNumberWizardSpellsToAdd = 0;
-
-                // Calculate the num of spells a wizard can add
-                if (pClassLeveledUpIn->m_bCanLearnFromScrolls)
-                {
-                    if (nMultiClassLevel[nMultiClassLeveledUpIn] == 1)
-                    {
-                        nNumberWizardSpellsToAdd = 3 + std::max((char) 0,
-                                                                pCreatureStats->CalcStatModifier(
-                                                                        nAbilityAtLevel[Ability::Intelligence] +
-                                                                        pRace->m_nINTAdjust));
-                    }
-                    else
-                    {
-                        nNumberWizardSpellsToAdd = 2;
-                    }
-                }
-
-                for (int nSpellLevel = 0; nSpellLevel < NUM_SPELL_LEVELS; nSpellLevel++)
-                {
-                    for (int nSpellIndex = 0;
-                         nSpellIndex < pLevelStats->m_pAddedKnownSpellList[nSpellLevel].num; nSpellIndex++)
-                    {
-                        // Can we add spells this level?
-                        if (pClassLeveledUpIn->m_bSpellbookRestricted && pClassLeveledUpIn->m_bNeedsToMemorizeSpells)
-                        {
-                            if (!pClassLeveledUpIn->GetSpellGain(nMultiClassLevel[nMultiClassLeveledUpIn], nSpellLevel))
-                            {
-                                if (auto strrefFailure = HandleValidationFailure(
-                                        ValidationFailureType::Spell,
-                                        ValidationFailureSubType::SpellInvalidSpellGainWizard,
-                                        STRREF_SPELL_ILLEGAL_LEVEL))
-                                {
-                                    return strrefFailure;
-                                }
-                            }
-                        }
-                        else if (pClassLeveledUpIn->m_bSpellbookRestricted && !pClassLeveledUpIn->m_bNeedsToMemorizeSpells)
-                        {
-                            if (!pClassLeveledUpIn->GetSpellsKnownPerLevel(nMultiClassLevel[nMultiClassLeveledUpIn],
-                                                                           nSpellLevel,
-                                                                           nClassLeveledUpIn, pCreatureStats->m_nRace,
-                                                                           nAbilityAtLevel[pClassLeveledUpIn->m_nSpellcastingAbility]))
-                            {
-                                if (auto strrefFailure = HandleValidationFailure(
-                                        ValidationFailureType::Spell,
-                                        ValidationFailureSubType::SpellInvalidSpellGainBardSorcerer,
-                                        STRREF_SPELL_ILLEGAL_LEVEL))
-                                {
-                                    return strrefFailure;
-                                }
-                            }
-                        }
-                        else
-                        {
-                            if (auto strrefFailure = HandleValidationFailure(
-                                    ValidationFailureType::Spell,
-                                    ValidationFailureSubType::SpellInvalidSpellGainOtherClasses,
-                                    STRREF_SPELL_ILLEGAL_LEVEL))
-                            {
-                                return strrefFailure;
-                            }
-                        }
-
-                        uint32_t nSpellID = pLevelStats->m_pAddedKnownSpellList[nSpellLevel].element[nSpellIndex];
-                        CNWSpell *pSpell = pRules->m_pSpellArray->GetSpell(nSpellID);
-
-                        if (!pSpell)
-                        {
-                            if (auto strrefFailure = HandleValidationFailure(
-                                    ValidationFailureType::Spell,
-                                    ValidationFailureSubType::InvalidSpell,
-                                    STRREF_SPELL_INVALID_SPELL))
-                            {
-                                return strrefFailure;
-                            }
-                        }
-
-                        // Store the spell id so we can retrieve it later
-                        s_ELCSpellID = nSpellID;
-
-                        // Check the spell level
-                        if (pSpell->GetSpellLevel(nClassLeveledUpIn) != nSpellLevel)
-                        {
-                            if (auto strrefFailure = HandleValidationFailure(
-                                    ValidationFailureType::Spell,
-                                    ValidationFailureSubType::SpellInvalidSpellLevel,
-                                    STRREF_SPELL_REQ_SPELL_LEVEL))
-                            {
-                                return strrefFailure;
-                            }
-                        }
-
-                        // Check for minimum ability
-                        if (pClassLeveledUpIn->m_bSpellbookRestricted)
-                        {
-                            if (nAbilityAtLevel[pClassLeveledUpIn->m_nSpellcastingAbility] < 10 + nSpellLevel)
-                            {
-                                if (auto strrefFailure = HandleValidationFailure(
-                                        ValidationFailureType::Spell,
-                                        ValidationFailureSubType::SpellMinimumAbility,
-                                        STRREF_SPELL_REQ_ABILITY))
-                                {
-                                    return strrefFailure;
-                                }
-                            }
-                        }
-
-                        // Check Opposition School
-                        if (pClassLeveledUpIn->m_bSpellbookRestricted && pClassLeveledUpIn->m_bNeedsToMemorizeSpells)
-                        {
-                            uint8_t nSchool = pCreatureStats->GetSchool(nClassLeveledUpIn);
-
-                            if (nSchool != 0)
-                            {
-                                int32_t nOppositionSchool;
-                                if (pRules->m_p2DArrays->GetSpellSchoolTable()->GetINTEntry(nSchool, "Opposition", &nOppositionSchool))
-                                {
-                                    if (pSpell->m_nSchool == (uint8_t) nOppositionSchool)
-                                    {
-                                        if (auto strrefFailure = HandleValidationFailure(
-                                                ValidationFailureType::Spell,
-                                                ValidationFailureSubType::SpellRestrictedSpellSchool,
-                                                STRREF_SPELL_OPPOSITE_SPELL_SCHOOL))
-                                        {
-                                            return strrefFailure;
-                                        }
-                                    }
-                                }
-                            }
-                        }
-
-                        // Check if we already know the spell
-                        if (listSpells[nMultiClassLeveledUpIn][nSpellLevel].find(nSpellID) !=
-                            listSpells[nMultiClassLeveledUpIn][nSpellLevel].end())
-                        {
-                            if (auto strrefFailure = HandleValidationFailure(
-                                    ValidationFailureType::Spell,
-                                    ValidationFailureSubType::SpellAlreadyKnown,
-                                    STRREF_SPELL_LEARNED_TWICE))
-                            {
-                                return strrefFailure;
-                            }
-                        }
-
-                        // Check if we're a wizard and haven't exceeded the number of spells we can add
-                        if (pClassLeveledUpIn->m_bSpellbookRestricted && pClassLeveledUpIn->m_bNeedsToMemorizeSpells)
-                        {
-                            if (nSpellLevel != 0)
-                            {
-                                if (!nNumberWizardSpellsToAdd)
-                                {
-                                    if (auto strrefFailure = HandleValidationFailure(
-                                            ValidationFailureType::Spell,
-                                            ValidationFailureSubType::SpellWizardExceedsNumSpellsToAdd,
-                                            STRREF_SPELL_ILLEGAL_NUM_SPELLS))
-                                    {
-                                        return strrefFailure;
-                                    }
-                                }
-                                nNumberWizardSpellsToAdd--;
-                            }
-                        }
-
-                        // Add the spell to our list
-                        listSpells[nMultiClassLeveledUpIn][nSpellLevel].insert(nSpellID);
-
-                        // Reset the spell id
-                        s_ELCSpellID = -1;
-                    }
-
-                    // Check Bard/Sorc removed spells
-                    for (int nSpellIndex = 0;
-                         nSpellIndex < pLevelStats->m_pRemovedKnownSpellList[nSpellLevel].num; nSpellIndex++)
-                    {
-                        if (!pClassLeveledUpIn->m_bSpellbookRestricted || pClassLeveledUpIn->m_bNeedsToMemorizeSpells ||
-                            (nMultiClassLevel[nMultiClassLeveledUpIn] == 1) ||
-                            !pClassLeveledUpIn->GetSpellsKnownPerLevel(nMultiClassLevel[nMultiClassLeveledUpIn],
-                                                                       nSpellLevel, nClassLeveledUpIn,
-                                                                       pCreatureStats->m_nRace,
-                                                                       nAbilityAtLevel[pClassLeveledUpIn->m_nSpellcastingAbility]))
-                        {
-                            if (auto strrefFailure = HandleValidationFailure(
-                                    ValidationFailureType::Spell,
-                                    ValidationFailureSubType::IllegalRemovedSpell,
-                                    STRREF_SPELL_ILLEGAL_REMOVED_SPELLS))
-                            {
-                                return strrefFailure;
-                            }
-                        }
-
-                        uint32_t nSpellID = pLevelStats->m_pRemovedKnownSpellList[nSpellLevel].element[nSpellIndex];
-
-                        CNWSpell *pSpell = pRules->m_pSpellArray->GetSpell(nSpellID);
-
-                        if (!pSpell)
-                        {
-                            if (auto strrefFailure = HandleValidationFailure(
-                                    ValidationFailureType::Spell,
-                                    ValidationFailureSubType::InvalidSpell,
-                                    STRREF_SPELL_INVALID_SPELL))
-                            {
-                                return strrefFailure;
-                            }
-                        }
-
-                        // Store te spell id so we can retrieve it later
-                        s_ELCSpellID = nSpellID;
-
-                        // Check if we actually know the spell
-                        if (listSpells[nMultiClassLeveledUpIn][nSpellLevel].find(nSpellID) ==
-                            listSpells[nMultiClassLeveledUpIn][nSpellLevel].end())
-                        {
-                            if (auto strrefFailure = HandleValidationFailure(
-                                    ValidationFailureType::Spell,
-                                    ValidationFailureSubType::RemovedNotKnownSpell,
-                                    STRREF_SPELL_ILLEGAL_REMOVED_SPELLS))
-                            {
-                                return strrefFailure;
-                            }
-                        }
-
-                        // Remove the spell from our list
-                        listSpells[nMultiClassLeveledUpIn][nSpellLevel].erase(nSpellID);
-
-                        // Reset the spell id
-                        s_ELCSpellID = -1;
-                    }
-                }
-
-                // Check if we have the valid number of spells
-                if (pClassLeveledUpIn->m_bSpellbookRestricted && !pClassLeveledUpIn->m_bCanLearnFromScrolls)
-                {
-                    for (int nSpellLevel = 0; nSpellLevel < NUM_SPELL_LEVELS; nSpellLevel++)
-                    {
-                        if (listSpells[nMultiClassLeveledUpIn][nSpellLevel].size() >
-                            pClassLeveledUpIn->GetSpellsKnownPerLevel(nMultiClassLevel[nMultiClassLeveledUpIn],
-                                                                      nSpellLevel, nClassLeveledUpIn,
-                                                                      pCreatureStats->m_nRace,
-                                                                      nAbilityAtLevel[pClassLeveledUpIn->m_nSpellcastingAbility]))
-                        {
-                            if (auto strrefFailure = HandleValidationFailure(
-                                    ValidationFailureType::Spell,
-                                    ValidationFailureSubType::InvalidNumSpells,
-                                    STRREF_SPELL_ILLEGAL_NUM_SPELLS))
-                            {
-                                return strrefFailure;
-                            }
-                        }
-                    }
-                }
-// **************************************************************************************************************************
-            }
-            // All levels processed, hurray!
-
-            // Final Spells Check
-            // Check if our list of spells from LevelStats are the same as the spells the character knows
-            for (int nMultiClass = 0; nMultiClass < pCreatureStats->m_nNumMultiClasses; nMultiClass++)
-            {
-                auto *pClass = &Globals::Rules()->m_lstClasses[pCreatureStats->GetClass(nMultiClass)];
-                // We skip wizard because they can learn spells from scrolls
-                if (!pClass->m_bCanLearnFromScrolls)
-                {
-                    for (int nSpellLevel = 0; nSpellLevel < NUM_SPELL_LEVELS; nSpellLevel++)
-                    {
-                        //  NOTE: Not sure if this is still needed, removing it for now.
-                        /*
-                        if (nSpellLevel != 0 || !(pClass->m_bSpellbookRestricted && pClass->m_bCanLearnFromScrolls))
-                        {
-                        */
-                        for (int nSpellIndex = 0;
-                             nSpellIndex < pCreatureStats->GetNumberKnownSpells(nMultiClass, nSpellLevel); nSpellIndex++)
-                        {
-                            if (listSpells[nMultiClass][nSpellLevel].empty())
-                            {
-                                if (auto strrefFailure = HandleValidationFailure(
-                                        ValidationFailureType::Spell,
-                                        ValidationFailureSubType::SpellListComparison,
-                                        STRREF_SPELL_ILLEGAL_NUM_SPELLS))
-                                {
-                                    return strrefFailure;
-                                }
-                            }
-
-                            uint32_t nSpellID = pCreatureStats->GetKnownSpell(nMultiClass, nSpellLevel, nSpellIndex);
-
-                            // Store the spell id so we can retrieve it later
-                            s_ELCSpellID = nSpellID;
-
-                            if (listSpells[nMultiClass][nSpellLevel].find(nSpellID) ==
-                                listSpells[nMultiClass][nSpellLevel].end())
-                            {
-                                if (auto strrefFailure = HandleValidationFailure(
-                                        ValidationFailureType::Spell,
-                                        ValidationFailureSubType::SpellListComparison,
-                                        STRREF_SPELL_ILLEGAL_NUM_SPELLS))
-                                {
-                                    return strrefFailure;
-                                }
-                            }
-
-                            listSpells[nMultiClass][nSpellLevel].erase(nSpellID);
-
-                            // Reset the spell id
-                            s_ELCSpellID = -1;
-                        }
-
-                        if (!listSpells[nMultiClass][nSpellLevel].empty())
-                        {
-                            if (auto strrefFailure = HandleValidationFailure(
-                                    ValidationFailureType::Spell,
-                                    ValidationFailureSubType::SpellListComparison,
-                                    STRREF_SPELL_ILLEGAL_NUM_SPELLS))
-                            {
-                                return strrefFailure;
-                            }
-                        }
-                        //}
-                    }
-                }
-            }
-
-            // Final Skills Check
-            // Compare our calculated rank with the saved rank
-            for (int nSkill = 0; nSkill < pRules->m_nNumSkills; nSkill++)
-            {
-                // Store the skill id so we can retrieve it later
-                s_ELCSkillID = nSkill;
-
-                if (listSkillRanks[nSkill] != (uint8_t) pCreatureStats->GetSkillRank(nSkill, nullptr, true))
-                {
-                    if (auto strrefFailure = HandleValidationFailure(
-                            ValidationFailureType::Skill,
-                            ValidationFailureSubType::SkillListComparison,
-                            STRREF_SKILL_INVALID_RANKS))
-                    {
-                        return strrefFailure;
-                    }
-                }
-
-                // Reset the skill id
-                s_ELCSkillID = -1;
-            }
-
-            // Final Feats Check
-            // Check if our list of feats from LevelStats are the same as the feats the character has
-            for (int nFeatIndex = 0; nFeatIndex < pCreatureStats->m_lstFeats.num; nFeatIndex++)
-            {
-                if (listFeats.empty())
-                {
-                    if (auto strrefFailure = HandleValidationFailure(
-                            ValidationFailureType::Feat,
-                            ValidationFailureSubType::FeatListComparison,
-                            STRREF_FEAT_TOO_MANY))
-                    {
-                        return strrefFailure;
-                    }
-                }
-
-                uint16_t nFeat = pCreatureStats->m_lstFeats.element[nFeatIndex];
-
-                // Store the skill id so we can retrieve it later
-                s_ELCFeatID = nFeat;
-
-                if (listFeats.find(nFeat) == listFeats.end())
-                {
-                    if (auto strrefFailure = HandleValidationFailure(
-                            ValidationFailureType::Feat,
-                            ValidationFailureSubType::FeatListComparison,
-                            STRREF_FEAT_TOO_MANY))
-                    {
-                        return strrefFailure;
-                    }
-                }
-
-                listFeats.erase(nFeat);
-
-                // Reset the feat id
-                s_ELCFeatID = -1;
-            }
-
-            // Check Misc Saving Throws
-            if (pCreatureStats->m_nFortSavingThrowMisc > 0 ||
-                pCreatureStats->m_nReflexSavingThrowMisc > 0 ||
-                pCreatureStats->m_nWillSavingThrowMisc > 0)
-            {
-                if (auto strrefFailure = HandleValidationFailure(
-                        ValidationFailureType::Character,
-                        ValidationFailureSubType::MiscSavingThrow,
-                        STRREF_CHARACTER_SAVING_THROW))
-                {
-                    return strrefFailure;
-                }
-            }
-
-            // Compare Feats Lists
-            int32_t nNumberOfFeats = 0;
-            for (int nLevel = 1; nLevel <= nCharacterLevel; nLevel++)
-            {
-                CNWLevelStats *pLevelStats = pCreatureStats->GetLevelStats(nLevel - 1);
-                nNumberOfFeats += pLevelStats->m_lstFeats.num;
-            }
-
-            if (pCreatureStats->m_lstFeats.num > nNumberOfFeats)
-            {
-                if (auto strrefFailure = HandleValidationFailure(
-                        ValidationFailureType::Feat,
-                        ValidationFailureSubType::NumFeatComparison,
-                        STRREF_FEAT_INVALID))
-                {
-                    return strrefFailure;
-                }
-            }
-
-            // Run a custom ELC check if enabled and there is an ELC script set
-            if (s_enableCustomELCCheck)
-            {
-                if (!s_elcScript.empty())
-                {
-                    if (auto strrefFailure = HandleValidationFailure(
-                            ValidationFailureType::Custom,
-                            ValidationFailureSubType::None,
-                            STRREF_CUSTOM))
-                    {
-                        return strrefFailure;
-                    }
-                }
-                else
-                {
-                    LOG_WARNING("NWNX_ELC: Skipping Custom ELC Check because an ELC script is not set!");
-                }
-            }
-
-            MessageBus::Broadcast("NWNX_EVENT_SIGNAL_EVENT", {"NWNX_ON_ELC_VALIDATE_CHARACTER_AFTER",
-                                                              Utils::ObjectIDToString(pPlayer->m_oidNWSObject)});
-
-            return 0;
-        }, Hooks::Order::Final);
+            return s_SendServerToPlayerArea_ClientArea->CallOriginal<int32_t>(pMessage, pPlayer, pArea, fX, fY, fZ,
+                                                                              vNewOrientation, bPlayerIsNewToModule);
+        }, Hooks::Order::Earliest) : nullptr;
 
 
 NWNX_EXPORT ArgumentStack SetELCScript(ArgumentStack&& args)
@@ -0,0 +1,431 @@
+#include "Validation.hpp"
+
+#include "API/CNWSCreature.hpp"
+#include "API/CNWSCreatureStats.hpp"
+#include "API/CNWSPlayer.hpp"
+#include "API/CNWLevelStats.hpp"
+#include "API/CNWRace.hpp"
+#include "API/CNWRules.hpp"
+#include "API/CNWClass.hpp"
+#include "API/CNWDomain.hpp"
+#include "API/CNWSkill.hpp"
+#include "API/CNWFeat.hpp"
+#include "API/CNWSpell.hpp"
+#include "API/CNWSpellArray.hpp"
+#include "API/CTwoDimArrays.hpp"
+
+#include <algorithm>
+
+
+using namespace NWNXLib;
+using namespace NWNXLib::API;
+using namespace NWNXLib::API::Constants;
+
+namespace ELC {
+
+static bool s_enforceCasterPrimaryStatIs11 = Config::Get<bool>("ENFORCE_CASTER_PRIMARY_STAT_IS_11", false);
+
+// Taken on first use and dropped whenever the rules are reloaded. Validations already running keep their copy.
+static std::shared_ptr<const RulesSnapshot> s_rules;
+
+static void InitRulesReloadHooks()
+{
+    static Hooks::Hook s_ReloadAllHook = Hooks::HookFunction(&CNWRules::ReloadAll,
+        +[](CNWRules *pThis) -> void
+        {
+            s_ReloadAllHook->CallOriginal<void>(pThis);
+            s_rules.reset();
+        }, Hooks::Order::Late);
+
+    static Hooks::Hook s_LoadRulesetInfoHook = Hooks::HookFunction(&CNWRules::LoadRulesetInfo,
+        +[](CNWRules *pThis) -> void
+        {
+            s_LoadRulesetInfoHook->CallOriginal<void>(pThis);
+            s_rules.reset();
+        }, Hooks::Order::Late);
+}
+
+std::shared_ptr<const RulesSnapshot> GetRulesSnapshot(CNWSCreatureStats *pCreatureStats)
+{
+    InitRulesReloadHooks();
+    if (s_rules)
+        return s_rules;
+
+    CNWRules *pRules = Globals::Rules();
+    auto rules = std::make_shared<RulesSnapshot>();
+
+    rules->skills.reserve(pRules->m_nNumSkills);
+    for (int nSkill = 0; nSkill < pRules->m_nNumSkills; nSkill++)
+    {
+        CNWSkill *pSkill = &pRules->m_lstSkills[nSkill];
+        rules->skills.push_back({!!pSkill->m_bAllClassesCanUse, !!pSkill->m_bUntrained});
+    }
+
+    rules->classes.resize(pRules->m_nNumClasses);
+    for (int nClass = 0; nClass < pRules->m_nNumClasses; nClass++)
+    {
+        CNWClass *pClass = &pRules->m_lstClasses[nClass];
+        auto &cls = rules->classes[nClass];
+
+        cls.bIsPlayerClass = pClass->m_bIsPlayerClass;
+        cls.bHasDomains = pClass->m_bHasDomains;
+        cls.bIsSpellCasterClass = pClass->m_bIsSpellCasterClass;
+        cls.bNeedsToMemorizeSpells = pClass->m_bNeedsToMemorizeSpells;
+        cls.bSpellbookRestricted = pClass->m_bSpellbookRestricted;
+        cls.bCanLearnFromScrolls = pClass->m_bCanLearnFromScrolls;
+        cls.nMaxLevel = pClass->m_nMaxLevel;
+        cls.nPrimaryAbility = pClass->m_nPrimaryAbility;
+        cls.nSpellcastingAbility = pClass->m_nSpellcastingAbility;
+        cls.nSkillPointBase = pClass->m_nSkillPointBase;
+
+        cls.attackBonus[0] = 0;
+        cls.bonusFeats[0] = 0;
+        for (int nLevel = 1; nLevel <= MAX_CLASS_LEVEL; nLevel++)
+        {
+            cls.attackBonus[nLevel] = pClass->GetAttackBonus(nLevel);
+            cls.bonusFeats[nLevel] = pClass->GetBonusFeats(nLevel);
+        }
+
+        cls.skillUseable.resize(pRules->m_nNumSkills);
+        cls.classSkill.resize(pRules->m_nNumSkills);
+        for (int nSkill = 0; nSkill < pRules->m_nNumSkills; nSkill++)
+        {
+            cls.skillUseable[nSkill] = pClass->IsSkillUseable(nSkill);
+            cls.classSkill[nSkill] = pClass->IsSkillClassSkill(nSkill);
+        }
+    }
+
+    rules->feats.reserve(pRules->m_nNumFeats);
+    for (int nFeat = 0; nFeat < pRules->m_nNumFeats; nFeat++)
+    {
+        CNWFeat *pFeat = &pRules->m_lstFeats[nFeat];
+        RulesSnapshot::Feat feat;
+
+        feat.nMinAttackBonus = pFeat->m_nMinAttackBonus;
+        feat.nMinSTR = pFeat->m_nMinSTR;
+        feat.nMinDEX = pFeat->m_nMinDEX;
+        feat.nMinINT = pFeat->m_nMinINT;
+        feat.nMinWIS = pFeat->m_nMinWIS;
+        feat.nMinCON = pFeat->m_nMinCON;
+        feat.nMinCHA = pFeat->m_nMinCHA;
+        feat.nMinSpellLevel = pFeat->m_nMinSpellLevel;
+        std::copy(std::begin(pFeat->m_lstPrereqFeats), std::end(pFeat->m_lstPrereqFeats), feat.prereqFeats.begin());
+        std::copy(std::begin(pFeat->m_lstOrPrereqFeats), std::end(pFeat->m_lstOrPrereqFeats), feat.orPrereqFeats.begin());
+        feat.nRequiredSkill = pFeat->m_nRequiredSkill;
+        feat.nRequiredSkill2 = pFeat->m_nRequiredSkill2;
+        feat.nMinRequiredSkillRank2 = pFeat->m_nMinRequiredSkillRank2;
+
+        rules->feats.push_back(feat);
+    }
+
+    for (int nValue = 0; nValue < 256; nValue++)
+    {
+        rules->statModifier[nValue] = pCreatureStats->CalcStatModifier(nValue);
+    }
+
+    rules->nCharGenBaseAbilityMin = pRules->GetRulesetIntEntry(CRULES_HASHEDSTR("CHARGEN_BASE_ABILITY_MIN"), 8);
+    rules->nCharGenBaseAbilityMax = pRules->GetRulesetIntEntry(CRULES_HASHEDSTR("CHARGEN_BASE_ABILITY_MAX"), 18);
+    rules->nAbilityCostIncrement2 = pRules->GetRulesetIntEntry(CRULES_HASHEDSTR("CHARGEN_ABILITY_COST_INCREMENT2"), 14);
+    rules->nAbilityCostIncrement3 = pRules->GetRulesetIntEntry(CRULES_HASHEDSTR("CHARGEN_ABILITY_COST_INCREMENT3"), 16);
+    rules->nSkillMaxLevel1Bonus = pRules->GetRulesetIntEntry(CRULES_HASHEDSTR("CHARGEN_SKILL_MAX_LEVEL_1_BONUS"), 3);
+
+    s_rules = std::move(rules);
+    return s_rules;
+}
+
+std::shared_ptr<const CharacterSnapshot> TakeCharacterSnapshot(CNWSPlayer *pPlayer, CNWSCreature *pCreature, const RulesSnapshot &rules)
+{
+    CNWRules *pRules = Globals::Rules();
+    CNWSCreatureStats *pCreatureStats = pCreature->m_pStats;
+    auto character = std::make_shared<CharacterSnapshot>();
+
+    character->bEnforceCasterPrimaryStatIs11 = s_enforceCasterPrimaryStatIs11;
+    character->bIsPC = pCreatureStats->m_bIsPC;
+    character->bIsDMCharacterFile = pCreatureStats->m_bIsDMCharacterFile;
+    character->nCharacterLevel = pCreatureStats->GetLevel(false);
+    character->bNewCharacter = character->nCharacterLevel == 1 && pCreatureStats->m_nExperience == 0;
+    character->bMiscSavingThrow = pCreatureStats->m_nFortSavingThrowMisc > 0 ||
+                                  pCreatureStats->m_nReflexSavingThrowMisc > 0 ||
+                                  pCreatureStats->m_nWillSavingThrowMisc > 0;
+
+    CNWRace *pRace = pCreatureStats->m_nRace < pRules->m_nNumRaces ? &pRules->m_lstRaces[pCreatureStats->m_nRace] : nullptr;
+    character->bValidRace = pRace != nullptr;
+    if (!pRace)
+        return character;
+
+    auto &race = character->race;
+    race.bIsPlayerRace = pRace->m_bIsPlayerRace;
+    race.nAbilitiesPointBuyNumber = pRace->m_nAbilitiesPointBuyNumber;
+    race.abilityAdjust[Ability::Strength] = pRace->m_nSTRAdjust;
+    race.abilityAdjust[Ability::Dexterity] = pRace->m_nDEXAdjust;
+    race.abilityAdjust[Ability::Constitution] = pRace->m_nCONAdjust;
+    race.abilityAdjust[Ability::Intelligence] = pRace->m_nINTAdjust;
+    race.abilityAdjust[Ability::Wisdom] = pRace->m_nWISAdjust;
+    race.abilityAdjust[Ability::Charisma] = pRace->m_nCHAAdjust;
+    race.nSkillPointModifierAbility = pRace->m_nSkillPointModifierAbility;
+    race.nFirstLevelSkillPointsMultiplier = pRace->m_nFirstLevelSkillPointsMultiplier;
+    race.nExtraSkillPointsPerLevel = pRace->m_nExtraSkillPointsPerLevel;
+    race.nNormalFeatEveryNthLevel = pRace->m_nNormalFeatEveryNthLevel;
+    race.nNumberNormalFeatsEveryNthLevel = pRace->m_nNumberNormalFeatsEveryNthLevel;
+    race.nExtraFeatsAtFirstLevel = pRace->m_nExtraFeatsAtFirstLevel;
+
+    // Multiclasses, cleric domain feats and the final spell lists
+    character->nDomainFeat1 = -1;
+    character->nDomainFeat2 = -1;
+    uint8_t nNumMultiClasses = std::min<uint8_t>(pCreatureStats->m_nNumMultiClasses, NUM_MULTICLASS);
+    character->multiClasses.resize(nNumMultiClasses);
+    for (int nMultiClass = 0; nMultiClass < nNumMultiClasses; nMultiClass++)
+    {
+        auto &multiClass = character->multiClasses[nMultiClass];
+        multiClass.nClass = pCreatureStats->GetClass(nMultiClass);
+        multiClass.nLevel = pCreatureStats->GetClassLevel(nMultiClass, false);
+
+        if (multiClass.nClass >= rules.classes.size())
+            return character;
+
+        CNWClass *pClass = &pRules->m_lstClasses[multiClass.nClass];
+        multiClass.bMeetsPrestigeClassRequirements = pCreatureStats->GetMeetsPrestigeClassRequirements(pClass);
+        multiClass.bAlignmentAllowed = nMultiClass != 0 || !character->bNewCharacter ||
+                                       pClass->GetIsAlignmentAllowed(pCreatureStats->GetSimpleAlignmentGoodEvil(),
+                                                                     pCreatureStats->GetSimpleAlignmentLawChaos());
+
+        if (pClass->m_bHasDomains)
+        {
+            if (CNWDomain *pDomain = pRules->GetDomain(pCreatureStats->GetDomain1(nMultiClass)))
+                character->nDomainFeat1 = pDomain->m_nGrantedFeat;
+            if (CNWDomain *pDomain = pRules->GetDomain(pCreatureStats->GetDomain2(nMultiClass)))
+                character->nDomainFeat2 = pDomain->m_nGrantedFeat;
+        }
+
+        for (int nSpellLevel = 0; nSpellLevel < NUM_SPELL_LEVELS; nSpellLevel++)
+        {
+            if (pClass->m_bIsSpellCasterClass && pClass->m_bNeedsToMemorizeSpells)
+                multiClass.spellGainWithBonus[nSpellLevel] = pCreatureStats->GetSpellGainWithBonus(nMultiClass, nSpellLevel);
+            else
+                multiClass.spellGainWithBonus[nSpellLevel] = 0;
+
+            auto &knownSpells = multiClass.knownSpells[nSpellLevel];
+            knownSpells.resize(pCreatureStats->GetNumberKnownSpells(nMultiClass, nSpellLevel));
+            for (size_t nSpellIndex = 0; nSpellIndex < knownSpells.size(); nSpellIndex++)
+            {
+                knownSpells[nSpellIndex] = pCreatureStats->GetKnownSpell(nMultiClass, nSpellLevel, nSpellIndex);
+            }
+        }
+    }
+
+    // Get our base ability stats
+    int32_t nMods[6] = {0};
+    CNWSCreatureStats::GetStatBonusesFromFeats(&pCreatureStats->m_lstFeats, nMods, true);
+
+    auto &nAbility = character->startingAbilities;
+    nAbility[Ability::Strength] = (pCreature->m_bIsPolymorphed ?
+                                   pCreature->m_nPrePolymorphSTR : pCreatureStats->m_nStrengthBase) +
+                                  nMods[Ability::Strength];
+    nAbility[Ability::Dexterity] = (pCreature->m_bIsPolymorphed ?
+                                    pCreature->m_nPrePolymorphDEX : pCreatureStats->m_nDexterityBase) +
+                                   nMods[Ability::Dexterity];
+    nAbility[Ability::Constitution] = (pCreature->m_bIsPolymorphed ?
+                                       pCreature->m_nPrePolymorphCON : pCreatureStats->m_nConstitutionBase) +
+                                      nMods[Ability::Constitution];
+    nAbility[Ability::Intelligence] = pCreatureStats->m_nIntelligenceBase + nMods[Ability::Intelligence];
+    nAbility[Ability::Wisdom] = pCreatureStats->m_nWisdomBase + nMods[Ability::Wisdom];
+    nAbility[Ability::Charisma] = pCreatureStats->m_nCharismaBase + nMods[Ability::Charisma];
+
+    uint8_t nNumLevels = std::min<int32_t>(character->nCharacterLevel, pCreatureStats->m_lstLevelStats.num);
+
+    // Get the level 1 ability values
+    for (int nLevel = 4; nLevel <= nNumLevels; nLevel += 4)
+    {
+        uint8_t nAbilityGain = pCreatureStats->GetLevelStats(nLevel - 1)->m_nAbilityGain;
+
+        if (nAbilityGain < Ability::MAX)
+            nAbility[nAbilityGain]--;
+    }
+
+    // Walk the levels to answer the per level queries
+    auto nAbilityAtLevel = nAbility;
+    std::array<uint8_t, NUM_MULTICLASS> nMultiClassLevel = {0};
+    std::vector<uint8_t> levelClasses;
+
+    character->levels.resize(nNumLevels);
+    for (int nLevel = 1; nLevel <= nNumLevels; nLevel++)
+    {
+        CNWLevelStats *pLevelStats = pCreatureStats->GetLevelStats(nLevel - 1);
+        auto &level = character->levels[nLevel - 1];
+
+        level.nClass = pLevelStats->m_nClass;
+        level.bEpic = pLevelStats->m_bEpic;
+        level.nHitDie = pLevelStats->m_nHitDie;
+        level.nSkillPointsRemaining = pLevelStats->m_nSkillPointsRemaining;
+
+        // Keep track of multiclass levels
+        level.nMultiClass = 0;
+        for (int nMultiClass = 0; nMultiClass < nNumMultiClasses; nMultiClass++)
+        {
+            if (level.nClass == character->multiClasses[nMultiClass].nClass)
+            {
+                nMultiClassLevel[nMultiClass]++;
+                level.nMultiClass = nMultiClass;
+            }
+        }
+        level.multiClassLevels = nMultiClassLevel;
+
+        if (level.nClass >= rules.classes.size())
+        {
+            character->levels.resize(nLevel);
+            break;
+        }
+
+        CNWClass *pClass = &pRules->m_lstClasses[level.nClass];
+        uint8_t nClassLevel = nMultiClassLevel[level.nMultiClass];
+
+        if (std::find(levelClasses.begin(), levelClasses.end(), level.nClass) == levelClasses.end())
+            levelClasses.push_back(level.nClass);
+
+        // Keep track of our ability values
+        if ((nLevel % 4) == 0 && pLevelStats->m_nAbilityGain < Ability::MAX)
+        {
+            nAbilityAtLevel[pLevelStats->m_nAbilityGain]++;
+        }
+
+        // Add the stat bonus from feats
+        int32_t nStatMods[6] = {0};
+        CNWSCreatureStats::GetStatBonusesFromFeats(&pLevelStats->m_lstFeats, nStatMods, false);
+
+        for (int nAbilityIndex = 0; nAbilityIndex < Ability::MAX; nAbilityIndex++)
+        {
+            nAbilityAtLevel[nAbilityIndex] += nStatMods[nAbilityIndex];
+            nAbilityAtLevel[nAbilityIndex] += pClass->GetAbilityGainForSingleLevel(nAbilityIndex, nClassLevel);
+        }
+        level.abilities = nAbilityAtLevel;
+
+        level.nMaxHitDie = pCreatureStats->GetHitDie(level.nMultiClass, level.nClass);
+
+        level.skillRanks.resize(rules.skills.size());
+        for (size_t nSkill = 0; nSkill < rules.skills.size(); nSkill++)
+        {
+            level.skillRanks[nSkill] = pLevelStats->m_lstSkillRanks[nSkill];
+        }
+
+        level.feats.reserve(pLevelStats->m_lstFeats.num);
+        for (int nFeatIndex = 0; nFeatIndex < pLevelStats->m_lstFeats.num; nFeatIndex++)
+        {
+            CharacterSnapshot::LevelFeat feat;
+            feat.nFeat = pLevelStats->m_lstFeats.element[nFeatIndex];
+            feat.bFirstLevelGranted = nLevel == 1 && pRace->IsFirstLevelGrantedFeat(feat.nFeat);
+
+            uint8_t nLevelGranted;
+            feat.bClassGranted = pClass->IsGrantedFeat(feat.nFeat, nLevelGranted) && nLevelGranted == nClassLevel;
+
+            level.feats.push_back(feat);
+        }
+
+        // Spell tables of the class leveled up in
+        uint8_t nCastingAbility = pClass->m_nSpellcastingAbility < Ability::MAX ?
+                                  nAbilityAtLevel[pClass->m_nSpellcastingAbility] : 0;
+        for (int nSpellLevel = 0; nSpellLevel < NUM_SPELL_LEVELS; nSpellLevel++)
+        {
+            level.spellGain[nSpellLevel] = pClass->m_bSpellbookRestricted && pClass->m_bNeedsToMemorizeSpells ?
+                                           pClass->GetSpellGain(nClassLevel, nSpellLevel) : 0;
+            level.spellsKnown[nSpellLevel] = pClass->m_bSpellbookRestricted ?
+                                             pClass->GetSpellsKnownPerLevel(nClassLevel, nSpellLevel, level.nClass,
+                                                                            pCreatureStats->m_nRace, nCastingAbility) : 0;
+        }
+
+        level.nOppositionSchool = -1;
+        if (pClass->m_bSpellbookRestricted && pClass->m_bNeedsToMemorizeSpells)
+        {
+            uint8_t nSchool = pCreatureStats->GetSchool(level.nClass);
+            int32_t nOppositionSchool;
+            if (nSchool != 0 &&
+                pRules->m_p2DArrays->GetSpellSchoolTable()->GetINTEntry(nSchool, "Opposition", &nOppositionSchool))
+            {
+                level.nOppositionSchool = (uint8_t) nOppositionSchool;
+            }
+        }
+
+        auto SnapshotSpell = [&](uint32_t nSpellID) -> CharacterSnapshot::LevelSpell
+        {
+            CNWSpell *pSpell = pRules->m_pSpellArray->GetSpell(nSpellID);
+            if (!pSpell)
+                return {nSpellID, false, 0, 0};
+
+            return {nSpellID, true, pSpell->GetSpellLevel(level.nClass), pSpell->m_nSchool};
+        };
+        for (int nSpellLevel = 0; nSpellLevel < NUM_SPELL_LEVELS; nSpellLevel++)
+        {
+            auto &added = pLevelStats->m_pAddedKnownSpellList[nSpellLevel];
+            for (int nSpellIndex = 0; nSpellIndex < added.num; nSpellIndex++)
+            {
+                level.addedSpells[nSpellLevel].push_back(SnapshotSpell(added.element[nSpellIndex]));
+            }
+
+            auto &removed = pLevelStats->m_pRemovedKnownSpellList[nSpellLevel];
+            for (int nSpellIndex = 0; nSpellIndex < removed.num; nSpellIndex++)
+            {
+                level.removedSpells[nSpellLevel].push_back(SnapshotSpell(removed.element[nSpellIndex]));
+            }
+        }
+
+        // Spell tables of every spontaneous caster multiclass, for the feat spell level requirements
+        for (int nMultiClass = 0; nMultiClass < NUM_MULTICLASS; nMultiClass++)
+        {
+            auto &spellsKnown = level.multiClassSpellsKnown[nMultiClass];
+            spellsKnown.fill(0);
+
+            if (nMultiClass >= nNumMultiClasses || !nMultiClassLevel[nMultiClass])
+                continue;
+
+            uint8_t nMultiClassClass = character->multiClasses[nMultiClass].nClass;
+            CNWClass *pMultiClass = &pRules->m_lstClasses[nMultiClassClass];
+            if (!pMultiClass->m_bIsSpellCasterClass || pMultiClass->m_bNeedsToMemorizeSpells)
+                continue;
+
+            uint8_t nMultiClassCastingAbility = pMultiClass->m_nSpellcastingAbility < Ability::MAX ?
+                                                nAbilityAtLevel[pMultiClass->m_nSpellcastingAbility] : 0;
+            for (int nSpellLevel = 1; nSpellLevel < NUM_SPELL_LEVELS; nSpellLevel++)
+            {
+                spellsKnown[nSpellLevel] = pMultiClass->GetSpellsKnownPerLevel(nMultiClassLevel[nMultiClass], nSpellLevel,
+                                                                              nMultiClassClass, pCreatureStats->m_nRace,
+                                                                              nMultiClassCastingAbility);
+            }
+        }
+    }
+
+    // Normal and bonus list flags of every feat taken, for every class leveled up in. A chosen feat that could not be
+    // placed is checked again on the next level, possibly in another class.
+    for (const auto &level : character->levels)
+    {
+        for (const auto &feat : level.feats)
+        {
+            if (feat.nFeat >= rules.feats.size())
+                continue;
+
+            for (auto nClass : levelClasses)
+            {
+                BOOL bNormalListFeat, bBonusListFeat;
+                pPlayer->ValidateCharacter_SetNormalBonusFlags(feat.nFeat, bNormalListFeat, bBonusListFeat, nClass);
+                character->featFlags.push_back({(uint32_t(feat.nFeat) << 8) | nClass, !!bNormalListFeat, !!bBonusListFeat});
+            }
+        }
+    }
+    std::sort(character->featFlags.begin(), character->featFlags.end(),
+              [](const auto &a, const auto &b) { return a.nKey < b.nKey; });
+    character->featFlags.erase(std::unique(character->featFlags.begin(), character->featFlags.end(),
+                                           [](const auto &a, const auto &b) { return a.nKey == b.nKey; }),
+                               character->featFlags.end());
+
+    // The final feat and skill lists
+    character->feats.assign(pCreatureStats->m_lstFeats.element,
+                            pCreatureStats->m_lstFeats.element + pCreatureStats->m_lstFeats.num);
+
+    character->skillRanks.resize(rules.skills.size());
+    for (size_t nSkill = 0; nSkill < rules.skills.size(); nSkill++)
+    {
+        character->skillRanks[nSkill] = pCreatureStats->GetSkillRank(nSkill, nullptr, true);
+    }
+
+    return character;
+}
+
+}
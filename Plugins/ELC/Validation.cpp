@@ -0,0 +1,917 @@
+#include "Validation.hpp"
+
+#include <algorithm>
+
+
+using namespace NWNXLib;
+using namespace NWNXLib::API::Constants;
+
+namespace ELC {
+
+// A sorted vector with the subset of std::set used by the validation below. Characters know at most a few hundred
+// feats and spells, so this avoids a node allocation per entry on every login.
+template <typename T>
+class FlatSet
+{
+public:
+    void insert(T value)
+    {
+        auto it = std::lower_bound(m_values.begin(), m_values.end(), value);
+        if (it == m_values.end() || *it != value)
+            m_values.insert(it, value);
+    }
+    void erase(T value)
+    {
+        auto it = std::lower_bound(m_values.begin(), m_values.end(), value);
+        if (it != m_values.end() && *it == value)
+            m_values.erase(it);
+    }
+    bool contains(T value) const { return std::binary_search(m_values.begin(), m_values.end(), value); }
+    bool empty() const { return m_values.empty(); }
+    size_t size() const { return m_values.size(); }
+    void clear() { m_values.clear(); }
+    typename std::vector<T>::const_iterator begin() const { return m_values.begin(); }
+    typename std::vector<T>::const_iterator end() const { return m_values.end(); }
+
+private:
+    std::vector<T> m_values;
+};
+
+// Walks the character the same way CNWSPlayer::ValidateCharacter does, but records each failure with the level, skill,
+// feat and spell being checked instead of stopping. Checks that would dereference an invalid race, class, feat or spell
+// are skipped, or end the walk when nothing after them can be checked.
+class Validator
+{
+public:
+    Validator(const CharacterSnapshot &character, const RulesSnapshot &rules)
+        : m_character(character), m_rules(rules) {}
+
+    std::vector<ValidationFailure> Run();
+
+private:
+    void Fail(ValidationFailureType::TYPE type, ValidationFailureSubType::TYPE subType, int32_t strRef)
+    {
+        m_failures.push_back({type, subType, strRef, m_level, m_skillId, m_featId, m_spellId});
+    }
+
+    bool CheckClasses();
+    void CheckAbilities();
+    bool CheckLevel(const CharacterSnapshot::Level &level, int nLevel);
+    void CheckSkills(const CharacterSnapshot::Level &level, const RulesSnapshot::Class &classLeveledUpIn, int nLevel);
+    void CheckFeats(const CharacterSnapshot::Level &level, const RulesSnapshot::Class &classLeveledUpIn, int nLevel);
+    void CheckChosenFeatRequirements(const CharacterSnapshot::Level &level, uint16_t nFeat);
+    void CheckSpells(const CharacterSnapshot::Level &level, const RulesSnapshot::Class &classLeveledUpIn);
+    void CheckFinalLists();
+
+    bool GetFeatFlags(uint16_t nFeat, uint8_t nClass, bool &bNormalListFeat, bool &bBonusListFeat) const
+    {
+        uint32_t nKey = (uint32_t(nFeat) << 8) | nClass;
+        auto it = std::lower_bound(m_character.featFlags.begin(), m_character.featFlags.end(), nKey,
+                                   [](const CharacterSnapshot::FeatFlags &flags, uint32_t key) { return flags.nKey < key; });
+        if (it == m_character.featFlags.end() || it->nKey != nKey)
+            return false;
+
+        bNormalListFeat = it->bNormalListFeat;
+        bBonusListFeat = it->bBonusListFeat;
+        return true;
+    }
+
+    int8_t CalcStatModifier(int32_t nValue) const { return m_rules.statModifier[(uint8_t)nValue]; }
+
+    const CharacterSnapshot &m_character;
+    const RulesSnapshot &m_rules;
+    const CharacterSnapshot::Race &m_race = m_character.race;
+    std::vector<ValidationFailure> m_failures;
+
+    int32_t m_level = -1;
+    int32_t m_skillId = -1;
+    int32_t m_featId = -1;
+    int32_t m_spellId = -1;
+
+    uint16_t m_nSkillPointsRemaining = 0;
+    std::vector<uint8_t> m_listSkillRanks;
+    FlatSet<uint16_t> m_listFeats;
+    FlatSet<uint16_t> m_listChosenFeats;
+    // [nMultiClass][nSpellLevel] -> {SpellIDs}
+    std::array<std::array<FlatSet<uint32_t>, NUM_SPELL_LEVELS>, NUM_MULTICLASS> m_listSpells;
+};
+
+std::vector<ValidationFailure> Validator::Run()
+{
+    // Check for non PC
+    if (!m_character.bIsPC)
+    {
+        Fail(ValidationFailureType::Character, ValidationFailureSubType::NonPCCharacter, STRREF_CHARACTER_NON_PLAYER);
+    }
+
+    // Check for DM character file
+    if (m_character.bIsDMCharacterFile)
+    {
+        Fail(ValidationFailureType::Character, ValidationFailureSubType::DMCharacter, STRREF_CHARACTER_DUNGEON_MASTER);
+    }
+
+    // Check for non player race, without a race nothing else can be checked
+    if (!m_character.bValidRace || !m_race.bIsPlayerRace)
+    {
+        Fail(ValidationFailureType::Character, ValidationFailureSubType::NonPlayerRace, STRREF_CHARACTER_NON_PLAYER_RACE);
+
+        if (!m_character.bValidRace)
+            return std::move(m_failures);
+    }
+
+    if (!CheckClasses())
+        return std::move(m_failures);
+
+    CheckAbilities();
+
+    m_listSkillRanks.resize(m_rules.skills.size(), 0);
+
+    for (int nLevel = 1; nLevel <= (int)m_character.levels.size(); nLevel++)
+    {
+        if (!CheckLevel(m_character.levels[nLevel - 1], nLevel))
+            return std::move(m_failures);
+    }
+    // All levels processed, hurray!
+
+    CheckFinalLists();
+
+    return std::move(m_failures);
+}
+
+bool Validator::CheckClasses()
+{
+    // Check for non player classes, class level restrictions and prestige class requirements
+    // We also check class alignment restrictions for new characters only
+    for (size_t nMultiClass = 0; nMultiClass < m_character.multiClasses.size(); nMultiClass++)
+    {
+        const auto &multiClass = m_character.multiClasses[nMultiClass];
+
+        if (multiClass.nClass >= m_rules.classes.size())
+        {
+            Fail(ValidationFailureType::Character, ValidationFailureSubType::NonPlayerClass, STRREF_CHARACTER_NON_PLAYER_CLASS);
+            return false;
+        }
+
+        const auto &cls = m_rules.classes[multiClass.nClass];
+
+        if (!cls.bIsPlayerClass)
+        {
+            Fail(ValidationFailureType::Character, ValidationFailureSubType::NonPlayerClass, STRREF_CHARACTER_NON_PLAYER_CLASS);
+        }
+
+        if (cls.nMaxLevel > 0 && multiClass.nLevel > cls.nMaxLevel)
+        {
+            Fail(ValidationFailureType::Character, ValidationFailureSubType::ClassLevelRestriction, STRREF_CHARACTER_NON_PLAYER_CLASS);
+        }
+
+        if (!multiClass.bMeetsPrestigeClassRequirements)
+        {
+            Fail(ValidationFailureType::Character, ValidationFailureSubType::PrestigeClassRequirements, STRREF_CHARACTER_NON_PLAYER_CLASS);
+        }
+
+        if (nMultiClass == 0 && m_character.bNewCharacter && !multiClass.bAlignmentAllowed)
+        {
+            Fail(ValidationFailureType::Character, ValidationFailureSubType::ClassAlignmentRestriction, STRREF_CHARACTER_NON_PLAYER_CLASS);
+        }
+    }
+
+    return true;
+}
+
+void Validator::CheckAbilities()
+{
+    auto nAbility = m_character.startingAbilities;
+
+    // Check if >18 in an ability
+    for (int nAbilityIndex = 0; nAbilityIndex < Ability::MAX; nAbilityIndex++)
+    {
+        if (nAbility[nAbilityIndex] > m_rules.nCharGenBaseAbilityMax)
+        {
+            Fail(ValidationFailureType::Character, ValidationFailureSubType::StartingAbilityValueMax, STRREF_CHARACTER_INVALID_ABILITY_SCORES);
+        }
+    }
+
+    // Point Buy System calculation
+    uint8_t nPointBuy = m_race.nAbilitiesPointBuyNumber;
+
+    for (int nAbilityIndex = 0; nAbilityIndex < Ability::MAX; nAbilityIndex++)
+    {
+        while (nAbility[nAbilityIndex] > m_rules.nCharGenBaseAbilityMin)
+        {
+            uint8_t nCost = nAbility[nAbilityIndex] > m_rules.nAbilityCostIncrement3 ? 3 :
+                            nAbility[nAbilityIndex] > m_rules.nAbilityCostIncrement2 ? 2 : 1;
+
+            if (nPointBuy < nCost)
+            {
+                Fail(ValidationFailureType::Character, ValidationFailureSubType::AbilityPointBuySystemCalculation, STRREF_CHARACTER_INVALID_ABILITY_SCORES);
+            }
+
+            nAbility[nAbilityIndex]--;
+            nPointBuy -= nCost;
+        }
+    }
+}
+
+bool Validator::CheckLevel(const CharacterSnapshot::Level &level, int nLevel)
+{
+    // Reset variables
+    m_skillId = -1;
+    m_featId = -1;
+    m_spellId = -1;
+
+    // Store our current level so we can retrieve it
+    m_level = nLevel;
+
+    if (level.nClass >= m_rules.classes.size())
+    {
+        Fail(ValidationFailureType::Character, ValidationFailureSubType::NonPlayerClass, STRREF_CHARACTER_NON_PLAYER_CLASS);
+        return false;
+    }
+
+    const auto &classLeveledUpIn = m_rules.classes[level.nClass];
+
+    // Check if our first level class is a spellcaster and if their primary casting stat is >= 11
+    if (m_character.bEnforceCasterPrimaryStatIs11 && nLevel == 1 && classLeveledUpIn.bIsSpellCasterClass)
+    {
+        if (classLeveledUpIn.nPrimaryAbility < Ability::MAX &&
+            m_character.startingAbilities[classLeveledUpIn.nPrimaryAbility] < 11)
+        {
+            Fail(ValidationFailureType::Character, ValidationFailureSubType::ClassSpellcasterInvalidPrimaryStat, STRREF_CHARACTER_INVALID_ABILITY_SCORES);
+        }
+    }
+
+    // Check Epic Level Flag
+    if ((nLevel < CHARACTER_EPIC_LEVEL) == level.bEpic)
+    {
+        Fail(ValidationFailureType::Feat, ValidationFailureSubType::EpicLevelFlag, STRREF_FEAT_INVALID);
+    }
+
+    // Check Hit Die
+    if (level.nHitDie > level.nMaxHitDie)
+    {
+        Fail(ValidationFailureType::Character, ValidationFailureSubType::TooManyHitPoints, STRREF_CHARACTER_TOO_MANY_HITPOINTS);
+    }
+
+    CheckSkills(level, classLeveledUpIn, nLevel);
+    CheckFeats(level, classLeveledUpIn, nLevel);
+    CheckSpells(level, classLeveledUpIn);
+
+    return true;
+}
+
+void Validator::CheckSkills(const CharacterSnapshot::Level &level, const RulesSnapshot::Class &classLeveledUpIn, int nLevel)
+{
+    // Calculate the skillpoints we gained this level
+    auto nSkillPointModifierAbility = m_race.nSkillPointModifierAbility;
+    auto numSkillPoints = nSkillPointModifierAbility >= 0 && nSkillPointModifierAbility < Ability::MAX ?
+                          CalcStatModifier(level.abilities[nSkillPointModifierAbility] +
+                                           m_race.abilityAdjust[nSkillPointModifierAbility]) : 0;
+
+    if (nLevel == 1)
+    {
+        m_nSkillPointsRemaining += m_race.nFirstLevelSkillPointsMultiplier *
+                                   std::max(1, classLeveledUpIn.nSkillPointBase + numSkillPoints);
+        m_nSkillPointsRemaining += m_race.nFirstLevelSkillPointsMultiplier * m_race.nExtraSkillPointsPerLevel;
+    }
+    else
+    {
+        m_nSkillPointsRemaining += std::max(1, classLeveledUpIn.nSkillPointBase + numSkillPoints);
+        m_nSkillPointsRemaining += m_race.nExtraSkillPointsPerLevel;
+    }
+
+    // Loop all the skills and check our LevelStats to see what changed
+    for (size_t nSkill = 0; nSkill < m_rules.skills.size(); nSkill++)
+    {
+        uint8_t nRankChange = level.skillRanks[nSkill];
+
+        // Set the id of the skill we're checking so we can retrieve it
+        m_skillId = nSkill;
+
+        if (!nRankChange)
+            continue;
+
+        // Figure out if we can use the skill and if it's a class skill
+        bool bCanUse = m_rules.skills[nSkill].bAllClassesCanUse;
+        bool bClassSkill = false;
+
+        if (classLeveledUpIn.skillUseable[nSkill])
+        {
+            bCanUse = true;
+            bClassSkill = classLeveledUpIn.classSkill[nSkill];
+        }
+
+        // We must be able to use the skill
+        if (!bCanUse)
+        {
+            Fail(ValidationFailureType::Skill, ValidationFailureSubType::UnusableSkill, STRREF_SKILL_UNUSEABLE);
+        }
+
+        // Check if we have enough available points
+        uint16_t nCost = bClassSkill ? nRankChange : nRankChange * 2;
+        if (nCost > m_nSkillPointsRemaining)
+        {
+            Fail(ValidationFailureType::Skill, ValidationFailureSubType::NotEnoughSkillPoints, STRREF_SKILL_INVALID_NUM_SKILLPOINTS);
+        }
+        m_nSkillPointsRemaining -= nCost;
+
+        // Increase the rank for the skill
+        m_listSkillRanks[nSkill] += nRankChange;
+
+        // Can't have more than Level + 3 in a class skill, or (Level + 3) / 2 for a non class skill
+        if (bClassSkill)
+        {
+            if (m_listSkillRanks[nSkill] > nLevel + m_rules.nSkillMaxLevel1Bonus)
+            {
+                Fail(ValidationFailureType::Skill, ValidationFailureSubType::InvalidNumRanksInClassSkill, STRREF_SKILL_INVALID_RANKS);
+            }
+        }
+        else
+        {
+            if (m_listSkillRanks[nSkill] > (nLevel + m_rules.nSkillMaxLevel1Bonus) / 2)
+            {
+                Fail(ValidationFailureType::Skill, ValidationFailureSubType::InvalidNumRanksInNonClassSkill, STRREF_SKILL_INVALID_RANKS);
+            }
+        }
+    }
+
+    // Reset the skill id
+    m_skillId = -1;
+
+    // Compare the remaining skillpoints in LevelStats with our own calculation
+    if (level.nSkillPointsRemaining > m_nSkillPointsRemaining)
+    {
+        Fail(ValidationFailureType::Skill, ValidationFailureSubType::InvalidNumRemainingSkillPoints, STRREF_SKILL_INVALID_NUM_SKILLPOINTS);
+    }
+}
+
+void Validator::CheckFeats(const CharacterSnapshot::Level &level, const RulesSnapshot::Class &classLeveledUpIn, int nLevel)
+{
+    uint8_t nMultiClassLevel = level.multiClassLevels[level.nMultiClass];
+
+    // Calculate the number of normal and bonus feats for this level
+    uint8_t nNumberNormalFeats = 0;
+    uint8_t nNumberBonusFeats = 0;
+
+    // First and every nth level gets a normal feat
+    if ((nLevel == 1) ||
+        ((m_race.nNormalFeatEveryNthLevel != 0) && (nLevel % m_race.nNormalFeatEveryNthLevel == 0)))
+    {
+        nNumberNormalFeats = m_race.nNumberNormalFeatsEveryNthLevel;
+    }
+
+    // Add any extra first level feats
+    if (nLevel == 1)
+    {
+        nNumberNormalFeats += m_race.nExtraFeatsAtFirstLevel;
+    }
+
+    nNumberBonusFeats = classLeveledUpIn.bonusFeats[std::min<int32_t>(nMultiClassLevel, MAX_CLASS_LEVEL)];
+
+    // Add this level's gained feats to our own list
+    for (const auto &levelFeat : level.feats)
+    {
+        uint16_t nFeat = levelFeat.nFeat;
+
+        if (nFeat >= m_rules.feats.size())
+        {
+            Fail(ValidationFailureType::Feat, ValidationFailureSubType::InvalidFeat, STRREF_FEAT_INVALID);
+        }
+
+        // Feats granted at first level by the race or at this class level by the class
+        bool bGranted = levelFeat.bFirstLevelGranted || levelFeat.bClassGranted;
+
+        // Check if it's one of our cleric domain feats
+        if (!bGranted && classLeveledUpIn.bHasDomains && nMultiClassLevel == 1)
+        {
+            bGranted = nFeat == m_character.nDomainFeat1 || nFeat == m_character.nDomainFeat2;
+        }
+
+        // Check if it's the "EpicCharacter" feat and we're level 21
+        if (!bGranted)
+        {
+            bGranted = nLevel == CHARACTER_EPIC_LEVEL && nFeat == Feat::EpicCharacter;
+        }
+
+        if (bGranted)
+            m_listFeats.insert(nFeat);
+        else
+            m_listChosenFeats.insert(nFeat);
+    }
+
+    // Check the requirements of the chosen feats
+    for (uint16_t nFeat : m_listChosenFeats)
+    {
+        CheckChosenFeatRequirements(level, nFeat);
+    }
+
+    // Check if we can actually pick our chosen feats this level
+    if (!m_listChosenFeats.empty() && !nNumberNormalFeats && !nNumberBonusFeats)
+    {
+        Fail(ValidationFailureType::Feat, ValidationFailureSubType::TooManyFeatsThisLevel, STRREF_FEAT_TOO_MANY);
+    }
+
+    // List to hold moved chosen feats
+    std::vector<uint16_t> listMovedFeats;
+
+    for (auto nFeatIndex : m_listChosenFeats)
+    {
+        // Set the id of the feat we're checking so we can retrieve it
+        m_featId = nFeatIndex;
+
+        bool bNormalListFeat = false;
+        bool bBonusListFeat = false;
+        GetFeatFlags(nFeatIndex, level.nClass, bNormalListFeat, bBonusListFeat);
+
+        // Not available to class
+        if (!bNormalListFeat && !bBonusListFeat)
+        {
+            Fail(ValidationFailureType::Feat, ValidationFailureSubType::FeatNotAvailableToClass, STRREF_FEAT_TOO_MANY);
+        }
+
+        // Normal Feat Only
+        if (bNormalListFeat && !bBonusListFeat)
+        {
+            if (!nNumberNormalFeats)
+            {
+                Fail(ValidationFailureType::Feat, ValidationFailureSubType::FeatIsNormalFeatOnly, STRREF_FEAT_TOO_MANY);
+            }
+
+            // Move the feat from our level list to the main list
+            m_listFeats.insert(nFeatIndex);
+            // Add the feat that's being moved to a different list because removing stuff while iterating is bad
+            listMovedFeats.push_back(nFeatIndex);
+            nNumberNormalFeats--;
+        }
+
+        // Bonus Feat Only
+        if (!bNormalListFeat && bBonusListFeat)
+        {
+            if (!nNumberBonusFeats)
+            {
+                Fail(ValidationFailureType::Feat, ValidationFailureSubType::FeatIsBonusFeatOnly, STRREF_FEAT_TOO_MANY);
+            }
+
+            // Move the feat from our level list to the main list
+            m_listFeats.insert(nFeatIndex);
+            // Add the feat that's being moved to a different list because removing stuff while iterating is bad
+            listMovedFeats.push_back(nFeatIndex);
+            nNumberBonusFeats--;
+        }
+
+        // Reset the feat id
+        m_featId = -1;
+    }
+
+    // Remove the moved feats from the chosen feat list
+    for (auto remove : listMovedFeats)
+    {
+        m_listChosenFeats.erase(remove);
+    }
+    listMovedFeats.clear();
+
+    // The feats that are left can be normal or bonus
+    for (auto nFeatIndex : m_listChosenFeats)
+    {
+        // Set the id of the feat we're checking so we can retrieve it
+        m_featId = nFeatIndex;
+
+        if (nNumberBonusFeats)
+        {
+            // Move the feat from our level list to the main list
+            m_listFeats.insert(nFeatIndex);
+            listMovedFeats.push_back(nFeatIndex);
+            nNumberBonusFeats--;
+        }
+        else if (nNumberNormalFeats)
+        {
+            // Move the feat from our level list to the main list
+            m_listFeats.insert(nFeatIndex);
+            listMovedFeats.push_back(nFeatIndex);
+            nNumberNormalFeats--;
+        }
+        else
+        {
+            Fail(ValidationFailureType::Feat, ValidationFailureSubType::TooManyFeatsThisLevel, STRREF_FEAT_TOO_MANY);
+        }
+
+        // Reset the feat id
+        m_featId = -1;
+    }
+
+    // Remove the moved feats from the chosen feat list
+    for (auto remove : listMovedFeats)
+    {
+        m_listChosenFeats.erase(remove);
+    }
+}
+
+void Validator::CheckChosenFeatRequirements(const CharacterSnapshot::Level &level, uint16_t nFeat)
+{
+    if (nFeat >= m_rules.feats.size())
+    {
+        Fail(ValidationFailureType::Feat, ValidationFailureSubType::InvalidFeat, STRREF_FEAT_INVALID);
+        return;
+    }
+
+    const auto &feat = m_rules.feats[nFeat];
+    const auto &abilities = level.abilities;
+
+    // Set the id of the feat we're checking so we can retrieve it
+    m_featId = nFeat;
+
+    // Spell Level Requirements
+    if (feat.nMinSpellLevel)
+    {
+        bool bSpellLevelMet = false;
+
+        for (size_t nMultiClass = 0; !bSpellLevelMet && nMultiClass < m_character.multiClasses.size(); nMultiClass++)
+        {
+            if (!level.multiClassLevels[nMultiClass])
+                continue;
+
+            const auto &multiClass = m_character.multiClasses[nMultiClass];
+            const auto &cls = m_rules.classes[multiClass.nClass];
+
+            if (cls.bIsSpellCasterClass && feat.nMinSpellLevel < NUM_SPELL_LEVELS)
+            {
+                if (!cls.bNeedsToMemorizeSpells)
+                    bSpellLevelMet = level.multiClassSpellsKnown[nMultiClass][feat.nMinSpellLevel];
+                else
+                    bSpellLevelMet = multiClass.spellGainWithBonus[feat.nMinSpellLevel];
+            }
+        }
+
+        if (!bSpellLevelMet)
+        {
+            Fail(ValidationFailureType::Feat, ValidationFailureSubType::FeatRequiredSpellLevelNotMet, STRREF_FEAT_REQ_SPELL_LEVEL);
+        }
+    }
+
+    // Ability Requirements
+    uint8_t nBaseAttackBonus = 0;
+
+    for (size_t nMultiClass = 0; nMultiClass < m_character.multiClasses.size(); nMultiClass++)
+    {
+        if (auto nMultiClassLevel = level.multiClassLevels[nMultiClass])
+        {
+            const auto &cls = m_rules.classes[m_character.multiClasses[nMultiClass].nClass];
+            nBaseAttackBonus += cls.attackBonus[std::min<int32_t>(nMultiClassLevel, MAX_CLASS_LEVEL)];
+        }
+    }
+
+    if (feat.nMinAttackBonus > nBaseAttackBonus)
+    {
+        Fail(ValidationFailureType::Feat, ValidationFailureSubType::FeatRequiredBaseAttackBonusNotMet, STRREF_FEAT_REQ_ABILITY);
+    }
+
+    auto CheckMinAbility = [&](uint8_t nMinValue, int32_t nAbility)
+    {
+        if (nMinValue > abilities[nAbility] + m_race.abilityAdjust[nAbility])
+        {
+            Fail(ValidationFailureType::Feat, ValidationFailureSubType::FeatRequiredAbilityValueNotMet, STRREF_FEAT_REQ_ABILITY);
+        }
+    };
+    CheckMinAbility(feat.nMinSTR, Ability::Strength);
+    CheckMinAbility(feat.nMinDEX, Ability::Dexterity);
+    CheckMinAbility(feat.nMinINT, Ability::Intelligence);
+    CheckMinAbility(feat.nMinWIS, Ability::Wisdom);
+    CheckMinAbility(feat.nMinCON, Ability::Constitution);
+    CheckMinAbility(feat.nMinCHA, Ability::Charisma);
+
+    // Skill Focus Feats
+    auto SkillFocusFeatCheck = [&](uint16_t nReqSkill) -> int32_t
+    {
+        if (nReqSkill == (uint16_t) -1)
+            return 0;
+
+        if (nReqSkill >= m_rules.skills.size())
+            return STRREF_FEAT_REQ_SKILL;
+
+        bool bSkillRequirementMet = false;
+
+        if (m_rules.skills[nReqSkill].bUntrained)
+        {
+            // Make sure we have a class that can use the skill
+            for (const auto &multiClass : m_character.multiClasses)
+            {
+                if (m_rules.classes[multiClass.nClass].skillUseable[nReqSkill])
+                {
+                    bSkillRequirementMet = true;
+                }
+            }
+
+            if (!bSkillRequirementMet)
+            {
+                return STRREF_FEAT_REQ_SKILL;
+            }
+        }
+
+        if (!bSkillRequirementMet && m_listSkillRanks[nReqSkill] == 0)
+        {
+            return STRREF_FEAT_REQ_SKILL;
+        }
+
+        if (m_listSkillRanks[nReqSkill] < feat.nMinRequiredSkillRank2)
+        {
+            return STRREF_SKILL_UNUSEABLE;
+        }
+
+        return 0;
+    };
+
+    for (auto nReqSkill : {feat.nRequiredSkill, feat.nRequiredSkill2})
+    {
+        if (auto retVal = SkillFocusFeatCheck(nReqSkill))
+        {
+            Fail(ValidationFailureType::Feat, ValidationFailureSubType::FeatRequiredSkillNotMet, retVal);
+        }
+    }
+
+    // Check Feat Prereqs
+    for (auto nPrereqFeat : feat.prereqFeats)
+    {
+        if (nPrereqFeat != (uint16_t) -1 &&
+            !m_listFeats.contains(nPrereqFeat) && !m_listChosenFeats.contains(nPrereqFeat))
+        {
+            Fail(ValidationFailureType::Feat, ValidationFailureSubType::FeatRequiredFeatNotMet, STRREF_FEAT_REQ_FEAT);
+        }
+    }
+
+    // The feat requires a "OrPrereq" feat
+    bool bHasOrPrereqFeat = false;
+    // The character has one of these feats
+    bool bOrPrereqFeatAcquired = false;
+
+    for (auto nPrereqFeat : feat.orPrereqFeats)
+    {
+        if (bOrPrereqFeatAcquired)
+            break;
+
+        if (nPrereqFeat != (uint16_t) -1)
+        {
+            bHasOrPrereqFeat = true;
+            bOrPrereqFeatAcquired = m_listFeats.contains(nPrereqFeat) || m_listChosenFeats.contains(nPrereqFeat);
+        }
+    }
+
+    if (bHasOrPrereqFeat && !bOrPrereqFeatAcquired)
+    {
+        Fail(ValidationFailureType::Feat, ValidationFailureSubType::FeatRequiredFeatNotMet, STRREF_FEAT_REQ_FEAT);
+    }
+
+    // Reset feat id
+    m_featId = -1;
+}
+
+void Validator::CheckSpells(const CharacterSnapshot::Level &level, const RulesSnapshot::Class &classLeveledUpIn)
+{
+    uint8_t nMultiClassLevel = level.multiClassLevels[level.nMultiClass];
+    auto &listSpells = m_listSpells[level.nMultiClass];
+    bool bWizard = classLeveledUpIn.bSpellbookRestricted && classLeveledUpIn.bNeedsToMemorizeSpells;
+    uint8_t nCastingAbility = classLeveledUpIn.nSpellcastingAbility < Ability::MAX ?
+                              level.abilities[classLeveledUpIn.nSpellcastingAbility] : 0;
+
+    uint32_t nNumberWizardSpellsToAdd = 0;
+
+    // Calculate the num of spells a wizard can add
+    if (classLeveledUpIn.bCanLearnFromScrolls)
+    {
+        if (nMultiClassLevel == 1)
+        {
+            nNumberWizardSpellsToAdd = 3 + std::max((int8_t) 0,
+                                                    CalcStatModifier(level.abilities[Ability::Intelligence] +
+                                                                     m_race.abilityAdjust[Ability::Intelligence]));
+        }
+        else
+        {
+            nNumberWizardSpellsToAdd = 2;
+        }
+    }
+
+    for (int nSpellLevel = 0; nSpellLevel < NUM_SPELL_LEVELS; nSpellLevel++)
+    {
+        for (const auto &spell : level.addedSpells[nSpellLevel])
+        {
+            // Can we add spells this level?
+            if (bWizard)
+            {
+                if (!level.spellGain[nSpellLevel])
+                {
+                    Fail(ValidationFailureType::Spell, ValidationFailureSubType::SpellInvalidSpellGainWizard, STRREF_SPELL_ILLEGAL_LEVEL);
+                }
+            }
+            else if (classLeveledUpIn.bSpellbookRestricted)
+            {
+                if (!level.spellsKnown[nSpellLevel])
+                {
+                    Fail(ValidationFailureType::Spell, ValidationFailureSubType::SpellInvalidSpellGainBardSorcerer, STRREF_SPELL_ILLEGAL_LEVEL);
+                }
+            }
+            else
+            {
+                Fail(ValidationFailureType::Spell, ValidationFailureSubType::SpellInvalidSpellGainOtherClasses, STRREF_SPELL_ILLEGAL_LEVEL);
+            }
+
+            if (!spell.bValid)
+            {
+                Fail(ValidationFailureType::Spell, ValidationFailureSubType::InvalidSpell, STRREF_SPELL_INVALID_SPELL);
+                continue;
+            }
+
+            // Store the spell id so we can retrieve it later
+            m_spellId = spell.nSpellID;
+
+            // Check the spell level
+            if (spell.nSpellLevel != nSpellLevel)
+            {
+                Fail(ValidationFailureType::Spell, ValidationFailureSubType::SpellInvalidSpellLevel, STRREF_SPELL_REQ_SPELL_LEVEL);
+            }
+
+            // Check for minimum ability
+            if (classLeveledUpIn.bSpellbookRestricted && nCastingAbility < 10 + nSpellLevel)
+            {
+                Fail(ValidationFailureType::Spell, ValidationFailureSubType::SpellMinimumAbility, STRREF_SPELL_REQ_ABILITY);
+            }
+
+            // Check Opposition School
+            if (bWizard && level.nOppositionSchool >= 0 && spell.nSchool == (uint8_t) level.nOppositionSchool)
+            {
+                Fail(ValidationFailureType::Spell, ValidationFailureSubType::SpellRestrictedSpellSchool, STRREF_SPELL_OPPOSITE_SPELL_SCHOOL);
+            }
+
+            // Check if we already know the spell
+            if (listSpells[nSpellLevel].contains(spell.nSpellID))
+            {
+                Fail(ValidationFailureType::Spell, ValidationFailureSubType::SpellAlreadyKnown, STRREF_SPELL_LEARNED_TWICE);
+            }
+
+            // Check if we're a wizard and haven't exceeded the number of spells we can add
+            if (bWizard && nSpellLevel != 0)
+            {
+                if (!nNumberWizardSpellsToAdd)
+                {
+                    Fail(ValidationFailureType::Spell, ValidationFailureSubType::SpellWizardExceedsNumSpellsToAdd, STRREF_SPELL_ILLEGAL_NUM_SPELLS);
+                }
+                nNumberWizardSpellsToAdd--;
+            }
+
+            // Add the spell to our list
+            listSpells[nSpellLevel].insert(spell.nSpellID);
+
+            // Reset the spell id
+            m_spellId = -1;
+        }
+
+        // Check Bard/Sorc removed spells
+        for (const auto &spell : level.removedSpells[nSpellLevel])
+        {
+            if (!classLeveledUpIn.bSpellbookRestricted || classLeveledUpIn.bNeedsToMemorizeSpells ||
+                nMultiClassLevel == 1 || !level.spellsKnown[nSpellLevel])
+            {
+                Fail(ValidationFailureType::Spell, ValidationFailureSubType::IllegalRemovedSpell, STRREF_SPELL_ILLEGAL_REMOVED_SPELLS);
+            }
+
+            if (!spell.bValid)
+            {
+                Fail(ValidationFailureType::Spell, ValidationFailureSubType::InvalidSpell, STRREF_SPELL_INVALID_SPELL);
+                continue;
+            }
+
+            // Store the spell id so we can retrieve it later
+            m_spellId = spell.nSpellID;
+
+            // Check if we actually know the spell
+            if (!listSpells[nSpellLevel].contains(spell.nSpellID))
+            {
+                Fail(ValidationFailureType::Spell, ValidationFailureSubType::RemovedNotKnownSpell, STRREF_SPELL_ILLEGAL_REMOVED_SPELLS);
+            }
+
+            // Remove the spell from our list
+            listSpells[nSpellLevel].erase(spell.nSpellID);
+
+            // Reset the spell id
+            m_spellId = -1;
+        }
+    }
+
+    // Check if we have the valid number of spells
+    if (classLeveledUpIn.bSpellbookRestricted && !classLeveledUpIn.bCanLearnFromScrolls)
+    {
+        for (int nSpellLevel = 0; nSpellLevel < NUM_SPELL_LEVELS; nSpellLevel++)
+        {
+            if (listSpells[nSpellLevel].size() > level.spellsKnown[nSpellLevel])
+            {
+                Fail(ValidationFailureType::Spell, ValidationFailureSubType::InvalidNumSpells, STRREF_SPELL_ILLEGAL_NUM_SPELLS);
+            }
+        }
+    }
+}
+
+void Validator::CheckFinalLists()
+{
+    // Final Spells Check
+    // Check if our list of spells from LevelStats are the same as the spells the character knows
+    for (size_t nMultiClass = 0; nMultiClass < m_character.multiClasses.size(); nMultiClass++)
+    {
+        const auto &multiClass = m_character.multiClasses[nMultiClass];
+
+        // We skip wizard because they can learn spells from scrolls
+        if (m_rules.classes[multiClass.nClass].bCanLearnFromScrolls)
+            continue;
+
+        for (int nSpellLevel = 0; nSpellLevel < NUM_SPELL_LEVELS; nSpellLevel++)
+        {
+            auto &listSpells = m_listSpells[nMultiClass][nSpellLevel];
+
+            for (auto nSpellID : multiClass.knownSpells[nSpellLevel])
+            {
+                if (listSpells.empty())
+                {
+                    Fail(ValidationFailureType::Spell, ValidationFailureSubType::SpellListComparison, STRREF_SPELL_ILLEGAL_NUM_SPELLS);
+                }
+
+                // Store the spell id so we can retrieve it later
+                m_spellId = nSpellID;
+
+                if (!listSpells.contains(nSpellID))
+                {
+                    Fail(ValidationFailureType::Spell, ValidationFailureSubType::SpellListComparison, STRREF_SPELL_ILLEGAL_NUM_SPELLS);
+                }
+
+                listSpells.erase(nSpellID);
+
+                // Reset the spell id
+                m_spellId = -1;
+            }
+
+            if (!listSpells.empty())
+            {
+                Fail(ValidationFailureType::Spell, ValidationFailureSubType::SpellListComparison, STRREF_SPELL_ILLEGAL_NUM_SPELLS);
+            }
+        }
+    }
+
+    // Final Skills Check
+    // Compare our calculated rank with the saved rank
+    for (size_t nSkill = 0; nSkill < m_rules.skills.size(); nSkill++)
+    {
+        // Store the skill id so we can retrieve it later
+        m_skillId = nSkill;
+
+        if (m_listSkillRanks[nSkill] != m_character.skillRanks[nSkill])
+        {
+            Fail(ValidationFailureType::Skill, ValidationFailureSubType::SkillListComparison, STRREF_SKILL_INVALID_RANKS);
+        }
+
+        // Reset the skill id
+        m_skillId = -1;
+    }
+
+    // Final Feats Check
+    // Check if our list of feats from LevelStats are the same as the feats the character has
+    for (auto nFeat : m_character.feats)
+    {
+        if (m_listFeats.empty())
+        {
+            Fail(ValidationFailureType::Feat, ValidationFailureSubType::FeatListComparison, STRREF_FEAT_TOO_MANY);
+        }
+
+        // Store the feat id so we can retrieve it later
+        m_featId = nFeat;
+
+        if (!m_listFeats.contains(nFeat))
+        {
+            Fail(ValidationFailureType::Feat, ValidationFailureSubType::FeatListComparison, STRREF_FEAT_TOO_MANY);
+        }
+
+        m_listFeats.erase(nFeat);
+
+        // Reset the feat id
+        m_featId = -1;
+    }
+
+    // Check Misc Saving Throws
+    if (m_character.bMiscSavingThrow)
+    {
+        Fail(ValidationFailureType::Character, ValidationFailureSubType::MiscSavingThrow, STRREF_CHARACTER_SAVING_THROW);
+    }
+
+    // Compare Feats Lists
+    size_t nNumberOfFeats = 0;
+    for (const auto &level : m_character.levels)
+    {
+        nNumberOfFeats += level.feats.size();
+    }
+
+    if (m_character.feats.size() > nNumberOfFeats)
+    {
+        Fail(ValidationFailureType::Feat, ValidationFailureSubType::NumFeatComparison, STRREF_FEAT_INVALID);
+    }
+}
+
+std::vector<ValidationFailure> ValidateCharacter(const CharacterSnapshot &character, const RulesSnapshot &rules)
+{
+    return Validator(character, rules).Run();
+}
+
+}
@@ -0,0 +1,281 @@
+#pragma once
+#include "nwnx.hpp"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace ELC {
+
+namespace ValidationFailureType
+{
+    enum TYPE
+    {
+        None = 0,
+        Character,
+        Item,
+        Skill,
+        Feat,
+        Spell,
+        Custom
+    };
+}
+namespace ValidationFailureSubType
+{
+    enum TYPE
+    {
+        None = 0,
+        ServerLevelRestriction,
+        LevelHack,
+        ColoredName,
+        UnidentifiedEquippedItem,
+        MinEquipLevel,
+        NonPCCharacter,
+        DMCharacter,
+        NonPlayerRace,
+        NonPlayerClass,
+        ClassLevelRestriction,
+        PrestigeClassRequirements,
+        ClassAlignmentRestriction,
+        StartingAbilityValueMax,
+        AbilityPointBuySystemCalculation,
+        ClassSpellcasterInvalidPrimaryStat,
+        EpicLevelFlag,
+        TooManyHitPoints,
+        UnusableSkill,
+        NotEnoughSkillPoints,
+        InvalidNumRanksInClassSkill,
+        InvalidNumRanksInNonClassSkill,
+        InvalidNumRemainingSkillPoints,
+        InvalidFeat,
+        FeatRequiredSpellLevelNotMet,
+        FeatRequiredBaseAttackBonusNotMet,
+        FeatRequiredAbilityValueNotMet,
+        FeatRequiredSkillNotMet,
+        FeatRequiredFeatNotMet,
+        TooManyFeatsThisLevel,
+        FeatNotAvailableToClass,
+        FeatIsNormalFeatOnly,
+        FeatIsBonusFeatOnly,
+        SpellInvalidSpellGainWizard,
+        SpellInvalidSpellGainBardSorcerer,
+        SpellInvalidSpellGainOtherClasses,
+        InvalidSpell,
+        SpellInvalidSpellLevel,
+        SpellMinimumAbilityBardSorcerer_Unused,
+        SpellMinimumAbilityWizard_Unused,
+        SpellMinimumAbility,
+        SpellRestrictedSpellSchool,
+        SpellAlreadyKnown,
+        SpellWizardExceedsNumSpellsToAdd,
+        IllegalRemovedSpell,
+        RemovedNotKnownSpell,
+        InvalidNumSpells,
+        SpellListComparison,
+        SkillListComparison,
+        FeatListComparison,
+        MiscSavingThrow,
+        NumFeatComparison,
+        NumMulticlass
+    };
+}
+// Validation Failure STRREFS
+const int32_t STRREF_CHARACTER_DOES_NOT_EXIST               = 63767;
+const int32_t STRREF_CHARACTER_LEVEL_RESTRICTION            = 57924;
+const int32_t STRREF_CHARACTER_NON_PLAYER                   = 63760;
+const int32_t STRREF_CHARACTER_DUNGEON_MASTER               = 67641;
+const int32_t STRREF_CHARACTER_NON_PLAYER_RACE              = 66166;
+const int32_t STRREF_CHARACTER_NON_PLAYER_CLASS             = 66167;
+const int32_t STRREF_CHARACTER_TOO_MANY_HITPOINTS           = 3109;
+const int32_t STRREF_CHARACTER_SAVING_THROW                 = 8066;
+const int32_t STRREF_CHARACTER_INVALID_ABILITY_SCORES       = 63761;
+const int32_t STRREF_CHARACTER_NUMBERMULTICLASSES           = 63764;
+const int32_t STRREF_ITEM_LEVEL_RESTRICTION                 = 68521;
+const int32_t STRREF_SKILL_UNUSEABLE                        = 63815;
+const int32_t STRREF_SKILL_INVALID_RANKS                    = 66165;
+const int32_t STRREF_SKILL_INVALID_NUM_SKILLPOINTS          = 66155;
+const int32_t STRREF_FEAT_INVALID                           = 76383;
+const int32_t STRREF_FEAT_TOO_MANY                          = 66222;
+const int32_t STRREF_FEAT_REQ_ABILITY                       = 66175;
+const int32_t STRREF_FEAT_REQ_SPELL_LEVEL                   = 66176;
+const int32_t STRREF_FEAT_REQ_FEAT                          = 66182;
+const int32_t STRREF_FEAT_REQ_SKILL                         = 66183;
+const int32_t STRREF_SPELL_REQ_SPELL_LEVEL                  = 66498;
+const int32_t STRREF_SPELL_INVALID_SPELL                    = 66499;
+const int32_t STRREF_SPELL_ILLEGAL_LEVEL                    = 68627;
+const int32_t STRREF_SPELL_REQ_ABILITY                      = 68628;
+const int32_t STRREF_SPELL_LEARNED_TWICE                    = 68629;
+const int32_t STRREF_SPELL_ILLEGAL_NUM_SPELLS               = 68630;
+const int32_t STRREF_SPELL_ILLEGAL_REMOVED_SPELLS           = 68631;
+const int32_t STRREF_SPELL_OPPOSITE_SPELL_SCHOOL            = 66500;
+const int32_t STRREF_CUSTOM                                 = 164;
+
+// Magic Numbers
+const int32_t NUM_CREATURE_ITEM_SLOTS       = 4;
+const int32_t NUM_MULTICLASS                = 8;
+const int32_t CHARACTER_EPIC_LEVEL          = 21;
+const int32_t NUM_SPELL_LEVELS              = 10;
+const int32_t MAX_CLASS_LEVEL               = 60;
+
+struct ValidationFailure
+{
+    ValidationFailureType::TYPE type;
+    ValidationFailureSubType::TYPE subType;
+    int32_t strRef;
+    int32_t level;
+    int32_t skillId;
+    int32_t featId;
+    int32_t spellId;
+};
+
+// The parts of CNWRules the validation reads. Built once on the main thread and shared read-only with the worker.
+struct RulesSnapshot
+{
+    struct Class
+    {
+        bool bIsPlayerClass;
+        bool bHasDomains;
+        bool bIsSpellCasterClass;
+        bool bNeedsToMemorizeSpells;
+        bool bSpellbookRestricted;
+        bool bCanLearnFromScrolls;
+        uint8_t nMaxLevel;
+        uint8_t nPrimaryAbility;
+        uint8_t nSpellcastingAbility;
+        uint8_t nSkillPointBase;
+        // Indexed by class level, 0 is unused
+        std::array<uint8_t, MAX_CLASS_LEVEL + 1> attackBonus;
+        std::array<uint8_t, MAX_CLASS_LEVEL + 1> bonusFeats;
+        std::vector<bool> skillUseable;
+        std::vector<bool> classSkill;
+    };
+    struct Skill
+    {
+        bool bAllClassesCanUse;
+        bool bUntrained;
+    };
+    struct Feat
+    {
+        uint8_t nMinAttackBonus;
+        uint8_t nMinSTR;
+        uint8_t nMinDEX;
+        uint8_t nMinINT;
+        uint8_t nMinWIS;
+        uint8_t nMinCON;
+        uint8_t nMinCHA;
+        uint8_t nMinSpellLevel;
+        std::array<uint16_t, 2> prereqFeats;
+        std::array<uint16_t, 5> orPrereqFeats;
+        uint16_t nRequiredSkill;
+        uint16_t nRequiredSkill2;
+        uint16_t nMinRequiredSkillRank2;
+    };
+
+    std::vector<Class> classes;
+    std::vector<Skill> skills;
+    std::vector<Feat> feats;
+    // CNWSCreatureStats::CalcStatModifier() for every ability value
+    std::array<int8_t, 256> statModifier;
+    int32_t nCharGenBaseAbilityMin;
+    int32_t nCharGenBaseAbilityMax;
+    int32_t nAbilityCostIncrement2;
+    int32_t nAbilityCostIncrement3;
+    int32_t nSkillMaxLevel1Bonus;
+};
+
+// Everything the validation needs to know about one character, copied on the main thread when it logs in. Engine
+// queries that depend on the character (hit dice, spell tables, feat lists) are answered here so the worker only
+// compares numbers.
+struct CharacterSnapshot
+{
+    struct Race
+    {
+        bool bIsPlayerRace;
+        int32_t nAbilitiesPointBuyNumber;
+        std::array<int8_t, NWNXLib::API::Constants::Ability::MAX> abilityAdjust;
+        int32_t nSkillPointModifierAbility;
+        int32_t nFirstLevelSkillPointsMultiplier;
+        int32_t nExtraSkillPointsPerLevel;
+        int32_t nNormalFeatEveryNthLevel;
+        int32_t nNumberNormalFeatsEveryNthLevel;
+        int32_t nExtraFeatsAtFirstLevel;
+    };
+    struct MultiClass
+    {
+        uint8_t nClass;
+        uint8_t nLevel;
+        bool bMeetsPrestigeClassRequirements;
+        bool bAlignmentAllowed;
+        std::array<uint8_t, NUM_SPELL_LEVELS> spellGainWithBonus;
+        std::array<std::vector<uint32_t>, NUM_SPELL_LEVELS> knownSpells;
+    };
+    struct LevelFeat
+    {
+        uint16_t nFeat;
+        bool bFirstLevelGranted;
+        bool bClassGranted;
+    };
+    struct LevelSpell
+    {
+        uint32_t nSpellID;
+        bool bValid;
+        uint8_t nSpellLevel;
+        uint8_t nSchool;
+    };
+    struct Level
+    {
+        uint8_t nClass;
+        uint8_t nMultiClass;
+        std::array<uint8_t, NUM_MULTICLASS> multiClassLevels;
+        bool bEpic;
+        uint8_t nHitDie;
+        uint8_t nMaxHitDie;
+        uint16_t nSkillPointsRemaining;
+        // Ability values once this level's gains are applied
+        std::array<uint8_t, NWNXLib::API::Constants::Ability::MAX> abilities;
+        std::vector<uint8_t> skillRanks;
+        std::vector<LevelFeat> feats;
+        std::array<std::vector<LevelSpell>, NUM_SPELL_LEVELS> addedSpells;
+        std::array<std::vector<LevelSpell>, NUM_SPELL_LEVELS> removedSpells;
+        // For the class leveled up in
+        std::array<uint8_t, NUM_SPELL_LEVELS> spellGain;
+        std::array<uint8_t, NUM_SPELL_LEVELS> spellsKnown;
+        int32_t nOppositionSchool;
+        // For every multiclass that casts without memorizing
+        std::array<std::array<uint8_t, NUM_SPELL_LEVELS>, NUM_MULTICLASS> multiClassSpellsKnown;
+    };
+    struct FeatFlags
+    {
+        uint32_t nKey; // (nFeat << 8) | nClass
+        bool bNormalListFeat;
+        bool bBonusListFeat;
+    };
+
+    // NWNX_ELC_ENFORCE_CASTER_PRIMARY_STAT_IS_11 when the snapshot was taken
+    bool bEnforceCasterPrimaryStatIs11;
+    bool bIsPC;
+    bool bIsDMCharacterFile;
+    bool bValidRace;
+    Race race;
+    uint8_t nCharacterLevel;
+    bool bNewCharacter;
+    std::vector<MultiClass> multiClasses;
+    uint16_t nDomainFeat1;
+    uint16_t nDomainFeat2;
+    // Base abilities with the ability gains and feat bonuses of all levels removed
+    std::array<uint8_t, NWNXLib::API::Constants::Ability::MAX> startingAbilities;
+    std::vector<Level> levels;
+    // Sorted by nKey
+    std::vector<FeatFlags> featFlags;
+    std::vector<uint16_t> feats;
+    std::vector<uint8_t> skillRanks;
+    bool bMiscSavingThrow;
+};
+
+std::shared_ptr<const RulesSnapshot> GetRulesSnapshot(CNWSCreatureStats *pCreatureStats);
+std::shared_ptr<const CharacterSnapshot> TakeCharacterSnapshot(CNWSPlayer *pPlayer, CNWSCreature *pCreature, const RulesSnapshot &rules);
+// Pure function of the two snapshots, safe to run on any thread. Unlike the engine it does not stop at the first
+// failure; every failure is returned in the order they are found so the ELC script can decide which ones to skip.
+std::vector<ValidationFailure> ValidateCharacter(const CharacterSnapshot &character, const RulesSnapshot &rules);
+
+}
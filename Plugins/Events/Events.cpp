@@ -3,7 +3,6 @@
 #include "API/CScriptCompiler.hpp"
 #include "API/CTlkTable.hpp"
 #include <set>
-#include <regex>
 
 namespace Events {
 
@@ -194,7 +193,7 @@ void RunEventInit(const std::string& eventName)
     std::vector<std::string> erase;
     for (const auto& it: s_initList)
     {
-        if (std::regex_search(eventName, std::regex(it.first)))
+        if (Pattern::Search(Pattern::Compile(it.first), eventName))
         {
             LOG_DEBUG("Running init function for events '%s' (requested by event '%s')", it.first, eventName);
             it.second();
@@ -17,6 +17,7 @@
 #include "API/Constants/Effect.hpp"
 #include "API/Globals.hpp"
 #include "API/Functions.hpp"
+#include <algorithm>
 #include <cmath>
 
 using namespace NWNXLib;
@@ -45,6 +46,16 @@ static Hooks::Hook s_OnApplyBonusFeatHook;
 static Hooks::Hook s_OnRemoveBonusFeatHook;
 static Hooks::Hook s_EatTURDHook;
 
+// The subset of a creature's feats that raise a bonus limit in GetTotalEffectBonus. Rebuilt when the
+// creature's feat list or the feat modifier configuration changes.
+struct BonusLimitFeatCache
+{
+    uint32_t generation = ~0u;
+    int32_t numFeats = -1;
+    vector<uint16_t> feats;
+};
+static POS::Extension<BonusLimitFeatCache> s_BonusLimitFeats;
+
 Feat::Feat(Services::ProxyServiceList* services)
     : Plugin(services)
 {
@@ -423,6 +434,29 @@ void Feat::ApplyFeatEffects(CNWSCreature *pCreature, uint16_t nFeat)
     }
 }
 
+// Reads a modifier without inserting the default into the configuration, unlike operator[].
+template <typename Map, typename Key>
+static int32_t GetFeatModifier(const Map& map, uint16_t nFeat, Key key)
+{
+    auto feat = map.find(nFeat);
+    if (feat == map.end())
+        return 0;
+    auto mod = feat->second.find(key);
+    return mod != feat->second.end() ? mod->second : 0;
+}
+
+bool Feat::HasCombatModifier(uint16_t nFeat, CombatModifierFlags flag)
+{
+    return nFeat < g_plugin->m_FeatCombatModifiers.size() && (g_plugin->m_FeatCombatModifiers[nFeat] & flag);
+}
+
+void Feat::SetCombatModifier(uint16_t nFeat, CombatModifierFlags flag)
+{
+    if (nFeat >= g_plugin->m_FeatCombatModifiers.size())
+        g_plugin->m_FeatCombatModifiers.resize(nFeat + 1, 0);
+    g_plugin->m_FeatCombatModifiers[nFeat] |= flag;
+}
+
 uint8_t Feat::SavingThrowRollHook(CNWSCreature *pCreature, uint8_t nSaveType, uint16_t nDifficultyClass, uint8_t nSpecificType,
                                ObjectID oidSaveVersus, int32_t bPrint, uint16_t nFeat, int32_t bQueueFeedback)
 {
@@ -430,26 +464,30 @@ uint8_t Feat::SavingThrowRollHook(CNWSCreature *pCreature, uint8_t nSaveType, ui
     uint16_t savingThrowBonusLimit = pServerExoApp->GetSavingThrowBonusLimit();
 
     auto *pTargetCreature = pServerExoApp->GetCreatureByGameObjectID(oidSaveVersus);
+    auto modFeatSaveBonus = GetFeatModifier(g_plugin->m_FeatSave, nFeat, nSaveType);
+    int32_t modTotalBonus = 0;
     for (int32_t j = 0; j < pCreature->m_pStats->m_lstFeats.num; j++)
     {
         auto nListFeat = pCreature->m_pStats->m_lstFeats.element[j];
-        auto modSaveBonus = g_plugin->m_FeatSave[nFeat][nSaveType] + g_plugin->m_FeatSave[nListFeat][Constants::SavingThrow::All];
+        modTotalBonus += modFeatSaveBonus;
+        if (!HasCombatModifier(nListFeat, SaveModifiers))
+            continue;
+
+        auto modSaveBonus = g_plugin->m_FeatSave[nListFeat][Constants::SavingThrow::All];
         uint8_t modSaveVSRaceBonus = 0;
         if (pTargetCreature)
         {
-            std::list<uint8_t> saveBonuses = {};
             for (int32_t k = 0; k <= Constants::SavingThrow::MAX; k++)
             {
-                saveBonuses.push_front(g_plugin->m_FeatSaveVsRace[nListFeat][k][pTargetCreature->m_pStats->m_nRace]);
-                saveBonuses.push_front(g_plugin->m_FeatSaveVsTypeRace[nListFeat][k][nSpecificType][pTargetCreature->m_pStats->m_nRace]);
+                modSaveVSRaceBonus = std::max(modSaveVSRaceBonus, (uint8_t)g_plugin->m_FeatSaveVsRace[nListFeat][k][pTargetCreature->m_pStats->m_nRace]);
+                modSaveVSRaceBonus = std::max(modSaveVSRaceBonus, (uint8_t)g_plugin->m_FeatSaveVsTypeRace[nListFeat][k][nSpecificType][pTargetCreature->m_pStats->m_nRace]);
             }
-            modSaveVSRaceBonus = *std::max_element(saveBonuses.begin(), saveBonuses.end());
         }
         auto modSaveVSTypeBonus = g_plugin->m_FeatSaveVsType[nListFeat][nSaveType][nSpecificType] +
                                   g_plugin->m_FeatSaveVsType[nListFeat][Constants::SavingThrow::All][nSpecificType];
-        pServerExoApp->SetSavingThrowBonusLimit(
-                pServerExoApp->GetSavingThrowBonusLimit() + modSaveBonus + modSaveVSRaceBonus + modSaveVSTypeBonus);
+        modTotalBonus += modSaveBonus + modSaveVSRaceBonus + modSaveVSTypeBonus;
     }
+    pServerExoApp->SetSavingThrowBonusLimit(savingThrowBonusLimit + modTotalBonus);
 
     auto retVal = s_SavingThrowRollHook->CallOriginal<uint8_t>(pCreature, nSaveType, nDifficultyClass, nSpecificType,
                                                                oidSaveVersus, bPrint, nFeat, bQueueFeedback);
@@ -459,10 +497,78 @@ uint8_t Feat::SavingThrowRollHook(CNWSCreature *pCreature, uint8_t nSaveType, ui
     return retVal;
 }
 
+bool Feat::IsBonusLimitFeat(uint16_t nFeat)
+{
+    auto hasNonZero = [](auto& map, uint16_t nFeat)
+    {
+        auto it = map.find(nFeat);
+        if (it == map.end())
+            return false;
+        return std::any_of(it->second.begin(), it->second.end(), [](auto& mod) { return mod.second != 0; });
+    };
+
+    auto ab = g_plugin->m_FeatAB.find(nFeat);
+    if (ab != g_plugin->m_FeatAB.end() && ab->second != 0)
+        return true;
+
+    if (hasNonZero(g_plugin->m_FeatAbility, nFeat) || hasNonZero(g_plugin->m_FeatABVsRace, nFeat))
+        return true;
+
+    auto saveVsRace = g_plugin->m_FeatSaveVsRace.find(nFeat);
+    if (saveVsRace != g_plugin->m_FeatSaveVsRace.end())
+    {
+        for (auto& saveMod : saveVsRace->second)
+        {
+            if (std::any_of(saveMod.second.begin(), saveMod.second.end(), [](auto& mod) { return mod.second != 0; }))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+const vector<uint16_t>& Feat::GetBonusLimitFeats(CNWSCreature *pCreature)
+{
+    auto *pStats = pCreature->m_pStats;
+    auto& cache = *s_BonusLimitFeats.Get(pCreature);
+    if (cache.generation != g_plugin->m_BonusLimitGeneration || cache.numFeats != pStats->m_lstFeats.num)
+    {
+        cache.generation = g_plugin->m_BonusLimitGeneration;
+        cache.numFeats = pStats->m_lstFeats.num;
+        cache.feats.clear();
+        for (int32_t i = 0; i < pStats->m_lstFeats.num; i++)
+        {
+            auto nFeat = pStats->m_lstFeats.element[i];
+            if (IsBonusLimitFeat(nFeat))
+                cache.feats.push_back(nFeat);
+        }
+    }
+    return cache.feats;
+}
+
+void Feat::InvalidateBonusLimitFeats(CNWSCreature *pCreature)
+{
+    s_BonusLimitFeats.Reset(pCreature);
+}
+
 int32_t Feat::GetTotalEffectBonusHook(CNWSCreature *pCreature, uint8_t nEffectBonusType, CNWSObject *pObject,
                                       int32_t bElementalDamage, int32_t bForceMax, uint8_t nSaveType, uint8_t nSpecificType,
                                       uint8_t nSkill, uint8_t nAbilityScore, int32_t bOffHand)
 {
+    if (nEffectBonusType != Constants::EffectBonusType::Attack && nEffectBonusType != Constants::EffectBonusType::SavingThrow &&
+        nEffectBonusType != Constants::EffectBonusType::Ability)
+    {
+        return s_GetTotalEffectBonusHook->CallOriginal<int32_t>(pCreature, nEffectBonusType, pObject, bElementalDamage,
+                                                                bForceMax, nSaveType, nSpecificType, nSkill, nAbilityScore, bOffHand);
+    }
+
+    auto& feats = GetBonusLimitFeats(pCreature);
+    if (feats.empty())
+    {
+        return s_GetTotalEffectBonusHook->CallOriginal<int32_t>(pCreature, nEffectBonusType, pObject, bElementalDamage,
+                                                                bForceMax, nSaveType, nSpecificType, nSkill, nAbilityScore, bOffHand);
+    }
+
     auto *pServerExoApp = Globals::AppManager()->m_pServerExoApp;
     uint16_t attackBonusLimit = pServerExoApp->GetAttackBonusLimit();
     uint16_t abilityBonusLimit = pServerExoApp->GetAbilityBonusLimit();
@@ -474,37 +580,59 @@ int32_t Feat::GetTotalEffectBonusHook(CNWSCreature *pCreature, uint8_t nEffectBo
         pTargetCreature = pServerExoApp->GetCreatureByGameObjectID(pObject->m_idSelf);
     }
 
-    for (int32_t j = 0; j < pCreature->m_pStats->m_lstFeats.num; j++)
+    auto getMod = [](auto& map, auto key) -> int32_t
     {
-        auto nFeat = pCreature->m_pStats->m_lstFeats.element[j];
-        if (nEffectBonusType == 1)
+        auto it = map.find(key);
+        return it == map.end() ? 0 : it->second;
+    };
+
+    for (auto nFeat : feats)
+    {
+        if (nEffectBonusType == Constants::EffectBonusType::Attack)
         {
-            auto modABBonus = g_plugin->m_FeatAB[nFeat];
+            auto modABBonus = getMod(g_plugin->m_FeatAB, nFeat);
             uint8_t modABVSRaceBonus = 0;
             if (pTargetCreature)
-                modABVSRaceBonus = g_plugin->m_FeatABVsRace[nFeat][pTargetCreature->m_pStats->m_nRace];
+            {
+                auto abVsRace = g_plugin->m_FeatABVsRace.find(nFeat);
+                if (abVsRace != g_plugin->m_FeatABVsRace.end())
+                    modABVSRaceBonus = getMod(abVsRace->second, pTargetCreature->m_pStats->m_nRace);
+            }
             pServerExoApp->SetAttackBonusLimit(pServerExoApp->GetAttackBonusLimit() + modABBonus + modABVSRaceBonus);
         }
-        else if (nEffectBonusType == 3)
+        else if (nEffectBonusType == Constants::EffectBonusType::SavingThrow)
         {
-            auto modSaveBonus = g_plugin->m_FeatAbility[nFeat][nSkill];
+            int32_t modSaveBonus = 0;
+            auto ability = g_plugin->m_FeatAbility.find(nFeat);
+            if (ability != g_plugin->m_FeatAbility.end())
+                modSaveBonus = getMod(ability->second, nSkill);
+
             uint8_t modSaveVSRaceBonus = 0;
             if (pTargetCreature)
             {
-                std::list<uint8_t> saveBonuses = {};
-                auto featRace = g_plugin->m_FeatSaveVsRace[nFeat][pTargetCreature->m_pStats->m_nRace];
-                saveBonuses.push_front(featRace[Constants::SavingThrow::All]);
-                saveBonuses.push_front(featRace[Constants::SavingThrow::Fortitude]);
-                saveBonuses.push_front(featRace[Constants::SavingThrow::Reflex]);
-                saveBonuses.push_front(featRace[Constants::SavingThrow::Will]);
-                modSaveVSRaceBonus = *std::max_element(saveBonuses.begin(), saveBonuses.end());
+                auto saveVsRace = g_plugin->m_FeatSaveVsRace.find(nFeat);
+                if (saveVsRace != g_plugin->m_FeatSaveVsRace.end())
+                {
+                    auto featRace = saveVsRace->second.find(pTargetCreature->m_pStats->m_nRace);
+                    if (featRace != saveVsRace->second.end())
+                    {
+                        for (auto nSave : { Constants::SavingThrow::All, Constants::SavingThrow::Fortitude,
+                                            Constants::SavingThrow::Reflex, Constants::SavingThrow::Will })
+                        {
+                            modSaveVSRaceBonus = std::max(modSaveVSRaceBonus, static_cast<uint8_t>(getMod(featRace->second, nSave)));
+                        }
+                    }
+                }
             }
             pServerExoApp->SetSavingThrowBonusLimit(
                     pServerExoApp->GetSavingThrowBonusLimit() + modSaveBonus + modSaveVSRaceBonus);
         }
-        else if (nEffectBonusType == 4)
+        else if (nEffectBonusType == Constants::EffectBonusType::Ability)
         {
-            auto modAbilityBonus = g_plugin->m_FeatAbility[nFeat][nAbilityScore];
+            int32_t modAbilityBonus = 0;
+            auto ability = g_plugin->m_FeatAbility.find(nFeat);
+            if (ability != g_plugin->m_FeatAbility.end())
+                modAbilityBonus = getMod(ability->second, nAbilityScore);
             pServerExoApp->SetAbilityBonusLimit(pServerExoApp->GetAbilityBonusLimit() + modAbilityBonus);
         }
     }
@@ -512,11 +640,11 @@ int32_t Feat::GetTotalEffectBonusHook(CNWSCreature *pCreature, uint8_t nEffectBo
     auto retVal = s_GetTotalEffectBonusHook->CallOriginal<int32_t>(pCreature, nEffectBonusType, pObject, bElementalDamage,
                                                                    bForceMax, nSaveType, nSpecificType, nSkill, nAbilityScore, bOffHand);
 
-    if (nEffectBonusType == 1)
+    if (nEffectBonusType == Constants::EffectBonusType::Attack)
         pServerExoApp->SetAttackBonusLimit(attackBonusLimit);
-    else if (nEffectBonusType == 3)
+    else if (nEffectBonusType == Constants::EffectBonusType::SavingThrow)
         pServerExoApp->SetSavingThrowBonusLimit(saveBonusLimit);
-    else if (nEffectBonusType == 4)
+    else if (nEffectBonusType == Constants::EffectBonusType::Ability)
         pServerExoApp->SetAbilityBonusLimit(abilityBonusLimit);
 
     return retVal;
@@ -527,16 +655,21 @@ int32_t Feat::GetWeaponPowerHook(CNWSCreature *pCreature, CNWSObject *pObject, i
     auto *pServerExoApp = Globals::AppManager()->m_pServerExoApp;
     uint16_t attackBonusLimit = pServerExoApp->GetAttackBonusLimit();
 
+    auto *pTargetCreature = pServerExoApp->GetCreatureByGameObjectID(pObject->m_idSelf);
+    int32_t modTotalBonus = 0;
     for (int32_t j = 0; j < pCreature->m_pStats->m_lstFeats.num; j++)
     {
         auto nFeat = pCreature->m_pStats->m_lstFeats.element[j];
+        if (!HasCombatModifier(nFeat, AttackModifiers))
+            continue;
+
         auto modABBonus = g_plugin->m_FeatAB[nFeat];
         uint8_t modABVSRaceBonus = 0;
-        auto *pTargetCreature = pServerExoApp->GetCreatureByGameObjectID(pObject->m_idSelf);
         if (pTargetCreature)
             modABVSRaceBonus = g_plugin->m_FeatABVsRace[nFeat][pTargetCreature->m_pStats->m_nRace];
-        pServerExoApp->SetAttackBonusLimit(pServerExoApp->GetAttackBonusLimit() + modABBonus + modABVSRaceBonus);
+        modTotalBonus += modABBonus + modABVSRaceBonus;
     }
+    pServerExoApp->SetAttackBonusLimit(attackBonusLimit + modTotalBonus);
 
     auto retVal = s_GetWeaponPowerHook->CallOriginal<int32_t>(pCreature, pObject, bOffHand);
 
@@ -615,28 +748,36 @@ void Feat::AddFeatHook(CNWSCreatureStats *pCreatureStats, uint16_t nFeat)
 {
     AddFeatEffects(pCreatureStats, nFeat);
     s_AddFeatHook->CallOriginal<void>(pCreatureStats, nFeat);
+    InvalidateBonusLimitFeats(pCreatureStats->m_pBaseCreature);
 }
 
 int32_t Feat::OnApplyBonusFeatHook(CNWSEffectListHandler *pEffectListHandler, CNWSObject *pObject, CGameEffect *pEffect, int32_t bLoadingGame)
 {
-    if (auto *pCreature = Utils::AsNWSCreature(pObject))
+    auto *pCreature = Utils::AsNWSCreature(pObject);
+    if (pCreature)
         AddFeatEffects(pCreature->m_pStats, pEffect->GetInteger(0));
 
-    return s_OnApplyBonusFeatHook->CallOriginal<int32_t>(pEffectListHandler, pObject, pEffect, bLoadingGame);
+    auto retVal = s_OnApplyBonusFeatHook->CallOriginal<int32_t>(pEffectListHandler, pObject, pEffect, bLoadingGame);
+    InvalidateBonusLimitFeats(pCreature);
+    return retVal;
 }
 
 void Feat::RemoveFeatHook(CNWSCreatureStats *pCreatureStats, uint16_t nFeat)
 {
     RemoveFeatEffects(pCreatureStats, nFeat);
     s_RemoveFeatHook->CallOriginal<void>(pCreatureStats, nFeat);
+    InvalidateBonusLimitFeats(pCreatureStats->m_pBaseCreature);
 }
 
 int32_t Feat::OnRemoveBonusFeatHook(CNWSEffectListHandler *pEffectListHandler, CNWSObject *pObject, CGameEffect *pEffect)
 {
-    if (auto *pCreature = Utils::AsNWSCreature(pObject))
+    auto *pCreature = Utils::AsNWSCreature(pObject);
+    if (pCreature)
         RemoveFeatEffects(pCreature->m_pStats, pEffect->GetInteger(0));
 
-    return s_OnRemoveBonusFeatHook->CallOriginal<int32_t>(pEffectListHandler, pObject, pEffect);
+    auto retVal = s_OnRemoveBonusFeatHook->CallOriginal<int32_t>(pEffectListHandler, pObject, pEffect);
+    InvalidateBonusLimitFeats(pCreature);
+    return retVal;
 }
 
 void Feat::EatTURDHook(CNWSPlayer *pPlayer, CNWSPlayerTURD *pTURD)
@@ -672,6 +813,7 @@ bool Feat::DoFeatModifier(int32_t featId, FeatModifier featMod, int32_t param1,
         case AB:
         {
             g_plugin->m_FeatAB[featId] = param1;
+            SetCombatModifier(featId, AttackModifiers);
             LOG_INFO("%s: Setting AB modifier to %d.", featName, param1);
             break;
         }
@@ -696,6 +838,7 @@ bool Feat::DoFeatModifier(int32_t featId, FeatModifier featMod, int32_t param1,
                 break;
             }
             g_plugin->m_FeatABVsRace[featId][param1] = param2;
+            SetCombatModifier(featId, AttackModifiers);
             auto versusRaceName = Globals::Rules()->m_lstRaces[param1].GetNamePluralText();
             LOG_INFO("%s: Setting AB modifier vs %s to %d.", featName, versusRaceName, param2);
             break;
@@ -843,6 +986,7 @@ bool Feat::DoFeatModifier(int32_t featId, FeatModifier featMod, int32_t param1,
                 break;
             }
             g_plugin->m_FeatSave[featId][param1] = param2;
+            SetCombatModifier(featId, SaveModifiers);
             LOG_INFO("%s: Setting %s Save modifier to %d.", featName, Constants::SavingThrow::ToString(param1), param2);
             break;
         }
@@ -855,6 +999,7 @@ bool Feat::DoFeatModifier(int32_t featId, FeatModifier featMod, int32_t param1,
                 break;
             }
             g_plugin->m_FeatSaveVsRace[featId][param1][param2] = param3;
+            SetCombatModifier(featId, SaveModifiers);
             LOG_INFO("%s: Setting %s Saves vs Race: %s modifier to %d.", featName,
                      Constants::SavingThrow::ToString(param1), Globals::Rules()->m_lstRaces[param2].GetNameText().CStr(),
                      param3);
@@ -869,6 +1014,7 @@ bool Feat::DoFeatModifier(int32_t featId, FeatModifier featMod, int32_t param1,
                 break;
             }
             g_plugin->m_FeatSaveVsType[featId][param1][param2] = param3;
+            SetCombatModifier(featId, SaveModifiers);
             LOG_INFO("%s: Setting %s Saves vs Type: %s modifier to %d.", featName,
                      Constants::SavingThrow::ToString(param1), Constants::SavingThrowType::ToString(param2),
                      param3);
@@ -883,6 +1029,7 @@ bool Feat::DoFeatModifier(int32_t featId, FeatModifier featMod, int32_t param1,
                 break;
             }
             g_plugin->m_FeatSaveVsTypeRace[featId][param1][param2][param3] = param4;
+            SetCombatModifier(featId, SaveModifiers);
             LOG_INFO("%s: Setting %s Saves vs Type: %s and Race: %s modifier to %d.", featName,
                      Constants::SavingThrow::ToString(param1),
                      Constants::SavingThrowType::ToString(param2),
@@ -1000,6 +1147,8 @@ ArgumentStack Feat::SetFeatModifier(ArgumentStack&& args)
     if (DoFeatModifier(featId, featMod, param1, param2, param3, param4) && !g_plugin->m_Feats.count(featId))
         g_plugin->m_Feats.insert(featId);
 
+    g_plugin->m_BonusLimitGeneration++;
+
     return ScriptAPI::Arguments();
 }
 
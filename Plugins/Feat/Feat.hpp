@@ -59,7 +59,17 @@ private:
         DAMAGE               = 30,
     };
 
+    // Which of the modifiers read by the combat hooks a feat has, indexed by feat id. Lets the hooks skip the
+    // feats without modifiers instead of hashing every feat of the creature.
+    enum CombatModifierFlags : uint8_t
+    {
+        AttackModifiers = 1 << 0,
+        SaveModifiers   = 1 << 1,
+    };
+
     set<uint16_t> m_Feats;
+    vector<uint8_t> m_FeatCombatModifiers;
+    uint32_t m_BonusLimitGeneration = 0;
     unordered_map<uint16_t, int32_t>                                                  m_FeatAB;
     unordered_map<uint16_t, unordered_map<uint8_t, int32_t>>                          m_FeatAbility;
     unordered_map<uint16_t, unordered_map<uint16_t, int32_t>>                         m_FeatABVsRace;
@@ -97,6 +107,11 @@ private:
     static void RemoveFeatEffects(CNWSCreatureStats*, uint16_t);
     static void AddRemoveBonusSpell(CNWSCreatureStats*, uint16_t, bool bAdd = true);
     static bool DoFeatModifier(int32_t, FeatModifier, int32_t, int32_t, int32_t, int32_t);
+    static bool HasCombatModifier(uint16_t, CombatModifierFlags);
+    static void SetCombatModifier(uint16_t, CombatModifierFlags);
+    static bool IsBonusLimitFeat(uint16_t);
+    static const vector<uint16_t>& GetBonusLimitFeats(CNWSCreature*);
+    static void InvalidateBonusLimitFeats(CNWSCreature*);
 
     static void AddFeatHook(CNWSCreatureStats*, uint16_t);
     static void RemoveFeatHook(CNWSCreatureStats*, uint16_t);
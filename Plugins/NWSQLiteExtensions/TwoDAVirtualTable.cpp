@@ -5,11 +5,22 @@
 #include "API/CTwoDimArrays.hpp"
 #include "API/CNWSModule.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <unordered_map>
+
 using namespace NWNXLib;
 using namespace NWNXLib::API;
 
 static bool s_2DAVirtualTableEnabled = false;
 static int Setup2DAVirtualTableModule(sqlite3 *db);
+// Bumped whenever a 2DA is (re)loaded, unloaded or destroyed, so column indexes built from it are rebuilt
+// and cursors look it up again. Entries are never erased, a new 2DA at a freed address gets a new generation.
+static std::unordered_map<C2DA*, uint32_t> s_2DAGenerations;
+
+extern "C" void _ZN4C2DAD1Ev(C2DA*);
 
 void TwoDAVirtualTable() __attribute__((constructor));
 void TwoDAVirtualTable()
@@ -31,6 +42,35 @@ void TwoDAVirtualTable()
                 }
             }
         }, Hooks::Order::Early);
+
+        static Hooks::Hook s_Load2DArrayHook = Hooks::HookFunction(&C2DA::Load2DArray,
+        +[](C2DA *pThis, BOOL bOptional) -> BOOL
+        {
+            s_2DAGenerations[pThis]++;
+            return s_Load2DArrayHook->CallOriginal<BOOL>(pThis, bOptional);
+        }, Hooks::Order::Earliest);
+
+        static Hooks::Hook s_Unload2DArrayHook = Hooks::HookFunction(&C2DA::Unload2DArray,
+        +[](C2DA *pThis) -> void
+        {
+            s_2DAGenerations[pThis]++;
+            s_Unload2DArrayHook->CallOriginal<void>(pThis);
+        }, Hooks::Order::Earliest);
+
+        static Hooks::Hook s_2DADtorHook = Hooks::HookFunction(&_ZN4C2DAD1Ev,
+        +[](C2DA *pThis) -> void
+        {
+            s_2DAGenerations[pThis]++;
+            s_2DADtorHook->CallOriginal<void>(pThis);
+        }, Hooks::Order::Earliest);
+
+        static Hooks::Hook s_ClearCached2DAsHook = Hooks::HookFunction(&CTwoDimArrays::ClearCached2DAs,
+        +[](CTwoDimArrays *pThis) -> void
+        {
+            for (auto& [p2DA, generation] : s_2DAGenerations)
+                generation++;
+            s_ClearCached2DAsHook->CallOriginal<void>(pThis);
+        }, Hooks::Order::Earliest);
     }
 }
 
@@ -68,6 +108,23 @@ NWNX_EXPORT ArgumentStack CreateVirtual2DATable(ArgumentStack&& args)
     return false;
 }
 
+// The rows of a column with a value, sorted by value. Strings compare like SQLite's BINARY collation,
+// integer and float columns are both kept as doubles, which hold their values exactly.
+struct V2DAColumnIndex
+{
+    std::vector<std::pair<std::string, uint32_t>> strings;
+    std::vector<std::pair<double, uint32_t>> numbers;
+    std::vector<uint32_t> rows;
+};
+
+// Column indexes are built on first use and dropped when the 2DA is reloaded.
+struct V2DAIndexes
+{
+    C2DA *p2DA = nullptr;
+    uint32_t generation = 0;
+    std::vector<std::shared_ptr<const V2DAColumnIndex>> columns;
+};
+
 typedef struct v2da_tab v2da_tab;
 struct v2da_tab
 {
@@ -75,15 +132,37 @@ struct v2da_tab
     char *twodaName;
     uint32_t numRows;
     uint8_t *columnTypes;
+    V2DAIndexes *pIndexes;
 };
 
+// A cursor walks either the rows [currentRow, endRow) or the positions [indexPos, indexEnd) of a column
+// index. The 2DA is looked up once per filter rather than for every cell, and again only if its generation
+// changed in between.
 typedef struct v2da_cursor v2da_cursor;
 struct v2da_cursor
 {
     sqlite3_vtab_cursor base;
     uint32_t currentRow;
+    uint32_t endRow;
+    C2DA *p2DA;
+    uint32_t generation;
+    std::shared_ptr<const V2DAColumnIndex> pIndex;
+    size_t indexPos;
+    size_t indexEnd;
 };
 
+// idxNum layout used between xBestIndex and xFilter: the low byte holds the bounds passed in argv, the
+// rest the constrained column + 1, 0 being the rowid.
+namespace V2DAIndexFlags
+{
+    constexpr int32_t Equal          = 0x01;
+    constexpr int32_t Lower          = 0x02;
+    constexpr int32_t LowerInclusive = 0x04;
+    constexpr int32_t Upper          = 0x08;
+    constexpr int32_t UpperInclusive = 0x10;
+    constexpr int32_t ColumnShift    = 8;
+}
+
 namespace V2DAColumnType
 {
     enum TYPE
@@ -186,6 +265,7 @@ static int v2daConnect(sqlite3 *db, void *pAux, int argc, const char* const *arg
         pNewVtab->twodaName = sqlite3_mprintf("%s", argv[3]);
         pNewVtab->numRows = p2DA->m_nNumRows;
         pNewVtab->columnTypes = columnTypes;
+        pNewVtab->pIndexes = new V2DAIndexes;
 
         sqlite3_vtab_config(db, SQLITE_VTAB_DIRECTONLY);
     }
@@ -204,15 +284,92 @@ static int v2daDisconnect(sqlite3_vtab *pVtab)
     auto *p2daVtab = (v2da_tab*)pVtab;
     sqlite3_free(p2daVtab->twodaName);
     sqlite3_free(p2daVtab->columnTypes);
+    delete p2daVtab->pIndexes;
     sqlite3_free(p2daVtab);
     return SQLITE_OK;
 }
 
+static std::shared_ptr<const V2DAColumnIndex> BuildColumnIndex(C2DA *p2DA, int32_t column, uint8_t columnType)
+{
+    auto pIndex = std::make_shared<V2DAColumnIndex>();
+    for (int32_t row = 0; row < p2DA->m_nNumRows; row++)
+    {
+        switch (columnType)
+        {
+            case V2DAColumnType::String:
+            {
+                CExoString sValue;
+                if (p2DA->GetCExoStringEntry(row, column, &sValue))
+                    pIndex->strings.emplace_back(sValue.CStr(), row);
+                break;
+            }
+            case V2DAColumnType::Integer:
+            {
+                int32_t nValue;
+                if (p2DA->GetINTEntry(row, column, &nValue))
+                    pIndex->numbers.emplace_back(nValue, row);
+                break;
+            }
+            case V2DAColumnType::Float:
+            {
+                float fValue;
+                if (p2DA->GetFLOATEntry(row, column, &fValue))
+                    pIndex->numbers.emplace_back(fValue, row);
+                break;
+            }
+        }
+    }
+
+    std::sort(pIndex->strings.begin(), pIndex->strings.end());
+    std::sort(pIndex->numbers.begin(), pIndex->numbers.end());
+    for (const auto& entry : pIndex->strings)
+        pIndex->rows.push_back(entry.second);
+    for (const auto& entry : pIndex->numbers)
+        pIndex->rows.push_back(entry.second);
+    return pIndex;
+}
+
+static std::shared_ptr<const V2DAColumnIndex> GetColumnIndex(v2da_tab *pVtab, C2DA *p2DA, int32_t column)
+{
+    auto& indexes = *pVtab->pIndexes;
+    const auto generation = s_2DAGenerations[p2DA];
+    if (indexes.p2DA != p2DA || indexes.generation != generation)
+    {
+        indexes.p2DA = p2DA;
+        indexes.generation = generation;
+        indexes.columns.clear();
+    }
+
+    indexes.columns.resize(p2DA->m_nNumColumns);
+    auto& pIndex = indexes.columns[column];
+    if (!pIndex)
+    {
+        LOG_DEBUG("Building index for column %i of 2DA '%s'", column, pVtab->twodaName);
+        pIndex = BuildColumnIndex(p2DA, column, pVtab->columnTypes[column]);
+    }
+    return pIndex;
+}
+
+// The positions in a sorted index between the bounds, either of which may be missing.
+template <typename T>
+static std::pair<size_t, size_t> FindRange(const std::vector<std::pair<T, uint32_t>>& entries,
+                                           const T *pLower, bool bLowerInclusive, const T *pUpper, bool bUpperInclusive)
+{
+    auto entryBefore = [](const std::pair<T, uint32_t>& entry, const T& value) { return entry.first < value; };
+    auto valueBefore = [](const T& value, const std::pair<T, uint32_t>& entry) { return value < entry.first; };
+
+    auto begin = entries.begin(), end = entries.end();
+    if (pLower)
+        begin = bLowerInclusive ? std::lower_bound(begin, end, *pLower, entryBefore) : std::upper_bound(begin, end, *pLower, valueBefore);
+    if (pUpper)
+        end = bUpperInclusive ? std::upper_bound(begin, end, *pUpper, valueBefore) : std::lower_bound(begin, end, *pUpper, entryBefore);
+    return { begin - entries.begin(), end - entries.begin() };
+}
+
 static int v2daOpen(sqlite3_vtab*, sqlite3_vtab_cursor **ppCursor)
 {
-    auto *pCursor = static_cast<v2da_cursor*>(sqlite3_malloc(sizeof(v2da_cursor)));
+    auto *pCursor = new (std::nothrow) v2da_cursor{};
     if(!pCursor) return SQLITE_NOMEM;
-    memset(pCursor, 0, sizeof(v2da_cursor));
     *ppCursor = &pCursor->base;
     return SQLITE_OK;
 }
@@ -220,14 +377,34 @@ static int v2daOpen(sqlite3_vtab*, sqlite3_vtab_cursor **ppCursor)
 static int v2daClose(sqlite3_vtab_cursor *cur)
 {
     auto *pCursor = (v2da_cursor*)cur;
-    sqlite3_free(pCursor);
+    delete pCursor;
     return SQLITE_OK;
 }
 
+static uint32_t CurrentRow(const v2da_cursor *pCursor)
+{
+    return pCursor->pIndex ? pCursor->pIndex->rows[pCursor->indexPos] : pCursor->currentRow;
+}
+
+// The 2DA cache is bounded, script code running between two steps can evict and free the cursor's 2DA.
+static C2DA *Cursor2DA(v2da_cursor *pCursor)
+{
+    if (pCursor->p2DA && s_2DAGenerations[pCursor->p2DA] != pCursor->generation)
+    {
+        auto *pVtab = (v2da_tab*)pCursor->base.pVtab;
+        pCursor->p2DA = Globals::Rules()->m_p2DArrays->GetCached2DA(pVtab->twodaName);
+        pCursor->generation = pCursor->p2DA ? s_2DAGenerations[pCursor->p2DA] : 0;
+    }
+    return pCursor->p2DA;
+}
+
 static int v2daNext(sqlite3_vtab_cursor *cur)
 {
     auto *pCursor = (v2da_cursor*)cur;
-    pCursor->currentRow++;
+    if (pCursor->pIndex)
+        pCursor->indexPos++;
+    else
+        pCursor->currentRow++;
     return SQLITE_OK;
 }
 
@@ -235,15 +412,17 @@ static int v2daColumn(sqlite3_vtab_cursor *cur, sqlite3_context *ctx, int i)
 {
     auto *pCursor = (v2da_cursor*)cur;
     auto *pVtab = (v2da_tab*)pCursor->base.pVtab;
+    const uint32_t currentRow = CurrentRow(pCursor);
 
-    if (auto *p2DA = Globals::Rules()->m_p2DArrays->GetCached2DA(pVtab->twodaName))
+    auto *p2DA = Cursor2DA(pCursor);
+    if (p2DA && i < p2DA->m_nNumColumns && currentRow < (uint32_t)p2DA->m_nNumRows)
     {
         switch (pVtab->columnTypes[i])
         {
             case V2DAColumnType::String:
             {
                 CExoString sValue;
-                if (p2DA->GetCExoStringEntry(pCursor->currentRow, i, &sValue))
+                if (p2DA->GetCExoStringEntry(currentRow, i, &sValue))
                 {
                     sqlite3_result_text(ctx, sValue.CStr(), -1, SQLITE_TRANSIENT);
                     return SQLITE_OK;
@@ -254,7 +433,7 @@ static int v2daColumn(sqlite3_vtab_cursor *cur, sqlite3_context *ctx, int i)
             case V2DAColumnType::Integer:
             {
                 int32_t nValue;
-                if (p2DA->GetINTEntry(pCursor->currentRow, i, &nValue))
+                if (p2DA->GetINTEntry(currentRow, i, &nValue))
                 {
                     sqlite3_result_int(ctx, nValue);
                     return SQLITE_OK;
@@ -265,7 +444,7 @@ static int v2daColumn(sqlite3_vtab_cursor *cur, sqlite3_context *ctx, int i)
             case V2DAColumnType::Float:
             {
                 float fValue;
-                if (p2DA->GetFLOATEntry(pCursor->currentRow, i, &fValue))
+                if (p2DA->GetFLOATEntry(currentRow, i, &fValue))
                 {
                     sqlite3_result_double(ctx, fValue);
                     return SQLITE_OK;
@@ -283,27 +462,244 @@ static int v2daColumn(sqlite3_vtab_cursor *cur, sqlite3_context *ctx, int i)
 static int v2daRowid(sqlite3_vtab_cursor *cur, sqlite_int64 *pRowid)
 {
     auto *pCursor = (v2da_cursor*)cur;
-    *pRowid = pCursor->currentRow;
+    *pRowid = CurrentRow(pCursor);
     return SQLITE_OK;
 }
 
 static int v2daEOF(sqlite3_vtab_cursor *cur)
 {
     auto *pCursor = (v2da_cursor*)cur;
-    auto *pVtab = (v2da_tab*)pCursor->base.pVtab;
-    return pCursor->currentRow >= pVtab->numRows;
+    if (pCursor->pIndex)
+        return pCursor->indexPos >= pCursor->indexEnd;
+    return pCursor->currentRow >= pCursor->endRow;
+}
+
+// Narrows [begin, end) to the rowids allowed by a bound. Bounds SQLite compares differently, like text,
+// are left to SQLite to check. Rowids fit in 32 bits, bounds are clamped well outside that range first so
+// the arithmetic below can't overflow.
+static void ApplyRowidBound(sqlite3_value *pValue, bool bLower, bool bInclusive, int64_t& begin, int64_t& end)
+{
+    constexpr int64_t RowidLimit = int64_t(1) << 33;
+    switch (sqlite3_value_type(pValue))
+    {
+        case SQLITE_NULL:
+            end = begin;
+            return;
+        case SQLITE_INTEGER:
+        {
+            const int64_t value = std::clamp<int64_t>(sqlite3_value_int64(pValue), -RowidLimit, RowidLimit);
+            if (bLower)
+                begin = std::max(begin, bInclusive ? value : value + 1);
+            else
+                end = std::min(end, bInclusive ? value + 1 : value);
+            return;
+        }
+        case SQLITE_FLOAT:
+        {
+            const double value = std::clamp<double>(sqlite3_value_double(pValue), -RowidLimit, RowidLimit);
+            if (std::isnan(value))
+            {
+                end = begin;
+                return;
+            }
+            if (bLower)
+                begin = std::max<double>(begin, bInclusive ? std::ceil(value) : std::floor(value) + 1);
+            else
+                end = std::min<double>(end, bInclusive ? std::floor(value) + 1 : std::ceil(value));
+            return;
+        }
+    }
 }
 
 static int v2daFilter(sqlite3_vtab_cursor *cur, int idxNum, const char *idxStr, int argc, sqlite3_value **argv)
 {
-    (void)idxNum; (void)idxStr; (void)argc; (void)argv;
+    (void)idxStr; (void)argc;
     auto *pCursor = (v2da_cursor*)cur;
+    auto *pVtab = (v2da_tab*)pCursor->base.pVtab;
+
+    pCursor->p2DA = Globals::Rules()->m_p2DArrays->GetCached2DA(pVtab->twodaName);
+    pCursor->generation = pCursor->p2DA ? s_2DAGenerations[pCursor->p2DA] : 0;
+    pCursor->pIndex.reset();
     pCursor->currentRow = 0;
+    pCursor->endRow = pCursor->p2DA ? pCursor->p2DA->m_nNumRows : 0;
+
+    const int32_t flags = idxNum & 0xFF;
+    const int32_t column = (idxNum >> V2DAIndexFlags::ColumnShift) - 1;
+    if (!pCursor->p2DA || !flags || column >= pCursor->p2DA->m_nNumColumns)
+        return SQLITE_OK;
+
+    int32_t arg = 0;
+    sqlite3_value *pLower = nullptr, *pUpper = nullptr;
+    bool bLowerInclusive = true, bUpperInclusive = true;
+    if (flags & V2DAIndexFlags::Equal)
+    {
+        pLower = pUpper = argv[arg++];
+    }
+    else
+    {
+        if (flags & V2DAIndexFlags::Lower)
+        {
+            pLower = argv[arg++];
+            bLowerInclusive = flags & V2DAIndexFlags::LowerInclusive;
+        }
+        if (flags & V2DAIndexFlags::Upper)
+        {
+            pUpper = argv[arg++];
+            bUpperInclusive = flags & V2DAIndexFlags::UpperInclusive;
+        }
+    }
+
+    if (column < 0)
+    {
+        int64_t begin = 0, end = pCursor->endRow;
+        if (pLower)
+            ApplyRowidBound(pLower, true, bLowerInclusive, begin, end);
+        if (pUpper)
+            ApplyRowidBound(pUpper, false, bUpperInclusive, begin, end);
+        pCursor->currentRow = std::clamp<int64_t>(begin, 0, pCursor->endRow);
+        pCursor->endRow = std::clamp<int64_t>(end, pCursor->currentRow, pCursor->endRow);
+        return SQLITE_OK;
+    }
+
+    // A NULL bound matches nothing, a bound of another type is left to SQLite and scans the whole table.
+    const bool bString = pVtab->columnTypes[column] == V2DAColumnType::String;
+    for (auto *pValue : { pLower, pUpper })
+    {
+        if (!pValue)
+            continue;
+        const auto type = sqlite3_value_type(pValue);
+        if (type == SQLITE_NULL)
+        {
+            pCursor->endRow = 0;
+            return SQLITE_OK;
+        }
+        if (bString ? type != SQLITE_TEXT : (type != SQLITE_INTEGER && type != SQLITE_FLOAT))
+            return SQLITE_OK;
+    }
+
+    auto pIndex = GetColumnIndex(pVtab, pCursor->p2DA, column);
+    std::pair<size_t, size_t> range;
+    if (bString)
+    {
+        std::string lower, upper;
+        if (pLower)
+            lower = (const char*)sqlite3_value_text(pLower);
+        if (pUpper)
+            upper = (const char*)sqlite3_value_text(pUpper);
+        range = FindRange(pIndex->strings, pLower ? &lower : nullptr, bLowerInclusive, pUpper ? &upper : nullptr, bUpperInclusive);
+    }
+    else
+    {
+        double lower = 0, upper = 0;
+        if (pLower)
+            lower = sqlite3_value_double(pLower);
+        if (pUpper)
+            upper = sqlite3_value_double(pUpper);
+        range = FindRange(pIndex->numbers, pLower ? &lower : nullptr, bLowerInclusive, pUpper ? &upper : nullptr, bUpperInclusive);
+    }
+
+    pCursor->pIndex = std::move(pIndex);
+    pCursor->indexPos = range.first;
+    pCursor->indexEnd = range.second;
     return SQLITE_OK;
 }
 
-static int v2daBestIndex(sqlite3_vtab*, sqlite3_index_info*)
+// Picks the cheapest of an equality lookup or a range on the rowid or a single column, preferring the
+// rowid. Constraints are not omitted, SQLite double checks every row, so a plan only has to return a
+// superset of the matching rows.
+static int v2daBestIndex(sqlite3_vtab *pVtab, sqlite3_index_info *pInfo)
 {
+    auto *p2daVtab = (v2da_tab*)pVtab;
+    const double numRows = std::max<uint32_t>(p2daVtab->numRows, 1);
+
+    struct Candidate
+    {
+        int32_t equal = -1;
+        int32_t lower = -1;
+        int32_t upper = -1;
+    };
+    std::map<int32_t, Candidate> candidates;
+    for (int32_t i = 0; i < pInfo->nConstraint; i++)
+    {
+        const auto& constraint = pInfo->aConstraint[i];
+        if (!constraint.usable)
+            continue;
+        if (constraint.iColumn >= 0 && p2daVtab->columnTypes[constraint.iColumn] == V2DAColumnType::String &&
+            sqlite3_stricmp(sqlite3_vtab_collation(pInfo, i), "BINARY") != 0)
+            continue;
+
+        auto& candidate = candidates[constraint.iColumn];
+        switch (constraint.op)
+        {
+            case SQLITE_INDEX_CONSTRAINT_EQ: if (candidate.equal < 0) candidate.equal = i; break;
+            case SQLITE_INDEX_CONSTRAINT_GT:
+            case SQLITE_INDEX_CONSTRAINT_GE: if (candidate.lower < 0) candidate.lower = i; break;
+            case SQLITE_INDEX_CONSTRAINT_LT:
+            case SQLITE_INDEX_CONSTRAINT_LE: if (candidate.upper < 0) candidate.upper = i; break;
+        }
+    }
+
+    int32_t bestColumn = -2, bestFlags = 0, bestEqual = -1, bestLower = -1, bestUpper = -1;
+    double bestCost = numRows;
+    for (auto [column, candidate] : candidates)
+    {
+        double cost;
+        int32_t flags = 0;
+        if (candidate.equal >= 0)
+        {
+            cost = column < 0 ? 1 : 10;
+            flags = V2DAIndexFlags::Equal;
+            candidate.lower = candidate.upper = -1;
+        }
+        else if (candidate.lower >= 0 || candidate.upper >= 0)
+        {
+            cost = numRows / (candidate.lower >= 0 && candidate.upper >= 0 ? 8 : 3) + (column < 0 ? 0 : 10);
+            if (candidate.lower >= 0)
+                flags |= V2DAIndexFlags::Lower | (pInfo->aConstraint[candidate.lower].op == SQLITE_INDEX_CONSTRAINT_GE ? V2DAIndexFlags::LowerInclusive : 0);
+            if (candidate.upper >= 0)
+                flags |= V2DAIndexFlags::Upper | (pInfo->aConstraint[candidate.upper].op == SQLITE_INDEX_CONSTRAINT_LE ? V2DAIndexFlags::UpperInclusive : 0);
+        }
+        else
+        {
+            continue;
+        }
+
+        if (cost < bestCost)
+        {
+            bestCost = cost;
+            bestColumn = column;
+            bestFlags = flags;
+            bestEqual = candidate.equal;
+            bestLower = candidate.lower;
+            bestUpper = candidate.upper;
+        }
+    }
+
+    int32_t argvIndex = 1;
+    for (int32_t constraint : { bestEqual, bestLower, bestUpper })
+    {
+        if (constraint >= 0)
+            pInfo->aConstraintUsage[constraint].argvIndex = argvIndex++;
+    }
+
+    pInfo->estimatedCost = bestCost;
+    if (bestColumn >= -1)
+    {
+        pInfo->idxNum = ((bestColumn + 1) << V2DAIndexFlags::ColumnShift) | bestFlags;
+        pInfo->estimatedRows = bestEqual >= 0 ? (bestColumn < 0 ? 1 : 4) : (sqlite3_int64)bestCost;
+        if (bestColumn == -1 && bestEqual >= 0)
+            pInfo->idxFlags |= SQLITE_INDEX_SCAN_UNIQUE;
+    }
+    else
+    {
+        pInfo->idxNum = 0;
+        pInfo->estimatedRows = (sqlite3_int64)numRows;
+    }
+
+    // Full scans and rowid lookups return the rows in rowid order.
+    if (pInfo->nOrderBy == 1 && !pInfo->aOrderBy[0].desc && pInfo->aOrderBy[0].iColumn == -1 && bestColumn < 0)
+        pInfo->orderByConsumed = 1;
+
     return SQLITE_OK;
 }
 
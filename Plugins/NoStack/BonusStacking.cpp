@@ -7,6 +7,7 @@
 #include "API/CNWSCombatRound.hpp"
 #include "API/CNWSCreature.hpp"
 #include "API/CNWSCreatureStats.hpp"
+#include "API/CNWSEffectListHandler.hpp"
 #include "API/CNWSItem.hpp"
 #include "API/CNWSObject.hpp"
 #include "API/CNWSpellArray.hpp"
@@ -16,6 +17,7 @@
 
 #include <algorithm>
 #include <numeric>
+#include <unordered_map>
 
 namespace NostackMode
 {
@@ -61,6 +63,7 @@ static int32_t s_nSpellDefaultType = NostackType::Circumstance;
 static int32_t s_nItemDefaultType = NostackType::Enhancement;
 
 static Hooks::Hook s_GetTotalEffectBonusHook = nullptr;
+static Hooks::Hook s_DestroyCreatureHook = nullptr;
 
 struct EffectData
 {
@@ -70,6 +73,48 @@ struct EffectData
     uint32_t subType = 0;
 };
 
+// Everything that decides which effects count towards a bonus. Fields that don't
+// matter for a given bonus type are left zeroed so they share a cache entry.
+struct BonusContext
+{
+    uint8_t bonusType = 0;
+    uint8_t attackType = 0;
+    uint8_t saveType = 0;
+    uint8_t specificType = 0;
+    uint8_t skill = 0;
+    uint8_t abilityScore = 0;
+    uint16_t race = static_cast<uint16_t>(~0u);
+    uint8_t alignLaw = static_cast<uint8_t>(~0u);
+    uint8_t alignGood = static_cast<uint8_t>(~0u);
+
+    bool operator==(const BonusContext& other) const
+    {
+        return bonusType == other.bonusType && attackType == other.attackType && saveType == other.saveType
+            && specificType == other.specificType && skill == other.skill && abilityScore == other.abilityScore
+            && race == other.race && alignLaw == other.alignLaw && alignGood == other.alignGood;
+    }
+};
+
+// Stacked totals before any bonus limits are applied. The limits are applied on every
+// query since the Race and Feat plugins raise them per call.
+struct BonusTotals
+{
+    uint32_t bonus = 0;
+    uint32_t penalty = 0;
+    uint32_t supernaturalInnateBonus = 0;
+    uint32_t supernaturalInnatePenalty = 0;
+};
+
+// Per creature cache of aggregated totals. Cleared whenever a bonus effect is applied to
+// or removed from the creature, or when the stacking configuration changes.
+struct BonusCache
+{
+    std::vector<std::pair<BonusContext, BonusTotals>> entries;
+};
+
+constexpr size_t MAX_CACHED_CONTEXTS = 32;
+static std::unordered_map<ObjectID, BonusCache> s_bonusCache;
+
 constexpr auto MAX_DAMAGE_FLAGS = 13;
 
 static std::vector<EffectData> s_positiveEffects;
@@ -78,6 +123,9 @@ static int32_t s_nMaxValues[NostackType::Max + 1];
 
 void CNWSCreatureStats__UpdateCombatInformation(CNWSCreatureStats*);
 int32_t CNWSCreature__GetTotalEffectBonus(CNWSCreature*, uint8_t, CNWSObject*, BOOL, BOOL, uint8_t, uint8_t, uint8_t, uint8_t, BOOL);
+static void InvalidateBonusCache(CNWSObject*);
+static void HookBonusEffectHandlers();
+extern "C" void _ZN12CNWSCreatureD1Ev(CNWSCreature*);
 
 
 void BonusStacking() __attribute__((constructor));
@@ -100,6 +148,13 @@ void BonusStacking()
         s_bIgnoreSupernaturalInnate = Config::Get<bool>("IGNORE_SUPERNATURAL_INNATE", false);
 
         s_GetTotalEffectBonusHook = Hooks::HookFunction(&CNWSCreature::GetTotalEffectBonus, &CNWSCreature__GetTotalEffectBonus, Hooks::Order::Final);
+        s_DestroyCreatureHook = Hooks::HookFunction(&_ZN12CNWSCreatureD1Ev,
+            +[](CNWSCreature* pThis)
+            {
+                s_bonusCache.erase(pThis->m_idSelf);
+                s_DestroyCreatureHook->CallOriginal<void>(pThis);
+            }, Hooks::Order::Early);
+        HookBonusEffectHandlers();
 
         s_positiveEffects.reserve(50);
         s_negativeEffects.reserve(50);
@@ -151,55 +206,21 @@ void AddEffect(EffectData&& effectData, bool negative)
     }
 }
 
-int32_t CNWSCreature__GetTotalEffectBonus(CNWSCreature* thisPtr, uint8_t nEffectBonusType, CNWSObject* pObject, BOOL bElementalDamage,
-    BOOL bForceMax, uint8_t nSaveType, uint8_t nSpecificType, uint8_t nSkill, uint8_t nAbilityScore, BOOL bOffHand)
+static BonusTotals AggregateBonusEffects(CNWSCreature* thisPtr, const BonusContext& ctx)
 {
-    if (nEffectBonusType == Constants::EffectBonusType::Damage
-        || ((nEffectBonusType == Constants::EffectBonusType::Attack || nEffectBonusType == Constants::EffectBonusType::TouchAttack) && !s_nAttackBonusStackingMode)
-        || (nEffectBonusType == Constants::EffectBonusType::SavingThrow && !s_nSavingThrowStackingMode)
-        || (nEffectBonusType == Constants::EffectBonusType::Ability && !s_nAbilityStackingMode)
-        || (nEffectBonusType == Constants::EffectBonusType::Skill && !s_nSkillStackingMode)
-        )
-    {
-        return s_GetTotalEffectBonusHook->CallOriginal<int32_t>(thisPtr, nEffectBonusType, pObject,
-            bElementalDamage, bForceMax, nSaveType, nSpecificType, nSkill, nAbilityScore, bOffHand);
-    }
-
-    auto* pCurrentAttack = thisPtr->m_pcCombatRound->GetAttack(thisPtr->m_pcCombatRound->m_nCurrentAttack);
-    auto nAttackType = pCurrentAttack->m_nWeaponAttackType;
-    if (!nAttackType)
-    {
-        nAttackType = bOffHand ? 2 : 1;
-    }
-
-    uint16_t nRace = static_cast<uint16_t>(~0u);
-    uint8_t nAlignLaw = static_cast<uint8_t>(~0u), nAlignGood = static_cast<uint8_t>(~0u);
-    uint32_t nEffectBonus = 0, nEffectPenalty = 0, nSupernaturalInnateBonus = 0, nSupernaturalInnatePenalty = 0;
-
-    if (pObject)
-    {
-        auto* pCreature = Utils::AsNWSCreature(pObject);
-        if (!pCreature)
-            if (auto* pAoE = Utils::AsNWSAreaOfEffectObject(pObject))
-                pCreature = Globals::AppManager()->m_pServerExoApp->GetCreatureByGameObjectID(pAoE->m_oidCreator);
-
-        if (pCreature && pCreature->m_pStats)
-        {
-            nRace = pCreature->m_pStats->m_nRace;
-            nAlignLaw = pCreature->m_pStats->GetSimpleAlignmentLawChaos();
-            nAlignGood = pCreature->m_pStats->GetSimpleAlignmentGoodEvil();
-        }
-    }
+    BonusTotals totals;
+    int stackingMode = NostackMode::Disabled;
 
     s_positiveEffects.resize(0);
     s_negativeEffects.resize(0);
 
-    switch (nEffectBonusType)
+    switch (ctx.bonusType)
     {
         default:
-            return 0;
+            return totals;
         case Constants::EffectBonusType::Attack:
         case Constants::EffectBonusType::TouchAttack:
+            stackingMode = s_nAttackBonusStackingMode;
             for (auto i = thisPtr->m_pStats->m_nAttackBonusPtr; i < thisPtr->m_appliedEffects.num; i++)
             {
                 auto nType = thisPtr->m_appliedEffects.element[i]->m_nType;
@@ -208,22 +229,22 @@ int32_t CNWSCreature__GetTotalEffectBonus(CNWSCreature* thisPtr, uint8_t nEffect
 
                 auto pEffect = thisPtr->m_appliedEffects.element[i];
                 auto nEffectWeaponType = pEffect->GetInteger(1);
-                bool bValidWeapon = nEffectWeaponType == 0 || nEffectWeaponType == nAttackType;
-                if (nAttackType == Constants::WeaponAttackType::AdditionalWeapon)
+                bool bValidWeapon = nEffectWeaponType == 0 || nEffectWeaponType == ctx.attackType;
+                if (ctx.attackType == Constants::WeaponAttackType::AdditionalWeapon)
                     bValidWeapon |= nEffectWeaponType == Constants::WeaponAttackType::MainhandWeapon
                                  || nEffectWeaponType == Constants::WeaponAttackType::CreatureLeftWeapon;
-                else if (nAttackType == Constants::WeaponAttackType::AdditionalUnarmed)
+                else if (ctx.attackType == Constants::WeaponAttackType::AdditionalUnarmed)
                     bValidWeapon |= nEffectWeaponType == Constants::WeaponAttackType::Unarmed;
 
                 if (bValidWeapon
-                    && CheckRaceAlignment(nRace, pEffect->GetInteger(2),
-                                          nAlignLaw, pEffect->GetInteger(3),
-                                          nAlignGood, pEffect->GetInteger(4))
+                    && CheckRaceAlignment(ctx.race, pEffect->GetInteger(2),
+                                          ctx.alignLaw, pEffect->GetInteger(3),
+                                          ctx.alignGood, pEffect->GetInteger(4))
                     )
                 {
                     int32_t nEffectStrength = pEffect->GetInteger(0);
 
-                    if (nEffectWeaponType == 0 || nEffectBonusType != Constants::EffectBonusType::TouchAttack)
+                    if (nEffectWeaponType == 0 || ctx.bonusType != Constants::EffectBonusType::TouchAttack)
                     {
                         if (pEffect->m_nType == Constants::EffectTrueType::AttackIncrease)
                             AddEffect(EffectData{ pEffect->m_oidCreator, pEffect->m_nSpellId, nEffectStrength, pEffect->m_nSubType }, false);
@@ -232,28 +253,10 @@ int32_t CNWSCreature__GetTotalEffectBonus(CNWSCreature* thisPtr, uint8_t nEffect
                     }
                 }
             }
-
-            {
-                nEffectBonus = GetUnstackedBonus(false, s_nAttackBonusStackingMode);
-                nEffectPenalty = GetUnstackedBonus(true, s_bAlwaysStackPenalties ? NostackMode::Disabled : s_nAttackBonusStackingMode);
-
-                if (s_bIgnoreSupernaturalInnate)
-                {
-                    nSupernaturalInnateBonus = GetUnstackedBonus(false, 0, true);
-                    nSupernaturalInnatePenalty = GetUnstackedBonus(true, 0, true);
-                }
-
-                uint32_t nAttackBonusLimit = Globals::AppManager()->m_pServerExoApp->GetAttackBonusLimit() + nSupernaturalInnateBonus - nSupernaturalInnatePenalty;
-                nEffectBonus = std::min(nEffectBonus, nAttackBonusLimit);
-                nEffectPenalty = std::min(nEffectPenalty, nAttackBonusLimit);
-            }
-            return nEffectBonus - nEffectPenalty + nSupernaturalInnateBonus - nSupernaturalInnatePenalty;
-
-        case Constants::EffectBonusType::Damage:
-            //TODO: Damage bonuses can be added if needed by someone
-            return 0;
+            break;
 
         case Constants::EffectBonusType::SavingThrow:
+            stackingMode = s_nSavingThrowStackingMode;
             for (int i = thisPtr->m_pStats->m_nSavingThrowBonusPtr; i < thisPtr->m_appliedEffects.num; i++)
             {
                 auto nType = thisPtr->m_appliedEffects.element[i]->m_nType;
@@ -264,11 +267,11 @@ int32_t CNWSCreature__GetTotalEffectBonus(CNWSCreature* thisPtr, uint8_t nEffect
                 auto nEffectSaveType = pEffect->GetInteger(1);
                 auto nEffectSpecificType = pEffect->GetInteger(2);
 
-                if ((nEffectSaveType == 0 || nEffectSaveType == nSaveType)
-                    && (nEffectSpecificType == 0 || nEffectSpecificType == nSpecificType)
-                    && CheckRaceAlignment(nRace, pEffect->GetInteger(3),
-                                          nAlignLaw, pEffect->GetInteger(4),
-                                          nAlignGood, pEffect->GetInteger(5))
+                if ((nEffectSaveType == 0 || nEffectSaveType == ctx.saveType)
+                    && (nEffectSpecificType == 0 || nEffectSpecificType == ctx.specificType)
+                    && CheckRaceAlignment(ctx.race, pEffect->GetInteger(3),
+                                          ctx.alignLaw, pEffect->GetInteger(4),
+                                          ctx.alignGood, pEffect->GetInteger(5))
                     )
                 {
                     int32_t nEffectStrength = pEffect->GetInteger(0);
@@ -283,32 +286,10 @@ int32_t CNWSCreature__GetTotalEffectBonus(CNWSCreature* thisPtr, uint8_t nEffect
                     }
                 }
             }
-
-            nEffectBonus = GetUnstackedBonus(false, s_nSavingThrowStackingMode);
-            nEffectPenalty = GetUnstackedBonus(true, s_bAlwaysStackPenalties ? NostackMode::Disabled : s_nSavingThrowStackingMode);
-
-            if (s_bIgnoreSupernaturalInnate)
-            {
-                nSupernaturalInnateBonus = GetUnstackedBonus(false, 0, true);
-                nSupernaturalInnatePenalty = GetUnstackedBonus(true, 0, true);
-            }
-
-            {
-                uint32_t nSavingThrowBonusLimit = Globals::AppManager()->m_pServerExoApp->GetSavingThrowBonusLimit() + nSupernaturalInnateBonus - nSupernaturalInnatePenalty;
-                nEffectBonus = std::min(nEffectBonus, nSavingThrowBonusLimit);
-                nEffectPenalty = std::min(nEffectPenalty, nSavingThrowBonusLimit);
-            }
-
-            if (thisPtr->m_pStats->HasFeat(Constants::Feat::SacredDefense1))
-            {
-                int nChampionLevel = thisPtr->m_pStats->GetNumLevelsOfClass(Constants::ClassType::DivineChampion);
-                if (nChampionLevel > 1)
-                    nEffectBonus += nChampionLevel / 2;
-            }
-
-            return nEffectBonus - nEffectPenalty + nSupernaturalInnateBonus - nSupernaturalInnatePenalty;
+            break;
 
         case Constants::EffectBonusType::Ability:
+            stackingMode = s_nAbilityStackingMode;
             for (int i = thisPtr->m_pStats->m_nAbilityPtr; i < thisPtr->m_appliedEffects.num; i++)
             {
                 auto nType = thisPtr->m_appliedEffects.element[i]->m_nType;
@@ -318,7 +299,7 @@ int32_t CNWSCreature__GetTotalEffectBonus(CNWSCreature* thisPtr, uint8_t nEffect
                 auto pEffect = thisPtr->m_appliedEffects.element[i];
                 uint8_t nEffectAbility = pEffect->GetInteger(0);
 
-                if (nEffectAbility != nAbilityScore)
+                if (nEffectAbility != ctx.abilityScore)
                     continue;
 
                 int32_t nEffectStrength = pEffect->GetInteger(1);
@@ -332,25 +313,10 @@ int32_t CNWSCreature__GetTotalEffectBonus(CNWSCreature* thisPtr, uint8_t nEffect
                     AddEffect(EffectData{ pEffect->m_oidCreator, pEffect->m_nSpellId, nEffectStrength, pEffect->m_nSubType }, true);
                 }
             }
-
-            nEffectBonus = GetUnstackedBonus(false, s_nAbilityStackingMode);
-            nEffectPenalty = GetUnstackedBonus(true, s_bAlwaysStackPenalties ? NostackMode::Disabled : s_nAbilityStackingMode);
-
-            if (s_bIgnoreSupernaturalInnate)
-            {
-                nSupernaturalInnateBonus = GetUnstackedBonus(false, 0, true);
-                nSupernaturalInnatePenalty = GetUnstackedBonus(true, 0, true);
-            }
-
-            {
-                uint32_t nAbilityBonusLimit = Globals::AppManager()->m_pServerExoApp->GetAbilityBonusLimit() + nSupernaturalInnateBonus - nSupernaturalInnatePenalty;
-                uint32_t nAbilityPenaltyLimit = Globals::AppManager()->m_pServerExoApp->GetAbilityPenaltyLimit() + nSupernaturalInnateBonus - nSupernaturalInnatePenalty;
-                nEffectBonus = std::min(nEffectBonus, nAbilityBonusLimit);
-                nEffectPenalty = std::min(nEffectPenalty, nAbilityPenaltyLimit);
-            }
-            return nEffectBonus - nEffectPenalty + nSupernaturalInnateBonus- nSupernaturalInnatePenalty;
+            break;
 
         case Constants::EffectBonusType::Skill:
+            stackingMode = s_nSkillStackingMode;
             for (int i = thisPtr->m_pStats->m_nSkillBonusPtr; i < thisPtr->m_appliedEffects.num; i++)
             {
                 auto nType = thisPtr->m_appliedEffects.element[i]->m_nType;
@@ -360,10 +326,10 @@ int32_t CNWSCreature__GetTotalEffectBonus(CNWSCreature* thisPtr, uint8_t nEffect
                 auto pEffect = thisPtr->m_appliedEffects.element[i];
                 uint8_t nEffectSkill = pEffect->GetInteger(0);
 
-                if ((nEffectSkill == nSkill || nEffectSkill == static_cast<uint8_t>(~0u))
-                    && CheckRaceAlignment(nRace, pEffect->GetInteger(2),
-                                          nAlignLaw, pEffect->GetInteger(3),
-                                          nAlignGood, pEffect->GetInteger(4))
+                if ((nEffectSkill == ctx.skill || nEffectSkill == static_cast<uint8_t>(~0u))
+                    && CheckRaceAlignment(ctx.race, pEffect->GetInteger(2),
+                                          ctx.alignLaw, pEffect->GetInteger(3),
+                                          ctx.alignGood, pEffect->GetInteger(4))
                     )
                 {
                     auto nEffectStrength = pEffect->GetInteger(1);
@@ -378,23 +344,186 @@ int32_t CNWSCreature__GetTotalEffectBonus(CNWSCreature* thisPtr, uint8_t nEffect
                     }
                 }
             }
+            break;
+    }
 
-            nEffectBonus =  GetUnstackedBonus(false, s_nSkillStackingMode);
-            nEffectPenalty = GetUnstackedBonus(true, s_bAlwaysStackPenalties ? NostackMode::Disabled : s_nSkillStackingMode);
+    totals.bonus = GetUnstackedBonus(false, stackingMode);
+    totals.penalty = GetUnstackedBonus(true, s_bAlwaysStackPenalties ? NostackMode::Disabled : stackingMode);
 
-            if (s_bIgnoreSupernaturalInnate)
+    if (s_bIgnoreSupernaturalInnate)
+    {
+        totals.supernaturalInnateBonus = GetUnstackedBonus(false, 0, true);
+        totals.supernaturalInnatePenalty = GetUnstackedBonus(true, 0, true);
+    }
+
+    return totals;
+}
+
+static const BonusTotals& GetBonusTotals(CNWSCreature* thisPtr, const BonusContext& ctx)
+{
+    auto& cache = s_bonusCache[thisPtr->m_idSelf];
+    for (const auto& entry : cache.entries)
+    {
+        if (entry.first == ctx)
+            return entry.second;
+    }
+
+    if (cache.entries.size() >= MAX_CACHED_CONTEXTS)
+        cache.entries.clear();
+
+    cache.entries.emplace_back(ctx, AggregateBonusEffects(thisPtr, ctx));
+    return cache.entries.back().second;
+}
+
+static void InvalidateBonusCache(CNWSObject* pObject)
+{
+    if (!pObject)
+        return;
+
+    auto it = s_bonusCache.find(pObject->m_idSelf);
+    if (it != s_bonusCache.end())
+        it->second.entries.clear();
+}
+
+static void HookBonusEffectHandlers()
+{
+#define HOOK_APPLY_EFFECT(_address) \
+    static Hooks::Hook CAT(pOnApplyHook, __LINE__) = Hooks::HookFunction(_address, \
+    +[](CNWSEffectListHandler *thisPtr, CNWSObject *pObject, CGameEffect *pEffect, BOOL bLoadingGame) -> int32_t \
+    { \
+        auto retVal = CAT(pOnApplyHook, __LINE__)->CallOriginal<int32_t>(thisPtr, pObject, pEffect, bLoadingGame); \
+        InvalidateBonusCache(pObject); \
+        return retVal; \
+    }, Hooks::Order::Early)
+
+#define HOOK_REMOVE_EFFECT(_address) \
+    static Hooks::Hook CAT(pOnRemoveHook, __LINE__) = Hooks::HookFunction(_address, \
+    +[](CNWSEffectListHandler *thisPtr, CNWSObject *pObject, CGameEffect *pEffect) -> int32_t \
+    { \
+        auto retVal = CAT(pOnRemoveHook, __LINE__)->CallOriginal<int32_t>(thisPtr, pObject, pEffect); \
+        InvalidateBonusCache(pObject); \
+        return retVal; \
+    }, Hooks::Order::Early)
+
+    HOOK_APPLY_EFFECT(&CNWSEffectListHandler::OnApplyAttackIncrease);
+    HOOK_APPLY_EFFECT(&CNWSEffectListHandler::OnApplyAttackDecrease);
+    HOOK_APPLY_EFFECT(&CNWSEffectListHandler::OnApplySavingThrowIncrease);
+    HOOK_APPLY_EFFECT(&CNWSEffectListHandler::OnApplySavingThrowDecrease);
+    HOOK_APPLY_EFFECT(&CNWSEffectListHandler::OnApplyAbilityIncrease);
+    HOOK_APPLY_EFFECT(&CNWSEffectListHandler::OnApplyAbilityDecrease);
+    HOOK_APPLY_EFFECT(&CNWSEffectListHandler::OnApplySkillIncrease);
+    HOOK_APPLY_EFFECT(&CNWSEffectListHandler::OnApplySkillDecrease);
+
+    HOOK_REMOVE_EFFECT(&CNWSEffectListHandler::OnRemoveAttackIncrease);
+    HOOK_REMOVE_EFFECT(&CNWSEffectListHandler::OnRemoveAttackDecrease);
+    HOOK_REMOVE_EFFECT(&CNWSEffectListHandler::OnRemoveSavingThrowIncrease);
+    HOOK_REMOVE_EFFECT(&CNWSEffectListHandler::OnRemoveSavingThrowDecrease);
+    HOOK_REMOVE_EFFECT(&CNWSEffectListHandler::OnRemoveAbilityIncrease);
+    HOOK_REMOVE_EFFECT(&CNWSEffectListHandler::OnRemoveAbilityDecrease);
+    HOOK_REMOVE_EFFECT(&CNWSEffectListHandler::OnRemoveSkillIncrease);
+    HOOK_REMOVE_EFFECT(&CNWSEffectListHandler::OnRemoveSkillDecrease);
+
+#undef HOOK_REMOVE_EFFECT
+#undef HOOK_APPLY_EFFECT
+}
+
+int32_t CNWSCreature__GetTotalEffectBonus(CNWSCreature* thisPtr, uint8_t nEffectBonusType, CNWSObject* pObject, BOOL bElementalDamage,
+    BOOL bForceMax, uint8_t nSaveType, uint8_t nSpecificType, uint8_t nSkill, uint8_t nAbilityScore, BOOL bOffHand)
+{
+    if (nEffectBonusType == Constants::EffectBonusType::Damage
+        || ((nEffectBonusType == Constants::EffectBonusType::Attack || nEffectBonusType == Constants::EffectBonusType::TouchAttack) && !s_nAttackBonusStackingMode)
+        || (nEffectBonusType == Constants::EffectBonusType::SavingThrow && !s_nSavingThrowStackingMode)
+        || (nEffectBonusType == Constants::EffectBonusType::Ability && !s_nAbilityStackingMode)
+        || (nEffectBonusType == Constants::EffectBonusType::Skill && !s_nSkillStackingMode)
+        )
+    {
+        return s_GetTotalEffectBonusHook->CallOriginal<int32_t>(thisPtr, nEffectBonusType, pObject,
+            bElementalDamage, bForceMax, nSaveType, nSpecificType, nSkill, nAbilityScore, bOffHand);
+    }
+
+    BonusContext ctx;
+    ctx.bonusType = nEffectBonusType;
+
+    // Ability bonuses don't care about who they're versus, skip resolving the target
+    if (pObject && nEffectBonusType != Constants::EffectBonusType::Ability)
+    {
+        auto* pCreature = Utils::AsNWSCreature(pObject);
+        if (!pCreature)
+            if (auto* pAoE = Utils::AsNWSAreaOfEffectObject(pObject))
+                pCreature = Globals::AppManager()->m_pServerExoApp->GetCreatureByGameObjectID(pAoE->m_oidCreator);
+
+        if (pCreature && pCreature->m_pStats)
+        {
+            ctx.race = pCreature->m_pStats->m_nRace;
+            ctx.alignLaw = pCreature->m_pStats->GetSimpleAlignmentLawChaos();
+            ctx.alignGood = pCreature->m_pStats->GetSimpleAlignmentGoodEvil();
+        }
+    }
+
+    auto* pServerExoApp = Globals::AppManager()->m_pServerExoApp;
+    switch (nEffectBonusType)
+    {
+        default:
+            return 0;
+        case Constants::EffectBonusType::Attack:
+        case Constants::EffectBonusType::TouchAttack:
+        {
+            auto* pCurrentAttack = thisPtr->m_pcCombatRound->GetAttack(thisPtr->m_pcCombatRound->m_nCurrentAttack);
+            ctx.attackType = pCurrentAttack->m_nWeaponAttackType;
+            if (!ctx.attackType)
             {
-                nSupernaturalInnateBonus = GetUnstackedBonus(false, 0, true);
-                nSupernaturalInnatePenalty = GetUnstackedBonus(true, 0, true);
+                ctx.attackType = bOffHand ? 2 : 1;
             }
 
+            auto totals = GetBonusTotals(thisPtr, ctx);
+            uint32_t nAttackBonusLimit = pServerExoApp->GetAttackBonusLimit() + totals.supernaturalInnateBonus - totals.supernaturalInnatePenalty;
+            uint32_t nEffectBonus = std::min(totals.bonus, nAttackBonusLimit);
+            uint32_t nEffectPenalty = std::min(totals.penalty, nAttackBonusLimit);
+
+            return nEffectBonus - nEffectPenalty + totals.supernaturalInnateBonus - totals.supernaturalInnatePenalty;
+        }
+        case Constants::EffectBonusType::SavingThrow:
+        {
+            ctx.saveType = nSaveType;
+            ctx.specificType = nSpecificType;
+
+            auto totals = GetBonusTotals(thisPtr, ctx);
+            uint32_t nSavingThrowBonusLimit = pServerExoApp->GetSavingThrowBonusLimit() + totals.supernaturalInnateBonus - totals.supernaturalInnatePenalty;
+            uint32_t nEffectBonus = std::min(totals.bonus, nSavingThrowBonusLimit);
+            uint32_t nEffectPenalty = std::min(totals.penalty, nSavingThrowBonusLimit);
+
+            if (thisPtr->m_pStats->HasFeat(Constants::Feat::SacredDefense1))
             {
-                uint32_t nSkillBonusLimit = Globals::AppManager()->m_pServerExoApp->GetSkillBonusLimit() + nSupernaturalInnateBonus - nSupernaturalInnatePenalty;
-                nEffectBonus = std::min(nEffectBonus, nSkillBonusLimit);
-                nEffectPenalty = std::min(nEffectPenalty, nSkillBonusLimit);
+                int nChampionLevel = thisPtr->m_pStats->GetNumLevelsOfClass(Constants::ClassType::DivineChampion);
+                if (nChampionLevel > 1)
+                    nEffectBonus += nChampionLevel / 2;
             }
 
-            return nEffectBonus - nEffectPenalty + nSupernaturalInnateBonus - nSupernaturalInnatePenalty;
+            return nEffectBonus - nEffectPenalty + totals.supernaturalInnateBonus - totals.supernaturalInnatePenalty;
+        }
+        case Constants::EffectBonusType::Ability:
+        {
+            ctx.abilityScore = nAbilityScore;
+
+            auto totals = GetBonusTotals(thisPtr, ctx);
+            uint32_t nAbilityBonusLimit = pServerExoApp->GetAbilityBonusLimit() + totals.supernaturalInnateBonus - totals.supernaturalInnatePenalty;
+            uint32_t nAbilityPenaltyLimit = pServerExoApp->GetAbilityPenaltyLimit() + totals.supernaturalInnateBonus - totals.supernaturalInnatePenalty;
+            uint32_t nEffectBonus = std::min(totals.bonus, nAbilityBonusLimit);
+            uint32_t nEffectPenalty = std::min(totals.penalty, nAbilityPenaltyLimit);
+
+            return nEffectBonus - nEffectPenalty + totals.supernaturalInnateBonus - totals.supernaturalInnatePenalty;
+        }
+        case Constants::EffectBonusType::Skill:
+        {
+            ctx.skill = nSkill;
+
+            auto totals = GetBonusTotals(thisPtr, ctx);
+            uint32_t nSkillBonusLimit = pServerExoApp->GetSkillBonusLimit() + totals.supernaturalInnateBonus - totals.supernaturalInnatePenalty;
+            uint32_t nEffectBonus = std::min(totals.bonus, nSkillBonusLimit);
+            uint32_t nEffectPenalty = std::min(totals.penalty, nSkillBonusLimit);
+
+            return nEffectBonus - nEffectPenalty + totals.supernaturalInnateBonus - totals.supernaturalInnatePenalty;
+        }
     }
 
     return 0;
@@ -505,6 +634,7 @@ NWNX_EXPORT ArgumentStack SetSpellBonusType(ArgumentStack&& args)
       ASSERT_OR_THROW(nBonusType <= NostackType::Max);
 
     s_nSpellBonusTypes[nSpellId] = nBonusType;
+    s_bonusCache.clear();
 
     return {};
 }
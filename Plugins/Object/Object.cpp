@@ -77,6 +77,185 @@ NWNX_EXPORT ArgumentStack GetLocalVariable(ArgumentStack&& args)
     return {type, key};
 }
 
+// A variable can hold a value of every type under the same name, enumeration returns one entry per type.
+static const int32_t s_LocalVariableTypes[] = { 1, 2, 3, 4, 5, 6 };
+
+static bool HasLocalVariableType(const CNWSScriptVar& var, int32_t type)
+{
+    switch (type)
+    {
+        case 1: return var.HasInt();
+        case 2: return var.HasFloat();
+        case 3: return var.HasString();
+        case 4: return var.HasObject();
+        case 5: return var.HasLocation();
+        case 6: return var.HasJson();
+    }
+    return false;
+}
+
+template <typename F>
+static void ForEachLocalVariable(CNWSScriptVarTable *pVarTable, int32_t typeFilter, const std::string& prefix, F&& fn)
+{
+    for (auto& [name, var] : pVarTable->m_vars)
+    {
+        if (!prefix.empty() && std::strncmp(name.CStr(), prefix.c_str(), prefix.size()) != 0)
+            continue;
+
+        for (auto type : s_LocalVariableTypes)
+        {
+            if ((typeFilter < 0 || typeFilter == type) && HasLocalVariableType(var, type))
+                fn(name, var, type);
+        }
+    }
+}
+
+// A snapshot of the variables an enumeration started with, so changing them while iterating is safe.
+struct LocalVariableCursor
+{
+    std::vector<std::pair<int32_t, std::string>> vars;
+    size_t next = 0;
+};
+
+static POS::Extension<LocalVariableCursor> s_LocalVariableCursors;
+
+static ArgumentStack NextLocalVariable(LocalVariableCursor& cursor)
+{
+    if (cursor.next >= cursor.vars.size())
+    {
+        cursor.vars.clear();
+        return {-1, ""};
+    }
+    const auto& [type, key] = cursor.vars[cursor.next++];
+    return {type, key};
+}
+
+NWNX_EXPORT ArgumentStack GetFirstLocalVariable(ArgumentStack&& args)
+{
+    if (auto *pGameObject = Utils::PopGameObject(args))
+    {
+        const auto typeFilter = args.extract<int32_t>();
+        const auto prefix = args.extract<std::string>();
+
+        auto *pCursor = s_LocalVariableCursors.Get(pGameObject);
+        pCursor->vars.clear();
+        pCursor->next = 0;
+        ForEachLocalVariable(Utils::GetScriptVarTable(pGameObject), typeFilter, prefix,
+            [&](const CExoString& name, const CNWSScriptVar&, int32_t type) { pCursor->vars.emplace_back(type, name.CStr()); });
+
+        return NextLocalVariable(*pCursor);
+    }
+    return {-1, ""};
+}
+
+NWNX_EXPORT ArgumentStack GetNextLocalVariable(ArgumentStack&& args)
+{
+    if (auto *pGameObject = Utils::PopGameObject(args))
+        return NextLocalVariable(*s_LocalVariableCursors.Get(pGameObject));
+    return {-1, ""};
+}
+
+static json LocationToJson(const CScriptLocation& loc)
+{
+    return {{"area", loc.m_oArea},
+            {"position", {loc.m_vPosition.x, loc.m_vPosition.y, loc.m_vPosition.z}},
+            {"orientation", {loc.m_vOrientation.x, loc.m_vOrientation.y, loc.m_vOrientation.z}}};
+}
+
+static CScriptLocation JsonToLocation(const json& j)
+{
+    CScriptLocation loc;
+    loc.m_oArea = j.value("area", Constants::OBJECT_INVALID);
+    if (auto it = j.find("position"); it != j.end() && it->is_array() && it->size() == 3)
+        loc.m_vPosition = {(*it)[0].get<float>(), (*it)[1].get<float>(), (*it)[2].get<float>()};
+    if (auto it = j.find("orientation"); it != j.end() && it->is_array() && it->size() == 3)
+        loc.m_vOrientation = {(*it)[0].get<float>(), (*it)[1].get<float>(), (*it)[2].get<float>()};
+    return loc;
+}
+
+NWNX_EXPORT ArgumentStack ExportLocalVariables(ArgumentStack&& args)
+{
+    json vars = json::array();
+    if (auto *pGameObject = Utils::PopGameObject(args))
+    {
+        const auto typeFilter = args.extract<int32_t>();
+        const auto prefix = args.extract<std::string>();
+
+        ForEachLocalVariable(Utils::GetScriptVarTable(pGameObject), typeFilter, prefix,
+            [&](const CExoString& name, const CNWSScriptVar& var, int32_t type)
+            {
+                json value;
+                switch (type)
+                {
+                    case 1: value = var.m_int; break;
+                    case 2: value = var.m_float; break;
+                    case 3: value = var.m_string.CStr(); break;
+                    case 4: value = var.m_objectId; break;
+                    case 5: value = LocationToJson(var.m_location); break;
+                    case 6: value = var.m_json.m_shared->m_json; break;
+                }
+                vars.push_back({{"name", name.CStr()}, {"type", type}, {"value", std::move(value)}});
+            });
+    }
+    return JsonEngineStructure(std::move(vars), "");
+}
+
+NWNX_EXPORT ArgumentStack ImportLocalVariables(ArgumentStack&& args)
+{
+    int32_t retVal = 0;
+    if (auto *pGameObject = Utils::PopGameObject(args))
+    {
+        const auto vars = args.extract<JsonEngineStructure>();
+        const auto& j = vars.m_shared->m_json;
+        if (!j.is_array())
+            return -1;
+
+        auto *pVarTable = Utils::GetScriptVarTable(pGameObject);
+        for (const auto& var : j)
+        {
+            if (!var.is_object() || !var.contains("name") || !var.contains("type") || !var.contains("value") ||
+                !var["name"].is_string() || !var["type"].is_number_integer())
+                continue;
+
+            CExoString name = var["name"].get<std::string>().c_str();
+            const auto& value = var["value"];
+            switch (var["type"].get<int32_t>())
+            {
+                case 1:
+                    if (!value.is_number()) continue;
+                    pVarTable->SetInt(name, value.get<int32_t>());
+                    break;
+                case 2:
+                    if (!value.is_number()) continue;
+                    pVarTable->SetFloat(name, value.get<float>());
+                    break;
+                case 3:
+                {
+                    if (!value.is_string()) continue;
+                    CExoString str = value.get<std::string>().c_str();
+                    pVarTable->SetString(name, str);
+                    break;
+                }
+                case 4:
+                    if (!value.is_number_integer()) continue;
+                    pVarTable->SetObject(name, value.get<ObjectID>());
+                    break;
+                case 5:
+                    if (!value.is_object()) continue;
+                    pVarTable->SetLocation(name, JsonToLocation(value));
+                    break;
+                case 6:
+                    pVarTable->SetJson(name, JsonEngineStructure(value, ""));
+                    break;
+                default:
+                    continue;
+            }
+            retVal++;
+        }
+    }
+    return retVal;
+}
+
 NWNX_EXPORT ArgumentStack SetPosition(ArgumentStack&& args)
 {
     if (auto *pObject = Utils::PopObject(args))
@@ -5,12 +5,24 @@
 #include "API/CExoResMan.hpp"
 #include "API/CTlkTable.hpp"
 
+#include "ScriptCache.hpp"
+
 namespace Optimizations {
 
 using namespace NWNXLib;
 using namespace NWNXLib::API;
 
-static std::unordered_map<int32_t, std::pair<DataBlockRef, DataBlockRef>> s_CachedScriptChunks;
+static std::unique_ptr<ScriptCache> s_CachedScriptChunks;
+
+// The same chunk compiles differently depending on whether it gets wrapped into main().
+static std::string GetChunkKey(const CExoString& sScriptChunk, BOOL bWrapIntoMain)
+{
+    std::string key;
+    key.reserve(sScriptChunk.GetLength() + 1);
+    key.push_back(bWrapIntoMain ? 'W' : 'R');
+    key.append(sScriptChunk.CStr(), sScriptChunk.GetLength());
+    return key;
+}
 
 void CacheScriptChunks() __attribute__((constructor));
 void CacheScriptChunks()
@@ -19,6 +31,9 @@ void CacheScriptChunks()
     {
         LOG_INFO("Caching script chunks");
 
+        s_CachedScriptChunks = std::make_unique<ScriptCache>("Script chunk cache");
+        s_CachedScriptChunks->SetBudget(size_t(Config::Get<int>("CACHE_SCRIPT_CHUNKS_MAX_SIZE_MB", 64)) * 1024 * 1024);
+
         static Hooks::Hook s_SetUpJITCompiledScript = Hooks::HookFunction(&CVirtualMachine::SetUpJITCompiledScript,
         +[](CVirtualMachine *pVirtualMachine, const CExoString& sScriptChunk, BOOL bWrapIntoMain) -> int32_t
         {
@@ -29,15 +44,14 @@ void CacheScriptChunks()
                 return -633;
             }
 
-            int32_t nHash = sScriptChunk.GetHash();
+            const auto key = GetChunkKey(sScriptChunk, bWrapIntoMain);
 
-            auto cachedScript = s_CachedScriptChunks.find(nHash);
-            if (cachedScript != s_CachedScriptChunks.end())
+            if (auto *pCachedScript = s_CachedScriptChunks->Find(key))
             {
                 pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel].m_sScriptName = "!Chunk";
                 pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel].m_nScriptEventID = 0;
                 pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel].m_sScriptChunk = sScriptChunk;
-                pVirtualMachine->InitializeScript(&pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel], cachedScript->second.first, cachedScript->second.second);
+                pVirtualMachine->InitializeScript(&pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel], pCachedScript->code, pCachedScript->debug);
                 return 0;
             }
 
@@ -52,39 +66,22 @@ void CacheScriptChunks()
             int32_t nScriptDataSize;
             pVirtualMachine->m_pJitCompiler->GetCompiledScriptCode(&pScriptData, &nScriptDataSize);
 
-            if (pScriptData[0] == 'N' && pScriptData[1] == 'C' && pScriptData[2] == 'S' && pScriptData[3] == ' ' &&
-                pScriptData[4] == 'V' && pScriptData[6] == '.' && pScriptData[8] == 'B')
+            auto pScriptDataBlock = ParseCompiledScript(pScriptData, nScriptDataSize);
+            if (!pScriptDataBlock)
             {
-                int32_t nVersion = 0;
-                if (pScriptData[5] >= '1' && pScriptData[5] <= '9')
-                    nVersion += (pScriptData[5] - '0') * 10;
-                if (pScriptData[7] >= '1' && pScriptData[7] <= '9')
-                    nVersion += pScriptData[7] - '0';
-                if (nVersion != 10)
-                {
-                    --pVirtualMachine->m_nRecursionLevel;
-                    return -635;
-                }
-
-                pScriptData += 13;
-                nScriptDataSize -= 13;
-
-                DataBlockRef pScriptDataBlock = std::make_shared<DataBlock>();
-                pScriptDataBlock->Append(pScriptData, nScriptDataSize);
-
-                auto pNDB = Globals::ExoResMan()->Get("!Chunk", pVirtualMachine->m_nResTypeDebug);
+                --pVirtualMachine->m_nRecursionLevel;
+                return -635;
+            }
 
-                s_CachedScriptChunks[nHash] = std::make_pair(pScriptDataBlock, pNDB);
+            auto pNDB = Globals::ExoResMan()->Get("!Chunk", pVirtualMachine->m_nResTypeDebug);
 
-                pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel].m_sScriptName = "!Chunk";
-                pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel].m_nScriptEventID = 0;
-                pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel].m_sScriptChunk = sScriptChunk;
-                pVirtualMachine->InitializeScript(&pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel], pScriptDataBlock, pNDB);
-                return 0;
-            }
+            s_CachedScriptChunks->Insert(key, {pScriptDataBlock, pNDB});
 
-            --pVirtualMachine->m_nRecursionLevel;
-            return -635;
+            pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel].m_sScriptName = "!Chunk";
+            pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel].m_nScriptEventID = 0;
+            pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel].m_sScriptChunk = sScriptChunk;
+            pVirtualMachine->InitializeScript(&pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel], pScriptDataBlock, pNDB);
+            return 0;
         }, Hooks::Order::Final);
     }
 }
@@ -94,11 +91,15 @@ extern "C" ArgumentStack FlushCachedChunks(ArgumentStack&& args)
 {
     const auto scriptChunk = args.extract<std::string>();
 
+    if (!s_CachedScriptChunks)
+        return {};
+
     if (scriptChunk.empty())
-        s_CachedScriptChunks.clear();
+        s_CachedScriptChunks->Clear();
     else
     {
-        s_CachedScriptChunks.erase(CExoString(scriptChunk).GetHash());
+        s_CachedScriptChunks->Erase(GetChunkKey(scriptChunk, true));
+        s_CachedScriptChunks->Erase(GetChunkKey(scriptChunk, false));
     }
 
     return {};
@@ -109,12 +110,12 @@ extern "C" ArgumentStack CacheScriptChunk(ArgumentStack&& args)
     const auto scriptChunk = args.extract<std::string>();
     const auto wrapIntoMain = args.extract<int32_t>();
 
-    if (scriptChunk.empty())
+    if (scriptChunk.empty() || !s_CachedScriptChunks)
         return "";
 
-    int32_t nHash = CExoString(scriptChunk).GetHash();
+    const auto key = GetChunkKey(scriptChunk, wrapIntoMain);
 
-    if (s_CachedScriptChunks.find(nHash) != s_CachedScriptChunks.end())
+    if (s_CachedScriptChunks->Contains(key))
         return "";
 
     int32_t nReturnValue = Globals::VirtualMachine()->m_pJitCompiler->CompileScriptChunk(scriptChunk, wrapIntoMain);
@@ -129,33 +130,31 @@ extern "C" ArgumentStack CacheScriptChunk(ArgumentStack&& args)
     int32_t nScriptDataSize;
     Globals::VirtualMachine()->m_pJitCompiler->GetCompiledScriptCode(&pScriptData, &nScriptDataSize);
 
-    if (pScriptData[0] == 'N' && pScriptData[1] == 'C' && pScriptData[2] == 'S' && pScriptData[3] == ' ' &&
-        pScriptData[4] == 'V' && pScriptData[6] == '.' && pScriptData[8] == 'B')
+    auto pScriptDataBlock = ParseCompiledScript(pScriptData, nScriptDataSize);
+    if (!pScriptDataBlock)
     {
-        int32_t nVersion = 0;
-        if (pScriptData[5] >= '1' && pScriptData[5] <= '9')
-            nVersion += (pScriptData[5] - '0') * 10;
-        if (pScriptData[7] >= '1' && pScriptData[7] <= '9')
-            nVersion += pScriptData[7] - '0';
-        if (nVersion != 10)
-        {
-            CExoString retVal;
-            retVal.Format("%s: %s", Globals::TlkTable()->GetSimpleString(635).CStr(), Globals::VirtualMachine()->m_pJitCompiler->m_sCapturedError.CStr());
-            return retVal.CStr();
-        }
+        CExoString retVal;
+        retVal.Format("%s: %s", Globals::TlkTable()->GetSimpleString(635).CStr(), Globals::VirtualMachine()->m_pJitCompiler->m_sCapturedError.CStr());
+        return retVal.CStr();
+    }
 
-        pScriptData += 13;
-        nScriptDataSize -= 13;
+    auto pNDB = Globals::ExoResMan()->Get("!Chunk", Constants::ResRefType::NDB);
 
-        DataBlockRef pScriptDataBlock = std::make_shared<DataBlock>();
-        pScriptDataBlock->Append(pScriptData, nScriptDataSize);
+    s_CachedScriptChunks->Insert(key, {pScriptDataBlock, pNDB});
 
-        auto pNDB = Globals::ExoResMan()->Get("!Chunk", Constants::ResRefType::NDB);
+    return "";
+}
 
-        s_CachedScriptChunks[nHash] = std::make_pair(pScriptDataBlock, pNDB);
-    }
+// No nwscript export, call it manually. Returns hits, misses, evictions, invalidations, entries and bytes.
+extern "C" ArgumentStack GetCachedChunksStats(ArgumentStack&&)
+{
+    if (!s_CachedScriptChunks)
+        return {0, 0, 0, 0, 0, 0};
 
-    return "";
+    s_CachedScriptChunks->LogStats();
+    const auto& stats = s_CachedScriptChunks->Stats();
+    return {(int32_t)stats.hits, (int32_t)stats.misses, (int32_t)stats.evictions, (int32_t)stats.invalidations,
+            (int32_t)s_CachedScriptChunks->Size(), (int32_t)s_CachedScriptChunks->Bytes()};
 }
 
 }
@@ -3,13 +3,57 @@
 #include "API/CVirtualMachine.hpp"
 #include "API/CScriptCompiler.hpp"
 #include "API/CExoResMan.hpp"
+#include "API/CExoStringList.hpp"
+
+#include "ScriptCache.hpp"
 
 namespace Optimizations {
 
 using namespace NWNXLib;
 using namespace NWNXLib::API;
 
-static std::unordered_map<int32_t, DataBlockRef> s_CachedScripts;
+static std::unique_ptr<ScriptCache> s_CachedScripts;
+
+static DataBlockRef LoadCompiledScript(const CExoString& sScript, int32_t& nError)
+{
+    auto pVMFile = Globals::ExoResMan()->Get(sScript, Globals::VirtualMachine()->m_nResTypeCompiled);
+    if (!pVMFile)
+    {
+        nError = -634;
+        return nullptr;
+    }
+
+    auto pScriptDataBlock = ParseCompiledScript((char*)pVMFile->Data(), pVMFile->Used());
+    if (!pScriptDataBlock)
+        nError = -635;
+    return pScriptDataBlock;
+}
+
+static void PreloadScripts()
+{
+    // Only the module's own scripts, the base game ships thousands that most modules never run.
+    CExoStringList *pList = Globals::ExoResMan()->GetResOfType(Constants::ResRefType::NCS, true);
+    if (!pList)
+        return;
+
+    int32_t nLoaded = 0, nError;
+    for (int i = 0; i < pList->m_nCount; i++)
+    {
+        const CExoString& sScript = *pList->m_pStrings[i];
+        const auto key = GetScriptKey(sScript.CStr());
+        if (s_CachedScripts->Contains(key))
+            continue;
+
+        if (auto pScriptDataBlock = LoadCompiledScript(sScript, nError))
+        {
+            s_CachedScripts->Insert(key, {pScriptDataBlock, nullptr});
+            nLoaded++;
+        }
+    }
+    delete pList;
+
+    LOG_INFO("Preloaded %d scripts (%zu bytes)", nLoaded, s_CachedScripts->Bytes());
+}
 
 void CacheScripts() __attribute__((constructor));
 void CacheScripts()
@@ -18,6 +62,19 @@ void CacheScripts()
     {
         LOG_INFO("Caching scripts");
 
+        s_CachedScripts = std::make_unique<ScriptCache>("Script cache");
+        s_CachedScripts->SetBudget(size_t(Config::Get<int>("CACHE_SCRIPTS_MAX_SIZE_MB", 0)) * 1024 * 1024);
+
+        if (Config::Get<bool>("CACHE_SCRIPTS_PRELOAD", false))
+        {
+            MessageBus::Subscribe("NWNX_CORE_SIGNAL",
+                [](const std::vector<std::string>& message)
+                {
+                    if (message[0] == "ON_MODULE_LOAD_FINISH")
+                        PreloadScripts();
+                });
+        }
+
         static Hooks::Hook s_ReadScriptFile = Hooks::HookFunction(&CVirtualMachine::ReadScriptFile,
         +[](CVirtualMachine *pVirtualMachine, CExoString *psFileName, int32_t nScriptEventID) -> int32_t
         {
@@ -32,58 +89,30 @@ void CacheScripts()
             if (psFileName)
                 sScript = *psFileName;
 
-            int32_t nHash = sScript.GetHash();
+            const auto key = GetScriptKey(sScript.CStr());
+            DataBlockRef pScriptDataBlock;
 
-            auto cachedScript = s_CachedScripts.find(nHash);
-            if (cachedScript != s_CachedScripts.end())
+            if (auto *pCachedScript = s_CachedScripts->Find(key))
             {
-                pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel].m_sScriptName = sScript;
-                pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel].m_nScriptEventID = nScriptEventID;
-                pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel].m_sScriptChunk = "";
-                pVirtualMachine->InitializeScript(&pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel], cachedScript->second);
-                return 0;
+                pScriptDataBlock = pCachedScript->code;
             }
-
-            auto pVMFile = Globals::ExoResMan()->Get(sScript, pVirtualMachine->m_nResTypeCompiled);
-            if (!pVMFile)
-            {
-                --pVirtualMachine->m_nRecursionLevel;
-                return -634;
-            }
-
-            char *pScriptData = (char*)pVMFile->Data();
-            uint32_t nScriptDataSize = pVMFile->Used();
-
-            if (pScriptData[0] == 'N' && pScriptData[1] == 'C' && pScriptData[2] == 'S' && pScriptData[3] == ' ' &&
-                pScriptData[4] == 'V' && pScriptData[6] == '.' && pScriptData[8] == 'B')
+            else
             {
-                int32_t nVersion = 0;
-                if (pScriptData[5] >= '1' && pScriptData[5] <= '9')
-                    nVersion += (pScriptData[5] - '0') * 10;
-                if (pScriptData[7] >= '1' && pScriptData[7] <= '9')
-                    nVersion += pScriptData[7] - '0';
-                if (nVersion != 10)
+                int32_t nError;
+                pScriptDataBlock = LoadCompiledScript(sScript, nError);
+                if (!pScriptDataBlock)
                 {
                     --pVirtualMachine->m_nRecursionLevel;
-                    return -635;
+                    return nError;
                 }
-
-                pScriptData += 13;
-                nScriptDataSize -= 13;
-
-                DataBlockRef pScriptDataBlock = std::make_shared<DataBlock>();
-                pScriptDataBlock->Append(pScriptData, nScriptDataSize);
-                s_CachedScripts[nHash] = pScriptDataBlock;
-
-                pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel].m_sScriptName = sScript;
-                pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel].m_nScriptEventID = nScriptEventID;
-                pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel].m_sScriptChunk = "";
-                pVirtualMachine->InitializeScript(&pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel], pScriptDataBlock);
-                return 0;
+                s_CachedScripts->Insert(key, {pScriptDataBlock, nullptr});
             }
 
-            --pVirtualMachine->m_nRecursionLevel;
-            return -635;
+            pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel].m_sScriptName = sScript;
+            pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel].m_nScriptEventID = nScriptEventID;
+            pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel].m_sScriptChunk = "";
+            pVirtualMachine->InitializeScript(&pVirtualMachine->m_pVirtualMachineScript[pVirtualMachine->m_nRecursionLevel], pScriptDataBlock);
+            return 0;
         }, Hooks::Order::Final);
     }
 }
@@ -93,12 +122,27 @@ extern "C" ArgumentStack FlushCachedScripts(ArgumentStack&& args)
 {
     const auto script = args.extract<std::string>();
 
+    if (!s_CachedScripts)
+        return {};
+
     if (script.empty())
-        s_CachedScripts.clear();
+        s_CachedScripts->Clear();
     else
-        s_CachedScripts.erase(CExoString(script).GetHash());
+        s_CachedScripts->Erase(GetScriptKey(script));
 
     return {};
 }
 
+// No nwscript export, call it manually. Returns hits, misses, evictions, invalidations, entries and bytes.
+extern "C" ArgumentStack GetCachedScriptsStats(ArgumentStack&&)
+{
+    if (!s_CachedScripts)
+        return {0, 0, 0, 0, 0, 0};
+
+    s_CachedScripts->LogStats();
+    const auto& stats = s_CachedScripts->Stats();
+    return {(int32_t)stats.hits, (int32_t)stats.misses, (int32_t)stats.evictions, (int32_t)stats.invalidations,
+            (int32_t)s_CachedScripts->Size(), (int32_t)s_CachedScripts->Bytes()};
+}
+
 }
@@ -0,0 +1,221 @@
+#include "ScriptCache.hpp"
+
+#include "API/CExoResMan.hpp"
+
+#include <algorithm>
+
+namespace Optimizations {
+
+using namespace NWNXLib;
+using namespace NWNXLib::API;
+
+// Caches are created from plugin constructor functions, so don't rely on static initialization order.
+static std::vector<ScriptCache*>& GetScriptCaches()
+{
+    static std::vector<ScriptCache*> s_ScriptCaches;
+    return s_ScriptCaches;
+}
+
+static void InitInvalidationHooks()
+{
+    static Hooks::Hook s_AddKeyTable = Hooks::HookFunction(&CExoResMan::AddKeyTable,
+    +[](CExoResMan *pThis, uint32_t nPriority, const CExoString& sName, uint32_t nTableType, BOOL bDetectChanges, const ResourceAccessCheckFn accessCheck) -> BOOL
+    {
+        auto retVal = s_AddKeyTable->CallOriginal<BOOL>(pThis, nPriority, sName, nTableType, bDetectChanges, accessCheck);
+        ScriptCache::InvalidateAll();
+        return retVal;
+    }, Hooks::Order::Late);
+
+    static Hooks::Hook s_RemoveKeyTable = Hooks::HookFunction(&CExoResMan::RemoveKeyTable,
+    +[](CExoResMan *pThis, const CExoString& sName, uint32_t nTableType, BOOL bEmitWarningOnFailure) -> BOOL
+    {
+        auto retVal = s_RemoveKeyTable->CallOriginal<BOOL>(pThis, sName, nTableType, bEmitWarningOnFailure);
+        ScriptCache::InvalidateAll();
+        return retVal;
+    }, Hooks::Order::Late);
+
+    static Hooks::Hook s_UpdateKeyTable = Hooks::HookFunction(&CExoResMan::UpdateKeyTable,
+    +[](CExoResMan *pThis, const CExoString& sName, uint32_t nTableType) -> BOOL
+    {
+        auto retVal = s_UpdateKeyTable->CallOriginal<BOOL>(pThis, sName, nTableType);
+        ScriptCache::InvalidateAll();
+        return retVal;
+    }, Hooks::Order::Late);
+
+    static Hooks::Hook s_AddOverride = Hooks::HookFunction(&CExoResMan::AddOverride,
+    +[](CExoResMan *pThis, const CResRef& oldname, const CResRef& newname, RESTYPE restype) -> void
+    {
+        s_AddOverride->CallOriginal<void>(pThis, oldname, newname, restype);
+        if (restype == Constants::ResRefType::NCS)
+            ScriptCache::InvalidateScript(oldname.GetResRefStr());
+    }, Hooks::Order::Late);
+
+    static Hooks::Hook s_RemoveOverride = Hooks::HookFunction(&CExoResMan::RemoveOverride,
+    +[](CExoResMan *pThis, const CResRef& name, RESTYPE restype) -> void
+    {
+        s_RemoveOverride->CallOriginal<void>(pThis, name, restype);
+        if (restype == Constants::ResRefType::NCS)
+            ScriptCache::InvalidateScript(name.GetResRefStr());
+    }, Hooks::Order::Late);
+
+    static Hooks::Hook s_ClearOverrides = Hooks::HookFunction(&CExoResMan::ClearOverrides,
+    +[](CExoResMan *pThis) -> void
+    {
+        s_ClearOverrides->CallOriginal<void>(pThis);
+        ScriptCache::InvalidateAll();
+    }, Hooks::Order::Late);
+
+    static Hooks::Hook s_SetResObject = Hooks::HookFunction(&CExoResMan::SetResObject,
+    +[](CExoResMan *pThis, const CResRef& cResRef, RESTYPE nType, CRes *pNewRes) -> void
+    {
+        s_SetResObject->CallOriginal<void>(pThis, cResRef, nType, pNewRes);
+        if (nType == Constants::ResRefType::NCS)
+            ScriptCache::InvalidateScript(cResRef.GetResRefStr());
+    }, Hooks::Order::Late);
+}
+
+ScriptCache::ScriptCache(const char* name) : m_Name(name)
+{
+    InitInvalidationHooks();
+    GetScriptCaches().push_back(this);
+}
+
+ScriptCache::~ScriptCache()
+{
+    auto& caches = GetScriptCaches();
+    caches.erase(std::remove(caches.begin(), caches.end(), this), caches.end());
+}
+
+void ScriptCache::SetBudget(size_t bytes)
+{
+    m_Budget = bytes;
+    Evict();
+}
+
+const ScriptCache::Entry* ScriptCache::Find(const std::string& key)
+{
+    auto it = m_Entries.find(key);
+    if (it == m_Entries.end())
+    {
+        m_Stats.misses++;
+        return nullptr;
+    }
+
+    m_Stats.hits++;
+    m_Lru.splice(m_Lru.begin(), m_Lru, it->second.lru);
+    return &it->second.entry;
+}
+
+void ScriptCache::Insert(const std::string& key, Entry entry)
+{
+    Erase(key);
+
+    size_t size = key.size();
+    if (entry.code)
+        size += entry.code->Used();
+    if (entry.debug)
+        size += entry.debug->Used();
+
+    auto it = m_Entries.emplace(key, Node{std::move(entry), size, {}}).first;
+    m_Lru.push_front(&it->first);
+    it->second.lru = m_Lru.begin();
+    m_Bytes += size;
+
+    Evict();
+}
+
+void ScriptCache::Erase(const std::string& key)
+{
+    auto it = m_Entries.find(key);
+    if (it == m_Entries.end())
+        return;
+
+    m_Bytes -= it->second.size;
+    m_Lru.erase(it->second.lru);
+    m_Entries.erase(it);
+}
+
+void ScriptCache::Clear()
+{
+    m_Entries.clear();
+    m_Lru.clear();
+    m_Bytes = 0;
+}
+
+void ScriptCache::Evict()
+{
+    // Always keep the entry that was just used, even if it alone is over budget.
+    while (m_Budget && m_Bytes > m_Budget && m_Lru.size() > 1)
+    {
+        Erase(*m_Lru.back());
+        m_Stats.evictions++;
+    }
+}
+
+void ScriptCache::LogStats() const
+{
+    LOG_INFO("%s: %zu entries, %zu bytes, %llu hits, %llu misses, %llu evictions, %llu invalidations.",
+             m_Name, m_Entries.size(), m_Bytes, (unsigned long long)m_Stats.hits, (unsigned long long)m_Stats.misses,
+             (unsigned long long)m_Stats.evictions, (unsigned long long)m_Stats.invalidations);
+}
+
+void ScriptCache::InvalidateAll()
+{
+    for (auto *pCache : GetScriptCaches())
+    {
+        if (!pCache->m_Entries.empty())
+        {
+            pCache->m_Stats.invalidations += pCache->m_Entries.size();
+            pCache->Clear();
+        }
+    }
+}
+
+void ScriptCache::InvalidateScript(const std::string& script)
+{
+    const auto key = GetScriptKey(script);
+    for (auto *pCache : GetScriptCaches())
+    {
+        auto it = pCache->m_Entries.find(key);
+        if (it == pCache->m_Entries.end())
+            continue;
+
+        pCache->m_Bytes -= it->second.size;
+        pCache->m_Lru.erase(it->second.lru);
+        pCache->m_Entries.erase(it);
+        pCache->m_Stats.invalidations++;
+    }
+}
+
+std::string GetScriptKey(const std::string& script)
+{
+    std::string key = script;
+    std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+    return key;
+}
+
+DataBlockRef ParseCompiledScript(const char* pScriptData, int32_t nScriptDataSize)
+{
+    if (nScriptDataSize < 13)
+        return nullptr;
+
+    if (pScriptData[0] == 'N' && pScriptData[1] == 'C' && pScriptData[2] == 'S' && pScriptData[3] == ' ' &&
+        pScriptData[4] == 'V' && pScriptData[6] == '.' && pScriptData[8] == 'B')
+    {
+        int32_t nVersion = 0;
+        if (pScriptData[5] >= '1' && pScriptData[5] <= '9')
+            nVersion += (pScriptData[5] - '0') * 10;
+        if (pScriptData[7] >= '1' && pScriptData[7] <= '9')
+            nVersion += pScriptData[7] - '0';
+        if (nVersion != 10)
+            return nullptr;
+
+        DataBlockRef pScriptDataBlock = std::make_shared<DataBlock>();
+        pScriptDataBlock->Append(pScriptData + 13, nScriptDataSize - 13);
+        return pScriptDataBlock;
+    }
+
+    return nullptr;
+}
+
+}
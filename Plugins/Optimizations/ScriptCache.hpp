@@ -0,0 +1,79 @@
+#pragma once
+
+#include "nwnx.hpp"
+
+#include <list>
+#include <unordered_map>
+
+namespace Optimizations {
+
+struct ScriptCacheStats
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t invalidations = 0;
+};
+
+//
+// Compiled script bytecode keyed by the lowercased script name or chunk text, so two keys can never
+// share an entry. With a memory budget set the least recently used entries are evicted once the
+// cached bytecode grows past it. Every cache is flushed when the resource manager's search path or
+// overrides change, and a single script when its resource is replaced.
+//
+class ScriptCache
+{
+public:
+    struct Entry
+    {
+        DataBlockRef code;
+        DataBlockRef debug;
+    };
+
+    explicit ScriptCache(const char* name);
+    ~ScriptCache();
+
+    // 0 means no limit.
+    void SetBudget(size_t bytes);
+
+    const Entry* Find(const std::string& key);
+    void Insert(const std::string& key, Entry entry);
+    bool Contains(const std::string& key) const { return m_Entries.find(key) != m_Entries.end(); }
+    void Erase(const std::string& key);
+    void Clear();
+
+    size_t Size() const { return m_Entries.size(); }
+    size_t Bytes() const { return m_Bytes; }
+    const ScriptCacheStats& Stats() const { return m_Stats; }
+    void LogStats() const;
+
+    // Flushes every registered cache, or only the given script name. Script names are case insensitive.
+    static void InvalidateAll();
+    static void InvalidateScript(const std::string& script);
+
+private:
+    struct Node
+    {
+        Entry entry;
+        size_t size;
+        std::list<const std::string*>::iterator lru;
+    };
+
+    void Evict();
+
+    const char* m_Name;
+    size_t m_Budget = 0;
+    size_t m_Bytes = 0;
+    std::unordered_map<std::string, Node> m_Entries;
+    std::list<const std::string*> m_Lru; // Most recently used first.
+    ScriptCacheStats m_Stats;
+};
+
+// Resrefs are case insensitive, script caches are keyed on the lowercased name.
+std::string GetScriptKey(const std::string& script);
+
+// Strips and checks the "NCS V1.0 B" header of compiled script data. Returns nullptr if the data is not
+// a supported compiled script.
+DataBlockRef ParseCompiledScript(const char* pScriptData, int32_t nScriptDataSize);
+
+}
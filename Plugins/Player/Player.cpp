@@ -615,31 +615,25 @@ NWNX_EXPORT ArgumentStack SetRestAnimation(ArgumentStack&& args)
 
 NWNX_EXPORT ArgumentStack SetObjectVisualTransformOverride(ArgumentStack&& args)
 {
-    static Hooks::Hook pSetObjectVisualTransformOverrideHook =
-            Hooks::HookFunction(&CNWSMessage::ComputeGameObjectUpdateForObject,
-                +[](CNWSMessage *pMessage, CNWSPlayer *pPlayer, CNWSObject *pPlayerGameObject, CGameObjectArray *pGameObjectArray, ObjectID oidObjectToUpdate) -> void
-                {
-                    if (auto *pObject = Utils::AsNWSObject(Utils::GetGameObject(oidObjectToUpdate)))
-                    {
-                        if (pObject->m_nObjectType == Constants::ObjectType::Creature ||
-                            pObject->m_nObjectType == Constants::ObjectType::Placeable ||
-                            pObject->m_nObjectType == Constants::ObjectType::Item ||
-                            pObject->m_nObjectType == Constants::ObjectType::Door)
-                        {
-                            if (auto objectVisualTransformData = pObject->nwnxGet<void*>("OVTO!" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject)))
-                            {
-                                auto *pObjectVisualTransformData = static_cast<ObjectVisualTransformData*>(*objectVisualTransformData);
-
-                                std::swap(pObjectVisualTransformData, pObject->m_pVisualTransformData);
-                                pSetObjectVisualTransformOverrideHook->CallOriginal<void>(pMessage, pPlayer, pPlayerGameObject, pGameObjectArray, oidObjectToUpdate);
-                                std::swap(pObjectVisualTransformData, pObject->m_pVisualTransformData);
+    // Swapped with the object's own transform data for the duration of the update.
+    struct VisualTransformOverride
+    {
+        ObjectVisualTransformData data;
+        ObjectVisualTransformData *pSwap = &data;
+    };
 
-                                return;
-                            }
-                        }
-                    }
-                    pSetObjectVisualTransformOverrideHook->CallOriginal<void>(pMessage, pPlayer, pPlayerGameObject, pGameObjectArray, oidObjectToUpdate);
-                }, Hooks::Order::Early);
+    static const uint32_t s_OverrideType = UpdateOverrides::RegisterType(
+        [](CNWSObject *pObject, void *pData, bool)
+        {
+            if (pObject->m_nObjectType == Constants::ObjectType::Creature ||
+                pObject->m_nObjectType == Constants::ObjectType::Placeable ||
+                pObject->m_nObjectType == Constants::ObjectType::Item ||
+                pObject->m_nObjectType == Constants::ObjectType::Door)
+            {
+                std::swap(static_cast<VisualTransformOverride*>(pData)->pSwap, pObject->m_pVisualTransformData);
+            }
+        },
+        [](void *pData) { delete static_cast<VisualTransformOverride*>(pData); });
 
     if (auto *pPlayer = Utils::PopPlayer(args))
     {
@@ -648,38 +642,29 @@ NWNX_EXPORT ArgumentStack SetObjectVisualTransformOverride(ArgumentStack&& args)
         const auto transform = args.extract<int32_t>();
         const auto value = args.extract<float>();
 
-        auto obj = Utils::GetGameObject(oidObject);
+        if (!Utils::GetGameObject(oidObject))
+            return {};
+
         if (transform < 0)
         {
-            if (auto objectVisualTransformData = obj->nwnxGet<void*>("OVTO!" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject)))
-            {
-                auto pObjectVisualTransformData = static_cast<ObjectVisualTransformData*>(*objectVisualTransformData);
-
-                obj->nwnxRemove("OVTO!" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject));
-
-                delete pObjectVisualTransformData;
-            }
+            UpdateOverrides::Remove(pPlayer->m_oidNWSObject, oidObject, s_OverrideType);
         }
         else
         {
-            ObjectVisualTransformData *pObjectVisualTransformData;
+            auto *pOverride = static_cast<VisualTransformOverride*>(UpdateOverrides::Get(pPlayer->m_oidNWSObject, oidObject, s_OverrideType));
 
-            if (auto objectVisualTransformData = obj->nwnxGet<void*>("OVTO!" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject)))
+            if (!pOverride)
             {
-                pObjectVisualTransformData = static_cast<ObjectVisualTransformData*>(*objectVisualTransformData);
-            }
-            else
-            {
-                pObjectVisualTransformData = new ObjectVisualTransformData();
-                pObjectVisualTransformData->m_scopes[0].m_scale = Vector{1.0f, 1.0f, 1.0f};
-                pObjectVisualTransformData->m_scopes[0].m_rotate = Vector{0.0f, 0.0f, 0.0f};
-                pObjectVisualTransformData->m_scopes[0].m_translate = Vector{0.0f, 0.0f, 0.0f};
-                pObjectVisualTransformData->m_scopes[0].m_animationSpeed = 1.0f;
-
-                obj->nwnxSet("OVTO!" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject),
-                        pObjectVisualTransformData, [](void*p) { delete static_cast<ObjectVisualTransformData*>(p); });
+                pOverride = new VisualTransformOverride();
+                pOverride->data.m_scopes[0].m_scale = Vector{1.0f, 1.0f, 1.0f};
+                pOverride->data.m_scopes[0].m_rotate = Vector{0.0f, 0.0f, 0.0f};
+                pOverride->data.m_scopes[0].m_translate = Vector{0.0f, 0.0f, 0.0f};
+                pOverride->data.m_scopes[0].m_animationSpeed = 1.0f;
+
+                UpdateOverrides::Set(pPlayer->m_oidNWSObject, oidObject, s_OverrideType, pOverride);
             }
 
+            auto *pObjectVisualTransformData = &pOverride->data;
             switch (transform)
             {
                 case Constants::ObjectVisualTransform::Scale:
@@ -726,33 +711,18 @@ NWNX_EXPORT ArgumentStack SetObjectVisualTransformOverride(ArgumentStack&& args)
 
 NWNX_EXPORT ArgumentStack ApplyLoopingVisualEffectToObject(ArgumentStack&& args)
 {
-    static Hooks::Hook pApplyLoopingVisualEffectToObjectHook =
-            Hooks::HookFunction(&CNWSMessage::ComputeGameObjectUpdateForObject,
-                +[](CNWSMessage *pMessage, CNWSPlayer *pPlayer, CNWSObject *pPlayerGameObject, CGameObjectArray *pGameObjectArray, ObjectID oidObjectToUpdate) -> void
-                {
-                    if (auto *pObject = Utils::AsNWSObject(Utils::GetGameObject(oidObjectToUpdate)))
-                    {
-                            if (auto loopingVisualEffectSet = pObject->nwnxGet<void*>("LVES!" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject)))
-                            {
-                                auto *pLoopingVisualEffectSet = static_cast<std::set<uint16_t> *>(*loopingVisualEffectSet);
-
-                                for(auto visualEffect : *pLoopingVisualEffectSet)
-                                {
-                                    pObject->AddLoopingVisualEffect(visualEffect, Constants::OBJECT_INVALID, 0);
-                                }
-
-                                pApplyLoopingVisualEffectToObjectHook->CallOriginal<void>(pMessage, pPlayer, pPlayerGameObject, pGameObjectArray, oidObjectToUpdate);
-
-                                for(auto visualEffect : *pLoopingVisualEffectSet)
-                                {
-                                    pObject->RemoveLoopingVisualEffect(visualEffect);
-                                }
-
-                                return;
-                            }
-                    }
-                    pApplyLoopingVisualEffectToObjectHook->CallOriginal<void>(pMessage, pPlayer, pPlayerGameObject, pGameObjectArray, oidObjectToUpdate);
-                }, Hooks::Order::Early);
+    static const uint32_t s_OverrideType = UpdateOverrides::RegisterType(
+        [](CNWSObject *pObject, void *pData, bool bApply)
+        {
+            for (auto visualEffect : *static_cast<std::set<uint16_t>*>(pData))
+            {
+                if (bApply)
+                    pObject->AddLoopingVisualEffect(visualEffect, Constants::OBJECT_INVALID, 0);
+                else
+                    pObject->RemoveLoopingVisualEffect(visualEffect);
+            }
+        },
+        [](void *pData) { delete static_cast<std::set<uint16_t>*>(pData); });
 
     if (auto *pPlayer = Utils::PopPlayer(args))
     {
@@ -765,29 +735,16 @@ NWNX_EXPORT ArgumentStack ApplyLoopingVisualEffectToObject(ArgumentStack&& args)
         {
             if (visualEffect < 0)
             {
-                if (auto loopingVisualEffectSet = pTarget->nwnxGet<void*>("LVES!" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject)))
-                {
-                    auto pLoopingVisualEffectSet = static_cast<std::set<uint16_t>*>(*loopingVisualEffectSet);
-
-                    pTarget->nwnxRemove("LVES!" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject));
-
-                    delete pLoopingVisualEffectSet;
-                }
+                UpdateOverrides::Remove(pPlayer->m_oidNWSObject, pTarget->m_idSelf, s_OverrideType);
             }
             else
             {
-                std::set<uint16_t> *pLoopingVisualEffectSet;
+                auto *pLoopingVisualEffectSet = static_cast<std::set<uint16_t>*>(UpdateOverrides::Get(pPlayer->m_oidNWSObject, pTarget->m_idSelf, s_OverrideType));
 
-                if (auto loopingVisualEffectSet = pTarget->nwnxGet<void*>("LVES!" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject)))
-                {
-                    pLoopingVisualEffectSet = static_cast<std::set<uint16_t>*>(*loopingVisualEffectSet);
-                }
-                else
+                if (!pLoopingVisualEffectSet)
                 {
                     pLoopingVisualEffectSet = new std::set<uint16_t>();
-
-                    pTarget->nwnxSet("LVES!" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject),
-                                    pLoopingVisualEffectSet, [](void*p) { delete static_cast<std::set<uint16_t>*>(p); });
+                    UpdateOverrides::Set(pPlayer->m_oidNWSObject, pTarget->m_idSelf, s_OverrideType, pLoopingVisualEffectSet);
                 }
 
                 if (pLoopingVisualEffectSet->find(visualEffect) != pLoopingVisualEffectSet->end())
@@ -806,24 +763,13 @@ NWNX_EXPORT ArgumentStack ApplyLoopingVisualEffectToObject(ArgumentStack&& args)
 
 NWNX_EXPORT ArgumentStack SetPlaceableNameOverride(ArgumentStack&& args)
 {
-    static Hooks::Hook pSetPlaceableNameOverrideHook =
-            Hooks::HookFunction(&CNWSMessage::ComputeGameObjectUpdateForObject,
-                +[](CNWSMessage *pMessage, CNWSPlayer *pPlayer, CNWSObject *pPlayerGameObject, CGameObjectArray *pGameObjectArray, ObjectID oidObjectToUpdate) -> void
-                {
-                    if (auto *pPlaceable = Utils::AsNWSPlaceable(Utils::GetGameObject(oidObjectToUpdate)))
-                    {
-                        if (auto name = pPlaceable->nwnxGet<std::string>("PLCNO_" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject)))
-                        {
-                            CExoString swapName = CExoString(*name);
-
-                            std::swap(swapName, pPlaceable->m_sDisplayName);
-                            pSetPlaceableNameOverrideHook->CallOriginal<void>(pMessage, pPlayer, pPlayerGameObject, pGameObjectArray, oidObjectToUpdate);
-                            std::swap(swapName, pPlaceable->m_sDisplayName);
-                            return;
-                        }
-                    }
-                    pSetPlaceableNameOverrideHook->CallOriginal<void>(pMessage, pPlayer, pPlayerGameObject, pGameObjectArray, oidObjectToUpdate);
-                }, Hooks::Order::Early);
+    static const uint32_t s_OverrideType = UpdateOverrides::RegisterType(
+        [](CNWSObject *pObject, void *pData, bool)
+        {
+            if (auto *pPlaceable = Utils::AsNWSPlaceable(pObject))
+                std::swap(*static_cast<CExoString*>(pData), pPlaceable->m_sDisplayName);
+        },
+        [](void *pData) { delete static_cast<CExoString*>(pData); });
 
     if (auto *pPlayer = Utils::PopPlayer(args))
     {
@@ -835,11 +781,11 @@ NWNX_EXPORT ArgumentStack SetPlaceableNameOverride(ArgumentStack&& args)
         {
             if (name.empty())
             {
-                pPlaceable->nwnxRemove("PLCNO_" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject));
+                UpdateOverrides::Remove(pPlayer->m_oidNWSObject, pPlaceable->m_idSelf, s_OverrideType);
             }
             else
             {
-                pPlaceable->nwnxSet("PLCNO_" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject), name);
+                UpdateOverrides::Set(pPlayer->m_oidNWSObject, pPlaceable->m_idSelf, s_OverrideType, new CExoString(name));
             }
 
             if (auto *pLastUpdateObject = pPlayer->GetLastUpdateObject(pPlaceable->m_idSelf))
@@ -1174,24 +1120,13 @@ NWNX_EXPORT ArgumentStack SetCustomToken(ArgumentStack&& args)
 
 NWNX_EXPORT ArgumentStack SetCreatureNameOverride(ArgumentStack&& args)
 {
-    static Hooks::Hook pSetCreatureNameOverrideHook =
-            Hooks::HookFunction(&CNWSMessage::ComputeGameObjectUpdateForObject,
-                 +[](CNWSMessage *pMessage, CNWSPlayer *pPlayer, CNWSObject *pPlayerGameObject, CGameObjectArray *pGameObjectArray, ObjectID oidObjectToUpdate) -> void
-                 {
-                     if (auto *pCreature = Utils::AsNWSCreature(Utils::GetGameObject(oidObjectToUpdate)))
-                     {
-                         if (auto name = pCreature->nwnxGet<std::string>("CRENO_" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject)))
-                         {
-                             CExoString swapName = CExoString(*name);
-
-                             std::swap(swapName, pCreature->m_sDisplayName);
-                             pSetCreatureNameOverrideHook->CallOriginal<void>(pMessage, pPlayer, pPlayerGameObject, pGameObjectArray, oidObjectToUpdate);
-                             std::swap(swapName, pCreature->m_sDisplayName);
-                             return;
-                         }
-                     }
-                     pSetCreatureNameOverrideHook->CallOriginal<void>(pMessage, pPlayer, pPlayerGameObject, pGameObjectArray, oidObjectToUpdate);
-                 }, Hooks::Order::Early);
+    static const uint32_t s_OverrideType = UpdateOverrides::RegisterType(
+        [](CNWSObject *pObject, void *pData, bool)
+        {
+            if (auto *pCreature = Utils::AsNWSCreature(pObject))
+                std::swap(*static_cast<CExoString*>(pData), pCreature->m_sDisplayName);
+        },
+        [](void *pData) { delete static_cast<CExoString*>(pData); });
 
     if (auto *pPlayer = Utils::PopPlayer(args))
     {
@@ -1203,11 +1138,11 @@ NWNX_EXPORT ArgumentStack SetCreatureNameOverride(ArgumentStack&& args)
         {
             if (name.empty())
             {
-                pCreature->nwnxRemove("CRENO_" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject));
+                UpdateOverrides::Remove(pPlayer->m_oidNWSObject, pCreature->m_idSelf, s_OverrideType);
             }
             else
             {
-                pCreature->nwnxSet("CRENO_" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject), name);
+                UpdateOverrides::Set(pPlayer->m_oidNWSObject, pCreature->m_idSelf, s_OverrideType, new CExoString(name));
             }
 
             if (auto *pLastUpdateObject = pPlayer->GetLastUpdateObject(pCreature->m_idSelf))
@@ -1330,22 +1265,12 @@ NWNX_EXPORT ArgumentStack ToggleDM(ArgumentStack&& args)
 
 NWNX_EXPORT ArgumentStack SetObjectMouseCursorOverride(ArgumentStack&& args)
 {
-    static Hooks::Hook pSetObjectMouseCursorOverrideHook =
-            Hooks::HookFunction(&CNWSMessage::ComputeGameObjectUpdateForObject,
-                +[](CNWSMessage *pMessage, CNWSPlayer *pPlayer, CNWSObject *pPlayerGameObject, CGameObjectArray *pGameObjectArray, ObjectID oidObjectToUpdate) -> void
-                {
-                    if (auto *pObject = Utils::AsNWSObject(Utils::GetGameObject(oidObjectToUpdate)))
-                    {
-                        if (auto cursorId = pObject->nwnxGet<int32_t>("OBJCO_" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject)))
-                        {
-                            std::swap(*cursorId, pObject->m_nMouseCursor);
-                            pSetObjectMouseCursorOverrideHook->CallOriginal<void>(pMessage, pPlayer, pPlayerGameObject, pGameObjectArray, oidObjectToUpdate);
-                            std::swap(*cursorId, pObject->m_nMouseCursor);
-                            return;
-                        }
-                    }
-                    pSetObjectMouseCursorOverrideHook->CallOriginal<void>(pMessage, pPlayer, pPlayerGameObject, pGameObjectArray, oidObjectToUpdate);
-                }, Hooks::Order::Early);
+    static const uint32_t s_OverrideType = UpdateOverrides::RegisterType(
+        [](CNWSObject *pObject, void *pData, bool)
+        {
+            std::swap(*static_cast<int32_t*>(pData), pObject->m_nMouseCursor);
+        },
+        [](void *pData) { delete static_cast<int32_t*>(pData); });
 
     if (auto *pPlayer = Utils::PopPlayer(args))
     {
@@ -1357,11 +1282,11 @@ NWNX_EXPORT ArgumentStack SetObjectMouseCursorOverride(ArgumentStack&& args)
         {
             if (cursorId < 0)
             {
-                pObject->nwnxRemove("OBJCO_" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject));
+                UpdateOverrides::Remove(pPlayer->m_oidNWSObject, pObject->m_idSelf, s_OverrideType);
             }
             else
             {
-                pObject->nwnxSet("OBJCO_" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject), cursorId);
+                UpdateOverrides::Set(pPlayer->m_oidNWSObject, pObject->m_idSelf, s_OverrideType, new int32_t(cursorId));
             }
         }
     }
@@ -1370,27 +1295,12 @@ NWNX_EXPORT ArgumentStack SetObjectMouseCursorOverride(ArgumentStack&& args)
 
 NWNX_EXPORT ArgumentStack SetObjectHiliteColorOverride(ArgumentStack&& args)
 {
-    static Hooks::Hook pSetObjectHiliteColorHook =
-            Hooks::HookFunction(&CNWSMessage::ComputeGameObjectUpdateForObject,
-                +[](CNWSMessage *pMessage, CNWSPlayer *pPlayer, CNWSObject *pPlayerGameObject, CGameObjectArray *pGameObjectArray, ObjectID oidObjectToUpdate) -> void
-                {
-                    if (auto *pObject = Utils::AsNWSObject(Utils::GetGameObject(oidObjectToUpdate)))
-                    {
-                        if (auto hiliteColor = pObject->nwnxGet<int32_t>("OBJHCO_" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject)))
-                        {
-                            Vector vHiliteColor = {};
-                            vHiliteColor.x = (float)((*hiliteColor >> 16) & 0xFF) / 255.0f; // R
-                            vHiliteColor.y = (float)((*hiliteColor >> 8) & 0xFF) / 255.0f;  // G
-                            vHiliteColor.z = (float)(*hiliteColor & 0xFF) / 255.0f;         // B
-
-                            std::swap(vHiliteColor, pObject->m_vHiliteColor);
-                            pSetObjectHiliteColorHook->CallOriginal<void>(pMessage, pPlayer, pPlayerGameObject, pGameObjectArray, oidObjectToUpdate);
-                            std::swap(vHiliteColor, pObject->m_vHiliteColor);
-                            return;
-                        }
-                    }
-                    pSetObjectHiliteColorHook->CallOriginal<void>(pMessage, pPlayer, pPlayerGameObject, pGameObjectArray, oidObjectToUpdate);
-                }, Hooks::Order::Early);
+    static const uint32_t s_OverrideType = UpdateOverrides::RegisterType(
+        [](CNWSObject *pObject, void *pData, bool)
+        {
+            std::swap(*static_cast<Vector*>(pData), pObject->m_vHiliteColor);
+        },
+        [](void *pData) { delete static_cast<Vector*>(pData); });
 
     if (auto *pPlayer = Utils::PopPlayer(args))
     {
@@ -1403,11 +1313,16 @@ NWNX_EXPORT ArgumentStack SetObjectHiliteColorOverride(ArgumentStack&& args)
         {
             if (hiliteColor < 0)
             {
-                pObject->nwnxRemove("OBJHCO_" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject));
+                UpdateOverrides::Remove(pPlayer->m_oidNWSObject, pObject->m_idSelf, s_OverrideType);
             }
             else
             {
-                pObject->nwnxSet("OBJHCO_" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject), hiliteColor);
+                auto *pHiliteColor = new Vector();
+                pHiliteColor->x = (float)((hiliteColor >> 16) & 0xFF) / 255.0f; // R
+                pHiliteColor->y = (float)((hiliteColor >> 8) & 0xFF) / 255.0f;  // G
+                pHiliteColor->z = (float)(hiliteColor & 0xFF) / 255.0f;         // B
+
+                UpdateOverrides::Set(pPlayer->m_oidNWSObject, pObject->m_idSelf, s_OverrideType, pHiliteColor);
             }
         }
     }
@@ -1831,22 +1746,12 @@ NWNX_EXPORT ArgumentStack GetGameObject(ArgumentStack&& args)
 
 NWNX_EXPORT ArgumentStack SetObjectUiDiscoveryMaskOverride(ArgumentStack&& args)
 {
-    static Hooks::Hook pSetObjectUiDiscoveryMaskOverrideHook =
-            Hooks::HookFunction(&CNWSMessage::ComputeGameObjectUpdateForObject,
-            +[](CNWSMessage *pMessage, CNWSPlayer *pPlayer, CNWSObject *pPlayerGameObject, CGameObjectArray *pGameObjectArray, ObjectID oidObjectToUpdate) -> void
-            {
-                if (auto *pObject = Utils::AsNWSObject(Utils::GetGameObject(oidObjectToUpdate)))
-                {
-                    if (auto discoveryMask = pObject->nwnxGet<int>("OBJUDO_" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject)))
-                    {
-                        std::swap(*discoveryMask, pObject->m_nUiDiscoveryMask);
-                        pSetObjectUiDiscoveryMaskOverrideHook->CallOriginal<void>(pMessage, pPlayer, pPlayerGameObject, pGameObjectArray, oidObjectToUpdate);
-                        std::swap(*discoveryMask, pObject->m_nUiDiscoveryMask);
-                        return;
-                    }
-                }
-                pSetObjectUiDiscoveryMaskOverrideHook->CallOriginal<void>(pMessage, pPlayer, pPlayerGameObject, pGameObjectArray, oidObjectToUpdate);
-            }, Hooks::Order::Early);
+    static const uint32_t s_OverrideType = UpdateOverrides::RegisterType(
+        [](CNWSObject *pObject, void *pData, bool)
+        {
+            std::swap(*static_cast<int32_t*>(pData), pObject->m_nUiDiscoveryMask);
+        },
+        [](void *pData) { delete static_cast<int32_t*>(pData); });
 
     if (auto *pPlayer = Utils::PopPlayer(args))
     {
@@ -1858,11 +1763,11 @@ NWNX_EXPORT ArgumentStack SetObjectUiDiscoveryMaskOverride(ArgumentStack&& args)
         {
             if (discoveryMask < 0)
             {
-                pObject->nwnxRemove("OBJUDO_" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject));
+                UpdateOverrides::Remove(pPlayer->m_oidNWSObject, pObject->m_idSelf, s_OverrideType);
             }
             else
             {
-                pObject->nwnxSet("OBJUDO_" + Utils::ObjectIDToString(pPlayer->m_oidNWSObject), discoveryMask);
+                UpdateOverrides::Set(pPlayer->m_oidNWSObject, pObject->m_idSelf, s_OverrideType, new int32_t(discoveryMask));
             }
         }
     }
@@ -469,15 +469,15 @@ int32_t Race::GetWeaponPowerHook(CNWSCreature *pCreature, CNWSObject *pObject, i
     uint16_t attackBonusLimit = pServerExoApp->GetAttackBonusLimit();
 
     auto nRace = pCreature->m_pStats->m_nRace;
-    auto modABBonus = g_plugin->m_RaceAB[nRace];
+    auto modABBonus = GetRaceAB(nRace);
     uint8_t modABVSRaceBonus = 0;
     auto *pTargetCreature = Globals::AppManager()->m_pServerExoApp->GetCreatureByGameObjectID(pObject->m_idSelf);
     if (pTargetCreature)
     {
-        modABVSRaceBonus = g_plugin->m_RaceABVsRace[nRace][pTargetCreature->m_pStats->m_nRace];
-        auto parRace = g_plugin->m_RaceParent[pTargetCreature->m_pStats->m_nRace];
+        modABVSRaceBonus = GetRaceABVsRace(nRace, pTargetCreature->m_pStats->m_nRace);
+        auto parRace = GetParentRaceId(pTargetCreature->m_pStats->m_nRace);
         if(parRace != RacialType::Invalid)
-            modABVSRaceBonus = g_plugin->m_RaceABVsRace[nRace][parRace];
+            modABVSRaceBonus = GetRaceABVsRace(nRace, parRace);
     }
 
 
@@ -561,14 +561,14 @@ int32_t Race::GetTotalEffectBonusHook(CNWSCreature *pCreature, uint8_t nEffectBo
     auto nRace = pCreature->m_pStats->m_nRace;
     if (nEffectBonusType == 1)
     {
-        auto modABBonus = g_plugin->m_RaceAB[nRace];
+        auto modABBonus = GetRaceAB(nRace);
         uint8_t modABVSRaceBonus = 0;
         if (pTargetCreature)
         {
-            modABVSRaceBonus = g_plugin->m_RaceABVsRace[nRace][pTargetCreature->m_pStats->m_nRace];
-            auto parRace = g_plugin->m_RaceParent[pTargetCreature->m_pStats->m_nRace];
+            modABVSRaceBonus = GetRaceABVsRace(nRace, pTargetCreature->m_pStats->m_nRace);
+            auto parRace = GetParentRaceId(pTargetCreature->m_pStats->m_nRace);
             if(parRace != RacialType::Invalid)
-                modABVSRaceBonus = g_plugin->m_RaceABVsRace[nRace][parRace];
+                modABVSRaceBonus = GetRaceABVsRace(nRace, parRace);
         }
         pServerExoApp->SetAttackBonusLimit(attackBonusLimit + modABBonus + modABVSRaceBonus);
     }
@@ -730,14 +730,14 @@ void Race::SetOrRestoreRace(bool before, CNWSCreatureStats *pCreatureStats, CNWS
     {
         if (pCreatureStats != nullptr)
         {
-            auto parentRace = g_plugin->m_RaceParent[pCreatureStats->m_nRace];
+            auto parentRace = GetParentRaceId(pCreatureStats->m_nRace);
             originalRace = pCreatureStats->m_nRace;
             if (parentRace != RacialType::Invalid)
                 pCreatureStats->m_nRace = parentRace;
         }
         if (pTgtCreatureStats != nullptr)
         {
-            auto versusParentRace = g_plugin->m_RaceParent[pTgtCreatureStats->m_nRace];
+            auto versusParentRace = GetParentRaceId(pTgtCreatureStats->m_nRace);
             originalTgtRace = pTgtCreatureStats->m_nRace;
             if (versusParentRace != RacialType::Invalid)
                 pTgtCreatureStats->m_nRace = versusParentRace;
@@ -791,10 +791,10 @@ int32_t Race::GetFavoredEnemyBonusHook(CNWSCreatureStats *pCreatureStats, CNWSCr
     if (fi != g_plugin->m_RaceFavoredEnemyFeat.end())
         nFeatList = fi->second;
 
-    auto pri = g_plugin->m_RaceParent.find(pTgtCreature->m_pStats->m_nRace);
-    if ( pri != g_plugin->m_RaceParent.end())
+    auto parentRace = GetParentRaceId(pTgtCreature->m_pStats->m_nRace);
+    if (parentRace != RacialType::Invalid)
     {
-        auto pfi = g_plugin->m_RaceFavoredEnemyFeat.find(pri->second);
+        auto pfi = g_plugin->m_RaceFavoredEnemyFeat.find(parentRace);
         if (pfi != g_plugin->m_RaceFavoredEnemyFeat.end())
         {
             nFeatList.insert(nFeatList.end(), pfi->second.begin(), pfi->second.end());
@@ -885,7 +885,7 @@ int32_t Race::CheckItemRaceRestrictionsHook(CNWSCreature *pCreature, CNWSItem *p
         if (pItem->GetPassiveProperty(i)->m_nPropertyName == Constants::ItemProperty::UseLimitationRacialType)
         {
             auto raceToCheck = pItem->GetPassiveProperty(i)->m_nSubType;
-            if (nRace == raceToCheck || g_plugin->m_RaceParent[nRace] == raceToCheck)
+            if (nRace == raceToCheck || GetParentRaceId(nRace) == raceToCheck)
             {
                 return 1;
             }
@@ -901,9 +901,49 @@ void Race::LoadRaceInfoHook(CNWRules *pRules)
 
     // Initialize the parent race to Invalid
     auto twoda = pRules->m_p2DArrays->GetCached2DA("RACIALTYPES", true);
-    for (int raceId = 0; raceId < twoda->m_nNumRows; raceId++)
+    g_plugin->m_RaceParent.assign(twoda->m_nNumRows, RacialType::Invalid);
+    BuildRaceABIndex();
+}
+
+uint16_t Race::GetParentRaceId(uint16_t nRace)
+{
+    return nRace < g_plugin->m_RaceParent.size() ? g_plugin->m_RaceParent[nRace] : (uint16_t)RacialType::Invalid;
+}
+
+int32_t Race::GetRaceAB(uint16_t nRace)
+{
+    return nRace < g_plugin->m_RaceABIndex.size() ? g_plugin->m_RaceABIndex[nRace] : 0;
+}
+
+int32_t Race::GetRaceABVsRace(uint16_t nRace, uint16_t nVersusRace)
+{
+    const size_t nNumRaces = g_plugin->m_RaceParent.size();
+    if (nRace >= nNumRaces || nVersusRace >= nNumRaces || g_plugin->m_RaceABVsRaceIndex.empty())
+        return 0;
+    return g_plugin->m_RaceABVsRaceIndex[nRace * nNumRaces + nVersusRace];
+}
+
+void Race::BuildRaceABIndex()
+{
+    const size_t nNumRaces = g_plugin->m_RaceParent.size();
+    g_plugin->m_RaceABIndex.assign(nNumRaces, 0);
+    for (auto& [nRace, modAB] : g_plugin->m_RaceAB)
+    {
+        if (nRace < nNumRaces)
+            g_plugin->m_RaceABIndex[nRace] = modAB;
+    }
+
+    g_plugin->m_RaceABVsRaceIndex.clear();
+    if (g_plugin->m_RaceABVsRace.empty())
+        return;
+    g_plugin->m_RaceABVsRaceIndex.assign(nNumRaces * nNumRaces, 0);
+    for (auto& [nRace, mods] : g_plugin->m_RaceABVsRace)
     {
-        g_plugin->m_RaceParent[raceId] = RacialType::Invalid;
+        for (auto& [nVersusRace, modAB] : mods)
+        {
+            if (nRace < nNumRaces && nVersusRace < nNumRaces)
+                g_plugin->m_RaceABVsRaceIndex[nRace * nNumRaces + nVersusRace] = modAB;
+        }
     }
 }
 
@@ -917,6 +957,7 @@ void Race::SetRaceModifier(int32_t raceId, RaceModifier raceMod, int32_t param1,
         case AB:
         {
             g_plugin->m_RaceAB[raceId] = param1;
+            BuildRaceABIndex();
             LOG_INFO("%s: Setting Natural AB modifier to %d.", raceName, param1);
             break;
         }
@@ -928,6 +969,7 @@ void Race::SetRaceModifier(int32_t raceId, RaceModifier raceMod, int32_t param1,
                 break;
             }
             g_plugin->m_RaceABVsRace[raceId][param1] = param2;
+            BuildRaceABIndex();
             auto versusRaceName = Globals::Rules()->m_lstRaces[param1].GetNamePluralText();
             LOG_INFO("%s: Setting Natural AB modifier vs %s to %d.", raceName, versusRaceName, param2);
             break;
@@ -1055,6 +1097,11 @@ void Race::SetRaceModifier(int32_t raceId, RaceModifier raceMod, int32_t param1,
         }
         case RACE:
         {
+            if ((size_t)raceId >= g_plugin->m_RaceParent.size())
+            {
+                g_plugin->m_RaceParent.resize(raceId + 1, RacialType::Invalid);
+                BuildRaceABIndex();
+            }
             g_plugin->m_RaceParent[raceId] = param1;
             g_plugin->m_ChildRaces[param1].push_back(raceId);
             auto parentRaceName = Globals::Rules()->m_lstRaces[param1].GetNameText();
@@ -1183,7 +1230,7 @@ ArgumentStack Race::SetRacialModifier(ArgumentStack&& args)
 ArgumentStack Race::GetParentRace(ArgumentStack&& args)
 {
     auto raceId = ScriptAPI::ExtractArgument<int>(args);
-    auto parentRace = g_plugin->m_RaceParent[raceId] == RacialType::Invalid ? raceId : g_plugin->m_RaceParent[raceId];
+    auto parentRace = GetParentRaceId(raceId) == RacialType::Invalid ? raceId : GetParentRaceId(raceId);
     return ScriptAPI::Arguments(parentRace);
 }
 
@@ -1225,7 +1272,7 @@ int32_t Race::GetAttackModifierVersusHook(CNWSCreatureStats* pStats, CNWSCreatur
     int32_t modABVSRaceBonus = 0;
     if(pCreature)
     {
-        auto parRace = g_plugin->m_RaceParent[pCreature->m_pStats->m_nRace];
+        auto parRace = GetParentRaceId(pCreature->m_pStats->m_nRace);
 
         if((parRace == RacialType::HumanoidOrc && pStats->HasFeat(Feat::BattleTrainingVersusOrcs)) ||
             (parRace == RacialType::HumanoidGoblinoid && pStats->HasFeat(Feat::BattleTrainingVersusGoblins)) ||
@@ -1254,7 +1301,7 @@ int16_t Race::GetArmorClassVersusHook(CNWSCreatureStats* pStats, CNWSCreature* p
     int32_t modACVSRaceBonus = 0;
     if(pCreature)
     {
-        auto parRace = g_plugin->m_RaceParent[pCreature->m_pStats->m_nRace];
+        auto parRace = GetParentRaceId(pCreature->m_pStats->m_nRace);
 
         if(parRace == RacialType::Giant && pStats->HasFeat(Feat::BattleTrainingVersusGiants))
             modACVSRaceBonus = Globals::Rules()->GetRulesetIntEntry(CRULES_HASHEDSTR("DEFENSIVE_TRAINING_MODIFIER"), 4);
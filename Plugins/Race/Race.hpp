@@ -68,7 +68,6 @@ private:
     unordered_map<uint16_t, vector<uint32_t>>                                         m_RaceImmunities;
     unordered_map<uint16_t, int32_t>                                                  m_RaceInitiative;
     unordered_map<uint16_t, int32_t>                                                  m_RaceMovementSpeed;
-    unordered_map<uint16_t, uint16_t>                                                 m_RaceParent;
     unordered_map<uint16_t, pair<uint8_t, uint16_t>>                                  m_RaceRegeneration;
     unordered_map<uint16_t, unordered_map<uint8_t, int32_t>>                          m_RaceSave;
     unordered_map<uint16_t, unordered_map<uint8_t, unordered_map<uint16_t, int16_t>>> m_RaceSaveVsRace;
@@ -80,12 +79,23 @@ private:
     unordered_map<uint16_t, vector<uint16_t>>                                         m_ChildRaces;
     unordered_map<uint16_t, vector<uint16_t>>                                         m_RaceFavoredEnemyFeat;
 
+    // Indexed by race id, sized to racialtypes.2da in LoadRaceInfoHook.
+    vector<uint16_t> m_RaceParent;
+    // Flat copies of m_RaceAB and m_RaceABVsRace for the attack hooks, indexed by [race] and
+    // [race * races + versus race]. Rebuilt whenever either changes.
+    vector<int32_t> m_RaceABIndex;
+    vector<int32_t> m_RaceABVsRaceIndex;
+
 
     static void DoEffect(CNWSCreature*, uint16_t, int32_t, int32_t = 0, int32_t = 0, int32_t = 0, int32_t = 0, int32_t = 0);
     static void RemoveRaceEffects(CNWSCreature*);
     static void ApplyRaceEffects(CNWSCreature*);
     static void SetOrRestoreRace(bool, CNWSCreatureStats*, CNWSCreatureStats* = nullptr);
     static void SetRaceModifier(int32_t, RaceModifier, int32_t, int32_t, int32_t);
+    static uint16_t GetParentRaceId(uint16_t);
+    static int32_t GetRaceAB(uint16_t);
+    static int32_t GetRaceABVsRace(uint16_t, uint16_t);
+    static void BuildRaceABIndex();
 
     static void ResolveInitiativeHook(CNWSCreature*);
 
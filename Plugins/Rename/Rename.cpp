@@ -3,7 +3,6 @@
 #include <sstream>
 #include <regex>
 #include <string>
-#include <random>
 #include <algorithm>
 #include "API/CAppManager.hpp"
 #include "API/CServerExoApp.hpp"
@@ -454,14 +453,13 @@ std::string Rename::GenerateRandomPlayerName(size_t length, ObjectID targetOid)
     auto iter = m_ObfuscatedNames.find(targetOid);
     if (iter != m_ObfuscatedNames.end())
         return iter->second;
-    static std::mt19937 rngEngine(std::random_device{}());
+    static auto& rng = Random::GetStream("Rename");
     static const std::string charSet = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
-    std::uniform_int_distribution<int> distribution(0, charSet.length() - 1);
     std::string randomPlayername;
     randomPlayername.reserve(length+1);
     for (size_t i = 0; i < length; ++i)
     {
-        randomPlayername += charSet[distribution(rngEngine)];
+        randomPlayername += charSet[rng.Range(charSet.length())];
     }
     m_ObfuscatedNames[targetOid] = randomPlayername;
     return randomPlayername;
@@ -1,8 +1,12 @@
 #include "Reveal.hpp"
 #include <string>
+#include "API/CNWSArea.hpp"
 #include "API/CNWSCreature.hpp"
 #include "API/CNWSFaction.hpp"
+#include "API/CNWSUUID.hpp"
 #include "API/Functions.hpp"
+#include <algorithm>
+#include <vector>
 
 
 
@@ -20,6 +24,66 @@ const std::string detectionKey = "DETECTION VECTOR";
 const int NWNX_REVEAL_SEEN = 1;
 const int NWNX_REVEAL_HEARD = 0;
 
+struct ObserverReveal
+{
+    ObjectID oidObserver;
+    int32_t detectionVector;
+};
+
+// Reveals of one hiding creature. The party state is persisted in POS and read from there the first time
+// the creature is checked and after its POS is loaded, observer reveals only last until the observer's next
+// stealth check.
+struct HiderReveals
+{
+    bool bRevealToParty = false;
+    int32_t partyDetectionVector = 0;
+    std::vector<ObserverReveal> observers;
+};
+
+static void LoadHiderReveals(CGameObject* pHidingObject, HiderReveals& reveals)
+{
+    auto partyReveal = pHidingObject->nwnxGet<int>(revealKey + "PARTY");
+    if (partyReveal && *partyReveal)
+    {
+        reveals.bRevealToParty = true;
+        auto detectionVector = pHidingObject->nwnxGet<int>(detectionKey + "PARTY");
+        reveals.partyDetectionVector = detectionVector ? *detectionVector : NWNX_REVEAL_HEARD;
+    }
+}
+
+static NWNXLib::POS::Extension<HiderReveals> s_HiderReveals(&LoadHiderReveals);
+// Until the first reveal, from a script or a creature loaded with a party reveal, stealth checks don't look
+// at the hider's reveals at all.
+static bool s_bAnyReveals = false;
+
+static void AddObserverReveal(HiderReveals& reveals, ObjectID oidObserver, int32_t detectionVector)
+{
+    for (auto& observer : reveals.observers)
+    {
+        if (observer.oidObserver == oidObserver)
+        {
+            observer.detectionVector = detectionVector;
+            return;
+        }
+    }
+    reveals.observers.push_back({oidObserver, detectionVector});
+    s_bAnyReveals = true;
+}
+
+template <typename Pred>
+static void RemoveObserverReveals(ObjectID oidHiding, Pred&& pred)
+{
+    if (auto *pReveals = s_HiderReveals.Get(Utils::GetGameObject(oidHiding)))
+    {
+        auto& observers = pReveals->observers;
+        observers.erase(std::remove_if(observers.begin(), observers.end(),
+            [&](const ObserverReveal& observer)
+            {
+                return pred(Utils::AsNWSCreature(Utils::GetGameObject(observer.oidObserver)));
+            }), observers.end());
+    }
+}
+
 NWNX_PLUGIN_ENTRY Plugin* PluginLoad(Services::ProxyServiceList* services)
 {
     g_plugin = new Reveal::Reveal(services);
@@ -37,56 +101,65 @@ Reveal::Reveal(Services::ProxyServiceList* services)
 
     REGISTER(RevealTo);
     REGISTER(SetRevealToParty);
+    REGISTER(RevealToFaction);
+    REGISTER(RevealToArea);
+    REGISTER(ClearReveals);
+    REGISTER(ClearRevealsToFaction);
+    REGISTER(ClearRevealsToArea);
 
 #undef REGISTER
 
     m_DoStealthDetection = Hooks::HookFunction(&CNWSCreature::DoStealthDetection, (void*)&HookStealthDetection, Hooks::Order::Late);
+    m_UUIDLoadFromGff = Hooks::HookFunction(&CNWSUUID::LoadFromGff, (void*)&HookUUIDLoadFromGff, Hooks::Order::Late);
 }
 
 Reveal::~Reveal()
 {
 }
+
 BOOL Reveal::HookStealthDetection(CNWSCreature* pObserverCreature, CNWSCreature* pHidingCreature, BOOL bClearLOS, BOOL* bSeen, BOOL* bHeard, BOOL bTargetHiding)
 {
-    if (pObserverCreature->m_bPlayerCharacter && pHidingCreature->m_bPlayerCharacter && pHidingCreature->m_nStealthMode)
+    if (s_bAnyReveals && pObserverCreature->m_bPlayerCharacter && pHidingCreature->m_bPlayerCharacter && pHidingCreature->m_nStealthMode)
     {
         if (pObserverCreature->GetArea() == pHidingCreature->GetArea())
         {
-            auto partyReveal = pHidingCreature->nwnxGet<int>(revealKey + "PARTY");
-            if (partyReveal && *partyReveal)
+            auto& reveals = *s_HiderReveals.Get(pHidingCreature);
+            if (reveals.bRevealToParty)
             {
                 if (pObserverCreature->GetFaction()->GetLeader() == pHidingCreature->GetFaction()->GetLeader())
                 {
-                    auto detectionVector = pHidingCreature->nwnxGet<int>(detectionKey + "PARTY");
-                    if (detectionVector && *detectionVector)
-                        *bSeen = *detectionVector;
-                    else
-                        *bSeen = false;
-
+                    *bSeen = reveals.partyDetectionVector;
                     *bHeard = true;
                     return true;
                 }
             }
 
-            auto reveal = pHidingCreature->nwnxGet<int>(revealKey + Utils::ObjectIDToString(pObserverCreature->m_idSelf));
-            if (reveal && *reveal)
+            for (auto it = reveals.observers.begin(); it != reveals.observers.end(); ++it)
             {
-                pHidingCreature->nwnxRemove(revealKey + Utils::ObjectIDToString(pObserverCreature->m_idSelf)); //remove mapping after first check
-                
-                auto detectionVector = pHidingCreature->nwnxGet<int>(detectionKey + Utils::ObjectIDToString(pObserverCreature->m_idSelf));
-                if (detectionVector && *detectionVector)
-                    *bSeen = *detectionVector;
-                else
-                    *bSeen = false;
-
-                *bHeard = true;
-                return true;
+                if (it->oidObserver == pObserverCreature->m_idSelf)
+                {
+                    *bSeen = it->detectionVector;
+                    *bHeard = true;
+                    reveals.observers.erase(it); //remove mapping after first check
+                    return true;
+                }
             }
         }
     }
     return g_plugin->m_DoStealthDetection->CallOriginal<BOOL>(pObserverCreature, pHidingCreature, bClearLOS, bSeen, bHeard, bTargetHiding);
 }
 
+// Creatures loaded from a save or a TURD copy carry their party reveal in POS, which the POS hook has just restored.
+bool Reveal::HookUUIDLoadFromGff(CNWSUUID* pThis, CResGFF* pRes, CResStruct* pStruct)
+{
+    auto retVal = g_plugin->m_UUIDLoadFromGff->CallOriginal<bool>(pThis, pRes, pStruct);
+    if (!s_bAnyReveals && pThis->m_parent)
+    {
+        auto partyReveal = pThis->m_parent->nwnxGet<int>(revealKey + "PARTY");
+        s_bAnyReveals = partyReveal && *partyReveal;
+    }
+    return retVal;
+}
 
 ArgumentStack Reveal::RevealTo(ArgumentStack&& args)
 {
@@ -94,9 +167,9 @@ ArgumentStack Reveal::RevealTo(ArgumentStack&& args)
     auto observerID = ScriptAPI::ExtractArgument<ObjectID>(args);
     auto detectionVector = ScriptAPI::ExtractArgument<int>(args);
 
-    auto stealther = Utils::GetGameObject(stealtherID);
-    stealther->nwnxSet(revealKey + Utils::ObjectIDToString(observerID), true); //store stealth to observer reveal map
-    stealther->nwnxSet(detectionKey + Utils::ObjectIDToString(observerID), detectionVector); //store the means through which detection happens
+    if (auto *stealther = Utils::GetGameObject(stealtherID))
+        AddObserverReveal(*s_HiderReveals.Get(stealther), observerID, detectionVector);
+
     return ScriptAPI::Arguments();
 }
 
@@ -106,9 +179,93 @@ ArgumentStack Reveal::SetRevealToParty(ArgumentStack&& args)
     auto revealToPartyState = ScriptAPI::ExtractArgument<int>(args);
     auto detectionVector = ScriptAPI::ExtractArgument<int>(args);
 
-    auto stealther = Utils::GetGameObject(stealtherID);
-    stealther->nwnxSet(revealKey + "PARTY", revealToPartyState, true); //store party reveal state
-    stealther->nwnxSet(detectionKey + "PARTY", detectionVector, true); //store the means through which detection happens
+    if (auto *stealther = Utils::GetGameObject(stealtherID))
+    {
+        auto& reveals = *s_HiderReveals.Get(stealther);
+        reveals.bRevealToParty = revealToPartyState;
+        if (revealToPartyState)
+            s_bAnyReveals = true;
+        reveals.partyDetectionVector = detectionVector;
+        stealther->nwnxSet(revealKey + "PARTY", revealToPartyState, true); //store party reveal state
+        stealther->nwnxSet(detectionKey + "PARTY", detectionVector, true); //store the means through which detection happens
+    }
+    return ScriptAPI::Arguments();
+}
+
+ArgumentStack Reveal::RevealToFaction(ArgumentStack&& args)
+{
+    auto stealtherID = ScriptAPI::ExtractArgument<ObjectID>(args);
+    auto *pFactionMember = Utils::PopCreature(args);
+    auto detectionVector = ScriptAPI::ExtractArgument<int>(args);
+
+    auto *stealther = Utils::GetGameObject(stealtherID);
+    if (stealther && pFactionMember)
+    {
+        if (auto *pFaction = pFactionMember->GetFaction())
+        {
+            auto& reveals = *s_HiderReveals.Get(stealther);
+            for (int32_t i = 0; i < pFaction->m_listFactionMembers.num; i++)
+            {
+                if (pFaction->m_listFactionMembers[i] != stealtherID)
+                    AddObserverReveal(reveals, pFaction->m_listFactionMembers[i], detectionVector);
+            }
+        }
+    }
+    return ScriptAPI::Arguments();
+}
+
+ArgumentStack Reveal::RevealToArea(ArgumentStack&& args)
+{
+    auto stealtherID = ScriptAPI::ExtractArgument<ObjectID>(args);
+    auto *pArea = Utils::PopArea(args);
+    auto detectionVector = ScriptAPI::ExtractArgument<int>(args);
+
+    auto *stealther = Utils::GetGameObject(stealtherID);
+    if (stealther && pArea)
+    {
+        auto& reveals = *s_HiderReveals.Get(stealther);
+        for (int32_t i = 0; i < pArea->m_aGameObjects.num; i++)
+        {
+            auto *pCreature = Utils::AsNWSCreature(Utils::GetGameObject(pArea->m_aGameObjects[i]));
+            if (pCreature && pCreature->m_bPlayerCharacter && pCreature->m_idSelf != stealtherID)
+                AddObserverReveal(reveals, pCreature->m_idSelf, detectionVector);
+        }
+    }
+    return ScriptAPI::Arguments();
+}
+
+ArgumentStack Reveal::ClearReveals(ArgumentStack&& args)
+{
+    auto stealtherID = ScriptAPI::ExtractArgument<ObjectID>(args);
+
+    RemoveObserverReveals(stealtherID, [](CNWSCreature*) { return true; });
+
+    return ScriptAPI::Arguments();
+}
+
+ArgumentStack Reveal::ClearRevealsToFaction(ArgumentStack&& args)
+{
+    auto stealtherID = ScriptAPI::ExtractArgument<ObjectID>(args);
+    auto *pFactionMember = Utils::PopCreature(args);
+
+    if (auto *pFaction = pFactionMember ? pFactionMember->GetFaction() : nullptr)
+    {
+        RemoveObserverReveals(stealtherID,
+            [pFaction](CNWSCreature* pObserver) { return !pObserver || pObserver->GetFaction() == pFaction; });
+    }
+    return ScriptAPI::Arguments();
+}
+
+ArgumentStack Reveal::ClearRevealsToArea(ArgumentStack&& args)
+{
+    auto stealtherID = ScriptAPI::ExtractArgument<ObjectID>(args);
+    auto *pArea = Utils::PopArea(args);
+
+    if (pArea)
+    {
+        RemoveObserverReveals(stealtherID,
+            [pArea](CNWSCreature* pObserver) { return !pObserver || pObserver->GetArea() == pArea; });
+    }
     return ScriptAPI::Arguments();
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "nwnx.hpp"
+
 using ArgumentStack = NWNXLib::ArgumentStack;
 
 namespace Reveal {
@@ -13,11 +14,18 @@ public:
 
 private:
     NWNXLib::Hooks::Hook m_DoStealthDetection;
+    NWNXLib::Hooks::Hook m_UUIDLoadFromGff;
 
     static BOOL HookStealthDetection(CNWSCreature* thisCreature, CNWSCreature* pHidingCreature, BOOL bClearLOS, BOOL* bSeen, BOOL* bHeard, BOOL bTargetHiding);
+    static bool HookUUIDLoadFromGff(CNWSUUID* pThis, CResGFF* pRes, CResStruct* pStruct);
 
     ArgumentStack RevealTo(ArgumentStack&& args);
     ArgumentStack SetRevealToParty(ArgumentStack&& args);
+    ArgumentStack RevealToFaction(ArgumentStack&& args);
+    ArgumentStack RevealToArea(ArgumentStack&& args);
+    ArgumentStack ClearReveals(ArgumentStack&& args);
+    ArgumentStack ClearRevealsToFaction(ArgumentStack&& args);
+    ArgumentStack ClearRevealsToArea(ArgumentStack&& args);
 };
 
 }
@@ -2,31 +2,210 @@
 
 #include "API/CExoDebugInternal.hpp"
 #include "API/CNWSVirtualMachineCommands.hpp"
+#include "API/CServerExoAppInternal.hpp"
+#include "API/CVirtualMachine.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <string_view>
 
 using namespace NWNXLib;
 using namespace NWNXLib::API;
 
+enum Category
+{
+    ServerCategory,
+    ScriptCategory,
+    Category_MAX
+};
+
+static constexpr const char* s_CategoryNames[Category_MAX] = { "SERVER", "SCRIPT" };
+
+// A server log line split into its parts. All views point into the message passed to WriteToLogFile.
+struct LogLine
+{
+    Category category;
+    std::string_view timestamp;
+    std::string_view script;
+    std::string_view message;
+};
+
+// Per category rate limit and sampling. A category forwards at most maxPerSecond lines per second (0 for
+// no limit), and of those only every sampleRate-th line.
+struct CategoryFilter
+{
+    uint32_t maxPerSecond = 0;
+    uint32_t sampleRate = 1;
+    uint32_t lines = 0;
+    uint32_t suppressed = 0;
+    uint64_t sampled = 0;
+    std::chrono::steady_clock::time_point windowStart;
+};
+
+static CategoryFilter GetCategoryFilter(Category category)
+{
+    const std::string name = s_CategoryNames[category];
+    CategoryFilter filter;
+    filter.maxPerSecond = Config::Get<uint32_t>(name + "_LINES_PER_SECOND", 0);
+    filter.sampleRate = std::max(Config::Get<uint32_t>(name + "_SAMPLE_RATE", 1), 1u);
+    return filter;
+}
+
+static std::FILE* OpenStructuredLog()
+{
+    std::FILE* file = nullptr;
+    if (auto path = Config::Get<std::string>("STRUCTURED_LOG"))
+    {
+        file = std::fopen(path->c_str(), "a");
+        if (!file)
+            LOG_ERROR("Unable to open structured log '%s'", *path);
+    }
+    return file;
+}
+
 static bool s_printString;
+static CategoryFilter s_Filters[Category_MAX] = { GetCategoryFilter(ServerCategory), GetCategoryFilter(ScriptCategory) };
+static std::FILE* s_StructuredLog = OpenStructuredLog();
+static bool s_StructuredLogDirty;
+
+static std::string_view Trim(std::string_view s)
+{
+    const auto first = s.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos)
+        return {};
+    const auto last = s.find_last_not_of(" \t\r\n");
+    return s.substr(first, last - first + 1);
+}
+
+static LogLine ParseMessage(CExoString* message)
+{
+    LogLine line = { s_printString ? ScriptCategory : ServerCategory, {}, {}, message->CStr() ? message->CStr() : "" };
+
+    if (s_printString)
+    {
+        auto *pVM = Globals::VirtualMachine();
+        if (pVM && pVM->m_nRecursionLevel >= 0)
+        {
+            auto& script = pVM->m_pVirtualMachineScript[pVM->m_nRecursionLevel];
+            if (!script.m_sScriptName.IsEmpty())
+                line.script = script.m_sScriptName.CStr();
+        }
+    }
+    else
+    {
+        // Split off the auto-added timestamp.
+        auto idxOfBracket = line.message.find_first_of(']');
+        if (idxOfBracket != std::string_view::npos)
+        {
+            line.timestamp = Trim(line.message.substr(0, idxOfBracket));
+            if (!line.timestamp.empty() && line.timestamp.front() == '[')
+                line.timestamp.remove_prefix(1);
+            line.message.remove_prefix(idxOfBracket + 1);
+        }
+    }
+
+    line.message = Trim(line.message);
+    return line;
+}
+
+// Starts a new rate limit window if the current one is over, reporting what it suppressed.
+static void EndExpiredWindow(Category category, std::chrono::steady_clock::time_point now)
+{
+    auto& filter = s_Filters[category];
+    if (now - filter.windowStart < std::chrono::seconds(1))
+        return;
+
+    if (filter.suppressed)
+        LOG_WARNING("(Server) %u %s log lines suppressed by rate limit", filter.suppressed, s_CategoryNames[category]);
+    filter.windowStart = now;
+    filter.lines = 0;
+    filter.suppressed = 0;
+}
 
-inline std::string TrimMessage(CExoString* message)
+static bool ShouldForward(Category category)
 {
-    std::string s = std::string(message->CStr());
+    auto& filter = s_Filters[category];
 
-    if (!s_printString)
+    if (filter.maxPerSecond)
     {
-        // Eat the auto-added timestamp.
-        auto idxOfBracket = s.find_first_of(']');
-        if (idxOfBracket != std::string::npos)
-            s.erase(0, idxOfBracket + 1);
+        EndExpiredWindow(category, std::chrono::steady_clock::now());
+
+        if (filter.lines >= filter.maxPerSecond)
+        {
+            filter.suppressed++;
+            return false;
+        }
+        filter.lines++;
     }
 
-    return String::Trim(s);
+    return filter.sampleRate == 1 || filter.sampled++ % filter.sampleRate == 0;
+}
+
+static void AppendJsonString(std::string& out, std::string_view s)
+{
+    out.push_back('"');
+    for (char c : s)
+    {
+        switch (c)
+        {
+            case '"':  out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            default:
+                if ((unsigned char)c < 0x20)
+                {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out.append(escaped);
+                }
+                else
+                    out.push_back(c);
+        }
+    }
+    out.push_back('"');
+}
+
+// Lines are only buffered here, the main loop hook flushes the file once a second.
+static void WriteStructured(const LogLine& line)
+{
+    // PrintString() lines don't carry a timestamp, give them one in the server log's format.
+    char timestamp[32];
+    auto time = line.timestamp;
+    if (time.empty())
+    {
+        const auto now = std::time(nullptr);
+        tm timeinfo;
+        localtime_r(&now, &timeinfo);
+        time = std::string_view(timestamp, std::strftime(timestamp, sizeof(timestamp), "%a %b %d %H:%M:%S", &timeinfo));
+    }
+
+    static std::string s_line;
+    s_line.assign("{\"source\":");
+    AppendJsonString(s_line, line.category == ScriptCategory ? "script" : "server");
+    s_line.append(",\"time\":");
+    AppendJsonString(s_line, time);
+    s_line.append(",\"script\":");
+    AppendJsonString(s_line, line.script);
+    s_line.append(",\"message\":");
+    AppendJsonString(s_line, line.message);
+    s_line.append("}\n");
+    std::fwrite(s_line.data(), 1, s_line.size(), s_StructuredLog);
+    s_StructuredLogDirty = true;
 }
 
 static Hooks::Hook s_WriteToLogFileHook = Hooks::HookFunction((void*)&CExoDebugInternal::WriteToLogFile,
     +[](CExoDebugInternal *pExoDebugInternal, CExoString* message) -> void
     {
-        LOG_INFO("(Server) %s", TrimMessage(message));
+        const auto line = ParseMessage(message);
+        if (ShouldForward(line.category))
+        {
+            LOG_INFO("(Server) %s", line.message);
+            if (s_StructuredLog)
+                WriteStructured(line);
+        }
         s_WriteToLogFileHook->CallOriginal<void>(pExoDebugInternal, message);
     }, Hooks::Order::VeryEarly);
 
@@ -38,3 +217,27 @@ static Hooks::Hook s_ExecuteCommandPrintStringHook = Hooks::HookFunction((void*)
         s_printString = false;
         return retVal;
     }, Hooks::Order::VeryEarly);
+
+// Once a second: reports lines suppressed in a rate limit window even if no further line ends it, and flushes
+// the structured log.
+static Hooks::Hook s_MainLoopHook = Hooks::HookFunction(&CServerExoAppInternal::MainLoop,
+    +[](CServerExoAppInternal *pServerExoAppInternal) -> int32_t
+    {
+        static auto s_lastTick = std::chrono::steady_clock::now();
+        const auto now = std::chrono::steady_clock::now();
+        if (now - s_lastTick >= std::chrono::seconds(1))
+        {
+            s_lastTick = now;
+            for (auto category : { ServerCategory, ScriptCategory })
+            {
+                if (s_Filters[category].maxPerSecond)
+                    EndExpiredWindow(category, now);
+            }
+            if (s_StructuredLogDirty)
+            {
+                std::fflush(s_StructuredLog);
+                s_StructuredLogDirty = false;
+            }
+        }
+        return s_MainLoopHook->CallOriginal<int32_t>(pServerExoAppInternal);
+    }, Hooks::Order::Late);
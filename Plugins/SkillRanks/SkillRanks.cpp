@@ -4,6 +4,7 @@
 #include "API/CNWSArea.hpp"
 #include "API/CNWSCreature.hpp"
 #include "API/CNWSCreatureStats.hpp"
+#include "API/CNWSEffectListHandler.hpp"
 #include "API/CNWSkill.hpp"
 #include "API/CAppManager.hpp"
 #include "API/CServerExoApp.hpp"
@@ -11,7 +12,6 @@
 #include "API/Globals.hpp"
 #include "API/Functions.hpp"
 #include <cmath>
-#include <list>
 #include <numeric>
 
 using namespace NWNXLib;
@@ -40,6 +40,13 @@ NWNX_PLUGIN_ENTRY Plugin* PluginLoad(Services::ProxyServiceList* services)
 namespace SkillRanks {
 
 static Hooks::Hook s_LoadRulesetInfoHook;
+static Hooks::Hook s_AddFeatHook;
+static Hooks::Hook s_RemoveFeatHook;
+static Hooks::Hook s_OnApplyBonusFeatHook;
+static Hooks::Hook s_OnRemoveBonusFeatHook;
+static Hooks::Hook s_DestroyCreatureHook;
+
+extern "C" void _ZN12CNWSCreatureD1Ev(CNWSCreature*);
 
 SkillRanks::SkillRanks(Services::ProxyServiceList* services)
     : Plugin(services)
@@ -63,6 +70,18 @@ SkillRanks::SkillRanks(Services::ProxyServiceList* services)
 
     s_LoadRulesetInfoHook = Hooks::HookFunction(&CNWRules::LoadRulesetInfo, (void*)&LoadRulesetInfoHook, Hooks::Order::Earliest);
     static auto s_GetSkillRank = Hooks::HookFunction(&CNWSCreatureStats::GetSkillRank, (void*)&GetSkillRankHook, Hooks::Order::Final);
+
+    // Keep the per creature skill tables current
+    s_AddFeatHook = Hooks::HookFunction(&CNWSCreatureStats::AddFeat, &AddFeatHook, Hooks::Order::Late);
+    s_RemoveFeatHook = Hooks::HookFunction(&CNWSCreatureStats::RemoveFeat, &RemoveFeatHook, Hooks::Order::Late);
+    s_OnApplyBonusFeatHook = Hooks::HookFunction(&CNWSEffectListHandler::OnApplyBonusFeat, &OnApplyBonusFeatHook, Hooks::Order::Late);
+    s_OnRemoveBonusFeatHook = Hooks::HookFunction(&CNWSEffectListHandler::OnRemoveBonusFeat, &OnRemoveBonusFeatHook, Hooks::Order::Late);
+    s_DestroyCreatureHook = Hooks::HookFunction(&_ZN12CNWSCreatureD1Ev,
+        +[](CNWSCreature *pThis)
+        {
+            g_plugin->m_creatureSkillTables.erase(pThis->m_idSelf);
+            s_DestroyCreatureHook->CallOriginal<void>(pThis);
+        }, Hooks::Order::Early);
 }
 
 SkillRanks::~SkillRanks()
@@ -74,6 +93,7 @@ void SkillRanks::LoadRulesetInfoHook(CNWRules* pRules)
     s_LoadRulesetInfoHook->CallOriginal<void>(pRules);
 
     g_plugin->m_blindnessMod = pRules->GetRulesetIntEntry(CRULES_HASHEDSTR("BLIND_PENALTY_TO_SKILL_CHECK"), 4);
+    g_plugin->m_skillFeatGeneration++;
 
     MessageBus::Subscribe("NWNX_SKILLRANK_SIGNAL",
                                  [](const std::vector<std::string>& message)
@@ -82,6 +102,7 @@ void SkillRanks::LoadRulesetInfoHook(CNWRules* pRules)
                                      auto nRace = std::stoi(message[1]);
                                      auto nMod = std::stoi(message[2]);
                                      g_plugin->m_skillRaceMod[nSkill][nRace] = nMod;
+                                     g_plugin->m_skillFeatGeneration++;
                                  });
 
     for (int featId = 0; featId < pRules->m_nNumFeats; featId++)
@@ -542,6 +563,129 @@ void SkillRanks::LoadRulesetInfoHook(CNWRules* pRules)
     }
 }
 
+SkillRanks::CreatureSkillSignature SkillRanks::GetCreatureSkillSignature(CNWSCreatureStats* pStats)
+{
+    CreatureSkillSignature signature;
+    signature.nNumFeats = pStats->m_lstFeats.num;
+    signature.nNumBonusFeats = pStats->m_lstBonusFeats.num;
+    signature.nRace = pStats->m_nRace;
+    for (auto i : {0, 1, 2})
+    {
+        signature.nClass[i] = pStats->GetClass(i);
+        signature.nClassLevel[i] = pStats->GetClassLevel(i, false);
+    }
+    return signature;
+}
+
+void SkillRanks::BuildCreatureSkillTable(CNWSCreatureStats* pStats, CreatureSkillTable& table)
+{
+    const auto numSkills = Globals::Rules()->m_nNumSkills;
+
+    table.nStaticModifier.assign(numSkills, 0);
+    table.nFlags.assign(numSkills, 0);
+    table.nSituationalOffset.assign(numSkills + 1, 0);
+    table.situationalFeats.clear();
+
+    for (int nSkill = 0; nSkill < numSkills; nSkill++)
+    {
+        table.nSituationalOffset[nSkill] = table.situationalFeats.size();
+
+        // Add any racial modifiers broadcasted from the Race plugin
+        auto raceMods = g_plugin->m_skillRaceMod.find(nSkill);
+        if (raceMods != g_plugin->m_skillRaceMod.end())
+        {
+            auto raceMod = raceMods->second.find(pStats->m_nRace);
+            if (raceMod != raceMods->second.end())
+                table.nStaticModifier[nSkill] += raceMod->second;
+        }
+
+        auto skillFeats = g_plugin->m_skillFeatMap.find(nSkill);
+        if (skillFeats == g_plugin->m_skillFeatMap.end())
+            continue;
+
+        for (auto& it : skillFeats->second)
+        {
+            if (!pStats->HasFeat(it.first))
+                continue;
+
+            const auto& skillFeat = it.second;
+            if (skillFeat.bBypassArmorCheckPenalty)
+                table.nFlags[nSkill] |= CreatureSkillTable::BypassArmorCheckPenalty;
+            if (skillFeat.nKeyAbilityMask)
+                table.nFlags[nSkill] |= CreatureSkillTable::OverrideKeyAbility;
+
+            int32_t nModifier = skillFeat.nModifier;
+            if (skillFeat.bitsetClasses.any())
+            {
+                for (auto i : {0, 1, 2})
+                {
+                    uint8_t playerClass = pStats->GetClass(i);
+                    if (playerClass != Constants::ClassType::Invalid && skillFeat.bitsetClasses.test(playerClass))
+                    {
+                        nModifier += int32_t(pStats->GetClassLevel(i, false) * skillFeat.fClassLevelMod);
+                    }
+                }
+            }
+
+            if (skillFeat.nKeyAbilityMask || skillFeat.nAreaFlagsRequired || skillFeat.nAreaFlagsForbidden || skillFeat.nDayOrNight)
+            {
+                table.situationalFeats.push_back({nModifier, skillFeat.nKeyAbilityMask,
+                                                  skillFeat.nAreaFlagsRequired, skillFeat.nAreaFlagsForbidden, skillFeat.nDayOrNight});
+            }
+            else
+            {
+                table.nStaticModifier[nSkill] += nModifier;
+            }
+        }
+    }
+    table.nSituationalOffset[numSkills] = table.situationalFeats.size();
+}
+
+const SkillRanks::CreatureSkillTable& SkillRanks::GetCreatureSkillTable(CNWSCreatureStats* pStats)
+{
+    auto& table = g_plugin->m_creatureSkillTables[pStats->m_pBaseCreature->m_idSelf];
+    auto signature = GetCreatureSkillSignature(pStats);
+    if (table.nGeneration != g_plugin->m_skillFeatGeneration || !(table.signature == signature))
+    {
+        table.nGeneration = g_plugin->m_skillFeatGeneration;
+        table.signature = signature;
+        BuildCreatureSkillTable(pStats, table);
+    }
+    return table;
+}
+
+void SkillRanks::InvalidateCreatureSkillTable(CNWSCreature* pCreature)
+{
+    if (pCreature)
+        g_plugin->m_creatureSkillTables.erase(pCreature->m_idSelf);
+}
+
+void SkillRanks::AddFeatHook(CNWSCreatureStats* pStats, uint16_t nFeat)
+{
+    s_AddFeatHook->CallOriginal<void>(pStats, nFeat);
+    InvalidateCreatureSkillTable(pStats->m_pBaseCreature);
+}
+
+void SkillRanks::RemoveFeatHook(CNWSCreatureStats* pStats, uint16_t nFeat)
+{
+    s_RemoveFeatHook->CallOriginal<void>(pStats, nFeat);
+    InvalidateCreatureSkillTable(pStats->m_pBaseCreature);
+}
+
+int32_t SkillRanks::OnApplyBonusFeatHook(CNWSEffectListHandler* pThis, CNWSObject* pObject, CGameEffect* pEffect, int32_t bLoadingGame)
+{
+    auto retVal = s_OnApplyBonusFeatHook->CallOriginal<int32_t>(pThis, pObject, pEffect, bLoadingGame);
+    InvalidateCreatureSkillTable(Utils::AsNWSCreature(pObject));
+    return retVal;
+}
+
+int32_t SkillRanks::OnRemoveBonusFeatHook(CNWSEffectListHandler* pThis, CNWSObject* pObject, CGameEffect* pEffect)
+{
+    auto retVal = s_OnRemoveBonusFeatHook->CallOriginal<int32_t>(pThis, pObject, pEffect);
+    InvalidateCreatureSkillTable(Utils::AsNWSCreature(pObject));
+    return retVal;
+}
+
 char SkillRanks::GetSkillRankHook(CNWSCreatureStats* thisPtr, uint8_t nSkill, CNWSObject* pVersus, int32_t bBaseOnly)
 {
     if (nSkill >= Globals::Rules()->m_nNumSkills)
@@ -559,113 +703,95 @@ char SkillRanks::GetSkillRankHook(CNWSCreatureStats* thisPtr, uint8_t nSkill, CN
 
     int32_t retVal = baseRank + thisPtr->m_pBaseCreature->GetTotalEffectBonus(5, pVersus, 0, 0, 0, 0, nSkill, -1, 0);
 
-    // Add any racial modifiers broadcasted from the Race plugin
-    retVal += g_plugin->m_skillRaceMod[nSkill][thisPtr->m_nRace];
+    // Racial modifiers and skill feats without any conditions are precomputed
+    const auto& table = GetCreatureSkillTable(thisPtr);
+    retVal += table.nStaticModifier[nSkill];
+
+    bool bHasOverrideKeyAbilityFeat = table.nFlags[nSkill] & CreatureSkillTable::OverrideKeyAbility;
+    bool bHasBypassArmorCheckPenaltyFeat = table.nFlags[nSkill] & CreatureSkillTable::BypassArmorCheckPenalty;
 
     auto *pArea = Globals::AppManager()->m_pServerExoApp->GetAreaByGameObjectID(thisPtr->m_pBaseCreature->m_oidArea);
 
-    // Now check if the creature has any skill impacting feats
-    bool bHasOverrideKeyAbilityFeat = false;
-    bool bHasBypassArmorCheckPenaltyFeat = false;
-    for (auto it: g_plugin->m_skillFeatMap[nSkill])
+    for (auto i = table.nSituationalOffset[nSkill]; i < table.nSituationalOffset[nSkill + 1]; i++)
     {
-        uint32_t featId = it.first;
-        if (thisPtr->HasFeat(featId))
-        {
-            auto skillFeat = it.second;
+        const auto& skillFeat = table.situationalFeats[i];
 
-            if (skillFeat.bBypassArmorCheckPenalty)
-                bHasBypassArmorCheckPenaltyFeat = true;
-
-            if (skillFeat.nKeyAbilityMask)
+        if (skillFeat.nKeyAbilityMask)
+        {
+            int8_t mods[6];
+            int32_t numMods = 0;
+            if ((skillFeat.nKeyAbilityMask & strMask) == strMask)
+                mods[numMods++] = thisPtr->m_nStrengthModifier;
+            if ((skillFeat.nKeyAbilityMask & conMask) == conMask)
+                mods[numMods++] = thisPtr->m_nConstitutionModifier;
+            if ((skillFeat.nKeyAbilityMask & dexMask) == dexMask)
+            {
+                int8_t dexMod = thisPtr->GetDEXMod(0);
+                if (thisPtr->m_pBaseCreature->GetBlind())
+                    dexMod -= g_plugin->m_blindnessMod;
+                mods[numMods++] = dexMod;
+            }
+            if ((skillFeat.nKeyAbilityMask & intMask) == intMask)
+                mods[numMods++] = thisPtr->m_nIntelligenceModifier;
+            if ((skillFeat.nKeyAbilityMask & wisMask) == wisMask)
+                mods[numMods++] = thisPtr->m_nWisdomModifier;
+            if ((skillFeat.nKeyAbilityMask & chaMask) == chaMask)
+                mods[numMods++] = thisPtr->m_nCharismaModifier;
+
+            if (numMods > 0)
             {
-                bHasOverrideKeyAbilityFeat = true;
-                std::list<int8_t> mods = {};
-                if ((skillFeat.nKeyAbilityMask & strMask) == strMask)
-                    mods.push_front(thisPtr->m_nStrengthModifier);
-                if ((skillFeat.nKeyAbilityMask & conMask) == conMask)
-                    mods.push_front(thisPtr->m_nConstitutionModifier);
-                if ((skillFeat.nKeyAbilityMask & dexMask) == dexMask)
-                {
-                    int8_t dexMod = thisPtr->GetDEXMod(0);
-                    if (thisPtr->m_pBaseCreature->GetBlind())
-                        dexMod -= g_plugin->m_blindnessMod;
-                    mods.push_front(dexMod);
-                }
-                if ((skillFeat.nKeyAbilityMask & intMask) == intMask)
-                    mods.push_front(thisPtr->m_nIntelligenceModifier);
-                if ((skillFeat.nKeyAbilityMask & wisMask) == wisMask)
-                    mods.push_front(thisPtr->m_nWisdomModifier);
-                if ((skillFeat.nKeyAbilityMask & chaMask) == chaMask)
-                    mods.push_front(thisPtr->m_nCharismaModifier);
                 if ((skillFeat.nKeyAbilityMask & minMask) == minMask)
                 {
-                    retVal += *std::min_element(mods.begin(), mods.end());
+                    retVal += *std::min_element(mods, mods + numMods);
                 }
                 else if ((skillFeat.nKeyAbilityMask & maxMask) == maxMask)
                 {
-                    retVal += *std::max_element(mods.begin(), mods.end());
+                    retVal += *std::max_element(mods, mods + numMods);
                 }
                 else if ((skillFeat.nKeyAbilityMask & avgMask) == avgMask)
                 {
-                    retVal += std::floor(std::accumulate(mods.begin(), mods.end(), 0.0) / mods.size());
+                    retVal += std::floor(std::accumulate(mods, mods + numMods, 0.0) / numMods);
                 }
                 else if ((skillFeat.nKeyAbilityMask & sumMask) == sumMask)
                 {
-                    retVal += std::accumulate(mods.begin(), mods.end(), 0);
+                    retVal += std::accumulate(mods, mods + numMods, 0);
                 }
             }
+        }
 
-            bool bAreaCheckRequired = false;
-            bool bAreaCheckPassed = false;
-            bool bDayNightCheckRequired = false;
-            bool bDayNightCheckPassed = false;
+        bool bAreaCheckRequired = false;
+        bool bAreaCheckPassed = false;
+        bool bDayNightCheckRequired = false;
+        bool bDayNightCheckPassed = false;
 
-            if (skillFeat.nAreaFlagsRequired || skillFeat.nAreaFlagsForbidden)
+        if (skillFeat.nAreaFlagsRequired || skillFeat.nAreaFlagsForbidden)
+        {
+            bAreaCheckRequired = true;
+            if (pArea &&
+                (!skillFeat.nAreaFlagsRequired ||
+                 (pArea->m_nFlags & skillFeat.nAreaFlagsRequired) == skillFeat.nAreaFlagsRequired) &&
+                (!skillFeat.nAreaFlagsForbidden ||
+                 !(pArea->m_nFlags & skillFeat.nAreaFlagsForbidden)))
             {
-                bAreaCheckRequired = true;
-                if (pArea &&
-                    (!skillFeat.nAreaFlagsRequired ||
-                     (skillFeat.nAreaFlagsRequired &&
-                     (pArea->m_nFlags & skillFeat.nAreaFlagsRequired) == skillFeat.nAreaFlagsRequired)) &&
-                    (!skillFeat.nAreaFlagsForbidden ||
-                     (skillFeat.nAreaFlagsForbidden && !(pArea->m_nFlags & skillFeat.nAreaFlagsForbidden))))
-
-                {
-                    bAreaCheckPassed = true;
-                }
+                bAreaCheckPassed = true;
             }
-            if (pArea && skillFeat.nDayOrNight > 0)
+        }
+        if (pArea && skillFeat.nDayOrNight > 0)
+        {
+            bDayNightCheckRequired = true;
+            auto currentHour = Utils::GetModule()->m_nCurrentHour;
+            auto isDay = currentHour >= Utils::GetModule()->m_nDawnHour && currentHour <= Utils::GetModule()->m_nDuskHour;
+            if ((skillFeat.nDayOrNight == 1 && !pArea->GetIsNight() && isDay) ||
+                (skillFeat.nDayOrNight == 2 && (pArea->GetIsNight() || !isDay)))
             {
-                bDayNightCheckRequired = true;
-                auto currentHour = Utils::GetModule()->m_nCurrentHour;
-                auto isDay = currentHour >= Utils::GetModule()->m_nDawnHour && currentHour <= Utils::GetModule()->m_nDuskHour;
-                if ((skillFeat.nDayOrNight == 1 && !pArea->GetIsNight() && isDay) ||
-                    (skillFeat.nDayOrNight == 2 && (pArea->GetIsNight() || !isDay)))
-                {
-                    bDayNightCheckPassed = true;
-                }
+                bDayNightCheckPassed = true;
             }
+        }
 
-            if ((!bAreaCheckRequired || (bAreaCheckRequired && bAreaCheckPassed)) &&
-                (!bDayNightCheckRequired || (bDayNightCheckRequired && bDayNightCheckPassed)))
-            {
-                // All feat checks have passed, add our modifier
-                retVal += skillFeat.nModifier;
-
-                // Add any class level modifiers too
-                if (skillFeat.bitsetClasses.any())
-                {
-                    for (auto i : {0, 1, 2})
-                    {
-                        uint8_t playerClass = thisPtr->GetClass(i);
-                        if (playerClass != Constants::ClassType::Invalid && skillFeat.bitsetClasses.test(playerClass))
-                        {
-                            retVal += int32_t(thisPtr->GetClassLevel(i, false) * skillFeat.fClassLevelMod);
-                        }
-                    }
-                }
-            }
+        if ((!bAreaCheckRequired || bAreaCheckPassed) && (!bDayNightCheckRequired || bDayNightCheckPassed))
+        {
+            // All feat checks have passed, add our modifier
+            retVal += skillFeat.nModifier;
         }
     }
 
@@ -850,6 +976,7 @@ ArgumentStack SkillRanks::SetSkillFeat(ArgumentStack&& args)
     else
     {
         g_plugin->m_skillFeatMap[skillId][featId] = skillFeats;
+        g_plugin->m_skillFeatGeneration++;
     }
 
     return ScriptAPI::Arguments();
@@ -873,6 +1000,7 @@ ArgumentStack SkillRanks::SetSkillFeatFocusModifier(ArgumentStack&& args)
             }
         }
     }
+    g_plugin->m_skillFeatGeneration++;
 
     return ScriptAPI::Arguments();
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "nwnx.hpp"
+#include <algorithm>
 #include <bitset>
 #include <map>
 
@@ -27,6 +28,10 @@ private:
 
     static void LoadRulesetInfoHook(CNWRules*);
     static char GetSkillRankHook(CNWSCreatureStats*, uint8_t, CNWSObject*, int32_t);
+    static void AddFeatHook(CNWSCreatureStats*, uint16_t);
+    static void RemoveFeatHook(CNWSCreatureStats*, uint16_t);
+    static int32_t OnApplyBonusFeatHook(CNWSEffectListHandler*, CNWSObject*, CGameEffect*, int32_t);
+    static int32_t OnRemoveBonusFeatHook(CNWSEffectListHandler*, CNWSObject*, CGameEffect*);
 
     uint8_t m_blindnessMod;
 
@@ -42,8 +47,58 @@ private:
         uint16_t nKeyAbilityMask;
     };
 
+    // A skill feat owned by a creature whose modifier depends on the situation or that
+    // overrides the key ability of the skill.
+    struct CreatureSkillFeat {
+        int32_t nModifier; // Includes the class level modifier
+        uint16_t nKeyAbilityMask;
+        uint8_t nAreaFlagsRequired;
+        uint8_t nAreaFlagsForbidden;
+        uint8_t nDayOrNight;
+    };
+
+    // Everything the feat derived modifiers of a creature depend on, other than the skill feat configuration.
+    struct CreatureSkillSignature {
+        int32_t nNumFeats = -1;
+        int32_t nNumBonusFeats = -1;
+        uint16_t nRace = 0;
+        uint8_t nClass[3] = {};
+        uint8_t nClassLevel[3] = {};
+
+        bool operator==(const CreatureSkillSignature& other) const
+        {
+            return nNumFeats == other.nNumFeats && nNumBonusFeats == other.nNumBonusFeats && nRace == other.nRace
+                && std::equal(nClass, nClass + 3, other.nClass) && std::equal(nClassLevel, nClassLevel + 3, other.nClassLevel);
+        }
+    };
+
+    // Precomputed feat derived skill modifiers for a single creature. Modifiers that always apply
+    // are summed into nStaticModifier, everything else lives in situationalFeats.
+    struct CreatureSkillTable {
+        enum Flags : uint8_t {
+            BypassArmorCheckPenalty = (1u << 0u),
+            OverrideKeyAbility      = (1u << 1u),
+        };
+
+        uint32_t nGeneration = ~0u;
+        CreatureSkillSignature signature;
+        std::vector<int32_t> nStaticModifier;
+        std::vector<uint8_t> nFlags;
+        std::vector<uint32_t> nSituationalOffset;
+        std::vector<CreatureSkillFeat> situationalFeats;
+    };
+
+    static const CreatureSkillTable& GetCreatureSkillTable(CNWSCreatureStats*);
+    static void BuildCreatureSkillTable(CNWSCreatureStats*, CreatureSkillTable&);
+    static CreatureSkillSignature GetCreatureSkillSignature(CNWSCreatureStats*);
+    static void InvalidateCreatureSkillTable(CNWSCreature*);
+
     std::unordered_map<uint8_t, std::unordered_map<uint16_t, SkillFeats>> m_skillFeatMap;
     std::unordered_map<uint16_t, std::unordered_map<uint8_t, int32_t>> m_skillRaceMod;
+
+    // Bumped whenever the skill feat or racial modifier configuration changes.
+    uint32_t m_skillFeatGeneration = 0;
+    std::unordered_map<ObjectID, CreatureSkillTable> m_creatureSkillTables;
 };
 
 }
@@ -1,8 +1,27 @@
 #include "ThreadWatchdog.hpp"
 #include "API/Functions.hpp"
+#include "API/CExoBase.hpp"
 #include "API/CServerExoAppInternal.hpp"
+#include "API/CVirtualMachine.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <pthread.h>
+#include <unordered_map>
 
 using namespace NWNXLib;
+using namespace NWNXLib::API;
 
 static ThreadWatchdog::ThreadWatchdog* g_plugin;
 
@@ -22,6 +41,210 @@ static uint32_t s_watchdogPeriod;
 static uint32_t s_watchdogKillThreshold;
 static Hooks::Hook s_MainLoopHook;
 
+// Once the main loop has been stalled for s_sampleThreshold milliseconds, the sampler thread signals the
+// main thread s_sampleFrequency times a second. The signal handler captures the stack and the running
+// script, the sampler thread aggregates them and writes a folded stack report when the stall ends.
+static constexpr int SAMPLE_SIGNAL = SIGPROF;
+static constexpr int32_t SAMPLE_MAX_FRAMES = 64;
+static constexpr int32_t SAMPLE_SKIP_FRAMES = 2; // The signal handler and the signal trampoline.
+
+struct Sample
+{
+    uint32_t request; // The s_sampleRequest the handler answered.
+    void* frames[SAMPLE_MAX_FRAMES];
+    int32_t frameCount;
+    char script[64];
+    int32_t scriptDepth;
+};
+
+struct StallReport
+{
+    std::chrono::steady_clock::time_point start;
+    uint32_t samples = 0;
+    std::map<std::pair<std::string, std::vector<void*>>, uint32_t> stacks;
+};
+
+static uint32_t s_sampleThreshold;
+static uint32_t s_sampleFrequency;
+static std::string s_reportDirectory;
+static pthread_t s_mainThread;
+// The handler can still be running when the sampler gives up on it, so s_sample is a seqlock: the
+// sequence is odd while the handler writes, and the sampler discards copies that raced with a write.
+static Sample s_sample;
+static std::atomic<uint32_t> s_sampleSequence;
+static std::atomic<uint32_t> s_sampleRequest;
+static std::mutex s_reportMutex;
+static std::optional<StallReport> s_report;
+
+static void SampleSignalHandler(int)
+{
+    const int savedErrno = errno;
+
+    const uint32_t sequence = s_sampleSequence.load(std::memory_order_relaxed);
+    s_sampleSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    s_sample.request = s_sampleRequest.load(std::memory_order_relaxed);
+    s_sample.frameCount = backtrace(s_sample.frames, SAMPLE_MAX_FRAMES);
+    s_sample.script[0] = '\0';
+    s_sample.scriptDepth = 0;
+
+    auto *pVM = Globals::VirtualMachine();
+    if (pVM && pVM->m_nRecursionLevel >= 0 && pVM->m_nRecursionLevel < (int32_t)std::size(pVM->m_pVirtualMachineScript))
+    {
+        s_sample.scriptDepth = pVM->m_nRecursionLevel + 1;
+        const char *name = pVM->m_pVirtualMachineScript[pVM->m_nRecursionLevel].m_sScriptName.CStr();
+        size_t i = 0;
+        for (; name[i] && i < sizeof(s_sample.script) - 1; i++)
+            s_sample.script[i] = name[i];
+        s_sample.script[i] = '\0';
+    }
+
+    s_sampleSequence.store(sequence + 2, std::memory_order_release);
+    errno = savedErrno;
+}
+
+// Copies the handler's answer to the given request, if it's there and wasn't being written.
+static bool ReadSample(uint32_t request, Sample& sample)
+{
+    const uint32_t sequence = s_sampleSequence.load(std::memory_order_acquire);
+    if (sequence & 1)
+        return false;
+
+    std::memcpy(&sample, &s_sample, sizeof(sample));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return s_sampleSequence.load(std::memory_order_relaxed) == sequence && sample.request == request;
+}
+
+static std::string Symbolise(void *address)
+{
+    // Return addresses point past the call, look up the call itself.
+    void *callSite = (char*)address - 1;
+    Dl_info info;
+    if (dladdr(callSite, &info))
+    {
+        if (info.dli_sname)
+        {
+            int status;
+            std::unique_ptr<char, decltype(&std::free)> demangled(abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status), &std::free);
+            return status == 0 ? demangled.get() : info.dli_sname;
+        }
+        if (info.dli_fname)
+        {
+            std::string module = info.dli_fname;
+            char offset[32];
+            std::snprintf(offset, sizeof(offset), "+0x%zx", (size_t)((char*)callSite - (char*)info.dli_fbase));
+            return module.substr(module.find_last_of('/') + 1) + offset;
+        }
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%p", address);
+    return buffer;
+}
+
+static void AddSample(std::chrono::steady_clock::time_point stallStart, const Sample& sample)
+{
+    std::lock_guard<std::mutex> lock(s_reportMutex);
+    if (!s_report)
+    {
+        LOG_WARNING("ThreadWatchdog: main loop stalled for %u ms, sampling its stack at %u Hz.", s_sampleThreshold, s_sampleFrequency);
+        s_report.emplace();
+        s_report->start = stallStart;
+    }
+
+    std::string script = "nwscript:none";
+    if (sample.scriptDepth)
+        script = "nwscript:" + std::string(sample.script) + " (depth " + std::to_string(sample.scriptDepth) + ")";
+
+    const int32_t frameCount = std::clamp(sample.frameCount, SAMPLE_SKIP_FRAMES, SAMPLE_MAX_FRAMES);
+    s_report->stacks[{std::move(script), std::vector<void*>(sample.frames + SAMPLE_SKIP_FRAMES, sample.frames + frameCount)}]++;
+    s_report->samples++;
+}
+
+// Writes the samples of the current stall, if any, in the folded stack format flamegraph.pl and
+// speedscope read. Each stack starts with the script that was running.
+static void WriteStallReport()
+{
+    std::lock_guard<std::mutex> lock(s_reportMutex);
+    if (!s_report)
+        return;
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - s_report->start).count();
+    const std::string directory = s_reportDirectory.empty() ? Globals::ExoBase()->m_sUserDirectory.CStr() : s_reportDirectory;
+    const std::string path = directory + "/stall_" + std::to_string(std::time(nullptr)) + ".folded";
+
+    if (auto *file = std::fopen(path.c_str(), "w"))
+    {
+        std::unordered_map<void*, std::string> symbols;
+        for (const auto& [stack, count] : s_report->stacks)
+        {
+            std::fputs(stack.first.c_str(), file);
+            // backtrace() is leaf first, folded stacks are root first.
+            for (auto it = stack.second.rbegin(); it != stack.second.rend(); ++it)
+            {
+                auto& symbol = symbols[*it];
+                if (symbol.empty())
+                    symbol = Symbolise(*it);
+                std::fputc(';', file);
+                std::fputs(symbol.c_str(), file);
+            }
+            std::fprintf(file, " %u\n", count);
+        }
+        std::fclose(file);
+        LOG_WARNING("ThreadWatchdog: stall of %.1f seconds, %u stack samples written to '%s'.", seconds, s_report->samples, path);
+    }
+    else
+    {
+        LOG_ERROR("ThreadWatchdog: unable to write stall report '%s'.", path);
+    }
+
+    s_report.reset();
+}
+
+static void RunSampler()
+{
+    const auto interval = std::chrono::microseconds(1000000 / s_sampleFrequency);
+    const auto threshold = std::chrono::milliseconds(s_sampleThreshold);
+
+    uint64_t lastCounter = s_mainThreadCounter;
+    auto lastProgress = std::chrono::steady_clock::now();
+    std::optional<std::chrono::steady_clock::time_point> pendingSince;
+    uint32_t request = 0;
+    Sample sample;
+
+    while (!g_exit)
+    {
+        std::this_thread::sleep_for(interval);
+        const auto now = std::chrono::steady_clock::now();
+
+        if (pendingSince && ReadSample(request, sample))
+        {
+            AddSample(lastProgress, sample);
+            pendingSince.reset();
+        }
+        else if (pendingSince && now - *pendingSince > std::chrono::seconds(1))
+        {
+            // The main thread has the signal blocked, try again.
+            pendingSince.reset();
+        }
+
+        if (s_mainThreadCounter != lastCounter)
+        {
+            lastCounter = s_mainThreadCounter;
+            lastProgress = now;
+            WriteStallReport();
+        }
+        else if (!pendingSince && now - lastProgress >= threshold)
+        {
+            s_sampleRequest.store(++request, std::memory_order_release);
+            if (pthread_kill(s_mainThread, SAMPLE_SIGNAL) == 0)
+                pendingSince = now;
+        }
+    }
+
+    WriteStallReport();
+}
+
 ThreadWatchdog::ThreadWatchdog(Services::ProxyServiceList* services)
     : Plugin(services)
 {
@@ -39,16 +262,48 @@ ThreadWatchdog::ThreadWatchdog(Services::ProxyServiceList* services)
     s_watchdogPeriod = Config::Get<uint32_t>("PERIOD", 15);
     // Default to effectively infinite
     s_watchdogKillThreshold = Config::Get<uint32_t>("KILL_THRESHOLD", ~0);
+
+    s_sampleThreshold = Config::Get<uint32_t>("SAMPLE_THRESHOLD", 0);
+    s_sampleFrequency = std::clamp(Config::Get<uint32_t>("SAMPLE_FREQUENCY", 100), 1u, 1000u);
+    s_reportDirectory = Config::Get<std::string>("STALL_REPORT_DIR", "");
+
+    if (s_sampleThreshold)
+    {
+        // backtrace() loads libgcc on first use, which is not safe from a signal handler.
+        void* frames[1];
+        backtrace(frames, 1);
+
+        struct sigaction action = {};
+        action.sa_handler = &SampleSignalHandler;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        sigaction(SAMPLE_SIGNAL, &action, nullptr);
+    }
+
+    // Stalls the main thread with a busy loop, to test the watchdog and the stall sampling.
+    Commands::Register("stall", [](std::string&, std::string& args)
+    {
+        const auto milliseconds = String::FromString<uint32_t>(args).value_or(1000);
+        LOG_INFO("Stalling the main thread for %u ms.", milliseconds);
+        const auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+        while (std::chrono::steady_clock::now() < end) {}
+    });
 }
 
 ThreadWatchdog::~ThreadWatchdog()
 {
     g_exit = true;
+    Commands::Unregister("stall");
 
     if (m_watchdog)
     {
         m_watchdog->join();
     }
+
+    if (m_sampler)
+    {
+        m_sampler->join();
+    }
 }
 
 int32_t ThreadWatchdog::MainLoopUpdate(CServerExoAppInternal *thisPtr)
@@ -59,6 +314,12 @@ int32_t ThreadWatchdog::MainLoopUpdate(CServerExoAppInternal *thisPtr)
     {
         g_exit = false;
 
+        if (s_sampleThreshold)
+        {
+            s_mainThread = pthread_self();
+            g_plugin->m_sampler = std::make_unique<std::thread>(&RunSampler);
+        }
+
         g_plugin->m_watchdog = std::make_unique<std::thread>([]()
         {
             static uint32_t killThreshold = s_watchdogKillThreshold;
@@ -95,6 +356,7 @@ int32_t ThreadWatchdog::MainLoopUpdate(CServerExoAppInternal *thisPtr)
 
                         if (--killThreshold == 0)
                         {
+                            WriteStallReport();
                             LOG_FATAL("ThreadWatchdog has detected %d successive LongStalls, and will kill the server, per configuration", s_watchdogKillThreshold);
                         }
                     }
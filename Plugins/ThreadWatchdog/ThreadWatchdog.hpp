@@ -15,6 +15,7 @@ public:
 private:
     static int32_t MainLoopUpdate(CServerExoAppInternal*);
     std::unique_ptr<std::thread> m_watchdog;
+    std::unique_ptr<std::thread> m_sampler;
 };
 
 }
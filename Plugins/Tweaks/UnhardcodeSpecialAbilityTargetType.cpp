@@ -52,7 +52,10 @@ void UnhardcodeSpecialAbilityTargetType()
                 {
                     uint16_t nSubFeat = 0;
                     if (nId == Constants::Feat::CalledShot)
-                        nSubFeat = rand() % 2 ? 65001 : 65000;
+                    {
+                        static auto& rng = Random::GetStream("Tweaks!CalledShot");
+                        nSubFeat = rng.Range(2) ? 65001 : 65000;
+                    }
                     pThis->UseFeat(nId, nSubFeat, oidTarget, oidTargetArea);
                     break;
                 }
@@ -5,6 +5,7 @@
 #include "API/CNWRules.hpp"
 #include "API/CTwoDimArrays.hpp"
 #include "API/CExoResMan.hpp"
+#include "API/CExoKeyTable.hpp"
 #include "API/CExoStringList.hpp"
 #include "API/CVirtualMachine.hpp"
 #include "API/CTlkTable.hpp"
@@ -36,8 +37,19 @@
 using namespace NWNXLib;
 using namespace NWNXLib::API;
 
-static size_t s_resRefIndex;
-static std::vector<std::string> s_listResRefs;
+// Sorted resrefs per type, built from ResMan on first use and dropped whenever a resource container is
+// added, removed or updated. Cursors keep the list they iterate alive.
+using ResRefList = std::shared_ptr<const std::vector<std::string>>;
+static std::unordered_map<uint32_t, ResRefList> s_resRefCatalogue;
+
+struct ResRefCursor
+{
+    ResRefList resRefs;
+    size_t index = 0;
+    size_t end = 0;
+    std::function<bool(const std::string&)> filter;
+};
+static ResRefCursor s_resRefCursor;
 static std::unique_ptr<CScriptCompiler> s_scriptCompiler;
 static std::unordered_map<std::string, std::string> s_serverConsoleCommandMap;
 
@@ -165,7 +177,7 @@ NWNX_EXPORT ArgumentStack StripColors(ArgumentStack&& args)
 {
     const auto s = args.extract<std::string>();
 
-    std::regex color_codes("<c.+?(?=>)>|<\\/c>");
+    static const std::regex color_codes("<c.+?(?=>)>|<\\/c>");
     std::string retVal = std::regex_replace(s, color_codes, "");
 
     return retVal;
@@ -233,55 +245,153 @@ NWNX_EXPORT ArgumentStack EncodeStringForURL(ArgumentStack&& args)
     return result;
 }
 
-NWNX_EXPORT ArgumentStack GetFirstResRef(ArgumentStack&& args)
+static void InitResRefCatalogueHooks()
 {
-    std::string retVal;
-
-    const auto resRefType = args.extract<int32_t>();
-    const auto regexFilter = args.extract<std::string>();
-    const auto bModuleOnly = args.extract<int32_t>();
+    static auto Invalidate = []() { s_resRefCatalogue.clear(); };
 
-    s_resRefIndex = 0;
-    s_listResRefs.clear();
-    s_listResRefs.reserve(25);
+    static Hooks::Hook s_AddKeyTableHook = Hooks::HookFunction(&CExoResMan::AddKeyTable,
+        +[](CExoResMan *pThis, uint32_t nPriority, const CExoString& sName, uint32_t nTableType, BOOL bDetectChanges, const ResourceAccessCheckFn accessCheck) -> BOOL
+        {
+            Invalidate();
+            return s_AddKeyTableHook->CallOriginal<BOOL>(pThis, nPriority, sName, nTableType, bDetectChanges, accessCheck);
+        }, Hooks::Order::Earliest);
+    static Hooks::Hook s_RemoveKeyTableHook = Hooks::HookFunction(&CExoResMan::RemoveKeyTable,
+        +[](CExoResMan *pThis, const CExoString& sName, uint32_t nTableType, BOOL bEmitWarningOnFailure) -> BOOL
+        {
+            Invalidate();
+            return s_RemoveKeyTableHook->CallOriginal<BOOL>(pThis, sName, nTableType, bEmitWarningOnFailure);
+        }, Hooks::Order::Earliest);
+    static Hooks::Hook s_UpdateKeyTableHook = Hooks::HookFunction(&CExoResMan::UpdateKeyTable,
+        +[](CExoResMan *pThis, const CExoString& sName, uint32_t nTableType) -> BOOL
+        {
+            Invalidate();
+            return s_UpdateKeyTableHook->CallOriginal<BOOL>(pThis, sName, nTableType);
+        }, Hooks::Order::Earliest);
+}
 
-    CExoStringList *pList = Globals::ExoResMan()->GetResOfType(resRefType, !!bModuleOnly);
+static ResRefList GetResRefsOfType(int32_t type, bool bModuleOnly)
+{
+    InitResRefCatalogueHooks();
 
-    if (pList)
+    auto& resRefs = s_resRefCatalogue[(uint32_t)type << 1 | bModuleOnly];
+    if (!resRefs)
     {
-        std::regex rgx(regexFilter);
-
-        for (int i = 0; i < pList->m_nCount; i++)
+        auto list = std::make_shared<std::vector<std::string>>();
+        if (auto *pList = Globals::ExoResMan()->GetResOfType(type, bModuleOnly))
         {
-            if (regexFilter.empty() || std::regex_match(pList->m_pStrings[i]->CStr(), rgx))
-            {
-                s_listResRefs.emplace_back(pList->m_pStrings[i]->CStr());
-            }
+            list->reserve(pList->m_nCount);
+            for (int i = 0; i < pList->m_nCount; i++)
+                list->emplace_back(pList->m_pStrings[i]->CStr());
+            delete pList;
         }
-
-        delete pList;
+        std::sort(list->begin(), list->end());
+        resRefs = std::move(list);
     }
+    return resRefs;
+}
+
+// Positions the cursor on the resrefs of the given type in [first, last), or from first on if last is empty.
+static void StartResRefCursor(int32_t type, bool bModuleOnly, const std::string& first, const std::string& last,
+                              std::function<bool(const std::string&)> filter = nullptr)
+{
+    auto resRefs = GetResRefsOfType(type, bModuleOnly);
+    s_resRefCursor.index = std::lower_bound(resRefs->begin(), resRefs->end(), first) - resRefs->begin();
+    s_resRefCursor.end = last.empty() ? resRefs->size() : std::lower_bound(resRefs->begin(), resRefs->end(), last) - resRefs->begin();
+    s_resRefCursor.resRefs = std::move(resRefs);
+    s_resRefCursor.filter = std::move(filter);
+}
 
-    if (s_resRefIndex < s_listResRefs.size())
+static std::string NextResRef()
+{
+    auto& cursor = s_resRefCursor;
+    while (cursor.resRefs && cursor.index < cursor.end)
     {
-        retVal = s_listResRefs[s_resRefIndex];
-        s_resRefIndex++;
+        const auto& resRef = (*cursor.resRefs)[cursor.index++];
+        if (!cursor.filter || cursor.filter(resRef))
+            return resRef;
     }
+    cursor.resRefs.reset();
+    return "";
+}
 
-    return retVal;
+// The end of the range of strings starting with prefix.
+static std::string PrefixEnd(std::string prefix)
+{
+    while (!prefix.empty() && (unsigned char)prefix.back() == 0xFF)
+        prefix.pop_back();
+    if (!prefix.empty())
+        prefix.back()++;
+    return prefix;
 }
 
-NWNX_EXPORT ArgumentStack GetNextResRef(ArgumentStack&&)
+NWNX_EXPORT ArgumentStack GetFirstResRef(ArgumentStack&& args)
 {
-    std::string retVal;
+    const auto resRefType = args.extract<int32_t>();
+    const auto regexFilter = args.extract<std::string>();
+    const auto bModuleOnly = args.extract<int32_t>();
 
-    if (s_resRefIndex < s_listResRefs.size())
+    // Filters like "nwnx_.*" only need the resrefs starting with their literal prefix.
+    const auto literal = regexFilter.find_first_not_of("abcdefghijklmnopqrstuvwxyz0123456789_");
+    if (literal != std::string::npos && regexFilter.compare(literal, std::string::npos, ".*") == 0)
+    {
+        const auto prefix = regexFilter.substr(0, literal);
+        StartResRefCursor(resRefType, !!bModuleOnly, prefix, PrefixEnd(prefix));
+    }
+    else if (!regexFilter.empty())
+    {
+        StartResRefCursor(resRefType, !!bModuleOnly, "", "",
+            [rgx = Pattern::Compile(regexFilter)](const std::string& resRef) { return Pattern::Match(rgx, resRef); });
+    }
+    else
     {
-        retVal = s_listResRefs[s_resRefIndex];
-        s_resRefIndex++;
+        StartResRefCursor(resRefType, !!bModuleOnly, "", "");
     }
 
-    return retVal;
+    return NextResRef();
+}
+
+NWNX_EXPORT ArgumentStack GetFirstResRefGlob(ArgumentStack&& args)
+{
+    const auto resRefType = args.extract<int32_t>();
+    const auto glob = args.extract<std::string>();
+    const auto bModuleOnly = args.extract<int32_t>();
+
+    const auto prefix = glob.substr(0, glob.find_first_of("*?"));
+    if (prefix.size() == glob.size())
+        StartResRefCursor(resRefType, !!bModuleOnly, glob, glob + '\0');
+    else
+        StartResRefCursor(resRefType, !!bModuleOnly, prefix, PrefixEnd(prefix),
+            [glob](const std::string& resRef) { return Pattern::Glob(glob, resRef); });
+
+    return NextResRef();
+}
+
+NWNX_EXPORT ArgumentStack GetFirstResRefInRange(ArgumentStack&& args)
+{
+    const auto resRefType = args.extract<int32_t>();
+    const auto first = args.extract<std::string>();
+    const auto last = args.extract<std::string>();
+    const auto bModuleOnly = args.extract<int32_t>();
+
+    StartResRefCursor(resRefType, !!bModuleOnly, first, last.empty() ? "" : last + '\0');
+    return NextResRef();
+}
+
+NWNX_EXPORT ArgumentStack GetNextResRef(ArgumentStack&&)
+{
+    return NextResRef();
+}
+
+NWNX_EXPORT ArgumentStack GetResRefContainer(ArgumentStack&& args)
+{
+    const auto resRef = args.extract<std::string>();
+    const auto resRefType = args.extract<int32_t>();
+
+    CExoKeyTable *pTable = nullptr;
+    CKeyTableEntry *pEntry = nullptr;
+    if (Globals::ExoResMan()->GetKeyEntry(CResRef(resRef), resRefType, &pTable, &pEntry, false) && pTable)
+        return std::string(pTable->m_sName.CStr());
+    return "";
 }
 
 NWNX_EXPORT ArgumentStack GetLastCreatedObject(ArgumentStack&& args)
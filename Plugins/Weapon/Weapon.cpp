@@ -93,15 +93,7 @@ ArgumentStack Weapon::SetWeaponFocusFeat(ArgumentStack&& args)
     CNWBaseItem *pBaseItem = Globals::Rules()->m_pBaseItemArray->GetBaseItem(w_bitem);
       ASSERT_OR_THROW(pBaseItem);
 
-    auto w = m_WeaponFocusMap.find(w_bitem);
-    if ( w != m_WeaponFocusMap.end())
-    {
-        w->second.emplace((uint32_t)feat);
-    }
-    else
-    {
-        m_WeaponFocusMap.insert({w_bitem, {(uint32_t)feat}});
-    }
+    m_WeaponFocusFeats.Add(w_bitem, feat);
     auto featName = pFeat->GetNameText();
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Weapon Focus Feat %d [%s] added for Base Item Type %d [%s]", feat, featName, w_bitem, baseItemName);
@@ -123,15 +115,7 @@ ArgumentStack Weapon::SetGreaterWeaponFocusFeat(ArgumentStack&& args)
     CNWBaseItem *pBaseItem = Globals::Rules()->m_pBaseItemArray->GetBaseItem(w_bitem);
       ASSERT_OR_THROW(pBaseItem);
 
-    auto w = m_GreaterWeaponFocusMap.find(w_bitem);
-    if ( w != m_GreaterWeaponFocusMap.end())
-    {
-        w->second.emplace((uint32_t)feat);
-    }
-    else
-    {
-        m_GreaterWeaponFocusMap.insert({w_bitem, {(uint32_t)feat}});
-    }
+    m_GreaterWeaponFocusFeats.Add(w_bitem, feat);
     auto featName = pFeat->GetNameText();
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Greater Weapon Focus Feat %d [%s] added for Base Item Type %d [%s]", feat, featName, w_bitem, baseItemName);
@@ -153,15 +137,7 @@ ArgumentStack Weapon::SetEpicWeaponFocusFeat(ArgumentStack&& args)
     CNWBaseItem *pBaseItem = Globals::Rules()->m_pBaseItemArray->GetBaseItem(w_bitem);
       ASSERT_OR_THROW(pBaseItem);
 
-    auto w = m_EpicWeaponFocusMap.find(w_bitem);
-    if ( w != m_EpicWeaponFocusMap.end())
-    {
-        w->second.emplace((uint32_t)feat);
-    }
-    else
-    {
-        m_EpicWeaponFocusMap.insert({w_bitem, {(uint32_t)feat}});
-    }
+    m_EpicWeaponFocusFeats.Add(w_bitem, feat);
     auto featName = pFeat->GetNameText();
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Epic Weapon Focus Feat %d [%s] added for Base Item Type %d [%s]", feat, featName, w_bitem, baseItemName);
@@ -248,15 +224,7 @@ ArgumentStack Weapon::SetWeaponImprovedCriticalFeat(ArgumentStack&& args)
     CNWBaseItem *pBaseItem = Globals::Rules()->m_pBaseItemArray->GetBaseItem(w_bitem);
       ASSERT_OR_THROW(pBaseItem);
 
-    auto w = m_WeaponImprovedCriticalMap.find(w_bitem);
-    if ( w != m_WeaponImprovedCriticalMap.end())
-    {
-        w->second.emplace((uint32_t)feat);
-    }
-    else
-    {
-        m_WeaponImprovedCriticalMap.insert({w_bitem, {(uint32_t)feat}});
-    }
+    m_WeaponImprovedCriticalFeats.Add(w_bitem, feat);
     auto featName = pFeat->GetNameText();
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Improved Critical Feat %d [%s] added for Base Item Type %d [%s]", feat, featName, w_bitem, baseItemName);
@@ -278,15 +246,7 @@ ArgumentStack Weapon::SetWeaponSpecializationFeat(ArgumentStack&& args)
     CNWBaseItem *pBaseItem = Globals::Rules()->m_pBaseItemArray->GetBaseItem(w_bitem);
       ASSERT_OR_THROW(pBaseItem);
 
-    auto w = m_WeaponSpecializationMap.find(w_bitem);
-    if ( w != m_WeaponSpecializationMap.end())
-    {
-        w->second.emplace((uint32_t)feat);
-    }
-    else
-    {
-        m_WeaponSpecializationMap.insert({w_bitem, {(uint32_t)feat}});
-    }
+    m_WeaponSpecializationFeats.Add(w_bitem, feat);
     auto featName = pFeat->GetNameText();
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Weapon Specialization Feat %d [%s] added for Base Item Type %d [%s]", feat, featName, w_bitem, baseItemName);
@@ -308,15 +268,7 @@ ArgumentStack Weapon::SetGreaterWeaponSpecializationFeat(ArgumentStack&& args)
     CNWBaseItem *pBaseItem = Globals::Rules()->m_pBaseItemArray->GetBaseItem(w_bitem);
       ASSERT_OR_THROW(pBaseItem);
 
-    auto w = m_GreaterWeaponSpecializationMap.find(w_bitem);
-    if ( w != m_GreaterWeaponSpecializationMap.end())
-    {
-        w->second.emplace((uint32_t)feat);
-    }
-    else
-    {
-        m_GreaterWeaponSpecializationMap.insert({w_bitem, {(uint32_t)feat}});
-    }
+    m_GreaterWeaponSpecializationFeats.Add(w_bitem, feat);
     auto featName = pFeat->GetNameText();
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Greater Weapon Specialization Feat %d [%s] added for Base Item Type %d [%s]", feat, featName, w_bitem, baseItemName);
@@ -338,15 +290,7 @@ ArgumentStack Weapon::SetEpicWeaponSpecializationFeat(ArgumentStack&& args)
     CNWBaseItem *pBaseItem = Globals::Rules()->m_pBaseItemArray->GetBaseItem(w_bitem);
       ASSERT_OR_THROW(pBaseItem);
 
-    auto w = m_EpicWeaponSpecializationMap.find(w_bitem);
-    if ( w != m_EpicWeaponSpecializationMap.end())
-    {
-        w->second.emplace((uint32_t)feat);
-    }
-    else
-    {
-        m_EpicWeaponSpecializationMap.insert({w_bitem, {(uint32_t)feat}});
-    }
+    m_EpicWeaponSpecializationFeats.Add(w_bitem, feat);
     auto featName = pFeat->GetNameText();
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Epic Weapon Specialization Feat %d [%s] added for Base Item Type %d [%s]", feat, featName, w_bitem, baseItemName);
@@ -368,15 +312,7 @@ ArgumentStack Weapon::SetEpicWeaponOverwhelmingCriticalFeat(ArgumentStack&& args
     CNWBaseItem *pBaseItem = Globals::Rules()->m_pBaseItemArray->GetBaseItem(w_bitem);
       ASSERT_OR_THROW(pBaseItem);
 
-    auto w = m_EpicWeaponOverwhelmingCriticalMap.find(w_bitem);
-    if ( w != m_EpicWeaponOverwhelmingCriticalMap.end())
-    {
-        w->second.emplace((uint32_t)feat);
-    }
-    else
-    {
-        m_EpicWeaponOverwhelmingCriticalMap.insert({w_bitem, {(uint32_t)feat}});
-    }
+    m_EpicWeaponOverwhelmingCriticalFeats.Add(w_bitem, feat);
     auto featName = pFeat->GetNameText();
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Overwhelming Critical Feat %d [%s] added for Base Item Type %d [%s]", feat, featName, w_bitem, baseItemName);
@@ -398,15 +334,7 @@ ArgumentStack Weapon::SetEpicWeaponDevastatingCriticalFeat(ArgumentStack&& args)
     CNWBaseItem *pBaseItem = Globals::Rules()->m_pBaseItemArray->GetBaseItem(w_bitem);
       ASSERT_OR_THROW(pBaseItem);
 
-    auto w = m_EpicWeaponDevastatingCriticalMap.find(w_bitem);
-    if ( w != m_EpicWeaponDevastatingCriticalMap.end())
-    {
-        w->second.emplace((uint32_t)feat);
-    }
-    else
-    {
-        m_EpicWeaponDevastatingCriticalMap.insert({w_bitem, {(uint32_t)feat}});
-    }
+    m_EpicWeaponDevastatingCriticalFeats.Add(w_bitem, feat);
     auto featName = pFeat->GetNameText();
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Devastating Critical Feat %d [%s] added for Base Item Type %d [%s]", feat, featName, w_bitem, baseItemName);
@@ -428,15 +356,7 @@ ArgumentStack Weapon::SetWeaponOfChoiceFeat(ArgumentStack&& args)
     CNWBaseItem *pBaseItem = Globals::Rules()->m_pBaseItemArray->GetBaseItem(w_bitem);
       ASSERT_OR_THROW(pBaseItem);
 
-    auto w = m_WeaponOfChoiceMap.find(w_bitem);
-    if ( w != m_WeaponOfChoiceMap.end())
-    {
-        w->second.emplace((uint32_t)feat);
-    }
-    else
-    {
-        m_WeaponOfChoiceMap.insert({w_bitem, {(uint32_t)feat}});
-    }
+    m_WeaponOfChoiceFeats.Add(w_bitem, feat);
     auto featName = pFeat->GetNameText();
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Weapon of Choice Feat %d [%s] added for Base Item Type %d [%s]", feat, featName, w_bitem, baseItemName);
@@ -507,13 +427,13 @@ int32_t Weapon::GetWeaponFocus(CNWSCreatureStats* pStats, CNWSItem* pWeapon)
     Weapon& plugin = *g_plugin;
 
 
-    auto w = plugin.m_WeaponFocusMap.find(pWeapon == nullptr ? (uint32_t)Constants::BaseItem::Gloves : pWeapon->m_nBaseItem);
+    auto *pFeats = plugin.m_WeaponFocusFeats.Get(pWeapon == nullptr ? (uint32_t)Constants::BaseItem::Gloves : pWeapon->m_nBaseItem);
 
-    bApplicableFeatExists = w != plugin.m_WeaponFocusMap.end();
+    bApplicableFeatExists = pFeats != nullptr;
 
     if (bApplicableFeatExists)
     {
-        for (auto feat : w->second)
+        for (auto feat : *pFeats)
         {
             bHasApplicableFeat = (pStats->HasFeat(feat) || (feat == Constants::Feat::WeaponFocus_Creature &&
             pStats->HasFeat(Constants::Feat::WeaponFocus_UnarmedStrike)));
@@ -531,13 +451,13 @@ int32_t Weapon::GetEpicWeaponFocus(CNWSCreatureStats* pStats, CNWSItem* pWeapon)
     int32_t bHasApplicableFeat = 0;
     Weapon& plugin = *g_plugin;
 
-    auto w = plugin.m_EpicWeaponFocusMap.find(pWeapon == nullptr ? (uint32_t)Constants::BaseItem::Gloves : pWeapon->m_nBaseItem);
+    auto *pFeats = plugin.m_EpicWeaponFocusFeats.Get(pWeapon == nullptr ? (uint32_t)Constants::BaseItem::Gloves : pWeapon->m_nBaseItem);
 
-    bApplicableFeatExists = w != plugin.m_EpicWeaponFocusMap.end();
+    bApplicableFeatExists = pFeats != nullptr;
 
     if (bApplicableFeatExists)
     {
-        for (auto feat : w->second)
+        for (auto feat : *pFeats)
         {
             bHasApplicableFeat = (pStats->HasFeat(feat) || (feat == Constants::Feat::EpicWeaponFocus_Creature &&
             pStats->HasFeat(Constants::Feat::EpicWeaponFocus_Unarmed)));
@@ -555,13 +475,13 @@ int32_t Weapon::GetWeaponImprovedCritical(CNWSCreatureStats* pStats, CNWSItem* p
     Weapon& plugin = *g_plugin;
 
 
-    auto w = plugin.m_WeaponImprovedCriticalMap.find(pWeapon == nullptr ? (uint32_t)Constants::BaseItem::Gloves : pWeapon->m_nBaseItem);
+    auto *pFeats = plugin.m_WeaponImprovedCriticalFeats.Get(pWeapon == nullptr ? (uint32_t)Constants::BaseItem::Gloves : pWeapon->m_nBaseItem);
 
-    bApplicableFeatExists = w != plugin.m_WeaponImprovedCriticalMap.end();
+    bApplicableFeatExists = pFeats != nullptr;
 
     if (bApplicableFeatExists)
     {
-        for (auto feat : w->second)
+        for (auto feat : *pFeats)
         {
             bHasApplicableFeat = (pStats->HasFeat(feat));
 
@@ -579,13 +499,13 @@ int32_t Weapon::GetWeaponSpecialization(CNWSCreatureStats* pStats, CNWSItem* pWe
     Weapon& plugin = *g_plugin;
 
 
-    auto w = plugin.m_WeaponSpecializationMap.find(pWeapon == nullptr ? (uint32_t)Constants::BaseItem::Gloves : pWeapon->m_nBaseItem);
+    auto *pFeats = plugin.m_WeaponSpecializationFeats.Get(pWeapon == nullptr ? (uint32_t)Constants::BaseItem::Gloves : pWeapon->m_nBaseItem);
 
-    bApplicableFeatExists = w != plugin.m_WeaponSpecializationMap.end();
+    bApplicableFeatExists = pFeats != nullptr;
 
     if (bApplicableFeatExists)
     {
-        for (auto feat : w->second)
+        for (auto feat : *pFeats)
         {
             bHasApplicableFeat = (pStats->HasFeat(feat));
 
@@ -603,13 +523,13 @@ int32_t Weapon::GetEpicWeaponSpecialization(CNWSCreatureStats* pStats, CNWSItem*
     Weapon& plugin = *g_plugin;
 
 
-    auto w = plugin.m_EpicWeaponSpecializationMap.find(pWeapon == nullptr ? (uint32_t)Constants::BaseItem::Gloves : pWeapon->m_nBaseItem);
+    auto *pFeats = plugin.m_EpicWeaponSpecializationFeats.Get(pWeapon == nullptr ? (uint32_t)Constants::BaseItem::Gloves : pWeapon->m_nBaseItem);
 
-    bApplicableFeatExists = w != plugin.m_EpicWeaponSpecializationMap.end();
+    bApplicableFeatExists = pFeats != nullptr;
 
     if (bApplicableFeatExists)
     {
-        for (auto feat : w->second)
+        for (auto feat : *pFeats)
         {
             bHasApplicableFeat = (pStats->HasFeat(feat));
 
@@ -627,13 +547,13 @@ int32_t Weapon::GetEpicWeaponOverwhelmingCritical(CNWSCreatureStats* pStats, CNW
     Weapon& plugin = *g_plugin;
 
 
-    auto w = plugin.m_EpicWeaponOverwhelmingCriticalMap.find(pWeapon == nullptr ? (uint32_t)Constants::BaseItem::Gloves : pWeapon->m_nBaseItem);
+    auto *pFeats = plugin.m_EpicWeaponOverwhelmingCriticalFeats.Get(pWeapon == nullptr ? (uint32_t)Constants::BaseItem::Gloves : pWeapon->m_nBaseItem);
 
-    bApplicableFeatExists = w != plugin.m_EpicWeaponOverwhelmingCriticalMap.end();
+    bApplicableFeatExists = pFeats != nullptr;
 
     if (bApplicableFeatExists)
     {
-        for (auto feat : w->second)
+        for (auto feat : *pFeats)
         {
             bHasApplicableFeat = (pStats->HasFeat(feat));
 
@@ -651,13 +571,13 @@ int32_t Weapon::GetEpicWeaponDevastatingCritical(CNWSCreatureStats* pStats, CNWS
     Weapon& plugin = *g_plugin;
 
 
-    auto w = plugin.m_EpicWeaponDevastatingCriticalMap.find(pWeapon == nullptr ? (uint32_t)Constants::BaseItem::Gloves : pWeapon->m_nBaseItem);
+    auto *pFeats = plugin.m_EpicWeaponDevastatingCriticalFeats.Get(pWeapon == nullptr ? (uint32_t)Constants::BaseItem::Gloves : pWeapon->m_nBaseItem);
 
-    bApplicableFeatExists = w != plugin.m_EpicWeaponDevastatingCriticalMap.end();
+    bApplicableFeatExists = pFeats != nullptr;
 
     if (bApplicableFeatExists)
     {
-        for (auto feat : w->second)
+        for (auto feat : *pFeats)
         {
             bHasApplicableFeat = (pStats->HasFeat(feat));
 
@@ -697,13 +617,13 @@ int32_t Weapon::GetIsWeaponOfChoice(CNWSCreatureStats* pStats, uint32_t nBaseIte
     Weapon& plugin = *g_plugin;
 
 
-    auto w = plugin.m_WeaponOfChoiceMap.find(nBaseItem);
+    auto *pFeats = plugin.m_WeaponOfChoiceFeats.Get(nBaseItem);
 
-    bApplicableFeatExists = w != plugin.m_WeaponOfChoiceMap.end();
+    bApplicableFeatExists = pFeats != nullptr;
 
     if (bApplicableFeatExists)
     {
-        for (auto feat : w->second)
+        for (auto feat : *pFeats)
         {
             bHasApplicableFeat = (pStats->HasFeat(feat));
 
@@ -764,13 +684,13 @@ int32_t Weapon::GetMeleeDamageBonus(CNWSCreatureStats* pStats, int32_t bOffHand,
     }
 
 
-    auto w = plugin.m_GreaterWeaponSpecializationMap.find(nBaseItem);
+    auto *pFeats = plugin.m_GreaterWeaponSpecializationFeats.Get(nBaseItem);
 
-    bApplicableFeatExists = w != plugin.m_GreaterWeaponSpecializationMap.end();
+    bApplicableFeatExists = pFeats != nullptr;
 
     if (bApplicableFeatExists)
     {
-        for (auto feat : w->second)
+        for (auto feat : *pFeats)
         {
             bHasApplicableFeat = (pStats->HasFeat(feat));
 
@@ -833,13 +753,13 @@ int32_t Weapon::GetDamageBonus(CNWSCreatureStats* pStats, CNWSCreature *pCreatur
     }
 
 
-    auto w = plugin.m_GreaterWeaponSpecializationMap.find(nBaseItem);
+    auto *pFeats = plugin.m_GreaterWeaponSpecializationFeats.Get(nBaseItem);
 
-    bApplicableFeatExists = w != plugin.m_GreaterWeaponSpecializationMap.end();
+    bApplicableFeatExists = pFeats != nullptr;
 
     if (bApplicableFeatExists)
     {
-        for (auto feat : w->second)
+        for (auto feat : *pFeats)
         {
             bHasApplicableFeat = (pStats->HasFeat(feat));
 
@@ -898,13 +818,13 @@ int32_t Weapon::GetRangedDamageBonus(CNWSCreatureStats* pStats)
         nBaseItem = pWeapon->m_nBaseItem;
     }
 
-    auto w = plugin.m_GreaterWeaponSpecializationMap.find(nBaseItem);
+    auto *pFeats = plugin.m_GreaterWeaponSpecializationFeats.Get(nBaseItem);
 
-    bApplicableFeatExists = w != plugin.m_GreaterWeaponSpecializationMap.end();
+    bApplicableFeatExists = pFeats != nullptr;
 
     if (bApplicableFeatExists)
     {
-        for (auto feat : w->second)
+        for (auto feat : *pFeats)
         {
             bHasApplicableFeat = (pStats->HasFeat(feat));
 
@@ -947,13 +867,13 @@ int32_t Weapon::GetAttackModifierVersus(CNWSCreatureStats* pStats, CNWSCreature*
         nBaseItem = pWeapon->m_nBaseItem;
     }
 
-    auto w = plugin.m_GreaterWeaponFocusMap.find(nBaseItem);
+    auto *pFeats = plugin.m_GreaterWeaponFocusFeats.Get(nBaseItem);
 
-    bApplicableFeatExists = w != plugin.m_GreaterWeaponFocusMap.end();
+    bApplicableFeatExists = pFeats != nullptr;
 
     if (bApplicableFeatExists)
     {
-        for (auto feat : w->second)
+        for (auto feat : *pFeats)
         {
             bHasApplicableFeat = (pStats->HasFeat(feat));
 
@@ -1040,13 +960,13 @@ int32_t Weapon::GetMeleeAttackBonus(CNWSCreatureStats* pStats, int32_t bOffHand,
         nBaseItem = pWeapon->m_nBaseItem;
     }
 
-    auto w = plugin.m_GreaterWeaponFocusMap.find(nBaseItem);
+    auto *pFeats = plugin.m_GreaterWeaponFocusFeats.Get(nBaseItem);
 
-    bApplicableFeatExists = w != plugin.m_GreaterWeaponFocusMap.end();
+    bApplicableFeatExists = pFeats != nullptr;
 
     if (bApplicableFeatExists)
     {
-        for (auto feat : w->second)
+        for (auto feat : *pFeats)
         {
             bHasApplicableFeat = (pStats->HasFeat(feat));
 
@@ -1087,13 +1007,13 @@ int32_t Weapon::GetRangedAttackBonus(CNWSCreatureStats* pStats, int32_t bInclude
 
     nBaseItem = pWeapon->m_nBaseItem;
 
-    auto w = plugin.m_GreaterWeaponFocusMap.find(nBaseItem);
+    auto *pFeats = plugin.m_GreaterWeaponFocusFeats.Get(nBaseItem);
 
-    bApplicableFeatExists = w != plugin.m_GreaterWeaponFocusMap.end();
+    bApplicableFeatExists = pFeats != nullptr;
 
     if (bApplicableFeatExists)
     {
-        for (auto feat : w->second)
+        for (auto feat : *pFeats)
         {
             bHasApplicableFeat = (pStats->HasFeat(feat));
 
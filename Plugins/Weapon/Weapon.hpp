@@ -1,7 +1,7 @@
 #pragma once
 
 #include "nwnx.hpp"
-#include <map>
+#include <algorithm>
 #include <set>
 #include "API/CNWSCreature.hpp"
 #include "API/CNWSCreatureStats.hpp"
@@ -28,6 +28,29 @@ struct MaxRangedAttackDistanceOverride
     float maxRangedPassiveAttackDistance;
 };
 
+// Weapon feats registered by scripts, indexed by base item id.
+class WeaponFeats
+{
+public:
+    void Add(uint32_t nBaseItem, uint16_t nFeat)
+    {
+        if (nBaseItem >= m_Feats.size())
+            m_Feats.resize(nBaseItem + 1);
+        auto& feats = m_Feats[nBaseItem];
+        if (std::find(feats.begin(), feats.end(), nFeat) == feats.end())
+            feats.push_back(nFeat);
+    }
+
+    // nullptr if no feats are registered for the base item.
+    const std::vector<uint16_t>* Get(uint32_t nBaseItem) const
+    {
+        return nBaseItem < m_Feats.size() && !m_Feats[nBaseItem].empty() ? &m_Feats[nBaseItem] : nullptr;
+    }
+
+private:
+    std::vector<std::vector<uint16_t>> m_Feats;
+};
+
 using ArgumentStack = NWNXLib::ArgumentStack;
 
 namespace Weapon {
@@ -91,16 +114,16 @@ private:
     static int32_t GetRangedAttackBonus             (CNWSCreatureStats *pStats, int32_t bIncludeBase, int32_t bTouchAttack);
     static int32_t GetAttackModifierVersus          (CNWSCreatureStats *pStats, CNWSCreature* pCreature);
 
-    std::map<std::uint32_t, std::set<std::uint32_t>> m_WeaponFocusMap;
-    std::map<std::uint32_t, std::set<std::uint32_t>> m_EpicWeaponFocusMap;
-    std::map<std::uint32_t, std::set<std::uint32_t>> m_WeaponImprovedCriticalMap;
-    std::map<std::uint32_t, std::set<std::uint32_t>> m_WeaponSpecializationMap;
-    std::map<std::uint32_t, std::set<std::uint32_t>> m_EpicWeaponSpecializationMap;
-    std::map<std::uint32_t, std::set<std::uint32_t>> m_EpicWeaponOverwhelmingCriticalMap;
-    std::map<std::uint32_t, std::set<std::uint32_t>> m_EpicWeaponDevastatingCriticalMap;
-    std::map<std::uint32_t, std::set<std::uint32_t>> m_WeaponOfChoiceMap;
-    std::map<std::uint32_t, std::set<std::uint32_t>> m_GreaterWeaponSpecializationMap;
-    std::map<std::uint32_t, std::set<std::uint32_t>> m_GreaterWeaponFocusMap;
+    WeaponFeats m_WeaponFocusFeats;
+    WeaponFeats m_EpicWeaponFocusFeats;
+    WeaponFeats m_WeaponImprovedCriticalFeats;
+    WeaponFeats m_WeaponSpecializationFeats;
+    WeaponFeats m_EpicWeaponSpecializationFeats;
+    WeaponFeats m_EpicWeaponOverwhelmingCriticalFeats;
+    WeaponFeats m_EpicWeaponDevastatingCriticalFeats;
+    WeaponFeats m_WeaponOfChoiceFeats;
+    WeaponFeats m_GreaterWeaponSpecializationFeats;
+    WeaponFeats m_GreaterWeaponFocusFeats;
 
     std::set<std::uint32_t>  m_WeaponUnarmedSet;
 